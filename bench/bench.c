@@ -0,0 +1,224 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "menu.h"
+#include "menu_latency.h"
+#include "bench.h"
+
+bench_alloc_stat_t bench_alloc_stat; ///< Счётчики выделений, обновляются хуками MENU_MALLOC/MENU_FREE
+
+/**
+ * @brief Заголовок блока памяти: хранит размер, чтобы free мог уменьшить bytes_current.
+ *        Объединение с max_align_t сохраняет выравнивание полезной нагрузки.
+ */
+typedef union {
+    size_t      size;
+    max_align_t align;
+} bench_alloc_header_t;
+
+void *menu_hook_malloc (size_t size)
+{
+    if (bench_alloc_stat.bytes_limit && bench_alloc_stat.bytes_current + size > bench_alloc_stat.bytes_limit)
+        return NULL;
+
+    bench_alloc_header_t *header = malloc(sizeof(bench_alloc_header_t) + size);
+    if (header == NULL)
+        return NULL;
+
+    header->size = size;
+    bench_alloc_stat.allocs++;
+    bench_alloc_stat.bytes_current += size;
+    if (bench_alloc_stat.bytes_current > bench_alloc_stat.bytes_peak)
+    {
+        bench_alloc_stat.bytes_peak = bench_alloc_stat.bytes_current;
+    }
+
+    return header + 1;
+}
+
+void menu_hook_free (void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    bench_alloc_header_t *header = (bench_alloc_header_t *)ptr - 1;
+    bench_alloc_stat.frees++;
+    bench_alloc_stat.bytes_current -= header->size;
+    free(header);
+}
+
+/**
+ * @brief Сбрасывает счётчики выделений. Текущий объём сохраняется, пик приравнивается к нему.
+ */
+void bench_alloc_reset (void)
+{
+    bench_alloc_stat.allocs     = 0;
+    bench_alloc_stat.frees      = 0;
+    bench_alloc_stat.bytes_peak = bench_alloc_stat.bytes_current;
+}
+
+/**
+ * @brief Монотонное время в наносекундах.
+ */
+uint64_t bench_now_ns (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+/**
+ * @brief Проигрывает скрипт ввода через колбэки меню.
+ *
+ * @param input Источник ввода с колбэками, полученными в taskReadKey.
+ * @param script Строка скрипта (см. bench_input_t).
+ * @return Количество сгенерированных событий.
+ */
+uint32_t bench_play (bench_input_t *input, const char *script)
+{
+    uint32_t events = 0;
+
+    for (; *script; script++)
+    {
+        if (*script == '+' || *script == '-' || *script == '*' || *script == '!' || (*script == '/' && input->jump))
+        {
+            MENU_LATENCY_BEGIN();
+        }
+
+        switch (*script)
+        {
+            case '+':
+                input->encoder += 2;
+                input->rotary(input->encoder);
+                break;
+            case '-':
+                input->encoder -= 2;
+                input->rotary(input->encoder);
+                break;
+            case '*':
+                input->push();
+                break;
+            case '!':
+                input->long_push();
+                break;
+            case '/':
+                if (script[1] == '\0')
+                    continue;
+                script++;
+                if (input->jump == NULL)
+                    continue;
+                input->jump(*script);
+                break;
+            case '#':
+                while (script[1] && script[1] != '\n')
+                    script++;
+                continue;
+            default:
+                continue;
+        }
+        events++;
+    }
+
+    return events;
+}
+
+/**
+ * @brief FNV-1a, используется для свёртки последовательности кадров в одно число.
+ */
+uint64_t bench_hash (uint64_t hash, const void *data, size_t len)
+{
+    const uint8_t *bytes = data;
+
+    if (hash == 0)
+        hash = 0xcbf29ce484222325ull;
+
+    while (len--)
+    {
+        hash ^= *bytes++;
+        hash *= 0x100000001b3ull;
+    }
+
+    return hash;
+}
+
+/**
+ * @brief Читает файл целиком в строку, завершённую нулём. Возвращает NULL при ошибке.
+ */
+char *bench_read_file (const char *path)
+{
+    FILE *file = fopen(path, "rb");
+    if (file == NULL)
+        return NULL;
+
+    fseek(file, 0, SEEK_END);
+    long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char *text = malloc((size_t)size + 1);
+    if (text != NULL)
+    {
+        size_t n = fread(text, 1, (size_t)size, file);
+        text[n] = '\0';
+    }
+
+    fclose(file);
+    return text;
+}
+
+#define BENCH_STACK_PATTERN 0xA5
+
+static uintptr_t s_stack_painted; ///< Нижний адрес окрашенной области
+
+/**
+ * @brief Окрашивает BENCH_STACK_PAINT байт стека ниже текущего кадра.
+ */
+static __attribute__((noinline)) void s_stack_paint (void)
+{
+    volatile uint8_t area[BENCH_STACK_PAINT];
+
+    for (size_t i = 0; i < sizeof(area); i++)
+    {
+        area[i] = BENCH_STACK_PATTERN;
+    }
+    s_stack_painted = (uintptr_t)area;
+}
+
+static __attribute__((noinline)) size_t s_stack_measure (void (*fn)(void *arg), void *arg)
+{
+    volatile uint8_t marker = 0;
+    uintptr_t top = (uintptr_t)&marker;
+
+    s_stack_paint();
+    fn(arg);
+
+    // Стек растёт вниз: первый изменённый байт снизу -- самая глубокая точка
+    const volatile uint8_t *p = (const volatile uint8_t *)s_stack_painted;
+    const volatile uint8_t *end = p + BENCH_STACK_PAINT;
+    while (p < end && *p == BENCH_STACK_PATTERN)
+    {
+        p++;
+    }
+
+    return top - (uintptr_t)p;
+}
+
+static void s_stack_noop (void *arg)
+{
+    (void)arg;
+}
+
+/**
+ * @brief Пиковая глубина стека вызова fn(arg) методом окраски, как на микроконтроллере.
+ *
+ * Из результата вычитается глубина пустого вызова, поэтому остаётся стек самой fn
+ * и всего, что она вызывает. Результат приблизительный (точность -- несколько слов).
+ */
+size_t bench_stack_usage (void (*fn)(void *arg), void *arg)
+{
+    size_t base = s_stack_measure(s_stack_noop, NULL);
+    size_t used = s_stack_measure(fn, arg);
+
+    return used > base ? used - base : 0;
+}
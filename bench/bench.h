@@ -0,0 +1,52 @@
+#include <stdint.h>
+#include <stddef.h>
+
+#include "console.h"
+
+#ifndef __BENCH_H__
+#define __BENCH_H__
+
+#define BENCH_STACK_PAINT 0x4000 ///< Размер окрашиваемой области стека для bench_stack_usage
+
+/**
+ * @typedef bench_alloc_stat_t
+ * @brief Счётчики выделений памяти, собираемые через MENU_ALLOC_HOOKS.
+ */
+typedef struct {
+    uint64_t allocs;        ///< Количество вызовов MENU_MALLOC
+    uint64_t frees;         ///< Количество вызовов MENU_FREE
+    uint64_t bytes_current; ///< Занято байт в данный момент
+    uint64_t bytes_peak;    ///< Максимум занятых байт
+    uint64_t bytes_limit;   ///< Ограничение кучи: MENU_MALLOC сверх него возвращает NULL (0 -- без ограничения)
+} bench_alloc_stat_t;
+
+/**
+ * @typedef bench_input_t
+ * @brief Скриптовый источник ввода, заменяющий taskReadKey из console.c.
+ *
+ * Скрипт -- строка символов:
+ * - `+` -- поворот энкодера вперёд (как стрелка вниз в консоли);
+ * - `-` -- поворот энкодера назад (стрелка вверх);
+ * - `*` -- короткое нажатие кнопки (Enter);
+ * - `!` -- длинное нажатие кнопки ('d');
+ * - `/X` -- быстрый переход по букве X ('/' и X в консоли), если задан колбэк `jump`;
+ * - `#` -- комментарий до конца строки. Остальные символы игнорируются.
+ */
+typedef struct {
+    rotary_encoder_callback_t    rotary;    ///< Колбэк энкодера
+    push_button_callback_t       push;      ///< Колбэк короткого нажатия
+    long_push_buttont_callback_t long_push; ///< Колбэк длинного нажатия
+    uint32_t                     encoder;   ///< Текущее значение энкодера (шаг 2, как в console.c)
+    void                       (*jump) (char key); ///< Быстрый переход по букве (Menu_JumpKey), NULL -- `/X` пропускается
+} bench_input_t;
+
+extern bench_alloc_stat_t bench_alloc_stat;
+
+uint64_t bench_now_ns      (void);
+void     bench_alloc_reset (void);
+uint32_t bench_play        (bench_input_t *input, const char *script);
+uint64_t bench_hash        (uint64_t hash, const void *data, size_t len);
+char    *bench_read_file   (const char *path);
+size_t   bench_stack_usage (void (*fn)(void *arg), void *arg);
+
+#endif // __BENCH_H__
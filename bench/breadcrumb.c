@@ -0,0 +1,273 @@
+#include "bench.h"
+#include "lcd1602.h"
+
+/**
+ * Строка пути в первой строке дисплея (MENU_BREADCRUMB): стоимость поворота, входа и выхода.
+ *
+ * menu.c включается целиком с MENU_BREADCRUMB=1, printMenuHeader выводит кадр через драйвер
+ * lcd1602.c (LCD1602_RENDER_DIFF) на шину, которая считает байты данных, попавшие в первую строку.
+ * Дерево глубиной 5: 4 корневых пункта, на каждом уровне "Back" и 3-4 подменю с длинными
+ * заголовками ("Options>PWM>Frequency>Fine tune" не помещается в 16 знаков).
+ *
+ * JSON-строка: наносекунды на перерисовку при повороте на глубине 4 с готовой строкой пути и
+ * с построением строки заново на каждый кадр (как без пошагового обновления), на вход в подменю
+ * и выход из него, байты первой строки на поворот и на вход/выход, примеры строк. Проверки:
+ * случайное блуждание `--steps N` (`--seed S`) -- после каждого действия строка совпадает с
+ * построенной заново по цепочке родителей, не шире дисплея, кончается началом заголовка
+ * родителя текущего кольца; поворот не пишет в первую строку.
+ *
+ * Запуск: MenuBreadcrumb [--steps N] [--seed S]
+ */
+#include "../menu.c"
+
+#define CRUMB_DEPTH  4 ///< Уровней подменю под корнем
+#define CRUMB_REPEAT 200000
+
+static const char *s_crumb_titles[CRUMB_DEPTH + 1][4] = {
+    { "Options", "Status", "Hi Arm", "Lo Arm" },
+    { "PWM", "Display", "Network", "Calibration" },
+    { "Frequency", "Duty cycle", "Dead time", "Soft start" },
+    { "Fine tune", "Coarse", "Limits", NULL },
+    { "Step size", "Min value", "Max value", NULL },
+};
+
+static uint32_t s_crumb_steps = 20000;
+static uint32_t s_crumb_seed  = 1;
+static uint8_t  s_crumb_address;    ///< Адрес DDRAM на счётной шине
+static uint32_t s_crumb_header_data; ///< Байт данных, записанных в первую строку
+static const char *s_crumb_header;  ///< Строка пути последнего кадра
+
+static void s_crumb_write (uint8_t value, uint8_t rs)
+{
+    if (rs == 0)
+    {
+        if (value & LCD1602_CMD_SET_DDRAM)
+            s_crumb_address = value & 0x7F;
+        return;
+    }
+    if (s_crumb_address < LCD1602_ROW1_ADDR)
+        s_crumb_header_data++;
+    s_crumb_address++;
+}
+
+void printMenuHeader(const char *header, const char *str)
+{
+    s_crumb_header = header;
+    lcd1602_print_header(header, str);
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static uint32_t s_crumb_random (uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 16;
+}
+
+/**
+ * @brief Подменю уровня `level` пункта `parent`: "Back" и пункты уровня (с подменю, кроме последнего уровня).
+ */
+static void s_crumb_build (menu_item_t *parent, uint32_t level)
+{
+    menu_item_t *back = s_menu_add_item("Back", parent, NULL, MENU_FLAG_GOTO_PARENT);
+    s_menu_set_child(parent, back);
+
+    for (uint32_t i = 0; i < 4 && s_crumb_titles[level][i]; i++)
+    {
+        menu_item_t *item = s_menu_add_item((char *)s_crumb_titles[level][i], parent, NULL, 0);
+        if (level < CRUMB_DEPTH)
+            s_crumb_build(item, level + 1);
+    }
+}
+
+/**
+ * @brief Первый пункт кольца с заголовком `title` среди детей `parent`.
+ */
+static menu_item_t * s_crumb_child (menu_item_t *parent, const char *title)
+{
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+    {
+        if (item->parent == parent && strncmp(item->title, title, MENU_ITEM_TITLE_LEN) == 0)
+            return item;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Строка пути, построенная заново по цепочке родителей (эталон пошагового обновления).
+ */
+static void s_crumb_reference (const menu_item_t *parent, char *text)
+{
+    menu_breadcrumb_t saved = s_menu_handle.breadcrumb;
+
+    s_menu_handle.breadcrumb.valid = 0;
+    strcpy(text, s_menu_breadcrumb_follow(parent));
+    s_menu_handle.breadcrumb = saved;
+}
+
+/**
+ * @brief Строка пути годится: совпадает с эталоном, не шире дисплея, кончается началом заголовка родителя.
+ */
+static int s_crumb_check (void)
+{
+    char reference[MENU_BREADCRUMB_WIDTH + 1];
+    const menu_item_t *parent = s_menu_handle.current->parent;
+
+    s_crumb_reference(parent, reference);
+    if (strcmp(reference, s_crumb_header) != 0 || strlen(s_crumb_header) > MENU_BREADCRUMB_WIDTH)
+        return 0;
+    if (parent == NULL)
+        return strcmp(s_crumb_header, MENU_BREADCRUMB_ROOT) == 0;
+
+    const char *tail = strrchr(s_crumb_header, '>');
+    tail = tail ? tail + 1 : (s_crumb_header[0] == '<' ? s_crumb_header + 1 : s_crumb_header);
+    return tail[0] && strncmp(tail, parent->title, strlen(tail)) == 0;
+}
+
+/**
+ * @brief Наносекунды на перерисовку при повороте по кольцу пункта `item`; `rebuild` -- строка пути заново.
+ */
+static double s_crumb_rotate_ns (menu_item_t *item, int rebuild)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t round = 0; round < 5; round++)
+    {
+        s_menu_handle.current = item;
+        uint64_t start = bench_now_ns();
+        for (uint32_t r = 0; r < CRUMB_REPEAT; r++)
+        {
+            s_menu_handle.current = s_menu_handle.current->next;
+            if (rebuild)
+                s_menu_handle.breadcrumb.valid = 0;
+            s_display_menu();
+        }
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < best)
+            best = ns;
+    }
+    return (double)best / CRUMB_REPEAT;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+        {
+            s_crumb_steps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_crumb_seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--steps N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < 4; i++)
+    {
+        menu_item_t *root = s_menu_add_item((char *)s_crumb_titles[0][i], NULL, NULL, 0);
+        s_crumb_build(root, 1);
+    }
+
+    // Путь Options>PWM>Frequency>Fine tune: кольцо глубины 4 и его родитель
+    menu_item_t *path[CRUMB_DEPTH + 1];
+    path[0] = s_crumb_child(NULL, s_crumb_titles[0][0]);
+    for (uint32_t level = 1; level <= CRUMB_DEPTH; level++)
+        path[level] = s_crumb_child(path[level - 1], s_crumb_titles[level][0]);
+
+    lcd1602_init(s_crumb_write, LCD1602_RENDER_DIFF);
+
+    // Примеры строк на каждой глубине
+    char examples[CRUMB_DEPTH + 1][MENU_BREADCRUMB_WIDTH + 1];
+    for (uint32_t level = 0; level <= CRUMB_DEPTH; level++)
+    {
+        s_menu_handle.current = level ? path[level - 1]->child : s_menu_handle.start;
+        s_display_menu();
+        strcpy(examples[level], s_crumb_header);
+    }
+
+    // Поворот на глубине 4: байты первой строки и время с готовой строкой и с построением заново
+    menu_item_t *deep = path[CRUMB_DEPTH - 1]->child;
+    s_menu_handle.current = deep;
+    s_display_menu();
+    s_crumb_header_data = 0;
+    for (uint32_t r = 0; r < 64; r++)
+    {
+        s_menu_handle.current = s_menu_handle.current->next;
+        s_display_menu();
+    }
+    uint32_t rotate_header = s_crumb_header_data;
+
+    double rotate_ns  = s_crumb_rotate_ns(deep, 0);
+    double rebuild_ns = s_crumb_rotate_ns(deep, 1);
+
+    // Вход в подменю глубины 4 и выход из него: пошаговое обновление строки пути
+    menu_item_t *outer = path[CRUMB_DEPTH - 1];
+    s_menu_handle.current = outer;
+    s_display_menu();
+    s_crumb_header_data = 0;
+    uint64_t best = UINT64_MAX;
+    for (uint32_t round = 0; round < 5; round++)
+    {
+        uint64_t start = bench_now_ns();
+        for (uint32_t r = 0; r < CRUMB_REPEAT; r++)
+        {
+            s_menu_handle.current = deep;
+            s_display_menu();
+            s_menu_handle.current = outer;
+            s_display_menu();
+        }
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < best)
+            best = ns;
+    }
+    double enter_leave_ns = (double)best / (2.0 * CRUMB_REPEAT);
+    double enter_leave_header = (double)s_crumb_header_data / (5.0 * 2 * CRUMB_REPEAT);
+
+    // Случайное блуждание: поворот, вход, выход (длинное нажатие -- к родителю)
+    bench_input_t input = { s_rotary_encoder_callback, s_push_button_callback, s_long_push_button_callback, 0, NULL };
+    uint32_t state = s_crumb_seed ? s_crumb_seed : 1;
+    uint32_t bad = 0;
+    uint32_t rotations = 0;
+    uint32_t rotate_header_walk = 0;
+    s_menu_handle.current = s_menu_handle.start;
+    s_display_menu();
+    for (uint32_t step = 0; step < s_crumb_steps; step++)
+    {
+        static const char actions[] = "++--**!";
+        char script[2] = { actions[s_crumb_random(&state) % (sizeof(actions) - 1)], '\0' };
+        uint32_t before = s_crumb_header_data;
+
+        bench_play(&input, script);
+        if (!s_crumb_check())
+            bad++;
+        if (script[0] == '+' || script[0] == '-')
+        {
+            rotations++;
+            rotate_header_walk += s_crumb_header_data - before;
+        }
+    }
+
+    int ok = bad == 0 && rotate_header == 0 && rotate_header_walk == 0;
+    printf("{\"bench\":\"breadcrumb\",\"width\":%u,\"depth\":%u,\"rotate_ns\":%.2f,\"rotate_rebuild_ns\":%.2f,"
+           "\"enter_leave_ns\":%.2f,\"rotate_header_bytes\":%u,\"enter_leave_header_bytes\":%.2f,"
+           "\"steps\":%u,\"rotations\":%u,\"mismatches\":%u,\"examples\":[",
+           (uint32_t)MENU_BREADCRUMB_WIDTH, (uint32_t)CRUMB_DEPTH, rotate_ns, rebuild_ns, enter_leave_ns,
+           rotate_header + rotate_header_walk, enter_leave_header, s_crumb_steps, rotations, bad);
+    for (uint32_t level = 0; level <= CRUMB_DEPTH; level++)
+        printf("%s\"%s\"", level ? "," : "", examples[level]);
+    printf("]}\n");
+
+    s_menu_free_items();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,152 @@
+#include "bench.h"
+#include "lcd1602.h"
+
+/**
+ * Трафик шины HD44780 на одно действие пользователя.
+ *
+ * menu.c включается целиком, printMenu выводит кадр через драйвер lcd1602.c
+ * на счётную шину. Дерево: кольцо из 32 пунктов, у первого -- подменю с пунктом
+ * редактирования значения (колбэк пункта перехватывает поворот энкодера).
+ *
+ * Для каждой стратегии перерисовки и каждой последовательности действий выводится
+ * количество команд, байт данных и оценка времени шины на действие:
+ * - `gpio_us` -- 4-битная параллельная шина без чтения флага занятости: выполнение + 2 мкс на байт;
+ * - `i2c_us`  -- PCF8574 на 100 кГц: 4 байта I2C (~360 мкс) + старт/адрес (~100 мкс) на байт LCD,
+ *               выполнение обычных команд скрыто передачей, CLEAR/HOME ждут 1.52 мс.
+ *
+ * Запуск: MenuBus [--table]
+ */
+#include "../menu.c"
+
+#define BUS_RING_SIZE     32
+#define BUS_EDIT_STEPS    32
+#define BUS_GPIO_BYTE_US  2
+#define BUS_I2C_BYTE_US   460
+
+static void s_bus_write (uint8_t value, uint8_t rs)
+{
+    (void)value;
+    (void)rs;
+}
+
+void printMenu(const char *str1, const char *str2)
+{
+    lcd1602_print_menu(str1, str2);
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+/**
+ * @brief Колбэк пункта "Value": поворот энкодера меняет значение, оно выводится во второй строке.
+ */
+static void s_bus_edit_value (void)
+{
+    char value[MENU_ITEM_TITLE_LEN];
+    menu_item_t *item = s_menu_handle.current;
+
+    item->data += (uint32_t)s_menu_handle.rotenc.delta;
+    snprintf(value, sizeof(value), "%lu", (unsigned long)item->data);
+    printMenu(item->title, value);
+}
+
+static void s_bus_build (void)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+    menu_item_t *first = NULL;
+
+    for (uint32_t i = 0; i < BUS_RING_SIZE; i++)
+    {
+        snprintf(title, sizeof(title), "Item %02u", i);
+        menu_item_t *item = s_menu_add_item(title, NULL, NULL, 0);
+        if (first == NULL)
+            first = item;
+    }
+
+    menu_item_t *back = s_menu_add_item("Back",  first, NULL, MENU_FLAG_GOTO_PARENT);
+    menu_item_t *value = s_menu_add_item("Value", first, s_bus_edit_value, 0);
+    s_menu_add_item("Sub 2", first, NULL, 0);
+    s_menu_add_item("Sub 3", first, NULL, 0);
+    s_menu_set_child(first, back);
+
+    value->data = 100;
+    s_menu_handle.current = s_menu_handle.start;
+}
+
+/**
+ * @brief Последовательность действий. `setup` выполняется без учёта трафика.
+ */
+typedef struct {
+    const char *name;
+    const char *setup;
+    char        script[BUS_RING_SIZE * 2 + BUS_EDIT_STEPS + 8];
+} bus_sequence_t;
+
+static const char *s_render_names[LCD1602_RENDER_COUNT] = { "clear", "rewrite", "diff" };
+
+int main(int argc, char *argv[])
+{
+    int table = argc > 1 && strcmp(argv[1], "--table") == 0;
+    bus_sequence_t sequences[4] = {
+        { "scroll_ring", "",   "" },  // 32 шага вперёд по кольцу: полный круг
+        { "scroll_back", "",   "" },  // 32 шага назад
+        { "enter_leave", "",   "*" "*" "*" "*" "*" "*" "*" "*" },
+        { "edit_value",  "*+", "" },  // Вход в подменю и пункт Value, затем правка значения
+    };
+
+    memset(sequences[0].script, '+', BUS_RING_SIZE);
+    memset(sequences[1].script, '-', BUS_RING_SIZE);
+    memset(sequences[3].script, '+', BUS_EDIT_STEPS / 2);
+    memset(sequences[3].script + BUS_EDIT_STEPS / 2, '-', BUS_EDIT_STEPS / 2);
+
+    s_bus_build();
+
+    if (table)
+    {
+        printf("%-12s %-8s %8s %8s %8s %10s %10s\n", "sequence", "render", "actions", "cmd/act", "data/act", "gpio_us/act", "i2c_us/act");
+    }
+
+    for (uint32_t render = 0; render < LCD1602_RENDER_COUNT; render++)
+    {
+        for (uint32_t i = 0; i < sizeof(sequences) / sizeof(sequences[0]); i++)
+        {
+            bench_input_t input = { s_rotary_encoder_callback, s_push_button_callback, s_long_push_button_callback, 0, NULL };
+
+            lcd1602_init(s_bus_write, render);
+            s_menu_handle.current = s_menu_handle.start;
+            s_display_menu();
+            bench_play(&input, sequences[i].setup);
+
+            lcd1602_stat_reset();
+            uint32_t actions = bench_play(&input, sequences[i].script);
+            const lcd1602_stat_t *stat = lcd1602_stat();
+
+            uint32_t bytes   = stat->commands + stat->data;
+            double   gpio_us = (double)stat->exec_us + (double)bytes * BUS_GPIO_BYTE_US;
+            double   i2c_us  = (double)bytes * BUS_I2C_BYTE_US + (double)stat->slow_commands * LCD1602_EXEC_SLOW_US;
+
+            if (table)
+            {
+                printf("%-12s %-8s %8u %8.2f %8.2f %10.0f %10.0f\n", sequences[i].name, s_render_names[render], actions,
+                       (double)stat->commands / actions, (double)stat->data / actions, gpio_us / actions, i2c_us / actions);
+            }
+            else
+            {
+                printf("{\"bench\":\"bus\",\"sequence\":\"%s\",\"render\":\"%s\",\"actions\":%u,"
+                       "\"commands\":%u,\"slow_commands\":%u,\"data\":%u,"
+                       "\"commands_per_action\":%.2f,\"data_per_action\":%.2f,"
+                       "\"gpio_us_per_action\":%.1f,\"i2c_us_per_action\":%.1f}\n",
+                       sequences[i].name, s_render_names[render], actions,
+                       stat->commands, stat->slow_commands, stat->data,
+                       (double)stat->commands / actions, (double)stat->data / actions,
+                       gpio_us / actions, i2c_us / actions);
+            }
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,337 @@
+#include "bench.h"
+
+/**
+ * Перекодировка заголовков UTF-8 в коды HD44780 (lcd1602_transcode): пропускная способность и проверки.
+ *
+ * menu.c включается целиком с MENU_TITLE_CHARSET=1. Корпуса: заголовки латиницей, кириллицей
+ * и смешанные (числа, единицы, знак градуса). Для каждого корпуса и знакогенератора (A00,
+ * русифицированный) выводятся МБ/с входного UTF-8:
+ * - `titles` -- каждый заголовок в поле из MENU_ITEM_TITLE_LEN байт, как в s_menu_add_item;
+ * - `bulk`   -- корпус одной строкой около мегабайта (длинные серии ASCII идут векторной веткой);
+ * - `copy`   -- копирование тех же заголовков в поле (s_menu_copy_title), нижняя граница;
+ * лучший из --repeat прогонов. Цель MenuCharsetScalar собрана с LCD1602_CHARSET_SCALAR=1.
+ *
+ * Проверки: известные коды ("Частота" в обоих ПЗУ, неверные последовательности); результат
+ * для корпуса целиком совпадает с посимвольной перекодировкой; в A00 знаки без ПЗУ занимают
+ * CGRAM не больше LCD1602_CGRAM_SLOTS раз, загрузка CGRAM -- одна команда и 8 байт на знак;
+ * меню с русскими заголовками: 16 знаков в поле, s_menu_find и s_menu_search по UTF-8.
+ *
+ * Запуск: MenuCharset [--repeat N]
+ */
+#include "../menu.c"
+
+#define CHARSET_BULK (1u << 20)
+
+static const char *s_charset_ascii[] = {
+    "PWM Frequency", "Duty cycle", "Voltage", "Load current", "Temperature", "Brightness", "Contrast", "Language",
+    "Factory reset", "Calibration", "Event log", "Time", "Date", "Sound", "Backlight", "Exit",
+};
+
+static const char *s_charset_cyrillic[] = {
+    "Частота ШИМ", "Скважность", "Напряжение", "Ток нагрузки", "Температура", "Яркость", "Контраст", "Язык",
+    "Сброс настроек", "Калибровка", "Журнал событий", "Время", "Дата", "Звук", "Подсветка", "Выход",
+};
+
+static const char *s_charset_mixed[] = {
+    "ШИМ 20 кГц", "Порог 3.3 В", "Темп. 25°C", "Ток 150 мА", "Выход 1", "Выход 2", "Канал A", "Канал B",
+    "Задержка 10 мс", "Гистерезис 2°", "Яркость 80%", "Контраст 50%", "Modbus ID", "RS-485 9600", "Сеть: DHCP", "Назад",
+};
+
+typedef struct {
+    const char  *name;
+    const char **titles;
+    uint32_t     count;
+} charset_corpus_t;
+
+static const charset_corpus_t s_charset_corpora[] = {
+    { "ascii",    s_charset_ascii,    sizeof(s_charset_ascii) / sizeof(s_charset_ascii[0])       },
+    { "cyrillic", s_charset_cyrillic, sizeof(s_charset_cyrillic) / sizeof(s_charset_cyrillic[0]) },
+    { "mixed",    s_charset_mixed,    sizeof(s_charset_mixed) / sizeof(s_charset_mixed[0])       },
+};
+
+static const char *s_charset_roms[LCD1602_ROM_COUNT] = { "a00", "cyrillic" };
+
+static uint32_t s_charset_repeat = 20;
+static uint32_t s_charset_bus_commands;
+static uint32_t s_charset_bus_data;
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static void s_charset_bus (uint8_t value, uint8_t rs)
+{
+    (void)value;
+    if (rs)
+        s_charset_bus_data++;
+    else
+        s_charset_bus_commands++;
+}
+
+/**
+ * @brief Корпус одной строкой: заголовки через пробел, пока не наберётся `size` байт.
+ */
+static char * s_charset_bulk (const charset_corpus_t *corpus, uint32_t size, uint32_t *length)
+{
+    char *text = malloc(size + 1);
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; text; i++)
+    {
+        const char *title = corpus->titles[i % corpus->count];
+        uint32_t len = (uint32_t)strlen(title);
+        if (n + len + 1 > size)
+            break;
+        memcpy(text + n, title, len);
+        n += len;
+        text[n++] = ' ';
+    }
+    if (text)
+        text[n] = '\0';
+    *length = n;
+    return text;
+}
+
+/**
+ * @brief Посимвольная перекодировка: каждый символ UTF-8 отдельным вызовом (без серий ASCII).
+ */
+static uint32_t s_charset_reference (char *dst, const char *src)
+{
+    const uint8_t *in = (const uint8_t *)src;
+    uint32_t n = 0;
+    char one[5];
+
+    while (*in)
+    {
+        uint32_t len = 1;
+        while ((in[len] & 0xC0) == 0x80 && len < 4)
+            len++;
+        memcpy(one, in, len);
+        one[len] = '\0';
+        n  += lcd1602_transcode(dst + n, 1, one);
+        in += len;
+    }
+    return n;
+}
+
+static int s_charset_expect (lcd1602_rom_t rom, const char *src, const uint8_t *codes, uint32_t count)
+{
+    char out[MENU_ITEM_TITLE_LEN];
+
+    lcd1602_charset_init(rom);
+    uint32_t n = lcd1602_transcode(out, MENU_ITEM_TITLE_LEN, src);
+    return n == count && memcmp(out, codes, count) == 0;
+}
+
+static int s_charset_check (void)
+{
+    static const uint8_t frequency_cyrillic[] = { 0xAB, 0x61, 0x63, 0xBF, 0x6F, 0xBF, 0x61 };
+    static const uint8_t frequency_a00[]      = { 0x08, 0x61, 0x63, 0x54, 0x6F, 0x54, 0x61 };
+    static const uint8_t invalid[]            = { 'A', '?', 'B', '?', '?', '?', 'C', '?', '?', 'D', 0xDF };
+    static const uint8_t sixteen[]            = { 0xA8, 0x6F, 0xE3, 0x63, 0xB3, 0x65, 0xBF, 0xBA, 0x61, 0x20,
+                                                  0xE3, 0xB8, 0x63, 0xBE, 0xBB, 0x65 };
+    int ok = 1;
+
+    ok = ok && s_charset_expect(LCD1602_ROM_CYRILLIC, "Частота", frequency_cyrillic, sizeof(frequency_cyrillic));
+    ok = ok && s_charset_expect(LCD1602_ROM_A00, "Частота", frequency_a00, sizeof(frequency_a00));
+    ok = ok && lcd1602_cgram_used() == 1;
+    // Оборванная последовательность, избыточная запись (три замены: ведущий байт и два продолжения),
+    // одиночное продолжение, 4 байта, знак градуса в ПЗУ A00
+    ok = ok && s_charset_expect(LCD1602_ROM_A00, "A\xD0" "B\xE0\x80\xAF" "C\x80\xF0\x9F\x98\x80" "D\xC2\xB0",
+                                invalid, sizeof(invalid));
+    ok = ok && s_charset_expect(LCD1602_ROM_CYRILLIC, "Подсветка дисплея", sixteen, sizeof(sixteen));
+
+    // DEL внутри длинной серии ASCII (векторная ветка) заменяется, как управляющие символы
+    char del[40];
+    lcd1602_charset_init(LCD1602_ROM_A00);
+    ok = ok && lcd1602_transcode(del, sizeof(del), "Motor speed\x7F" "limit in rpm, max") == 29 &&
+         del[10] == 'd' && del[11] == LCD1602_CHARSET_MISS && del[12] == 'l';
+
+    // Корпус целиком и посимвольно дают одни и те же коды
+    for (uint32_t c = 0; c < sizeof(s_charset_corpora) / sizeof(s_charset_corpora[0]); c++)
+    {
+        for (uint32_t rom = 0; rom < LCD1602_ROM_COUNT; rom++)
+        {
+            uint32_t length;
+            char *text = s_charset_bulk(&s_charset_corpora[c], 4096, &length);
+            char *fast = malloc(length);
+            char *slow = malloc(length);
+
+            lcd1602_charset_init((lcd1602_rom_t)rom);
+            uint32_t n = text && fast ? lcd1602_transcode(fast, length, text) : 0;
+            lcd1602_charset_init((lcd1602_rom_t)rom);
+            uint32_t m = text && slow ? s_charset_reference(slow, text) : 1;
+            ok = ok && n == m && memcmp(fast, slow, n) == 0;
+            free(text);
+            free(fast);
+            free(slow);
+        }
+    }
+    return ok;
+}
+
+/**
+ * @brief Русское меню в A00: CGRAM кончается, загрузка знаков -- одна серия.
+ */
+static int s_charset_cgram (void)
+{
+    char out[MENU_ITEM_TITLE_LEN];
+
+    lcd1602_charset_init(LCD1602_ROM_A00);
+    for (uint32_t i = 0; i < sizeof(s_charset_cyrillic) / sizeof(s_charset_cyrillic[0]); i++)
+        lcd1602_transcode(out, MENU_ITEM_TITLE_LEN, s_charset_cyrillic[i]);
+
+    lcd1602_init(s_charset_bus, LCD1602_RENDER_DIFF);
+    s_charset_bus_commands = 0;
+    s_charset_bus_data     = 0;
+    lcd1602_cgram_load();
+
+    printf("{\"bench\":\"charset\",\"check\":\"cgram\",\"rom\":\"a00\",\"corpus\":\"cyrillic\",\"cgram_used\":%u,"
+           "\"missing\":%u,\"load_commands\":%u,\"load_data\":%u}\n",
+           lcd1602_cgram_used(), lcd1602_charset_missing(), s_charset_bus_commands, s_charset_bus_data);
+
+    return lcd1602_cgram_used() == LCD1602_CGRAM_SLOTS && lcd1602_charset_missing() > 0 &&
+           s_charset_bus_commands == 1 && s_charset_bus_data == 8 * LCD1602_CGRAM_SLOTS;
+}
+
+/**
+ * @brief Меню с русскими заголовками: поле хранит 16 знаков, поиск принимает UTF-8.
+ */
+static int s_charset_menu (void)
+{
+    menu_item_t *found[2];
+
+    lcd1602_charset_init(LCD1602_ROM_CYRILLIC);
+    menu_item_t *group = s_menu_add_item("Настройки", NULL, NULL, 0);
+    menu_item_t *item  = s_menu_add_item("Подсветка дисплея", group, NULL, 0);
+    if (group == NULL || item == NULL)
+        return 0;
+    s_menu_set_child(group, item);
+    s_menu_handle.current = s_menu_handle.start;
+
+    int ok = strnlen(item->title, MENU_ITEM_TITLE_LEN) == MENU_ITEM_TITLE_LEN &&
+             s_menu_find(NULL, "Подсветка дисплея") == item &&
+             s_menu_search("Настр", MENU_SEARCH_PREFIX, found, 2) == 1 && found[0] == group;
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_free_items();
+#endif
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+    return ok;
+}
+
+static void s_charset_run (const charset_corpus_t *corpus, lcd1602_rom_t rom)
+{
+    char field[MENU_ITEM_TITLE_LEN];
+    uint64_t title_bytes = 0;
+    uint64_t best_titles = UINT64_MAX;
+    uint64_t best_copy   = UINT64_MAX;
+    uint64_t best_bulk   = UINT64_MAX;
+    volatile char sink = 0;
+
+    for (uint32_t i = 0; i < corpus->count; i++)
+        title_bytes += strlen(corpus->titles[i]);
+
+    // Заголовки по одному в поле пункта; 1000 проходов по корпусу на замер
+    for (uint32_t r = 0; r < s_charset_repeat; r++)
+    {
+        lcd1602_charset_init(rom);
+        uint64_t start = bench_now_ns();
+        for (uint32_t k = 0; k < 1000; k++)
+        {
+            for (uint32_t i = 0; i < corpus->count; i++)
+            {
+                lcd1602_transcode(field, MENU_ITEM_TITLE_LEN, corpus->titles[i]);
+                sink ^= field[0];
+            }
+        }
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < best_titles)
+            best_titles = ns;
+
+        start = bench_now_ns();
+        for (uint32_t k = 0; k < 1000; k++)
+        {
+            for (uint32_t i = 0; i < corpus->count; i++)
+            {
+                s_menu_copy_title(field, corpus->titles[i]);
+                sink ^= field[0];
+            }
+        }
+        ns = bench_now_ns() - start;
+        if (ns < best_copy)
+            best_copy = ns;
+    }
+
+    uint32_t length;
+    char *text = s_charset_bulk(corpus, CHARSET_BULK, &length);
+    char *out  = malloc(CHARSET_BULK);
+    uint32_t codes = 0;
+    for (uint32_t r = 0; text && out && r < s_charset_repeat; r++)
+    {
+        lcd1602_charset_init(rom);
+        uint64_t start = bench_now_ns();
+        codes = lcd1602_transcode(out, CHARSET_BULK, text);
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < best_bulk)
+            best_bulk = ns;
+    }
+    free(text);
+    free(out);
+
+    double titles_mb = (double)title_bytes * 1000.0 / 1e6;
+    printf("{\"bench\":\"charset\",\"rom\":\"%s\",\"corpus\":\"%s\",\"simd\":\"%s\",\"bytes_per_code\":%.2f,"
+           "\"titles_mb_s\":%.1f,\"copy_mb_s\":%.1f,\"bulk_mb_s\":%.1f,\"cgram_used\":%u,\"missing\":%u}\n",
+           s_charset_roms[rom], corpus->name,
+#if defined(LCD1602_CHARSET_SCALAR)
+           "none",
+#elif defined(__SSE2__)
+           "sse2",
+#elif defined(__ARM_NEON) && defined(__aarch64__)
+           "neon",
+#else
+           "none",
+#endif
+           codes ? (double)length / codes : 0.0,
+           titles_mb / ((double)best_titles / 1e9), titles_mb / ((double)best_copy / 1e9),
+           (double)length / 1e6 / ((double)best_bulk / 1e9), lcd1602_cgram_used(), lcd1602_charset_missing());
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            s_charset_repeat = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--repeat N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int checks = s_charset_check();
+    int cgram  = s_charset_cgram();
+    int menu   = s_charset_menu();
+    printf("{\"bench\":\"charset\",\"check\":\"codes\",\"codes_ok\":%s,\"cgram_ok\":%s,\"menu_ok\":%s}\n",
+           checks ? "true" : "false", cgram ? "true" : "false", menu ? "true" : "false");
+
+    for (uint32_t c = 0; c < sizeof(s_charset_corpora) / sizeof(s_charset_corpora[0]); c++)
+    {
+        for (uint32_t rom = 0; rom < LCD1602_ROM_COUNT; rom++)
+            s_charset_run(&s_charset_corpora[c], (lcd1602_rom_t)rom);
+    }
+
+    return checks && cgram && menu ? 0 : 1;
+}
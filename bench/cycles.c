@@ -0,0 +1,399 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/ptrace.h>
+#include <sys/wait.h>
+
+#include "console.h"
+#include "cycles.h"
+
+/**
+ * Модель стоимости горячих путей движка на хосте.
+ *
+ * На STM32 в CI не запустить, поэтому для каждого обработчика (энкодер, обработка позиции,
+ * кнопка, длинное нажатие, отрисовка) считается:
+ * - instructions -- число выполненных инструкций: дочерний процесс выполняется под ptrace,
+ *                   участок проходится по одной инструкции (PTRACE_SINGLESTEP);
+ * - loads/stores -- чтения и записи памяти: вторая копия движка собрана с -fsanitize=thread,
+ *                   вызовы __tsan_readN/__tsan_writeN считаются здесь;
+ * - calls        -- вызовы функций внутри участка (__tsan_func_entry).
+ * Из всех случаев вычитаются накладные расходы пустого участка ("empty"). printMenu -- пустая
+ * функция, так что render -- стоимость самого движка без драйвера дисплея.
+ *
+ * Счёт детерминирован для данного компилятора и флагов, поэтому сравнивается с эталонным
+ * файлом (bench/cycles.baseline) без допуска: рост инструкций или обращений -- регрессия.
+ * Абсолютные числа относятся к x86-64, а не к Cortex-M; важна их динамика между изменениями.
+ *
+ * Запуск: MenuCycles [--update] [--tolerance PCT] [BASELINE]
+ *   --update        -- перезаписать эталон текущими значениями
+ *   --tolerance PCT -- допустимый рост в процентах (по умолчанию 0)
+ * Код возврата 1 -- регрессия относительно эталона, собранного тем же компилятором. Без эталона
+ * и с эталоном другого компилятора сравнения нет: случаи выводятся со статусом "unchecked".
+ */
+
+#define CYCLES_MAX_NAME 32
+#define CYCLES_MAX_LINE 256 ///< Строка эталона, в том числе "# compiler ..."
+
+typedef struct {
+    char     name[CYCLES_MAX_NAME];
+    uint64_t instructions;
+    uint64_t loads;
+    uint64_t stores;
+    uint64_t calls;
+} cycles_cost_t;
+
+static cycles_cost_t s_cycles[CYCLES_MAX_CASES];
+static uint32_t      s_cycles_count;
+
+void (*cycles_body) (void);
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+    cycles_body();
+}
+
+/* Счётчики обращений к памяти: минимальная замена runtime TSan для cycles_access.c */
+
+static struct {
+    int      active;
+    uint64_t loads;
+    uint64_t stores;
+    uint64_t calls;
+} s_access;
+
+#define CYCLES_TSAN_ACCESS(size)                                                        \
+    void __tsan_read##size            (void *addr) { (void)addr; s_access.loads  += s_access.active; } \
+    void __tsan_write##size           (void *addr) { (void)addr; s_access.stores += s_access.active; } \
+    void __tsan_unaligned_read##size  (void *addr) { (void)addr; s_access.loads  += s_access.active; } \
+    void __tsan_unaligned_write##size (void *addr) { (void)addr; s_access.stores += s_access.active; }
+
+CYCLES_TSAN_ACCESS(1)
+CYCLES_TSAN_ACCESS(2)
+CYCLES_TSAN_ACCESS(4)
+CYCLES_TSAN_ACCESS(8)
+CYCLES_TSAN_ACCESS(16)
+
+void __tsan_read_range  (void *addr, unsigned long size) { (void)addr; (void)size; s_access.loads  += s_access.active; }
+void __tsan_write_range (void *addr, unsigned long size) { (void)addr; (void)size; s_access.stores += s_access.active; }
+void __tsan_func_entry  (void *pc) { (void)pc; s_access.calls += s_access.active; }
+void __tsan_func_exit   (void) { }
+void __tsan_init        (void) { }
+
+static void s_access_begin (void)
+{
+    s_access.loads  = 0;
+    s_access.stores = 0;
+    s_access.calls  = 0;
+    s_access.active = 1;
+}
+
+static void s_access_end (uint32_t index, const char *name)
+{
+    s_access.active = 0;
+    if (index >= CYCLES_MAX_CASES)
+        return;
+
+    snprintf(s_cycles[index].name, sizeof(s_cycles[index].name), "%s", name);
+    s_cycles[index].loads  = s_access.loads;
+    s_cycles[index].stores = s_access.stores;
+    s_cycles[index].calls  = s_access.calls;
+    if (index + 1 > s_cycles_count)
+        s_cycles_count = index + 1;
+}
+
+/* Подсчёт инструкций: трассируемый процесс останавливает себя на границах участка */
+
+static void s_trace_mark (void)
+{
+    raise(SIGSTOP);
+}
+
+static void s_trace_end (uint32_t index, const char *name)
+{
+    (void)index;
+    (void)name;
+    raise(SIGSTOP);
+}
+
+/**
+ * @brief Запускает cycles_native_run под ptrace и считает инструкции каждого участка.
+ * @return 0 -- успех.
+ */
+static int s_count_instructions (void)
+{
+    static const cycles_probe_t probe = { s_trace_mark, s_trace_end };
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        return 1;
+    }
+
+    if (pid == 0)
+    {
+        if (ptrace(PTRACE_TRACEME, 0, NULL, NULL) != 0)
+            _exit(2);
+        raise(SIGSTOP);
+        cycles_native_run(&probe);
+        _exit(0);
+    }
+
+    int status;
+    if (waitpid(pid, &status, 0) < 0 || !WIFSTOPPED(status))
+    {
+        fprintf(stderr, "cycles: tracee did not start\n");
+        return 1;
+    }
+    ptrace(PTRACE_SETOPTIONS, pid, NULL, (void *)PTRACE_O_EXITKILL);
+
+    int      stepping = 0;
+    uint32_t index    = 0;
+    uint64_t count    = 0;
+    for (;;)
+    {
+        if (ptrace(stepping ? PTRACE_SINGLESTEP : PTRACE_CONT, pid, NULL, NULL) != 0)
+        {
+            perror("ptrace");
+            return 1;
+        }
+        if (waitpid(pid, &status, 0) < 0)
+        {
+            perror("waitpid");
+            return 1;
+        }
+
+        if (WIFEXITED(status))
+            break;
+        if (WIFSIGNALED(status))
+        {
+            fprintf(stderr, "cycles: tracee killed by signal %d\n", WTERMSIG(status));
+            return 1;
+        }
+
+        int sig = WSTOPSIG(status);
+        if (sig == SIGTRAP && stepping)
+        {
+            count++;
+        }
+        else if (sig == SIGSTOP)
+        {
+            if (stepping)
+            {
+                // Проходы повторяют одни и те же случаи: учитывается последний
+                s_cycles[index % s_cycles_count].instructions = count;
+                index++;
+            }
+            stepping = !stepping;
+            count    = 0;
+        }
+        else
+        {
+            fprintf(stderr, "cycles: tracee stopped by signal %d\n", sig);
+            kill(pid, SIGKILL);
+            waitpid(pid, &status, 0);
+            return 1;
+        }
+    }
+
+    if (WEXITSTATUS(status) != 0 || index % s_cycles_count != 0)
+    {
+        fprintf(stderr, "cycles: tracee exited with %d after %u regions\n", WEXITSTATUS(status), index);
+        return 1;
+    }
+
+    return 0;
+}
+
+/* Эталон: строки "case instructions loads stores calls", '#' -- комментарий */
+
+static cycles_cost_t s_baseline[CYCLES_MAX_CASES];
+static uint32_t      s_baseline_count;
+static char          s_baseline_compiler[CYCLES_MAX_LINE];
+
+static int s_baseline_load (const char *path)
+{
+    FILE *file = fopen(path, "r");
+    if (file == NULL)
+        return -1;
+
+    char line[CYCLES_MAX_LINE];
+    while (fgets(line, sizeof(line), file) && s_baseline_count < CYCLES_MAX_CASES)
+    {
+        if (strncmp(line, "# compiler ", 11) == 0)
+        {
+            snprintf(s_baseline_compiler, sizeof(s_baseline_compiler), "%s", line + 11);
+            s_baseline_compiler[strcspn(s_baseline_compiler, "\n")] = '\0';
+            continue;
+        }
+        if (line[0] == '#')
+            continue;
+
+        cycles_cost_t *cost = &s_baseline[s_baseline_count];
+        unsigned long long instructions, loads, stores, calls;
+        if (sscanf(line, "%31s %llu %llu %llu %llu", cost->name, &instructions, &loads, &stores, &calls) == 5)
+        {
+            cost->instructions = instructions;
+            cost->loads        = loads;
+            cost->stores       = stores;
+            cost->calls        = calls;
+            s_baseline_count++;
+        }
+    }
+
+    fclose(file);
+    return 0;
+}
+
+static int s_baseline_save (const char *path)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return -1;
+
+    fprintf(file, "# MenuCycles: стоимость одного вызова обработчика (за вычетом пустого участка)\n");
+    fprintf(file, "# compiler %s\n", __VERSION__);
+    fprintf(file, "# case instructions loads stores calls\n");
+    for (uint32_t i = 1; i < s_cycles_count; i++)
+    {
+        fprintf(file, "%s %llu %llu %llu %llu\n", s_cycles[i].name,
+                (unsigned long long)s_cycles[i].instructions, (unsigned long long)s_cycles[i].loads,
+                (unsigned long long)s_cycles[i].stores, (unsigned long long)s_cycles[i].calls);
+    }
+
+    fclose(file);
+    return 0;
+}
+
+static const cycles_cost_t *s_baseline_find (const char *name)
+{
+    for (uint32_t i = 0; i < s_baseline_count; i++)
+    {
+        if (strcmp(s_baseline[i].name, name) == 0)
+            return &s_baseline[i];
+    }
+    return NULL;
+}
+
+static int s_exceeds (uint64_t value, uint64_t baseline, double tolerance)
+{
+    return (double)value > (double)baseline * (1.0 + tolerance / 100.0);
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baseline_path = NULL;
+    int         update        = 0;
+    double      tolerance     = 0.0;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--update") == 0)
+        {
+            update = 1;
+        }
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+        {
+            tolerance = strtod(argv[++i], NULL);
+        }
+        else if (argv[i][0] != '-' && baseline_path == NULL)
+        {
+            baseline_path = argv[i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--update] [--tolerance PCT] [BASELINE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    static const cycles_probe_t access_probe = { s_access_begin, s_access_end };
+    cycles_access_run(&access_probe);
+
+    if (s_cycles_count == 0 || s_count_instructions() != 0)
+        return 1;
+
+    // Накладные расходы замера -- случай 0 ("empty")
+    const cycles_cost_t empty = s_cycles[0];
+    for (uint32_t i = 1; i < s_cycles_count; i++)
+    {
+        s_cycles[i].instructions -= empty.instructions;
+        s_cycles[i].loads        -= empty.loads;
+        s_cycles[i].stores       -= empty.stores;
+        s_cycles[i].calls        -= empty.calls;
+    }
+
+    if (update)
+    {
+        if (baseline_path == NULL || s_baseline_save(baseline_path) != 0)
+        {
+            fprintf(stderr, "cannot write baseline %s\n", baseline_path ? baseline_path : "(none)");
+            return 1;
+        }
+        printf("{\"bench\":\"cycles\",\"updated\":\"%s\",\"cases\":%u}\n", baseline_path, s_cycles_count - 1);
+        return 0;
+    }
+
+    int have_baseline = baseline_path && s_baseline_load(baseline_path) == 0;
+    if (baseline_path && !have_baseline)
+        fprintf(stderr, "cannot read baseline %s\n", baseline_path);
+
+    if (have_baseline && strcmp(s_baseline_compiler, __VERSION__) != 0)
+    {
+        fprintf(stderr, "baseline recorded with '%s', this build is '%s': comparison skipped\n",
+                s_baseline_compiler, __VERSION__);
+        have_baseline = 0;
+    }
+
+    int regressions = 0;
+    printf("{\"bench\":\"cycles\",\"overhead_instructions\":%llu,\"compiler\":\"%s\"}\n",
+           (unsigned long long)empty.instructions, __VERSION__);
+    for (uint32_t i = 1; i < s_cycles_count; i++)
+    {
+        const cycles_cost_t *cost = &s_cycles[i];
+        const cycles_cost_t *base = have_baseline ? s_baseline_find(cost->name) : NULL;
+        const char *status = have_baseline ? "ok" : "unchecked";
+
+        if (have_baseline && base == NULL)
+        {
+            status = "new";
+        }
+        else if (base)
+        {
+            if (s_exceeds(cost->instructions, base->instructions, tolerance) ||
+                s_exceeds(cost->loads + cost->stores, base->loads + base->stores, tolerance))
+            {
+                status = "regression";
+                regressions++;
+            }
+            else if (cost->instructions < base->instructions || cost->loads + cost->stores < base->loads + base->stores)
+            {
+                status = "improved";
+            }
+        }
+
+        printf("{\"bench\":\"cycles\",\"case\":\"%s\",\"instructions\":%llu,\"loads\":%llu,\"stores\":%llu,\"calls\":%llu",
+               cost->name, (unsigned long long)cost->instructions, (unsigned long long)cost->loads,
+               (unsigned long long)cost->stores, (unsigned long long)cost->calls);
+        if (base)
+        {
+            printf(",\"baseline_instructions\":%llu,\"baseline_accesses\":%llu",
+                   (unsigned long long)base->instructions, (unsigned long long)(base->loads + base->stores));
+        }
+        printf(",\"status\":\"%s\"}\n", status);
+    }
+
+    return regressions ? 1 : 0;
+}
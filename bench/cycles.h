@@ -0,0 +1,34 @@
+#include <stdint.h>
+
+#ifndef __CYCLES_H__
+#define __CYCLES_H__
+
+#define CYCLES_MAX_CASES 32
+
+/**
+ * @typedef cycles_probe_t
+ * @brief Границы замеряемого участка.
+ *
+ * Прогон случаев выполняется в два прохода (первый прогревает ленивое связывание libc),
+ * `end` получает номер случая и имя, так что результаты второго прохода перезаписывают первый.
+ */
+typedef struct {
+    void (*begin) (void);
+    void (*end)   (uint32_t index, const char *name);
+} cycles_probe_t;
+
+/**
+ * @brief Тело taskReadKey: вызывается из Menu_Init копии движка после построения дерева.
+ */
+extern void (*cycles_body) (void);
+
+/**
+ * Одна и та же копия menu.c с набором случаев (cycles_engine.h) собирается дважды:
+ * без инструментирования -- для подсчёта инструкций пошаговой трассировкой,
+ * и с -fsanitize=thread -- для подсчёта обращений к памяти через __tsan_read/__tsan_write.
+ * Обе функции строят демонстрационное меню, прогоняют случаи и освобождают дерево.
+ */
+void cycles_native_run (const cycles_probe_t *probe);
+void cycles_access_run (const cycles_probe_t *probe);
+
+#endif // __CYCLES_H__
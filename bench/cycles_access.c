@@ -0,0 +1,7 @@
+/**
+ * Копия движка, собираемая с -fsanitize=thread: каждое чтение и запись памяти вызывает
+ * __tsan_readN/__tsan_writeN, которые считаются в cycles.c (runtime TSan не линкуется).
+ */
+#define CYCLES_ENGINE cycles_access
+
+#include "cycles_engine.h"
@@ -0,0 +1,134 @@
+/**
+ * Случаи модели стоимости горячих путей движка.
+ *
+ * Включается в cycles_native.c и cycles_access.c после определения CYCLES_ENGINE -- префикса
+ * имён копии движка: функция прогона -- CYCLES_ENGINE_run, открытые функции menu.c
+ * переименовываются ниже, чтобы две копии собирались в одну программу. Новая открытая
+ * функция движка добавляется в этот список.
+ * Каждый случай -- подготовка состояния (не замеряется) и замеряемый участок: ровно один
+ * вызов обработчика, как из прерывания энкодера или кнопки.
+ */
+#include "cycles.h"
+
+#define CYCLES_NAME_(engine, name) engine##_##name
+#define CYCLES_NAME(engine, name)  CYCLES_NAME_(engine, name)
+
+#define CYCLES_ENGINE_RUN      CYCLES_NAME(CYCLES_ENGINE, run)
+#define Menu_Init              CYCLES_NAME(CYCLES_ENGINE, menu_init)
+#define Menu_JumpKey           CYCLES_NAME(CYCLES_ENGINE, jump_key)
+#define Menu_Position          CYCLES_NAME(CYCLES_ENGINE, position)
+#define Menu_SetLanguage       CYCLES_NAME(CYCLES_ENGINE, set_language)
+#define Menu_SetLanguagePacked CYCLES_NAME(CYCLES_ENGINE, set_language_packed)
+#define Menu_Tick              CYCLES_NAME(CYCLES_ENGINE, tick)
+
+#include "../menu.c"
+
+#define CYCLES_ENCODER 100u ///< Значение энкодера перед замером (чётное: проходит фильтр)
+#define CYCLES_PASSES  2u   ///< Первый проход прогревает, учитывается второй
+
+typedef struct {
+    const char *name;
+    void      (*setup)  (void);
+    void      (*region) (void);
+} cycles_case_t;
+
+static menu_item_t *s_cycles_start;   ///< Start (корень, без дочерних)
+static menu_item_t *s_cycles_options; ///< Options (есть дочерняя цепочка)
+static menu_item_t *s_cycles_back;    ///< Options/Back (MENU_FLAG_GOTO_PARENT)
+static menu_item_t *s_cycles_pwm;     ///< Options/PWM (пункт подменю)
+
+static void s_cycles_at (menu_item_t *item)
+{
+    s_menu_handle.current        = item;
+    s_menu_handle.rotenc.current = CYCLES_ENCODER;
+    s_menu_handle.rotenc.prev    = CYCLES_ENCODER;
+    s_menu_handle.rotenc.delta   = 0;
+}
+
+static void s_cycles_setup_start   (void) { s_cycles_at(s_cycles_start); }
+static void s_cycles_setup_options (void) { s_cycles_at(s_cycles_options); }
+static void s_cycles_setup_back    (void) { s_cycles_at(s_cycles_back); }
+static void s_cycles_setup_pwm     (void) { s_cycles_at(s_cycles_pwm); }
+
+static void s_cycles_setup_next (void)
+{
+    s_cycles_at(s_cycles_start);
+    s_menu_handle.rotenc.delta = 1;
+}
+
+static void s_cycles_setup_prev (void)
+{
+    s_cycles_at(s_cycles_start);
+    s_menu_handle.rotenc.delta = -1;
+}
+
+/*
+ * Обработчики вызываются через указатели, как их вызывает платформа после taskReadKey,
+ * а значение энкодера читается из volatile: иначе при -O2 обработчик встраивается в участок
+ * и сворачивается по константному аргументу.
+ */
+static void (* volatile s_cycles_rotary)    (uint32_t) = s_rotary_encoder_callback;
+static void (* volatile s_cycles_position)  (void)     = s_menu_position_handling;
+static void (* volatile s_cycles_push)      (void)     = s_push_button_callback;
+static void (* volatile s_cycles_long_push) (void)     = s_long_push_button_callback;
+static void (* volatile s_cycles_display)   (void)     = s_display_menu;
+static void (* volatile s_cycles_jump)      (char)     = Menu_JumpKey;
+static volatile uint32_t s_cycles_encoder = CYCLES_ENCODER;
+static volatile char     s_cycles_key_other = 'o'; ///< Start -> Options: поиск записи индекса
+static volatile char     s_cycles_key_same  = 's'; ///< Start -> Start: следующий пункт с той же буквой
+
+static void s_cycles_empty            (void) { }
+static void s_cycles_encoder_filtered (void) { s_cycles_rotary(s_cycles_encoder + 1); }
+static void s_cycles_encoder_next     (void) { s_cycles_rotary(s_cycles_encoder + ENCODER_INPUT_FILTER); }
+static void s_cycles_encoder_prev     (void) { s_cycles_rotary(s_cycles_encoder - ENCODER_INPUT_FILTER); }
+static void s_cycles_position_step    (void) { s_cycles_position(); }
+static void s_cycles_button           (void) { s_cycles_push(); }
+static void s_cycles_long_button      (void) { s_cycles_long_push(); }
+static void s_cycles_render           (void) { s_cycles_display(); }
+static void s_cycles_jump_other       (void) { s_cycles_jump(s_cycles_key_other); }
+static void s_cycles_jump_same        (void) { s_cycles_jump(s_cycles_key_same); }
+
+static const cycles_case_t s_cycles_cases[] = {
+    { "empty",            s_cycles_setup_start,   s_cycles_empty            }, // Накладные расходы замера
+    { "encoder_filtered", s_cycles_setup_start,   s_cycles_encoder_filtered }, // Нечётное значение отбрасывается фильтром
+    { "encoder_next",     s_cycles_setup_start,   s_cycles_encoder_next     },
+    { "encoder_prev",     s_cycles_setup_start,   s_cycles_encoder_prev     },
+    { "position_next",    s_cycles_setup_next,    s_cycles_position_step    },
+    { "position_prev",    s_cycles_setup_prev,    s_cycles_position_step    },
+    { "button_child",     s_cycles_setup_options, s_cycles_button           },
+    { "button_parent",    s_cycles_setup_back,    s_cycles_button           },
+    { "button_none",      s_cycles_setup_start,   s_cycles_button           },
+    { "long_push_parent", s_cycles_setup_pwm,     s_cycles_long_button      },
+    { "long_push_start",  s_cycles_setup_start,   s_cycles_long_button      },
+    { "render",           s_cycles_setup_start,   s_cycles_render           },
+    { "jump_other",       s_cycles_setup_start,   s_cycles_jump_other       }, // Быстрый переход на другую букву
+    { "jump_same",        s_cycles_setup_start,   s_cycles_jump_same        }, // Повтор буквы текущего пункта
+};
+
+static const cycles_probe_t *s_cycles_probe;
+
+static void s_cycles_body (void)
+{
+    s_cycles_start   = s_menu_handle.start;
+    s_cycles_options = s_cycles_start->next->next;
+    s_cycles_back    = s_cycles_options->child;
+    s_cycles_pwm     = s_cycles_back->next;
+
+    for (uint32_t pass = 0; pass < CYCLES_PASSES; pass++)
+    {
+        for (uint32_t i = 0; i < sizeof(s_cycles_cases) / sizeof(s_cycles_cases[0]); i++)
+        {
+            s_cycles_cases[i].setup();
+            s_cycles_probe->begin();
+            s_cycles_cases[i].region();
+            s_cycles_probe->end(i, s_cycles_cases[i].name);
+        }
+    }
+}
+
+void CYCLES_ENGINE_RUN (const cycles_probe_t *probe)
+{
+    s_cycles_probe = probe;
+    cycles_body    = s_cycles_body;
+    Menu_Init();
+}
@@ -0,0 +1,6 @@
+/**
+ * Копия движка без инструментирования: по ней считаются инструкции.
+ */
+#define CYCLES_ENGINE cycles_native
+
+#include "cycles_engine.h"
@@ -0,0 +1,106 @@
+#include "bench.h"
+
+/**
+ * Отчёт о потребляемой меню памяти для текущей конфигурации сборки.
+ *
+ * menu.c включается целиком, чтобы получить размеры внутренних структур. Строится
+ * демонстрационное дерево из Menu_Init, после чего выводятся JSON-строки:
+ * - `config`  -- размеры пункта, состояния, статических массивов и оценка MENU_RAM_BYTES;
+ * - `strings` -- память под заголовки: выделено и реально занято;
+ * - `heap`    -- пик кучи при построении (только в динамическом режиме);
+ * - `stack`   -- пиковая глубина стека каждого обработчика ввода и отрисовки.
+ *
+ * Запуск: MenuFootprint (динамическая память), MenuFootprintStatic (статическая).
+ */
+#include "../menu.c"
+
+static const char *s_mode = (MENU_USAGE_MEMORY == MENU_USAGE_STATIC_MEMORY) ? "static" : "dynamic";
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+static void s_stack_rotary (void *arg)
+{
+    uint32_t *encoder = arg;
+    *encoder += 2;
+    s_rotary_encoder_callback(*encoder);
+}
+
+static void s_stack_push (void *arg)
+{
+    (void)arg;
+    s_push_button_callback();
+}
+
+static void s_stack_long_push (void *arg)
+{
+    (void)arg;
+    s_long_push_button_callback();
+}
+
+static void s_stack_display (void *arg)
+{
+    (void)arg;
+    s_display_menu();
+}
+
+static void s_report_stack (const char *handler, size_t bytes)
+{
+    printf("{\"bench\":\"footprint\",\"record\":\"stack\",\"mode\":\"%s\",\"handler\":\"%s\",\"bytes\":%zu}\n",
+           s_mode, handler, bytes);
+}
+
+/**
+ * @brief Вызывается из Menu_Init после построения дерева: здесь дерево уже готово.
+ */
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+
+    uint32_t items = 0;
+    size_t   title_used = 0;
+
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+    {
+        items++;
+        title_used += strnlen(item->title, MENU_ITEM_TITLE_LEN) + 1;
+    }
+
+    printf("{\"bench\":\"footprint\",\"record\":\"strings\",\"mode\":\"%s\",\"items\":%u,"
+           "\"title_bytes_allocated\":%zu,\"title_bytes_used\":%zu}\n",
+           s_mode, items, (size_t)items * MENU_ITEM_TITLE_LEN, title_used);
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    printf("{\"bench\":\"footprint\",\"record\":\"heap\",\"mode\":\"%s\",\"items\":%u,"
+           "\"allocs\":%llu,\"heap_peak_bytes\":%llu}\n",
+           s_mode, items, (unsigned long long)bench_alloc_stat.allocs,
+           (unsigned long long)bench_alloc_stat.bytes_peak);
+#endif
+
+    uint32_t encoder = 0;
+    s_report_stack("rotary", bench_stack_usage(s_stack_rotary, &encoder));
+    s_report_stack("push", bench_stack_usage(s_stack_push, NULL));
+    s_report_stack("long_push", bench_stack_usage(s_stack_long_push, NULL));
+    s_report_stack("display", bench_stack_usage(s_stack_display, NULL));
+}
+
+int main(void)
+{
+    printf("{\"bench\":\"footprint\",\"record\":\"config\",\"mode\":\"%s\",\"menu_size\":%u,\"title_len\":%u,"
+           "\"item_bytes\":%zu,\"handle_bytes\":%zu,\"items_bytes\":%zu,\"latency_bytes\":%zu,"
+           "\"trace_bytes\":%zu,\"ram_bytes\":%zu,\"ram_budget\":%u}\n",
+           s_mode, (unsigned)MENU_SIZE, (unsigned)MENU_ITEM_TITLE_LEN,
+           sizeof(menu_item_t), sizeof(menu_handle_t), (size_t)MENU_SIZE * sizeof(menu_item_t),
+           (size_t)MENU_LATENCY_RAM_BYTES, (size_t)MENU_TRACE_RAM_BYTES, (size_t)MENU_RAM_BYTES,
+           (unsigned)MENU_RAM_BUDGET);
+
+    bench_alloc_reset();
+    Menu_Init();
+
+    return 0;
+}
@@ -0,0 +1,458 @@
+#include "bench.h"
+
+/**
+ * Фаззер движка меню с проверкой структурных инвариантов.
+ *
+ * Вход фаззера -- байтовая строка:
+ * - байт 0: количество пунктов (1..FUZZ_MAX_ITEMS);
+ * - по два байта на пункт: выбор родителя среди уже созданных пунктов (0 -- корень) и флаги
+ *   (биты 1-2 флагов задают первую букву заголовка: 'A', 'a', 'B' или 'b');
+ * - байт: количество вызовов s_menu_set_child, по два байта на вызов: пункт и номер
+ *   дочернего пункта в его цепочке;
+ * - остаток: поток событий ввода, по байту на событие (включая скрытие и запрет пунктов).
+ *
+ * После построения дерева и после каждого события проверяется:
+ * - полное кольцо (`sibling_prev`) содержит ровно пункты с одним родителем, включая скрытые,
+ *   `sibling_next` -- обратная ему ссылка;
+ * - кольцо навигации видимого пункта замкнуто и содержит ровно видимые пункты с тем же родителем;
+ * - prev/next видимых пунктов симметричны;
+ * - отметка первого пункта (`first`) -- только у первого созданного в кольце; с
+ *   MENU_POSITION_INDICATOR счётчик кольца равен числу видимых пунктов, а номер видимого пункта
+ *   (`ordinal`, после перенумерации устаревшего кольца) -- его место среди видимых в порядке создания;
+ * - child указывает на пункт, чей parent -- этот пункт;
+ * - кольцо быстрого перехода (`jump`) пункта -- ровно пункты его кольца с той же первой буквой
+ *   (или пара кольцо/буква целиком вне индекса, если таблица заполнена); цели MenuFuzz собраны
+ *   с MENU_JUMP_INDEX=32;
+ * - текущий пункт -- один из созданных и не скрыт (если в его кольце есть видимые);
+ * - s_menu_walk посещает каждый пункт, достижимый по `child`, один раз до и один раз после подменю
+ *   на его уровне; s_menu_validate не находит нарушений, а при вложенности глубже MENU_WALK_DEPTH
+ *   обход и проверка сообщают о переполнении стека;
+ * - после освобождения в куче не осталось выделенной памяти (динамический режим).
+ * При нарушении печатается описание и вызывается abort().
+ *
+ * Совместим с libFuzzer (LLVMFuzzerTestOneInput; сборка clang с -DMENU_FUZZ_LIBFUZZER
+ * и -fsanitize=fuzzer) и AFL (вход из stdin или файлов). Без libFuzzer:
+ *   MenuFuzz FILE...          -- прогнать файлы
+ *   MenuFuzz                  -- прочитать вход из stdin (AFL)
+ *   MenuFuzz --random N [SEED] -- N случайных входов
+ */
+#include "../menu.c"
+
+#define FUZZ_MAX_ITEMS  64
+#define FUZZ_MAX_INPUT  4096
+#define FUZZ_RANDOM_MAX 512  ///< Максимальная длина случайного входа в режиме --random
+#define FUZZ_HASH_SIZE  128  ///< Открытая адресация: указатель пункта -> номер в s_fuzz_items
+
+static menu_item_t *s_fuzz_items[FUZZ_MAX_ITEMS];
+static uint32_t     s_fuzz_siblings[FUZZ_MAX_ITEMS]; ///< Количество пунктов с тем же родителем
+static uint32_t     s_fuzz_count;
+static menu_item_t *s_fuzz_hash[FUZZ_HASH_SIZE];
+
+void printMenu(const char *str1, const char *str2)
+{
+    // Заголовок должен читаться в пределах поля: strnlen не выйдет за MENU_ITEM_TITLE_LEN
+    (void)strnlen(str1, MENU_ITEM_TITLE_LEN);
+    (void)strnlen(str2, MENU_ITEM_TITLE_LEN);
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static void s_fuzz_item_callback (void)
+{
+    s_menu_handle.current->data++;
+}
+
+typedef struct {
+    uint32_t pre;
+    uint32_t post;
+    uint32_t bad_depth;
+} fuzz_walk_t;
+
+/**
+ * @brief Уровень пункта, достижимого из корня по `child`, или -1, если на пути есть родитель без `child`.
+ */
+static int32_t s_fuzz_depth (const menu_item_t *item)
+{
+    int32_t depth = 0;
+
+    for (const menu_item_t *parent = item->parent; parent; parent = parent->parent, depth++)
+    {
+        if (parent->child == NULL)
+            return -1;
+    }
+    return depth;
+}
+
+static int s_fuzz_walk_visit (menu_item_t *item, uint32_t depth, uint8_t order, void *context)
+{
+    fuzz_walk_t *walk = (fuzz_walk_t *)context;
+
+    if (s_fuzz_depth(item) != (int32_t)depth)
+        walk->bad_depth++;
+    if (order == MENU_WALK_PRE)
+        walk->pre++;
+    else
+        walk->post++;
+    return 0;
+}
+
+static void s_fuzz_fail (const char *what, const menu_item_t *item)
+{
+    fprintf(stderr, "fuzz: invariant violated: %s (item %p \"%.*s\")\n",
+            what, (const void *)item, MENU_ITEM_TITLE_LEN, item ? item->title : "");
+    abort();
+}
+
+static uint32_t s_fuzz_slot (const menu_item_t *item)
+{
+    return (uint32_t)(((uintptr_t)item >> 3) * 0x9E3779B1u) % FUZZ_HASH_SIZE;
+}
+
+static int s_fuzz_known (const menu_item_t *item)
+{
+    for (uint32_t slot = s_fuzz_slot(item); s_fuzz_hash[slot]; slot = (slot + 1) % FUZZ_HASH_SIZE)
+    {
+        if (s_fuzz_hash[slot] == item)
+            return 1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Индекс созданных пунктов: множество указателей и размеры колец по родителю.
+ */
+static void s_fuzz_index (void)
+{
+    memset(s_fuzz_hash, 0, sizeof(s_fuzz_hash));
+
+    for (uint32_t i = 0; i < s_fuzz_count; i++)
+    {
+        uint32_t slot = s_fuzz_slot(s_fuzz_items[i]);
+        while (s_fuzz_hash[slot])
+            slot = (slot + 1) % FUZZ_HASH_SIZE;
+        s_fuzz_hash[slot] = s_fuzz_items[i];
+
+        s_fuzz_siblings[i] = 0;
+        for (uint32_t j = 0; j < s_fuzz_count; j++)
+        {
+            if (s_fuzz_items[j]->parent == s_fuzz_items[i]->parent)
+                s_fuzz_siblings[i]++;
+        }
+    }
+}
+
+/**
+ * @brief Проверка всех структурных инвариантов дерева и курсора.
+ */
+static void s_fuzz_check (void)
+{
+    for (uint32_t i = 0; i < s_fuzz_count; i++)
+    {
+        menu_item_t *item = s_fuzz_items[i];
+
+        if (!s_fuzz_known(item->next) || !s_fuzz_known(item->prev) || !s_fuzz_known(item->sibling_prev))
+            s_fuzz_fail("prev/next points outside the tree", item);
+        if (item->sibling_prev->sibling_next != item)
+            s_fuzz_fail("sibling_next is not the inverse of sibling_prev", item);
+        if (item->child && (!s_fuzz_known(item->child) || item->child->parent != item))
+            s_fuzz_fail("child does not point back to its parent", item);
+#if (MENU_CURSOR_MEMORY > 0)
+        if (item->resume && (!s_fuzz_known(item->resume) || item->resume->parent != item || item->child == NULL))
+            s_fuzz_fail("resume is not an item of the child ring", item);
+        if (item->resume && (item->resume->flags & MENU_FLAG_GOTO_PARENT))
+            s_fuzz_fail("resume points to a Back item", item);
+#endif
+
+        // Полное кольцо (sibling_prev) -- ровно пункты того же родителя, включая скрытые
+        uint32_t ring = 0;
+        uint32_t visible = 0;
+        menu_item_t *walk = item;
+        do
+        {
+            if (walk->parent != item->parent)
+                s_fuzz_fail("full ring mixes items of different parents", walk);
+            visible += !(walk->flags & MENU_FLAG_HIDDEN);
+            walk = walk->sibling_prev;
+            ring++;
+        } while (walk != item && ring <= s_fuzz_count);
+
+        if (walk != item || ring != s_fuzz_siblings[i])
+            s_fuzz_fail("full ring differs from the set of siblings", item);
+
+        // Кольцо навигации замыкается и содержит ровно видимые пункты того же родителя
+        if (!(item->flags & MENU_FLAG_HIDDEN))
+        {
+            if (item->next->prev != item || item->prev->next != item)
+                s_fuzz_fail("prev/next are not symmetric", item);
+
+            ring = 0;
+            walk = item;
+            do
+            {
+                if (walk->parent != item->parent)
+                    s_fuzz_fail("ring mixes items of different parents", walk);
+                if (walk->flags & MENU_FLAG_HIDDEN)
+                    s_fuzz_fail("ring contains a hidden item", walk);
+                walk = walk->next;
+                ring++;
+            } while (walk != item && ring <= s_fuzz_count);
+
+            if (walk != item)
+                s_fuzz_fail("ring does not close", item);
+            if (ring != visible)
+                s_fuzz_fail("ring length differs from the number of visible siblings", item);
+#if (MENU_POSITION_INDICATOR > 0)
+            if ((*s_menu_ring_count(item) & ~MENU_RING_STALE) != visible)
+                s_fuzz_fail("ring count differs from the number of visible siblings", item);
+            if (*s_menu_ring_count(item) & MENU_RING_STALE)
+                s_menu_ring_number(item); // Номера после скрытия и показа -- как их увидит Menu_Position
+#endif
+        }
+
+        // Номер среди видимых и отметка первого пункта полного кольца
+        uint32_t earlier = 0;
+        uint32_t earlier_visible = 0;
+        for (uint32_t j = 0; j < i; j++)
+        {
+            if (s_fuzz_items[j]->parent == item->parent)
+            {
+                earlier++;
+                earlier_visible += !(s_fuzz_items[j]->flags & MENU_FLAG_HIDDEN);
+            }
+        }
+        if (!item->first != (earlier != 0))
+            s_fuzz_fail("first-item mark is not on the first created sibling", item);
+#if (MENU_POSITION_INDICATOR > 0)
+        if (!(item->flags & MENU_FLAG_HIDDEN) && item->ordinal != earlier_visible + 1)
+            s_fuzz_fail("ordinal differs from the position among visible siblings", item);
+#else
+        (void)earlier_visible;
+#endif
+
+#if (MENU_JUMP_INDEX > 0)
+        // Кольцо быстрого перехода: те же родитель и буква, длина -- число таких пунктов.
+        // При заполненной таблице индекса пара (кольцо, буква) целиком остаётся вне индекса.
+        uint32_t same = 0;
+        for (uint32_t j = 0; j < s_fuzz_count; j++)
+        {
+            if (s_fuzz_items[j]->parent == item->parent &&
+                s_menu_jump_key(s_fuzz_items[j]->title[0]) == s_menu_jump_key(item->title[0]))
+            {
+                if ((s_fuzz_items[j]->jump == NULL) != (item->jump == NULL))
+                    s_fuzz_fail("jump ring covers only part of the same-letter siblings", item);
+                same++;
+            }
+        }
+        if (item->jump == NULL)
+            continue;
+
+        uint32_t cycle = 0;
+        walk = item;
+        do
+        {
+            if (!s_fuzz_known(walk->jump))
+                s_fuzz_fail("jump points outside the tree", walk);
+            if (walk->parent != item->parent || s_menu_jump_key(walk->title[0]) != s_menu_jump_key(item->title[0]))
+                s_fuzz_fail("jump ring mixes rings or letters", walk);
+            walk = walk->jump;
+            cycle++;
+        } while (walk != item && cycle <= s_fuzz_count);
+
+        if (cycle != same)
+            s_fuzz_fail("jump ring length differs from the number of same-letter siblings", item);
+#endif
+    }
+
+    if (!s_fuzz_known(s_menu_handle.current))
+        s_fuzz_fail("cursor points outside the tree", s_menu_handle.current);
+    if ((s_menu_handle.current->flags & MENU_FLAG_HIDDEN) && s_menu_visible_from(s_menu_handle.current) != NULL)
+        s_fuzz_fail("cursor is on a hidden item while its ring has visible ones", s_menu_handle.current);
+
+    // Обход: каждый достижимый пункт по разу до и после подменю, переполнение -- только при глубокой вложенности
+    uint32_t reachable = 0;
+    int32_t  deepest   = -1;
+    for (uint32_t i = 0; i < s_fuzz_count; i++)
+    {
+        int32_t depth = s_fuzz_depth(s_fuzz_items[i]);
+        reachable += depth >= 0;
+        if (depth >= 0 && s_fuzz_items[i]->child && depth > deepest)
+            deepest = depth;
+    }
+    int overflow = deepest + 1 >= MENU_WALK_DEPTH;
+
+    fuzz_walk_t walk = { 0, 0, 0 };
+    int status = s_menu_walk(NULL, MENU_WALK_PRE | MENU_WALK_POST, s_fuzz_walk_visit, &walk);
+    if (status != (overflow ? MENU_WALK_OVERFLOW : MENU_WALK_DONE) || walk.bad_depth != 0)
+        s_fuzz_fail("tree walk status or depth is wrong", s_menu_handle.start);
+    if (!overflow && (walk.pre != reachable || walk.post != reachable))
+        s_fuzz_fail("tree walk does not visit every reachable item once", s_menu_handle.start);
+    if ((s_menu_validate(NULL) != NULL) != overflow)
+        s_fuzz_fail("s_menu_validate disagrees with the invariants", s_menu_validate(NULL));
+}
+
+static void s_fuzz_teardown (void)
+{
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_free_items();
+    if (bench_alloc_stat.bytes_current != 0)
+    {
+        fprintf(stderr, "fuzz: %llu bytes leaked after s_menu_free_items\n",
+                (unsigned long long)bench_alloc_stat.bytes_current);
+        abort();
+    }
+#endif
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+    s_fuzz_count = 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size)
+{
+    size_t pos = 0;
+    char title[MENU_ITEM_TITLE_LEN];
+
+    if (size < 1)
+        return 0;
+
+    uint32_t count = data[pos++] % FUZZ_MAX_ITEMS + 1;
+
+    for (uint32_t i = 0; i < count && pos + 2 <= size; i++)
+    {
+        uint32_t pick    = data[pos++] % (s_fuzz_count + 1);
+        uint8_t  flags   = data[pos++];
+        menu_item_t *parent = (pick == 0 || s_fuzz_count == 0) ? NULL : s_fuzz_items[pick - 1];
+
+        snprintf(title, sizeof(title), "%c%u", "AaBb"[(flags >> 1) & 0x03], i);
+        menu_item_t *item = s_menu_add_item(title, parent, (flags & 0x01) ? s_fuzz_item_callback : NULL,
+                                            flags & (MENU_FLAG_GOTO_PARENT | MENU_FLAG_EDIT_DATA | MENU_FLAG_GOTO_CHILD));
+        if (item == NULL)
+            break; // Статический массив исчерпан
+        s_fuzz_items[s_fuzz_count++] = item;
+    }
+
+    if (s_fuzz_count == 0)
+        return 0;
+
+    uint32_t links = pos < size ? data[pos++] : 0;
+    for (uint32_t i = 0; i < links && pos + 2 <= size; i++)
+    {
+        menu_item_t *item = s_fuzz_items[data[pos++] % s_fuzz_count];
+        uint32_t nth = data[pos++];
+        menu_item_t *child = NULL;
+
+        // Дочерний пункт выбирается среди пунктов, у которых item -- родитель
+        for (uint32_t j = 0, seen = 0; j < s_fuzz_count; j++)
+        {
+            if (s_fuzz_items[j]->parent == item && seen++ == nth % (s_fuzz_count + 1))
+            {
+                child = s_fuzz_items[j];
+                break;
+            }
+        }
+        if (child)
+            s_menu_set_child(item, child);
+    }
+
+    s_menu_handle.current = s_menu_handle.start;
+    s_fuzz_index();
+    s_fuzz_check();
+
+    uint32_t encoder = 0;
+    for (; pos < size; pos++)
+    {
+        switch (data[pos] & 0x03)
+        {
+            case 0:
+                encoder += (data[pos] & 0x04) ? 1 : 2; // Нечётные значения должен отсеять фильтр
+                s_rotary_encoder_callback(encoder);
+                break;
+            case 1:
+                encoder -= (data[pos] & 0x04) ? 1 : 2;
+                s_rotary_encoder_callback(encoder);
+                break;
+            case 2:
+                if (data[pos] & 0x04)
+                {
+                    // Скрытие/показ или запрет/разрешение пункта
+                    menu_item_t *item = s_fuzz_items[(data[pos] >> 4) % s_fuzz_count];
+                    if (data[pos] & 0x08)
+                        s_menu_set_enabled(item, (item->flags & MENU_FLAG_DISABLED) != 0);
+                    else
+                        s_menu_set_visible(item, (item->flags & MENU_FLAG_HIDDEN) != 0);
+                }
+                else
+                {
+                    s_push_button_callback();
+                }
+                break;
+            default:
+                if (data[pos] & 0x04)
+                    Menu_JumpKey("aAbBc"[(data[pos] >> 3) % 5]); // 'c' -- буква без пунктов
+                else
+                    s_long_push_button_callback();
+                break;
+        }
+        s_fuzz_check();
+    }
+
+    s_fuzz_teardown();
+    return 0;
+}
+
+#if !defined(MENU_FUZZ_LIBFUZZER)
+static int s_fuzz_file (FILE *file)
+{
+    static uint8_t data[FUZZ_MAX_INPUT];
+    size_t size = fread(data, 1, sizeof(data), file);
+
+    return LLVMFuzzerTestOneInput(data, size);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc >= 3 && strcmp(argv[1], "--random") == 0)
+    {
+        static uint8_t data[FUZZ_MAX_INPUT];
+        uint32_t runs  = (uint32_t)strtoul(argv[2], NULL, 0);
+        uint32_t state = argc > 3 ? (uint32_t)strtoul(argv[3], NULL, 0) : 0x9E3779B9u;
+
+        for (uint32_t run = 0; run < runs; run++)
+        {
+            size_t size = 0;
+
+            state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+            size = 1 + state % FUZZ_RANDOM_MAX;
+            for (size_t i = 0; i < size; i++)
+            {
+                state ^= state << 13; state ^= state >> 17; state ^= state << 5;
+                data[i] = (uint8_t)state;
+            }
+            LLVMFuzzerTestOneInput(data, size);
+        }
+
+        printf("fuzz: %u random inputs passed\n", runs);
+        return 0;
+    }
+
+    if (argc == 1)
+        return s_fuzz_file(stdin);
+
+    for (int i = 1; i < argc; i++)
+    {
+        FILE *file = fopen(argv[i], "rb");
+        if (file == NULL)
+        {
+            perror(argv[i]);
+            return EXIT_FAILURE;
+        }
+        s_fuzz_file(file);
+        fclose(file);
+    }
+
+    return 0;
+}
+#endif
@@ -0,0 +1,416 @@
+#include "bench.h"
+
+/**
+ * Нечёткий поиск по путям: задержка запроса, память индекса и его поддержка при изменениях.
+ *
+ * menu.c включается целиком. Дерево: FUZZY_AREAS областей в корне, в каждой FUZZY_SECTIONS
+ * разделов "Channel NN", в каждом FUZZY_PARAMS параметров "<слово> <номер>" (около 50 тысяч
+ * пунктов), собирается напрямую, как в MenuSearch. Первый запрос строит индекс: время и байты
+ * на пункт выводятся отдельно. Для каждого запроса выводятся число совпадений, лучшее и худшее
+ * время из --repeat прогонов и сверка лучших FUZZY_TOP с эталоном, который собирает путь
+ * каждого пункта строкой и сопоставляет запрос с ней целиком.
+ *
+ * Затем индекс проверяется после изменений дерева без перестроения: добавление области через
+ * s_menu_add_item и (на малом дереве) многократное построение и освобождение отложенного
+ * подменю (записи помечаются освобождёнными, индекс уплотняется) -- результаты сверяются
+ * с эталоном.
+ *
+ * Запуск: MenuFuzzy [--repeat N]
+ */
+#include <ctype.h>
+
+#include "../menu.c"
+
+#define FUZZY_AREAS    10
+#define FUZZY_SECTIONS 50
+#define FUZZY_PARAMS   100
+#define FUZZY_TOP      16
+#define FUZZY_CHURN    64  ///< Циклов построения и освобождения отложенного подменю
+#define FUZZY_SPARE    300 ///< Пунктов в отложенном подменю
+
+static const char *s_fuzzy_areas[FUZZY_AREAS] = {
+    "Hi Arm", "Lo Arm", "PWM", "Network", "Display", "Sensors", "Motors", "Power", "Logging", "System",
+};
+
+static const char *s_fuzzy_words[] = {
+    "Enable", "Delay", "Duration", "Frequency", "Voltage", "Current", "Mode", "Offset", "Gain", "Limit",
+};
+
+static const char *s_fuzzy_queries[] = {
+    "hi dur",         // Слова в разных уровнях пути
+    "net ch 7 gain",  // Четыре слова, цифра
+    "pwm freq 43",
+    "lo arm del",
+    "voltage",        // Одно слово во всех областях
+    "sens ch49 lim9",
+    "e",              // Один символ: почти все пункты
+    "zzz",            // Промах по фильтру символов
+};
+
+static uint32_t s_fuzzy_repeat = 50;
+static uint32_t s_fuzzy_items;
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+/**
+ * @brief Пункт в конце списка `folowing` без переинициализации кольца.
+ */
+static menu_item_t * s_fuzzy_add (const char *title, menu_item_t *parent)
+{
+    menu_item_t *item = s_create_new_item();
+    if (item == NULL)
+        return NULL;
+
+    memset(item, 0, sizeof(*item));
+    s_menu_copy_title(item->title, title);
+    item->parent = parent;
+    if (s_menu_handle.last)
+        s_menu_handle.last->folowing = item;
+    else
+        s_menu_handle.start = item;
+    s_menu_handle.last = item;
+    s_fuzzy_items++;
+
+    return item;
+}
+
+static int s_fuzzy_build (void)
+{
+    char title[MENU_ITEM_TITLE_LEN + 1];
+
+    for (uint32_t a = 0; a < FUZZY_AREAS; a++)
+    {
+        menu_item_t *area = s_fuzzy_add(s_fuzzy_areas[a], NULL);
+        if (area == NULL)
+            return 0;
+        for (uint32_t c = 0; c < FUZZY_SECTIONS; c++)
+        {
+            snprintf(title, sizeof(title), "Channel %02u", c);
+            menu_item_t *section = s_fuzzy_add(title, area);
+            if (section == NULL)
+                return 0;
+            for (uint32_t p = 0; p < FUZZY_PARAMS; p++)
+            {
+                snprintf(title, sizeof(title), "%s %u", s_fuzzy_words[p % 10], p);
+                if (s_fuzzy_add(title, section) == NULL)
+                    return 0;
+            }
+        }
+    }
+
+    // Кольца -- один проход на родителя
+    s_menu_rechain(NULL);
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+    {
+        if (item->parent && item->parent->child == NULL)
+        {
+            s_menu_rechain(item->parent);
+            s_menu_set_child(item->parent, item);
+        }
+    }
+#if (MENU_JUMP_INDEX > 0)
+    s_menu_jump_rebuild();
+#endif
+    s_menu_handle.current = s_menu_handle.start;
+
+    return 1;
+}
+
+/**
+ * @brief Эталон: путь пункта строкой "Hi Arm/Channel 07/Gain 38" и сопоставление с ней целиком.
+ *
+ * Правила те же, что у s_menu_fuzzy, но без индекса и состояний родителей: каждый пункт
+ * сопоставляется заново от корня.
+ */
+static int s_fuzzy_reference_score (const char *path, const char *query, int32_t *score)
+{
+    char     chars[MENU_FUZZY_QUERY];
+    uint32_t starts = 0;
+    uint32_t len    = 0;
+    int      word   = 1;
+
+    for (; *query && len < MENU_FUZZY_QUERY; query++)
+    {
+        if (*query == ' ')
+        {
+            word = 1;
+            continue;
+        }
+        chars[len] = (char)tolower((unsigned char)*query);
+        starts |= (uint32_t)word << len;
+        len++;
+        word = 0;
+    }
+
+    const char *own = strrchr(path, '/');
+    own = own ? own + 1 : path;
+
+    uint32_t matched = 0;
+    int32_t  total   = -1;
+    int32_t  in_own  = 0;
+    int      run     = 0;
+    char     prev    = '/';
+
+    for (const char *p = path; *p; p++)
+    {
+        if (*p == '/')
+        {
+            total--;
+            run  = 0;
+            prev = '/';
+            continue;
+        }
+        char c = (char)tolower((unsigned char)*p);
+        if (matched < len && c == chars[matched])
+        {
+            total += 1 + (prev == '/' || prev == ' ' || prev == '-' || prev == '_' ? ((starts >> matched) & 1 ? 8 : 2) : 0) + (run ? 4 : 0);
+            in_own += p >= own;
+            matched++;
+            run = 1;
+        }
+        else
+        {
+            if (matched && matched < len)
+                total--;
+            run = 0;
+        }
+        prev = c;
+    }
+
+    *score = total + 3 * in_own;
+    return len > 0 && matched == len;
+}
+
+static uint32_t s_fuzzy_reference (const char *query, menu_item_t **results, int32_t *scores, uint32_t capacity)
+{
+    uint32_t found = 0;
+    uint32_t kept  = 0;
+
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+    {
+        if (item->flags & MENU_FLAG_VIRTUAL)
+            continue;
+
+        // Путь от корня: уровни собираются снизу вверх
+        menu_item_t *chain[16];
+        uint32_t depth = 0;
+        for (menu_item_t *node = item; node && depth < 16; node = node->parent)
+            chain[depth++] = node;
+
+        char path[16 * (MENU_ITEM_TITLE_LEN + 1)];
+        size_t pos = 0;
+        while (depth-- > 0)
+        {
+            if (pos)
+                path[pos++] = '/';
+            size_t len = strnlen(chain[depth]->title, MENU_ITEM_TITLE_LEN);
+            memcpy(&path[pos], chain[depth]->title, len);
+            pos += len;
+        }
+        path[pos] = '\0';
+
+        int32_t score;
+        if (!s_fuzzy_reference_score(path, query, &score))
+            continue;
+        found++;
+
+        if (kept == capacity && score <= scores[kept - 1])
+            continue;
+        uint32_t at = kept < capacity ? kept++ : kept - 1;
+        for (; at > 0 && scores[at - 1] < score; at--)
+        {
+            results[at] = results[at - 1];
+            scores[at]  = scores[at - 1];
+        }
+        results[at] = item;
+        scores[at]  = score;
+    }
+    return found;
+}
+
+/**
+ * @brief Сверяет s_menu_fuzzy с эталоном: число совпадений, лучшие пункты и их оценки.
+ */
+static int s_fuzzy_check (const char *query, uint32_t *found)
+{
+    menu_item_t *results[FUZZY_TOP], *expected[FUZZY_TOP];
+    int32_t      scores[FUZZY_TOP], expected_scores[FUZZY_TOP];
+
+    uint32_t count     = s_menu_fuzzy(query, results, scores, FUZZY_TOP);
+    uint32_t reference = s_fuzzy_reference(query, expected, expected_scores, FUZZY_TOP);
+    uint32_t kept      = count < FUZZY_TOP ? count : FUZZY_TOP;
+
+    if (found)
+        *found = count;
+    if (count != reference)
+    {
+        fprintf(stderr, "fuzzy '%s': %u matches, expected %u\n", query, count, reference);
+        return 0;
+    }
+    for (uint32_t i = 0; i < kept; i++)
+    {
+        if (results[i] != expected[i] || scores[i] != expected_scores[i])
+        {
+            fprintf(stderr, "fuzzy '%s': #%u is '%.16s' (%d), expected '%.16s' (%d)\n", query, i,
+                    results[i]->title, scores[i], expected[i]->title, expected_scores[i]);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+static uint64_t s_fuzzy_index_bytes (void)
+{
+    return (uint64_t)s_menu_fuzzy_index.capacity *
+           (sizeof(menu_fuzzy_entry_t) + sizeof(menu_fuzzy_state_t) + 2 * sizeof(uint32_t));
+}
+
+static void s_fuzzy_build_spare (menu_item_t *spare)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+
+    for (uint32_t i = 0; i < FUZZY_SPARE; i++)
+    {
+        snprintf(title, sizeof(title), "Spare %u", i);
+        s_menu_add_item(title, spare, NULL, 0);
+    }
+}
+
+/**
+ * @brief Изменения дерева без перестроения индекса: добавление области и освобождение подменю.
+ */
+static int s_fuzzy_update (void)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+    int ok = 1;
+
+    // Новая область через s_menu_add_item: записи добавляются в индекс по одной
+    uint64_t start = bench_now_ns();
+    menu_item_t *area = s_menu_add_item("Telemetry", NULL, NULL, 0);
+    for (uint32_t c = 0; c < 4 && area; c++)
+    {
+        snprintf(title, sizeof(title), "Link %u", c);
+        menu_item_t *link = s_menu_add_item(title, area, NULL, 0);
+        for (uint32_t p = 0; p < 10 && link; p++)
+        {
+            snprintf(title, sizeof(title), "%s %u", s_fuzzy_words[p], p);
+            s_menu_add_item(title, link, NULL, 0);
+        }
+    }
+    uint64_t add_ns = bench_now_ns() - start;
+    ok = ok && area && s_fuzzy_check("tele link 3 gain", NULL) && s_fuzzy_check("hi dur", NULL);
+
+    // Отложенное подменю: построение добавляет записи, освобождение помечает их, затем уплотнение.
+    // s_menu_add_item переинициализирует кольцо обходом всего списка, поэтому на малом дереве
+    s_menu_free_items();
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+    for (uint32_t a = 0; a < FUZZY_AREAS; a++)
+    {
+        snprintf(title, sizeof(title), "%s", s_fuzzy_areas[a]);
+        menu_item_t *section = s_menu_add_item(title, NULL, NULL, 0);
+        for (uint32_t p = 0; p < 10 && section; p++)
+        {
+            snprintf(title, sizeof(title), "%s %u", s_fuzzy_words[p], p);
+            s_menu_add_item(title, section, NULL, 0);
+        }
+    }
+    s_menu_handle.current = s_menu_handle.start;
+    ok = ok && s_fuzzy_check("pwm freq", NULL);
+
+    menu_item_t *spare = s_menu_add_lazy("Spares", NULL, s_fuzzy_build_spare, 0);
+    uint32_t compactions = 0;
+    for (uint32_t i = 0; i < FUZZY_CHURN && ok && spare; i++)
+    {
+        s_menu_lazy_build(spare);
+        ok = s_fuzzy_check("spare 17", NULL);
+
+        uint32_t dead = s_menu_fuzzy_index.dead;
+        s_menu_handle.current = s_menu_handle.start;
+        s_menu_lazy_release(spare);
+        compactions += s_menu_fuzzy_index.dead < dead + FUZZY_SPARE;
+        ok = ok && s_fuzzy_check("spare 17", NULL) && s_fuzzy_check("pwm freq", NULL);
+    }
+
+    printf("{\"bench\":\"fuzzy\",\"update\":\"add_release\",\"added_ns\":%llu,\"churn\":%u,\"compactions\":%u,"
+           "\"entries\":%u,\"dead\":%u,\"ok\":%s}\n",
+           (unsigned long long)add_ns, FUZZY_CHURN, compactions, s_menu_fuzzy_index.count,
+           s_menu_fuzzy_index.dead, ok ? "true" : "false");
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            s_fuzzy_repeat = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (s_fuzzy_repeat == 0)
+                s_fuzzy_repeat = 1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--repeat N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!s_fuzzy_build())
+    {
+        fprintf(stderr, "fuzzy: cannot build the tree\n");
+        return 1;
+    }
+
+    menu_item_t *results[FUZZY_TOP];
+    int32_t      scores[FUZZY_TOP];
+
+    uint64_t start = bench_now_ns();
+    s_menu_fuzzy("x", results, scores, FUZZY_TOP);
+    uint64_t index_ns = bench_now_ns() - start;
+    printf("{\"bench\":\"fuzzy\",\"items\":%u,\"index_build_ns\":%llu,\"index_bytes\":%llu,\"bytes_per_item\":%.1f}\n",
+           s_fuzzy_items, (unsigned long long)index_ns, (unsigned long long)s_fuzzy_index_bytes(),
+           (double)s_fuzzy_index_bytes() / s_fuzzy_items);
+
+    int failed = 0;
+    for (uint32_t q = 0; q < sizeof(s_fuzzy_queries) / sizeof(s_fuzzy_queries[0]); q++)
+    {
+        const char *query = s_fuzzy_queries[q];
+        uint64_t best = UINT64_MAX, worst = 0;
+
+        for (uint32_t r = 0; r < s_fuzzy_repeat; r++)
+        {
+            start = bench_now_ns();
+            s_menu_fuzzy(query, results, scores, FUZZY_TOP);
+            uint64_t ns = bench_now_ns() - start;
+            best  = ns < best ? ns : best;
+            worst = ns > worst ? ns : worst;
+        }
+
+        uint32_t found = 0;
+        int ok = s_fuzzy_check(query, &found);
+        failed += !ok;
+
+        printf("{\"bench\":\"fuzzy\",\"query\":\"%s\",\"items\":%u,\"found\":%u,\"top\":\"%.16s\",\"top_score\":%d,"
+               "\"best_us\":%.1f,\"worst_us\":%.1f,\"ok\":%s}\n",
+               query, s_fuzzy_items, found, found ? results[0]->title : "", found ? scores[0] : 0,
+               best / 1000.0, worst / 1000.0, ok ? "true" : "false");
+    }
+
+    failed += !s_fuzzy_update();
+    s_menu_free_items();
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+
+    return failed ? 1 : 0;
+}
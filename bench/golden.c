@@ -0,0 +1,261 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "menu.h"
+#include "console.h"
+#include "lcd1602.h"
+#include "bench.h"
+
+/**
+ * Регрессия по эталонным кадрам.
+ *
+ * Для каждого скрипта NAME.script (формат -- см. bench_input_t) Menu_Init строит
+ * демонстрационное меню, скрипт проигрывается по событию, после каждого события
+ * записывается итоговый кадр 16x2. Результат сравнивается с NAME.golden:
+ *
+ *     0 init
+ *     |> Start         |
+ *     |Test            |
+ *     1 +
+ *     ...
+ *
+ * При расхождении выводится первое отличающееся событие и оба кадра.
+ *
+ * Запуск: MenuGolden [--update] [--repeat N] FILE.script...
+ *   --update   -- перезаписать эталоны текущими кадрами
+ *   --repeat N -- прогнать набор N раз и вывести скорость (скриптов в секунду)
+ */
+
+#define GOLDEN_BLOCK_LINES 3 ///< Строк на событие: заголовок и две строки кадра
+
+typedef struct {
+    char  *text;
+    size_t len;
+    size_t cap;
+} golden_buffer_t;
+
+static struct {
+    const char     *script;  ///< Скрипт текущего прогона
+    lcd1602_frame_t frame;   ///< Последний выведенный кадр
+    golden_buffer_t out;     ///< Записанные кадры текущего прогона
+} s_golden;
+
+static void s_golden_append (golden_buffer_t *buffer, const char *text)
+{
+    size_t len = strlen(text);
+
+    if (buffer->len + len + 1 > buffer->cap)
+    {
+        buffer->cap  = (buffer->len + len + 1) * 2;
+        buffer->text = realloc(buffer->text, buffer->cap);
+    }
+
+    memcpy(buffer->text + buffer->len, text, len + 1);
+    buffer->len += len;
+}
+
+static void s_golden_record (uint32_t index, const char *event)
+{
+    char line[LCD1602_COLS + 32];
+
+    snprintf(line, sizeof(line), "%u %s\n", index, event);
+    s_golden_append(&s_golden.out, line);
+    for (uint32_t row = 0; row < LCD1602_ROWS; row++)
+    {
+        snprintf(line, sizeof(line), "|%s|\n", s_golden.frame[row]);
+        s_golden_append(&s_golden.out, line);
+    }
+}
+
+void printMenu(const char *str1, const char *str2)
+{
+    lcd1602_compose(s_golden.frame, str1, str2);
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    bench_input_t input = { rotary_encoder_callback_func, push_button_callback_func, long_push_button_callback_func, 0, Menu_JumpKey };
+    char event[3] = { 0, 0, 0 };
+    uint32_t index = 0;
+
+    s_golden_record(index++, "init");
+
+    for (const char *p = s_golden.script; *p; p++)
+    {
+        if (*p == '#')
+        {
+            while (p[1] && p[1] != '\n')
+                p++;
+            continue;
+        }
+
+        // Быстрый переход `/X` -- одно событие из двух символов
+        event[0] = *p;
+        event[1] = (*p == '/' && p[1]) ? *++p : '\0';
+        if (bench_play(&input, event) != 0)
+        {
+            s_golden_record(index++, event);
+        }
+    }
+}
+
+/**
+ * @brief Возвращает начало строки номер `line` (с нуля) или NULL.
+ */
+static const char *s_golden_line (const char *text, uint32_t line)
+{
+    while (line-- && text)
+    {
+        text = strchr(text, '\n');
+        if (text)
+            text++;
+    }
+    return text && *text ? text : NULL;
+}
+
+static void s_golden_print_block (const char *label, const char *block)
+{
+    printf("  %s:\n", label);
+    for (uint32_t i = 0; i < GOLDEN_BLOCK_LINES && block && *block; i++)
+    {
+        const char *end = strchr(block, '\n');
+        int len = end ? (int)(end - block) : (int)strlen(block);
+        printf("    %.*s\n", len, block);
+        block = end ? end + 1 : NULL;
+    }
+}
+
+/**
+ * @brief Сравнивает записанные кадры с эталоном и печатает первое расхождение.
+ * @return 0 -- совпадает, 1 -- расхождение.
+ */
+static int s_golden_compare (const char *name, const char *expected, const char *actual)
+{
+    if (strcmp(expected, actual) == 0)
+        return 0;
+
+    for (uint32_t block = 0;; block++)
+    {
+        const char *e = s_golden_line(expected, block * GOLDEN_BLOCK_LINES);
+        const char *a = s_golden_line(actual,   block * GOLDEN_BLOCK_LINES);
+        const char *e_next = s_golden_line(expected, (block + 1) * GOLDEN_BLOCK_LINES);
+        const char *a_next = s_golden_line(actual,   (block + 1) * GOLDEN_BLOCK_LINES);
+        size_t e_len = e ? (e_next ? (size_t)(e_next - e) : strlen(e)) : 0;
+        size_t a_len = a ? (a_next ? (size_t)(a_next - a) : strlen(a)) : 0;
+
+        if (e_len != a_len || (e_len && memcmp(e, a, e_len) != 0))
+        {
+            printf("%s: frame %u differs\n", name, block);
+            s_golden_print_block("expected", e ? e : "<end of golden>");
+            s_golden_print_block("actual",   a ? a : "<end of run>");
+            return 1;
+        }
+    }
+}
+
+/**
+ * @brief Прогоняет один скрипт. Имя эталона -- путь скрипта с заменой расширения на .golden.
+ * @return 0 -- совпало (или эталон обновлён), 1 -- расхождение или ошибка.
+ */
+static int s_golden_run (const char *script_path, int update, int quiet)
+{
+    char golden_path[1024];
+    const char *dot = strrchr(script_path, '.');
+    size_t stem = dot ? (size_t)(dot - script_path) : strlen(script_path);
+
+    snprintf(golden_path, sizeof(golden_path), "%.*s.golden", (int)stem, script_path);
+
+    char *script = bench_read_file(script_path);
+    if (script == NULL)
+    {
+        printf("%s: cannot read\n", script_path);
+        return 1;
+    }
+
+    s_golden.script  = script;
+    s_golden.out.len = 0;
+    s_golden_append(&s_golden.out, "");
+    Menu_Init();
+    free(script);
+
+    if (update)
+    {
+        FILE *file = fopen(golden_path, "wb");
+        if (file == NULL || fwrite(s_golden.out.text, 1, s_golden.out.len, file) != s_golden.out.len)
+        {
+            printf("%s: cannot write\n", golden_path);
+            if (file)
+                fclose(file);
+            return 1;
+        }
+        fclose(file);
+        printf("%s: updated\n", golden_path);
+        return 0;
+    }
+
+    char *expected = bench_read_file(golden_path);
+    if (expected == NULL)
+    {
+        printf("%s: missing golden file (run with --update)\n", golden_path);
+        return 1;
+    }
+
+    int result = s_golden_compare(script_path, expected, s_golden.out.text);
+    if (result == 0 && !quiet)
+    {
+        printf("%s: ok\n", script_path);
+    }
+
+    free(expected);
+    return result;
+}
+
+int main(int argc, char *argv[])
+{
+    int update = 0;
+    uint32_t repeat = 1;
+    int first = 1;
+
+    for (; first < argc && strncmp(argv[first], "--", 2) == 0; first++)
+    {
+        if (strcmp(argv[first], "--update") == 0)
+        {
+            update = 1;
+        }
+        else if (strcmp(argv[first], "--repeat") == 0 && first + 1 < argc)
+        {
+            repeat = (uint32_t)strtoul(argv[++first], NULL, 0);
+        }
+    }
+
+    if (first >= argc || repeat == 0)
+    {
+        fprintf(stderr, "usage: %s [--update] [--repeat N] FILE.script...\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    int failures = 0;
+    uint64_t start = bench_now_ns();
+
+    for (uint32_t r = 0; r < repeat && failures == 0; r++)
+    {
+        for (int i = first; i < argc; i++)
+        {
+            failures += s_golden_run(argv[i], update && r == 0, r > 0);
+        }
+        update = 0;
+    }
+
+    uint64_t ns = bench_now_ns() - start;
+    uint64_t scripts = (uint64_t)repeat * (uint64_t)(argc - first);
+
+    if (repeat > 1)
+    {
+        printf("golden: %llu scripts in %.3f ms, %.0f scripts/s\n",
+               (unsigned long long)scripts, (double)ns / 1e6, (double)scripts * 1e9 / (double)ns);
+    }
+
+    free(s_golden.out.text);
+    return failures ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,205 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "menu.h"
+#include "console.h"
+#include "menu_latency.h"
+#include "menu_trace.h"
+#include "lcd1602.h"
+#include "bench.h"
+
+/**
+ * Безголовый прогон движка меню.
+ *
+ * menu.c линкуется без console.c: printMenu и taskReadKey реализованы здесь.
+ * Menu_Init строит демонстрационное дерево и вызывает taskReadKey, внутри которого
+ * проигрываются нагрузки. Результаты выводятся в stdout по одной JSON-записи на строку.
+ *
+ * Запуск: MenuHeadless [--events N] [--display null|record] [--script FILE]
+ *
+ * Сборка с MENU_LATENCY_ENABLE=1 (цель MenuLatency) дополнительно выводит для каждой нагрузки
+ * перцентили задержки по стадиям обработки события.
+ * Сборка с MENU_TRACE_ENABLE=1 (цель MenuTraceHeadless) принимает --trace FILE и сохраняет
+ * в него кольцо самописца после прогона.
+ */
+
+#define HEADLESS_DEFAULT_EVENTS 1000000u
+
+typedef enum {
+    HEADLESS_DISPLAY_NULL,   ///< printMenu ничего не делает
+    HEADLESS_DISPLAY_RECORD, ///< printMenu формирует кадр 16x2 и добавляет его в хеш
+} headless_display_t;
+
+/**
+ * @brief Нагрузка: скрипт, повторяемый до набора нужного числа событий.
+ *        Все скрипты начинаются и заканчиваются на пункте "Start" демонстрационного меню.
+ */
+typedef struct {
+    const char *name;
+    const char *script;
+} headless_workload_t;
+
+static const headless_workload_t s_workloads[] = {
+    { "nav",     "+++---" },          // Прокрутка корневого кольца в обе стороны
+    { "button",  "-**+" },            // Options -> Back -> Options -> Start
+    { "gesture", "-*+*!!!" },         // Вглубь до PWM/Back и назад длинными нажатиями
+    { "mixed",   "-*++*+-*!+" },      // Options -> Lo Arm -> вход, прокрутка, выход
+};
+
+static struct {
+    headless_display_t display;
+    uint32_t           events;
+    const char        *script_path;
+    const char        *trace_path;
+    uint64_t           frames;
+    uint64_t           frame_hash;
+    uint64_t           start_ns;
+} s_headless = { HEADLESS_DISPLAY_NULL, HEADLESS_DEFAULT_EVENTS, NULL, NULL, 0, 0, 0 };
+
+void printMenu(const char *str1, const char *str2)
+{
+    s_headless.frames++;
+
+    if (s_headless.display == HEADLESS_DISPLAY_RECORD)
+    {
+        lcd1602_frame_t frame;
+        lcd1602_compose(frame, str1, str2);
+        s_headless.frame_hash = bench_hash(s_headless.frame_hash, frame, sizeof(frame));
+    }
+}
+
+static void s_report (const char *workload, uint64_t events, uint64_t ns)
+{
+    printf("{\"bench\":\"headless\",\"workload\":\"%s\",\"display\":\"%s\","
+           "\"events\":%llu,\"ns_total\":%llu,\"ns_per_event\":%.2f,\"events_per_sec\":%.0f,"
+           "\"allocs\":%llu,\"frees\":%llu,\"frames\":%llu,\"frame_hash\":\"%016llx\"}\n",
+           workload, s_headless.display == HEADLESS_DISPLAY_RECORD ? "record" : "null",
+           (unsigned long long)events, (unsigned long long)ns,
+           events ? (double)ns / (double)events : 0.0,
+           ns ? (double)events * 1e9 / (double)ns : 0.0,
+           (unsigned long long)bench_alloc_stat.allocs, (unsigned long long)bench_alloc_stat.frees,
+           (unsigned long long)s_headless.frames, (unsigned long long)s_headless.frame_hash);
+}
+
+#if (MENU_LATENCY_ENABLE != 0)
+static void s_report_latency (const char *workload)
+{
+    static const char *stages[MENU_LATENCY_STAGES] = { "dispatch", "callback", "render", "flush", "total" };
+
+    for (uint32_t stage = 0; stage < MENU_LATENCY_STAGES; stage++)
+    {
+        const menu_latency_hist_t *hist = menu_latency_get(stage);
+
+        printf("{\"bench\":\"latency\",\"workload\":\"%s\",\"stage\":\"%s\",\"count\":%lu,"
+               "\"min_ns\":%lu,\"p50_ns\":%lu,\"p90_ns\":%lu,\"p99_ns\":%lu,\"max_ns\":%lu}\n",
+               workload, stages[stage], (unsigned long)hist->count, (unsigned long)hist->min,
+               (unsigned long)menu_latency_percentile(stage, 500), (unsigned long)menu_latency_percentile(stage, 900),
+               (unsigned long)menu_latency_percentile(stage, 990), (unsigned long)hist->max);
+    }
+}
+#endif
+
+static void s_run (bench_input_t *input, const char *name, const char *script)
+{
+    uint64_t events = 0;
+
+    s_headless.frames     = 0;
+    s_headless.frame_hash = 0;
+    bench_alloc_reset();
+#if (MENU_LATENCY_ENABLE != 0)
+    menu_latency_reset();
+#endif
+
+    uint64_t start = bench_now_ns();
+    while (events < s_headless.events)
+    {
+        uint32_t played = bench_play(input, script);
+        if (played == 0)
+            break;
+        events += played;
+    }
+    uint64_t ns = bench_now_ns() - start;
+
+    s_report(name, events, ns);
+#if (MENU_LATENCY_ENABLE != 0)
+    s_report_latency(name);
+#endif
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    bench_input_t input = { rotary_encoder_callback_func, push_button_callback_func, long_push_button_callback_func, 0, NULL };
+
+    s_report("build", 0, bench_now_ns() - s_headless.start_ns);
+
+    if (s_headless.script_path)
+    {
+        char *script = bench_read_file(s_headless.script_path);
+        if (script == NULL)
+        {
+            fprintf(stderr, "headless: cannot read %s\n", s_headless.script_path);
+            exit(EXIT_FAILURE);
+        }
+        s_run(&input, "script", script);
+        free(script);
+    }
+    else
+    {
+        for (size_t i = 0; i < sizeof(s_workloads) / sizeof(s_workloads[0]); i++)
+        {
+            s_run(&input, s_workloads[i].name, s_workloads[i].script);
+        }
+    }
+
+    // После возврата Menu_Init освобождает пункты меню
+    bench_alloc_reset();
+    s_headless.frames     = 0;
+    s_headless.frame_hash = 0;
+    s_headless.start_ns   = bench_now_ns();
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+        {
+            s_headless.events = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--display") == 0 && i + 1 < argc)
+        {
+            i++;
+            s_headless.display = strcmp(argv[i], "record") == 0 ? HEADLESS_DISPLAY_RECORD : HEADLESS_DISPLAY_NULL;
+        }
+        else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc)
+        {
+            s_headless.script_path = argv[++i];
+        }
+        else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc)
+        {
+            s_headless.trace_path = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--events N] [--display null|record] [--script FILE] [--trace FILE]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+    }
+
+    bench_alloc_reset();
+    s_headless.start_ns = bench_now_ns();
+    Menu_Init();
+
+    s_report("teardown", 0, bench_now_ns() - s_headless.start_ns);
+
+#if (MENU_TRACE_ENABLE != 0)
+    if (s_headless.trace_path && menu_trace_dump(s_headless.trace_path) != 0)
+    {
+        fprintf(stderr, "headless: cannot write %s\n", s_headless.trace_path);
+        return EXIT_FAILURE;
+    }
+#endif
+
+    return 0;
+}
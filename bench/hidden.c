@@ -0,0 +1,183 @@
+#include "bench.h"
+
+/**
+ * Скрытые пункты: стоимость шага энкодера и скрытия/показа в зависимости от числа скрытых.
+ *
+ * menu.c включается целиком, чтобы вызвать s_menu_set_visible. Корневое кольцо из
+ * HIDDEN_ITEMS пунктов; для каждой доли скрытых пункты скрываются случайно (фиксированное
+ * зерно), затем курсор проходит --steps шагов вперёд и назад с проверкой: каждый шаг ведёт
+ * к следующему видимому пункту в порядке создания. Затем --steps шагов замеряются без
+ * проверок. Последний прогон оставляет видимыми два соседних пункта, между которыми по
+ * кругу скрыты все остальные.
+ *
+ * JSON-строка на долю: скрытые пункты, наносекунды на шаг, на скрытие и на показ пункта.
+ *
+ * Запуск: MenuHidden [--steps N] [--seed S]
+ */
+#include "../menu.c"
+
+#define HIDDEN_ITEMS 1000
+
+static const uint32_t s_hidden_percent[] = { 0, 50, 90, 99 };
+
+static uint32_t     s_hidden_steps = 100000;
+static uint32_t     s_hidden_seed  = 1;
+static uint32_t     s_hidden_encoder;
+static menu_item_t *s_hidden_items[HIDDEN_ITEMS];
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static uint32_t s_hidden_random (uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 16;
+}
+
+/**
+ * @brief Эталон: следующий (step > 0) или предыдущий видимый пункт в порядке создания.
+ */
+static menu_item_t * s_hidden_expected (uint32_t from, int step)
+{
+    uint32_t i = from;
+    do
+    {
+        i = (i + (step > 0 ? 1 : HIDDEN_ITEMS - 1)) % HIDDEN_ITEMS;
+    } while (s_hidden_items[i]->flags & MENU_FLAG_HIDDEN);
+    return s_hidden_items[i];
+}
+
+static int s_hidden_walk (int step)
+{
+    for (uint32_t i = 0; i < s_hidden_steps; i++)
+    {
+        uint32_t     from     = (uint32_t)s_menu_handle.current->data;
+        menu_item_t *expected = s_hidden_expected(from, step);
+
+        s_hidden_encoder += step > 0 ? ENCODER_INPUT_FILTER : -ENCODER_INPUT_FILTER;
+        s_rotary_encoder_callback(s_hidden_encoder);
+        if (s_menu_handle.current != expected)
+        {
+            fprintf(stderr, "hidden: step %d from '%.16s' went to '%.16s', expected '%.16s'\n", step,
+                    s_hidden_items[from]->title, s_menu_handle.current->title, expected->title);
+            return 0;
+        }
+    }
+    return 1;
+}
+
+/**
+ * @brief Прогон: скрыть `hide` пунктов (`keep` -- два соседних пункта остаются видимыми).
+ */
+static int s_hidden_run (uint32_t hide, int keep, const char *name)
+{
+    uint32_t state = s_hidden_seed ? s_hidden_seed : 1;
+    uint32_t order[HIDDEN_ITEMS];
+    char title[MENU_ITEM_TITLE_LEN];
+
+    for (uint32_t i = 0; i < HIDDEN_ITEMS; i++)
+    {
+        snprintf(title, sizeof(title), "Item %u", i);
+        s_hidden_items[i] = s_menu_add_item(title, NULL, NULL, 0);
+        if (s_hidden_items[i] == NULL)
+            return 0;
+        s_hidden_items[i]->data = i;
+        order[i] = i;
+    }
+
+    // Случайный порядок скрытия (Фишер -- Йейтс); при `keep` видимыми остаются пункты 0 и 1
+    for (uint32_t i = HIDDEN_ITEMS - 1; i > 0; i--)
+    {
+        uint32_t j = s_hidden_random(&state) % (i + 1);
+        uint32_t t = order[i];
+        order[i] = order[j];
+        order[j] = t;
+    }
+
+    s_menu_handle.current = s_hidden_items[keep ? 0 : order[HIDDEN_ITEMS - 1]];
+    uint64_t start = bench_now_ns();
+    uint32_t hidden = 0;
+    for (uint32_t i = 0; hidden < hide; i++)
+    {
+        if (keep && order[i] < 2)
+            continue;
+        s_menu_set_visible(s_hidden_items[order[i]], 0);
+        hidden++;
+    }
+    uint64_t hide_ns = bench_now_ns() - start;
+
+    int ok = !(s_menu_handle.current->flags & MENU_FLAG_HIDDEN) && s_hidden_walk(1) && s_hidden_walk(-1);
+
+    // Замер без проверок
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < s_hidden_steps; i++)
+    {
+        s_hidden_encoder += ENCODER_INPUT_FILTER;
+        s_rotary_encoder_callback(s_hidden_encoder);
+    }
+    uint64_t step_ns = bench_now_ns() - start;
+
+    // Показ в обратном порядке: кольцо должно вернуться к порядку создания
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < HIDDEN_ITEMS; i++)
+        s_menu_set_visible(s_hidden_items[order[HIDDEN_ITEMS - 1 - i]], 1);
+    uint64_t show_ns = bench_now_ns() - start;
+
+    menu_item_t *walk = s_hidden_items[0];
+    for (uint32_t i = 0; i < HIDDEN_ITEMS && ok; i++, walk = walk->next)
+        ok = walk == s_hidden_items[i] && walk->prev == s_hidden_items[(i + HIDDEN_ITEMS - 1) % HIDDEN_ITEMS];
+
+    printf("{\"bench\":\"hidden\",\"case\":\"%s\",\"items\":%u,\"hidden\":%u,\"steps\":%u,\"ns_per_step\":%.2f,"
+           "\"ns_per_hide\":%.2f,\"ns_per_show\":%.2f,\"ok\":%s}\n",
+           name, HIDDEN_ITEMS, hidden, s_hidden_steps, s_hidden_steps ? (double)step_ns / s_hidden_steps : 0.0,
+           hidden ? (double)hide_ns / hidden : 0.0, (double)show_ns / HIDDEN_ITEMS, ok ? "true" : "false");
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_free_items();
+#endif
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+    s_hidden_encoder = 0;
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+        {
+            s_hidden_steps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_hidden_seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--steps N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    char name[16];
+    for (uint32_t i = 0; i < sizeof(s_hidden_percent) / sizeof(s_hidden_percent[0]); i++)
+    {
+        snprintf(name, sizeof(name), "%u%%", s_hidden_percent[i]);
+        failed += !s_hidden_run(HIDDEN_ITEMS * s_hidden_percent[i] / 100, 0, name);
+    }
+    failed += !s_hidden_run(HIDDEN_ITEMS - 2, 1, "all_but_two");
+
+    return failed ? 1 : 0;
+}
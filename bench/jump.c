@@ -0,0 +1,172 @@
+#include "bench.h"
+
+/**
+ * Быстрый переход по первой букве: стоимость Menu_JumpKey в зависимости от длины кольца.
+ *
+ * menu.c включается целиком. Для каждой длины строится корневое кольцо из пунктов с
+ * заголовками "<буква><номер>" (буквы a-z, случайные с фиксированным зерном) и проигрывается
+ * --jumps нажатий случайных букв. Каждый переход сверяется с эталоном, найденным обходом
+ * кольца. Выводятся наносекунды на переход и сколько шагов энкодера (в ближайшую сторону)
+ * заменил бы один переход.
+ *
+ * MenuJump собирается с индексом (MENU_JUMP_INDEX=32), MenuJumpScan -- с
+ * MENU_JUMP_INDEX=0, когда переход ищется обходом кольца.
+ *
+ * Запуск: MenuJump [--jumps N] [--seed S]
+ */
+#include "../menu.c"
+
+static const uint32_t s_jump_counts[] = { 16, 256, 4096 };
+
+static uint32_t s_jump_jumps = 100000;
+static uint32_t s_jump_seed  = 1;
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static uint32_t s_jump_random (uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 16;
+}
+
+/**
+ * @brief Эталон: пункт, к которому должен привести переход из `from` по букве `key`.
+ *
+ * С индексом -- следующий пункт с той же буквой, если `from` начинается с неё, иначе первый
+ * такой пункт кольца (от `first`). Без индекса -- следующий после `from` пункт с этой буквой.
+ */
+static menu_item_t * s_jump_expected (menu_item_t *first, menu_item_t *from, char key)
+{
+#if (MENU_JUMP_INDEX > 0)
+    menu_item_t *item = from->title[0] == key ? from->next : first;
+#else
+    menu_item_t *item = from->next;
+    (void)first;
+#endif
+    for (uint32_t i = 0; i < 2; i++)
+    {
+        // Два прохода по кольцу: от `item` до конца и по кругу до него же
+        menu_item_t *walk = item;
+        do
+        {
+            if (walk->title[0] == key)
+                return walk;
+            walk = walk->next;
+        } while (walk != item);
+    }
+    return NULL;
+}
+
+/**
+ * @brief Шаги энкодера от `from` до `to` в ближайшую сторону.
+ */
+static uint32_t s_jump_distance (menu_item_t *from, menu_item_t *to, uint32_t count)
+{
+    uint32_t forward = 0;
+    while (from != to && forward < count)
+    {
+        from = from->next;
+        forward++;
+    }
+    return forward < count - forward ? forward : count - forward;
+}
+
+static int s_jump_run (uint32_t count)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+    uint32_t state = s_jump_seed ? s_jump_seed : 1;
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < count; i++)
+    {
+        snprintf(title, sizeof(title), "%c%u", 'a' + s_jump_random(&state) % 26, i);
+        if (s_menu_add_item(title, NULL, NULL, 0) == NULL)
+        {
+            fprintf(stderr, "jump %u: s_menu_add_item failed\n", count);
+            return 0;
+        }
+    }
+    uint64_t build_ns = bench_now_ns() - start;
+
+    menu_item_t *first = s_menu_handle.start;
+    char *keys = malloc(s_jump_jumps);
+    for (uint32_t i = 0; i < s_jump_jumps; i++)
+        keys[i] = (char)('a' + s_jump_random(&state) % 26);
+
+    // Проверка по эталону и шаги энкодера, которые заменяет переход
+    int ok = 1;
+    uint64_t spins = 0;
+    s_menu_handle.current = first;
+    for (uint32_t i = 0; i < s_jump_jumps && ok; i++)
+    {
+        menu_item_t *from     = s_menu_handle.current;
+        menu_item_t *expected = s_jump_expected(first, from, keys[i]);
+
+        Menu_JumpKey(keys[i]);
+        if (s_menu_handle.current != (expected ? expected : from))
+        {
+            fprintf(stderr, "jump %u: '%c' from '%.16s' went to '%.16s', expected '%.16s'\n", count, keys[i],
+                    from->title, s_menu_handle.current->title, expected ? expected->title : from->title);
+            ok = 0;
+        }
+        spins += s_jump_distance(from, s_menu_handle.current, count);
+    }
+
+    // Замер без проверок
+    s_menu_handle.current = first;
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < s_jump_jumps; i++)
+        Menu_JumpKey(keys[i]);
+    uint64_t ns = bench_now_ns() - start;
+
+    printf("{\"bench\":\"jump\",\"index\":%u,\"items\":%u,\"build_ns\":%llu,\"jumps\":%u,\"ns_per_jump\":%.2f,"
+           "\"spin_steps_per_jump\":%.2f,\"ok\":%s}\n",
+           MENU_JUMP_INDEX, count, (unsigned long long)build_ns, s_jump_jumps,
+           s_jump_jumps ? (double)ns / s_jump_jumps : 0.0,
+           s_jump_jumps ? (double)spins / s_jump_jumps : 0.0, ok ? "true" : "false");
+
+    free(keys);
+    s_menu_free_items();
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--jumps") == 0 && i + 1 < argc)
+        {
+            s_jump_jumps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_jump_seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--jumps N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    for (uint32_t i = 0; i < sizeof(s_jump_counts) / sizeof(s_jump_counts[0]); i++)
+    {
+        failed += !s_jump_run(s_jump_counts[i]);
+    }
+
+    return failed ? 1 : 0;
+}
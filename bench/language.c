@@ -0,0 +1,282 @@
+#include "bench.h"
+
+/**
+ * Смена языка: таблицы строк в ПЗУ (Menu_SetLanguage) против перестроения меню с новыми заголовками.
+ *
+ * menu.c включается целиком с MENU_STRINGS=LANG_STRINGS. Дерево -- LANG_GROUPS групп по
+ * LANG_PARAMS параметров (плюс "Back" в каждой); заголовки -- строки таблиц en, de, fr.
+ * Одно и то же дерево строится двумя способами: пунктами с заголовком в поле (s_menu_add_item,
+ * как раньше) и пунктами со строкой таблицы (s_menu_add_string).
+ *
+ * JSON-строка: наносекунды на перерисовку (s_display_menu) для обоих деревьев, на смену языка
+ * (замена таблицы и перерисовка) и на перестроение дерева с заголовками в новом языке, размер
+ * пункта. Проверки: кадры прогона по дереву строк в каждом языке совпадают с кадрами дерева с
+ * заголовками этого языка; после смены языка быстрый переход, s_menu_find и s_menu_search
+ * находят пункты по новым заголовкам.
+ *
+ * Запуск: MenuLanguage [--repeat N]
+ */
+#include "../menu.c"
+
+#define LANG_GROUPS 4
+#define LANG_PARAMS 6
+
+enum {
+    STR_BACK,
+    STR_GROUP_0,
+    STR_PARAM_0 = STR_GROUP_0 + LANG_GROUPS,
+    STR_COUNT   = STR_PARAM_0 + LANG_GROUPS * LANG_PARAMS,
+};
+
+_Static_assert(STR_COUNT <= MENU_STRINGS, "MENU_STRINGS is too small for the bench tables");
+
+static const menu_string_t s_lang_en[MENU_STRINGS] = {
+    [STR_BACK]         = "Back",
+    [STR_GROUP_0 + 0]  = "PWM",         [STR_GROUP_0 + 1] = "Display",
+    [STR_GROUP_0 + 2]  = "Network",     [STR_GROUP_0 + 3] = "System",
+    [STR_PARAM_0 + 0]  = "Frequency",   [STR_PARAM_0 + 1]  = "Duty cycle",  [STR_PARAM_0 + 2]  = "Enable",
+    [STR_PARAM_0 + 3]  = "Dead time",   [STR_PARAM_0 + 4]  = "Polarity",    [STR_PARAM_0 + 5]  = "Soft start",
+    [STR_PARAM_0 + 6]  = "Brightness",  [STR_PARAM_0 + 7]  = "Contrast",    [STR_PARAM_0 + 8]  = "Backlight",
+    [STR_PARAM_0 + 9]  = "Timeout",     [STR_PARAM_0 + 10] = "Language",    [STR_PARAM_0 + 11] = "Units",
+    [STR_PARAM_0 + 12] = "Address",     [STR_PARAM_0 + 13] = "Baud rate",   [STR_PARAM_0 + 14] = "Parity",
+    [STR_PARAM_0 + 15] = "Stop bits",   [STR_PARAM_0 + 16] = "Gateway",     [STR_PARAM_0 + 17] = "DHCP",
+    [STR_PARAM_0 + 18] = "Version",     [STR_PARAM_0 + 19] = "Reset",       [STR_PARAM_0 + 20] = "Calibrate",
+    [STR_PARAM_0 + 21] = "Event log",   [STR_PARAM_0 + 22] = "Clock",       [STR_PARAM_0 + 23] = "Password",
+};
+
+static const menu_string_t s_lang_de[MENU_STRINGS] = {
+    [STR_BACK]         = "Zurueck",
+    [STR_GROUP_0 + 0]  = "PWM",         [STR_GROUP_0 + 1] = "Anzeige",
+    [STR_GROUP_0 + 2]  = "Netzwerk",    [STR_GROUP_0 + 3] = "System",
+    [STR_PARAM_0 + 0]  = "Frequenz",    [STR_PARAM_0 + 1]  = "Tastgrad",    [STR_PARAM_0 + 2]  = "Aktiv",
+    [STR_PARAM_0 + 3]  = "Totzeit",     [STR_PARAM_0 + 4]  = "Polaritaet",  [STR_PARAM_0 + 5]  = "Sanftanlauf",
+    [STR_PARAM_0 + 6]  = "Helligkeit",  [STR_PARAM_0 + 7]  = "Kontrast",    [STR_PARAM_0 + 8]  = "Beleuchtung",
+    [STR_PARAM_0 + 9]  = "Zeitlimit",   [STR_PARAM_0 + 10] = "Sprache",     [STR_PARAM_0 + 11] = "Einheiten",
+    [STR_PARAM_0 + 12] = "Adresse",     [STR_PARAM_0 + 13] = "Baudrate",    [STR_PARAM_0 + 14] = "Paritaet",
+    [STR_PARAM_0 + 15] = "Stoppbits",   [STR_PARAM_0 + 16] = "Gateway",     [STR_PARAM_0 + 17] = "DHCP",
+    [STR_PARAM_0 + 18] = "Version",     [STR_PARAM_0 + 19] = "Ruecksetzen", [STR_PARAM_0 + 20] = "Kalibrieren",
+    [STR_PARAM_0 + 21] = "Ereignisse",  [STR_PARAM_0 + 22] = "Uhr",         [STR_PARAM_0 + 23] = "Passwort",
+};
+
+static const menu_string_t s_lang_fr[MENU_STRINGS] = {
+    [STR_BACK]         = "Retour",
+    [STR_GROUP_0 + 0]  = "MLI",         [STR_GROUP_0 + 1] = "Affichage",
+    [STR_GROUP_0 + 2]  = "Reseau",      [STR_GROUP_0 + 3] = "Systeme",
+    [STR_PARAM_0 + 0]  = "Frequence",   [STR_PARAM_0 + 1]  = "Rapport cycl.", [STR_PARAM_0 + 2]  = "Activer",
+    [STR_PARAM_0 + 3]  = "Temps mort",  [STR_PARAM_0 + 4]  = "Polarite",    [STR_PARAM_0 + 5]  = "Demarrage doux",
+    [STR_PARAM_0 + 6]  = "Luminosite",  [STR_PARAM_0 + 7]  = "Contraste",   [STR_PARAM_0 + 8]  = "Retroeclairage",
+    [STR_PARAM_0 + 9]  = "Delai",       [STR_PARAM_0 + 10] = "Langue",      [STR_PARAM_0 + 11] = "Unites",
+    [STR_PARAM_0 + 12] = "Adresse",     [STR_PARAM_0 + 13] = "Debit",       [STR_PARAM_0 + 14] = "Parite",
+    [STR_PARAM_0 + 15] = "Bits d'arret", [STR_PARAM_0 + 16] = "Passerelle", [STR_PARAM_0 + 17] = "DHCP",
+    [STR_PARAM_0 + 18] = "Version",     [STR_PARAM_0 + 19] = "Reinitialiser", [STR_PARAM_0 + 20] = "Calibrer",
+    [STR_PARAM_0 + 21] = "Journal",     [STR_PARAM_0 + 22] = "Horloge",     [STR_PARAM_0 + 23] = "Mot de passe",
+};
+
+typedef struct {
+    const char          *name;
+    const menu_string_t *strings;
+} lang_table_t;
+
+static const lang_table_t s_lang_tables[] = {
+    { "en", s_lang_en },
+    { "de", s_lang_de },
+    { "fr", s_lang_fr },
+};
+
+#define LANG_TABLES (sizeof(s_lang_tables) / sizeof(s_lang_tables[0]))
+
+/// Прогон по дереву: все группы, параметры, выход и переход по букве
+static const char *s_lang_script = "*++++++++!+*+++!++*+++++++!+++*++!+++*+!";
+
+static uint32_t s_lang_repeat = 100000;
+static uint64_t s_lang_frames;  ///< Хеш кадров прогона
+static volatile uint32_t s_lang_sink;
+static menu_item_t *s_lang_back[LANG_GROUPS]; ///< "Back" групп: вход в подменю прогона начинается с него
+static int      s_lang_hash_frames;
+
+void printMenu(const char *str1, const char *str2)
+{
+    if (!s_lang_hash_frames)
+    {
+        // Замер перерисовки: только чтение заголовков, как вывод в теневой буфер
+        s_lang_sink += (uint8_t)str1[0] + (uint8_t)str2[0];
+        return;
+    }
+    s_lang_frames = bench_hash(s_lang_frames, str1, strnlen(str1, MENU_ITEM_TITLE_LEN));
+    s_lang_frames = bench_hash(s_lang_frames, "|", 1);
+    s_lang_frames = bench_hash(s_lang_frames, str2, strnlen(str2, MENU_ITEM_TITLE_LEN));
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+/**
+ * @brief Строит дерево: со строками таблицы (`strings` 1) или с заголовками языка `table` в полях.
+ */
+static int s_lang_build (const menu_string_t *table, int strings)
+{
+    for (uint32_t g = 0; g < LANG_GROUPS; g++)
+    {
+        uint32_t id = STR_GROUP_0 + g;
+        menu_item_t *group = strings ? s_menu_add_string(id, NULL, NULL, 0) : s_menu_add_item((char *)table[id], NULL, NULL, 0);
+        if (group == NULL)
+            return 0;
+
+        menu_item_t *back = strings ? s_menu_add_string(STR_BACK, group, NULL, MENU_FLAG_GOTO_PARENT)
+                                    : s_menu_add_item((char *)table[STR_BACK], group, NULL, MENU_FLAG_GOTO_PARENT);
+        if (back == NULL)
+            return 0;
+        s_menu_set_child(group, back);
+        s_lang_back[g] = back;
+
+        for (uint32_t p = 0; p < LANG_PARAMS; p++)
+        {
+            id = STR_PARAM_0 + g * LANG_PARAMS + p;
+            if ((strings ? s_menu_add_string(id, group, NULL, 0) : s_menu_add_item((char *)table[id], group, NULL, 0)) == NULL)
+                return 0;
+        }
+    }
+    s_menu_handle.current = s_menu_handle.start;
+    return 1;
+}
+
+static void s_lang_reset (void)
+{
+    const menu_string_t *strings = s_menu_handle.strings;
+
+    s_menu_free_items();
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+    s_menu_handle.strings = strings;
+}
+
+/**
+ * @brief Кадры прогона s_lang_script от корня.
+ */
+static uint64_t s_lang_play (void)
+{
+    bench_input_t input = { s_rotary_encoder_callback, s_push_button_callback, s_long_push_button_callback, 0, Menu_JumpKey };
+
+    // Энкодер и память курсора подменю от прошлого прогона сбрасываются: кадры зависят только от языка
+    memset(&s_menu_handle.rotenc, 0, sizeof(s_menu_handle.rotenc));
+    for (uint32_t g = 0; g < LANG_GROUPS; g++)
+        s_lang_back[g]->parent->child = s_lang_back[g];
+
+    s_lang_hash_frames = 1;
+    s_lang_frames      = 0;
+    s_menu_handle.current = s_menu_handle.start;
+    s_display_menu();
+    bench_play(&input, s_lang_script);
+    s_lang_hash_frames = 0;
+    return s_lang_frames;
+}
+
+static uint64_t s_lang_render_ns (void)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t round = 0; round < 5; round++)
+    {
+        uint64_t start = bench_now_ns();
+        for (uint32_t r = 0; r < s_lang_repeat; r++)
+            s_display_menu();
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < best)
+            best = ns;
+    }
+    return best;
+}
+
+/**
+ * @brief После смены языка: переход по букве, поиск и s_menu_find по заголовкам нового языка.
+ */
+static int s_lang_lookup (const menu_string_t *table)
+{
+    menu_item_t *found[2];
+    menu_item_t *frequency = s_lang_back[0]->next; // Первый параметр первой группы
+
+    s_menu_handle.current = s_lang_back[0];
+    Menu_JumpKey(table[STR_PARAM_0][0]);
+    int ok = s_menu_handle.current == frequency;
+
+    ok = ok && s_menu_find(NULL, table[STR_PARAM_0]) == frequency;
+    ok = ok && s_menu_search(table[STR_PARAM_0], MENU_SEARCH_EXACT, found, 2) >= 1 && found[0] == frequency;
+    s_menu_handle.current = s_menu_handle.start;
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            s_lang_repeat = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--repeat N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    uint64_t inline_frames[LANG_TABLES];
+    int ok = 1;
+
+    // Эталон: дерево с заголовками в полях, построенное на каждом языке
+    for (uint32_t l = 0; l < LANG_TABLES; l++)
+    {
+        ok = ok && s_lang_build(s_lang_tables[l].strings, 0);
+        inline_frames[l] = s_lang_play();
+        s_lang_reset();
+    }
+
+    // Перестроение меню на новом языке -- то, что требовалось без таблиц
+    uint64_t rebuild_ns = UINT64_MAX;
+    for (uint32_t r = 0; r < 200; r++)
+    {
+        uint64_t start = bench_now_ns();
+        s_menu_free_items();
+        memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+        s_lang_build(s_lang_tables[r % LANG_TABLES].strings, 0);
+        s_display_menu();
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < rebuild_ns)
+            rebuild_ns = ns;
+    }
+    uint64_t render_inline = s_lang_render_ns();
+    s_lang_reset();
+
+    // Дерево строк: кадры в каждом языке, поиск после смены, стоимость смены и перерисовки
+    Menu_SetLanguage(s_lang_tables[0].strings);
+    ok = ok && s_lang_build(NULL, 1);
+    int frames_match = 1;
+    int lookup = 1;
+    for (uint32_t l = 0; l < LANG_TABLES; l++)
+    {
+        Menu_SetLanguage(s_lang_tables[l].strings);
+        frames_match = frames_match && s_lang_play() == inline_frames[l];
+        lookup = lookup && s_lang_lookup(s_lang_tables[l].strings);
+    }
+
+    uint64_t start = bench_now_ns();
+    for (uint32_t r = 0; r < s_lang_repeat; r++)
+        Menu_SetLanguage(s_lang_tables[r & 1].strings);
+    uint64_t switch_ns = bench_now_ns() - start;
+    uint64_t render_strings = s_lang_render_ns();
+
+    ok = ok && frames_match && lookup && s_menu_validate(NULL) == NULL;
+    printf("{\"bench\":\"language\",\"languages\":%u,\"items\":%u,\"render_ns_inline\":%.2f,\"render_ns_strings\":%.2f,"
+           "\"switch_ns\":%.2f,\"rebuild_ns\":%llu,\"item_bytes\":%zu,\"table_bytes\":%zu,"
+           "\"frames_match\":%s,\"lookup_ok\":%s}\n",
+           (uint32_t)LANG_TABLES, LANG_GROUPS * (LANG_PARAMS + 2),
+           (double)render_inline / s_lang_repeat, (double)render_strings / s_lang_repeat,
+           (double)switch_ns / s_lang_repeat, (unsigned long long)rebuild_ns, sizeof(menu_item_t),
+           sizeof(s_lang_en), frames_match ? "true" : "false", lookup ? "true" : "false");
+
+    s_menu_free_items();
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,234 @@
+#include "bench.h"
+
+/**
+ * Отложенные подменю: время загрузки и память широкого дерева настроек.
+ *
+ * menu.c включается целиком, чтобы вызвать s_menu_add_lazy и s_menu_lazy_trim. Дерево:
+ * LAZY_GROUPS групп в корне, в каждой "Back" и LAZY_SECTIONS разделов, в каждом разделе
+ * "Back" и LAZY_PARAMS параметров. Дерево строится в трёх режимах:
+ * - `eager`    -- всё сразу, как в Menu_Init;
+ * - `lazy`     -- группы и разделы через s_menu_add_lazy, подменю строятся при первом входе;
+ * - `pressure` -- то же при ограничении кучи: при нехватке памяти s_create_new_item
+ *                освобождает неактивные подменю (s_menu_lazy_trim).
+ * В каждом режиме проигрывается один и тот же случайный скрипт (--events, --seed); хеш всех
+ * кадров должен совпасть с `eager`. Выводится время построения при загрузке, пункты и куча
+ * после загрузки, после скрипта и (для `lazy`) после s_menu_lazy_trim.
+ *
+ * Запуск: MenuLazy [--events N] [--seed S]
+ */
+#include "../menu.c"
+
+#define LAZY_GROUPS   32
+#define LAZY_SECTIONS 8
+#define LAZY_PARAMS   8
+#define LAZY_PRESSURE_GROUPS 2 ///< В режиме pressure куча вмещает загрузку и столько полных групп
+
+typedef enum {
+    LAZY_MODE_EAGER,
+    LAZY_MODE_LAZY,
+    LAZY_MODE_PRESSURE,
+} lazy_mode_t;
+
+static struct {
+    lazy_mode_t mode;
+    uint32_t    events;
+    uint32_t    seed;
+    uint64_t    frame_hash;
+    uint32_t    builds;     ///< Вызовы построителей
+} s_lazy = { LAZY_MODE_EAGER, 20000, 1, 0, 0 };
+
+void printMenu(const char *str1, const char *str2)
+{
+    s_lazy.frame_hash = bench_hash(s_lazy.frame_hash, str1, strnlen(str1, MENU_ITEM_TITLE_LEN));
+    s_lazy.frame_hash = bench_hash(s_lazy.frame_hash, "|", 1);
+    s_lazy.frame_hash = bench_hash(s_lazy.frame_hash, str2, strnlen(str2, MENU_ITEM_TITLE_LEN));
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+/**
+ * @brief Создаёт пункт с подменю: отложенный или построенный сразу, в зависимости от режима.
+ */
+static menu_item_t * s_lazy_submenu (char *title, menu_item_t *parent, menu_builder_t builder)
+{
+    if (s_lazy.mode != LAZY_MODE_EAGER)
+        return s_menu_add_lazy(title, parent, builder, 0);
+
+    menu_item_t *item = s_menu_add_item(title, parent, NULL, 0);
+    if (item)
+    {
+        builder(item);
+        s_menu_set_child(item, item->folowing);
+    }
+    return item;
+}
+
+static void s_lazy_build_section (menu_item_t *section)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+
+    s_lazy.builds++;
+    s_menu_add_item("Back", section, NULL, MENU_FLAG_GOTO_PARENT);
+    for (uint32_t i = 0; i < LAZY_PARAMS; i++)
+    {
+        snprintf(title, sizeof(title), "Param %u", i);
+        s_menu_add_item(title, section, NULL, 0);
+    }
+}
+
+static void s_lazy_build_group (menu_item_t *group)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+
+    s_lazy.builds++;
+    s_menu_add_item("Back", group, NULL, MENU_FLAG_GOTO_PARENT);
+    for (uint32_t i = 0; i < LAZY_SECTIONS; i++)
+    {
+        snprintf(title, sizeof(title), "Section %u", i);
+        s_lazy_submenu(title, group, s_lazy_build_section);
+    }
+}
+
+static void s_lazy_build (void)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+
+    for (uint32_t i = 0; i < LAZY_GROUPS; i++)
+    {
+        snprintf(title, sizeof(title), "Group %02u", i);
+        s_lazy_submenu(title, NULL, s_lazy_build_group);
+    }
+    s_menu_handle.current = s_menu_handle.start;
+}
+
+static uint32_t s_lazy_items (void)
+{
+    uint32_t items = 0;
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+        items++;
+    return items;
+}
+
+/**
+ * @brief Случайный скрипт с фиксированным зерном: одинаковый во всех режимах.
+ */
+static char *s_lazy_script (void)
+{
+    char *script = malloc(s_lazy.events + 1);
+    uint32_t state = s_lazy.seed ? s_lazy.seed : 1;
+
+    for (uint32_t i = 0; i < s_lazy.events; i++)
+    {
+        state = state * 1664525u + 1013904223u;
+        uint32_t r = (state >> 16) % 100;
+        script[i] = r < 35 ? '+' : r < 60 ? '-' : r < 85 ? '*' : '!';
+    }
+    script[s_lazy.events] = '\0';
+
+    return script;
+}
+
+static const char *s_lazy_mode_name (lazy_mode_t mode)
+{
+    return mode == LAZY_MODE_EAGER ? "eager" : mode == LAZY_MODE_LAZY ? "lazy" : "pressure";
+}
+
+/**
+ * @brief Прогон одного режима. `limit` -- ограничение кучи (0 -- без ограничения).
+ * @return Хеш кадров.
+ */
+static uint64_t s_lazy_run (lazy_mode_t mode, const char *script, uint64_t limit, uint64_t *boot_heap)
+{
+    bench_input_t input = { s_rotary_encoder_callback, s_push_button_callback, s_long_push_button_callback, 0, NULL };
+
+    s_lazy.mode       = mode;
+    s_lazy.builds     = 0;
+    s_lazy.frame_hash = 0;
+    bench_alloc_reset();
+
+    uint64_t start = bench_now_ns();
+    s_lazy_build();
+    uint64_t build_ns = bench_now_ns() - start;
+
+    uint32_t boot_items = s_lazy_items();
+    uint64_t heap       = bench_alloc_stat.bytes_current;
+    uint32_t boot_builds = s_lazy.builds;
+    if (boot_heap)
+        *boot_heap = heap;
+
+    bench_alloc_stat.bytes_limit = limit;
+    start = bench_now_ns();
+    bench_play(&input, script);
+    uint64_t play_ns = bench_now_ns() - start;
+
+    uint32_t items      = s_lazy_items();
+    uint64_t heap_after = bench_alloc_stat.bytes_current;
+
+    printf("{\"bench\":\"lazy\",\"mode\":\"%s\",\"build_ns\":%llu,\"boot_items\":%u,\"boot_heap_bytes\":%llu,"
+           "\"events\":%u,\"play_ns_per_event\":%.2f,\"builds\":%u,\"items\":%u,\"heap_bytes\":%llu,"
+           "\"heap_peak\":%llu,\"heap_limit\":%llu",
+           s_lazy_mode_name(mode), (unsigned long long)build_ns, boot_items, (unsigned long long)heap,
+           s_lazy.events, s_lazy.events ? (double)play_ns / s_lazy.events : 0.0, s_lazy.builds - boot_builds,
+           items, (unsigned long long)heap_after, (unsigned long long)bench_alloc_stat.bytes_peak,
+           (unsigned long long)limit);
+
+    if (mode == LAZY_MODE_LAZY)
+    {
+        // Освобождение неактивных подменю: остаётся только путь до курсора
+        start = bench_now_ns();
+        uint32_t released = s_menu_lazy_trim();
+        uint64_t trim_ns = bench_now_ns() - start;
+        printf(",\"trim_released\":%u,\"trim_ns\":%llu,\"trim_items\":%u,\"trim_heap_bytes\":%llu",
+               released, (unsigned long long)trim_ns, s_lazy_items(),
+               (unsigned long long)bench_alloc_stat.bytes_current);
+    }
+    printf(",\"frame_hash\":\"%016llx\"}\n", (unsigned long long)s_lazy.frame_hash);
+
+    bench_alloc_stat.bytes_limit = 0;
+    s_menu_free_items();
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+
+    return s_lazy.frame_hash;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+        {
+            s_lazy.events = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_lazy.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--events N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    char *script = s_lazy_script();
+    uint64_t boot_heap = 0;
+
+    uint64_t eager = s_lazy_run(LAZY_MODE_EAGER, script, 0, NULL);
+    uint64_t lazy  = s_lazy_run(LAZY_MODE_LAZY,  script, 0, &boot_heap);
+
+    // Группа целиком: сама группа не считается (она в корне), разделы и их параметры
+    uint64_t group_bytes = (uint64_t)(1 + LAZY_SECTIONS + LAZY_SECTIONS * (1 + LAZY_PARAMS)) * sizeof(menu_item_t);
+    uint64_t pressure = s_lazy_run(LAZY_MODE_PRESSURE, script, boot_heap + LAZY_PRESSURE_GROUPS * group_bytes, NULL);
+
+    free(script);
+
+    int ok = lazy == eager && pressure == eager;
+    printf("{\"bench\":\"lazy\",\"frames_match\":%s}\n", ok ? "true" : "false");
+
+    return ok ? 0 : 1;
+}
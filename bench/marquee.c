@@ -0,0 +1,273 @@
+#include "bench.h"
+#include "lcd1602.h"
+
+/**
+ * Бегущая строка длинных заголовков: трафик шины и время процессора на секунду прокрутки.
+ *
+ * menu.c включается целиком с MENU_MARQUEE_TITLES, printMenu выводит кадр через драйвер
+ * lcd1602.c на счётную шину. Кольцо: короткие пункты и пункты с длинными заголовками
+ * (s_menu_add_long). Выбирается пункт с длинным заголовком, и планировщик таймера вызывает
+ * Menu_Tick каждые MARQUEE_TICK_MS мс в течение `--seconds` секунд.
+ *
+ * Для каждой стратегии перерисовки драйвера выводятся команды, байты данных и время шины на
+ * секунду прокрутки (оценки `gpio_us` и `i2c_us` -- как в MenuBus). Для сравнения считается
+ * прокрутка командой сдвига дисплея HD44780 (`shift`): сдвигаются обе строки, поэтому на шаг
+ * переписываются маркер выбора и вторая строка по новым адресам.
+ *
+ * Время процессора: наносекунды на Menu_Tick, когда выбран короткий пункт, когда шаг ещё не
+ * наступил и на шаг с перерисовкой; итог -- микросекунды на секунду прокрутки. Проверки:
+ * первая строка каждого кадра -- "> " и MENU_MARQUEE_WIDTH знаков текста с ожидаемым смещением,
+ * вторая строка не перерисовывается, число шагов совпадает с расчётным.
+ *
+ * Запуск: MenuMarquee [--seconds N]
+ */
+#include "../menu.c"
+
+#define MARQUEE_TICK_MS     10
+#define MARQUEE_GPIO_BYTE_US 2
+#define MARQUEE_I2C_BYTE_US  460
+
+static const char *s_marquee_long = "Output frequency of PWM generator";
+static const char *s_marquee_other = "Temperature sensor calibration";
+
+static uint32_t s_marquee_prints;     ///< Кадров с первой строкой бегущего заголовка
+static uint32_t s_marquee_offset;     ///< Смещение последнего выведенного кадра
+static int      s_marquee_bad;        ///< Кадр не совпал с ожидаемым
+static int      s_marquee_check;      ///< Проверять кадры
+
+static void s_marquee_write (uint8_t value, uint8_t rs)
+{
+    (void)value;
+    (void)rs;
+}
+
+void printMenu(const char *str1, const char *str2)
+{
+    if (s_marquee_check && str1 >= s_marquee_long && str1 < s_marquee_long + strlen(s_marquee_long))
+    {
+        // Смещения идут 1, 2, ..., последнее, 0, 1, ...: строка возвращается к началу после паузы
+        uint32_t offset = (uint32_t)(str1 - s_marquee_long);
+        uint32_t last   = (uint32_t)strlen(s_marquee_long) - MENU_MARQUEE_WIDTH;
+        uint32_t expect = s_marquee_prints == 0 ? 1 : (s_marquee_offset == last ? 0 : s_marquee_offset + 1);
+        lcd1602_frame_t frame;
+        char row[LCD1602_COLS + 1];
+
+        lcd1602_compose(frame, str1, str2);
+        snprintf(row, sizeof(row), "> %.*s", MENU_MARQUEE_WIDTH, s_marquee_long + expect);
+        if (offset != expect || strcmp(frame[0], row) != 0)
+            s_marquee_bad = 1;
+        s_marquee_offset = offset;
+        s_marquee_prints++;
+    }
+    lcd1602_print_menu(str1, str2);
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static menu_item_t *s_marquee_item;  ///< Пункт с бегущим заголовком
+static menu_item_t *s_marquee_short; ///< Короткий пункт
+
+static void s_marquee_build (void)
+{
+    s_marquee_short = s_menu_add_item("Status", NULL, NULL, 0);
+    s_marquee_item  = s_menu_add_long(s_marquee_long, NULL, NULL, 0);
+    s_menu_add_long(s_marquee_other, NULL, NULL, 0);
+    s_menu_add_item("Exit", NULL, NULL, 0);
+}
+
+/**
+ * @brief Выбирает пункт и выводит кадр (вне учёта трафика).
+ */
+static void s_marquee_select (menu_item_t *item)
+{
+    s_menu_handle.current = item;
+    s_display_menu();
+}
+
+#define MARQUEE_DDRAM_ROW 40 ///< Ячеек DDRAM в строке HD44780
+
+static char    s_marquee_ddram[LCD1602_ROWS][MARQUEE_DDRAM_ROW]; ///< Модель DDRAM для прокрутки сдвигом
+static uint8_t s_marquee_address;                                ///< Счётчик адреса модели
+
+/**
+ * @brief Записывает знак в ячейку DDRAM, если он там ещё не стоит (адрес -- только при разрыве).
+ */
+static void s_marquee_put (uint32_t row, uint32_t cell, char c)
+{
+    uint8_t address = (uint8_t)((row ? LCD1602_ROW1_ADDR : 0) + cell);
+
+    if (s_marquee_ddram[row][cell] == c)
+        return;
+    if (s_marquee_address != address)
+        lcd1602_command(LCD1602_CMD_SET_DDRAM | address);
+    lcd1602_data((uint8_t)c);
+    s_marquee_ddram[row][cell] = c;
+    s_marquee_address = address + 1;
+}
+
+/**
+ * @brief Прокрутка командой сдвига дисплея. Текст пишется в DDRAM один раз, на шаг -- сдвиг влево
+ *        и ячейки видимого окна, которые отличаются от нужных: маркер "> " и вторая строка
+ *        сдвинулись вместе с текстом. Возврат к началу -- HOME (медленная команда) и
+ *        восстановление затёртого маркером текста.
+ */
+static void s_marquee_shift (uint32_t steps, uint32_t last, const char *next)
+{
+    char     row0[MARQUEE_DDRAM_ROW];
+    char     row1[LCD1602_COLS];
+    uint32_t shift = 0;
+
+    memset(row0, ' ', sizeof(row0));
+    memcpy(row0 + 2, s_marquee_long, strlen(s_marquee_long));
+    memset(row1, ' ', sizeof(row1));
+    memcpy(row1, next, strnlen(next, LCD1602_COLS));
+
+    // Начальное состояние DDRAM, как после вывода первого кадра
+    memset(s_marquee_ddram, ' ', sizeof(s_marquee_ddram));
+    memcpy(s_marquee_ddram[0] + 2, s_marquee_long, strlen(s_marquee_long));
+    s_marquee_ddram[0][0] = '>';
+    memcpy(s_marquee_ddram[1], row1, sizeof(row1));
+    s_marquee_address = 0xFF;
+
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        if (shift < last)
+        {
+            shift++;
+            lcd1602_command(LCD1602_CMD_SHIFT | 0x08);
+        }
+        else
+        {
+            shift = 0;
+            lcd1602_command(LCD1602_CMD_HOME);
+            s_marquee_address = 0;
+        }
+
+        for (uint32_t k = 0; k < LCD1602_COLS; k++)
+            s_marquee_put(0, shift + k, k < 2 ? "> "[k] : row0[shift + k]);
+        for (uint32_t k = 0; k < LCD1602_COLS; k++)
+            s_marquee_put(1, shift + k, row1[k]);
+    }
+}
+
+static const char *s_render_names[LCD1602_RENDER_COUNT] = { "clear", "rewrite", "diff" };
+
+static void s_marquee_report (const char *mode, uint32_t seconds, uint32_t steps)
+{
+    const lcd1602_stat_t *stat = lcd1602_stat();
+    uint32_t bytes   = stat->commands + stat->data;
+    double   gpio_us = (double)stat->exec_us + (double)bytes * MARQUEE_GPIO_BYTE_US;
+    double   i2c_us  = (double)bytes * MARQUEE_I2C_BYTE_US + (double)stat->slow_commands * LCD1602_EXEC_SLOW_US;
+
+    printf("{\"bench\":\"marquee\",\"render\":\"%s\",\"seconds\":%u,\"steps\":%u,"
+           "\"commands_per_s\":%.1f,\"data_per_s\":%.1f,\"bytes_per_step\":%.2f,"
+           "\"gpio_us_per_s\":%.0f,\"i2c_us_per_s\":%.0f}\n",
+           mode, seconds, steps, (double)stat->commands / seconds, (double)stat->data / seconds,
+           steps ? (double)bytes / steps : 0.0, gpio_us / seconds, i2c_us / seconds);
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t seconds = 60;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc)
+        {
+            seconds = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--seconds N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (seconds == 0)
+        seconds = 1;
+
+    s_marquee_build();
+
+    uint32_t last    = (uint32_t)strlen(s_marquee_long) - MENU_MARQUEE_WIDTH;
+    uint32_t ticks   = seconds * 1000 / MARQUEE_TICK_MS;
+    // Первый вызов задаёт срок, дальше шаг каждые MENU_MARQUEE_STEP_MS; цикл -- пауза, сдвиги, пауза, возврат
+    uint32_t steps   = (ticks - 1) * MARQUEE_TICK_MS / MENU_MARQUEE_STEP_MS;
+    uint32_t period  = last + 1 + 2 * MENU_MARQUEE_HOLD;
+    uint32_t expect  = 0;
+    for (uint32_t step = 0; step < steps; step++)
+    {
+        uint32_t phase = (step + period - MENU_MARQUEE_HOLD) % period; // 0 -- первый сдвиг
+        if (phase < last || phase == last + MENU_MARQUEE_HOLD)
+            expect++;
+    }
+
+    int ok = 1;
+    for (uint32_t render = 0; render < LCD1602_RENDER_COUNT; render++)
+    {
+        lcd1602_init(s_marquee_write, render);
+        s_marquee_select(s_marquee_short); // Строка начинается заново при каждом выборе пункта
+        s_marquee_select(s_marquee_item);
+
+        s_marquee_check  = 1;
+        s_marquee_prints = 0;
+        s_marquee_bad    = 0;
+        lcd1602_stat_reset();
+        for (uint32_t t = 0; t < ticks; t++)
+            Menu_Tick(t * MARQUEE_TICK_MS);
+        s_marquee_check  = 0;
+
+        ok = ok && !s_marquee_bad && s_marquee_prints == expect;
+        s_marquee_report(s_render_names[render], seconds, s_marquee_prints);
+
+        // Со стратегией diff вторая строка на шину не попадает: только знаки первой строки
+        if (render == LCD1602_RENDER_DIFF)
+            ok = ok && lcd1602_stat()->data <= s_marquee_prints * (LCD1602_COLS - 2);
+    }
+
+    lcd1602_stat_reset();
+    s_marquee_shift(expect, last, s_menu_title(s_marquee_item->next));
+    s_marquee_report("shift", seconds, expect);
+
+    // Время процессора: строка стоит (короткий пункт), шаг не наступил, прокрутка целиком (шина -- пустая функция)
+    lcd1602_init(s_marquee_write, LCD1602_RENDER_DIFF);
+    s_marquee_select(s_marquee_short);
+    uint64_t start = bench_now_ns();
+    for (uint32_t t = 0; t < ticks * 100; t++)
+        Menu_Tick(t);
+    double idle_ns = (double)(bench_now_ns() - start) / (ticks * 100.0);
+
+    s_marquee_select(s_marquee_item);
+    Menu_Tick(0);
+    start = bench_now_ns();
+    for (uint32_t t = 0; t < ticks * 100; t++)
+        Menu_Tick(t % MENU_MARQUEE_STEP_MS); // Срок -- MENU_MARQUEE_STEP_MS: не наступает
+    double wait_ns = (double)(bench_now_ns() - start) / (ticks * 100.0);
+
+    uint64_t scroll_ns = UINT64_MAX;
+    for (uint32_t round = 0; round < 20; round++)
+    {
+        s_marquee_select(s_marquee_short);
+        s_marquee_select(s_marquee_item);
+        start = bench_now_ns();
+        for (uint32_t t = 0; t < ticks; t++)
+            Menu_Tick(t * MARQUEE_TICK_MS);
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < scroll_ns)
+            scroll_ns = ns;
+    }
+    double step_ns = expect ? ((double)scroll_ns - (double)(ticks - expect) * wait_ns) / expect : 0.0;
+    double cpu_us  = (double)scroll_ns / 1000.0 / seconds;
+
+    printf("{\"bench\":\"marquee\",\"title_len\":%zu,\"width\":%u,\"step_ms\":%u,\"tick_ms\":%u,"
+           "\"tick_idle_ns\":%.2f,\"tick_wait_ns\":%.2f,\"tick_step_ns\":%.1f,\"cpu_us_per_s\":%.2f,"
+           "\"item_bytes\":%zu,\"frames_ok\":%s}\n",
+           strlen(s_marquee_long), (uint32_t)MENU_MARQUEE_WIDTH, (uint32_t)MENU_MARQUEE_STEP_MS, (uint32_t)MARQUEE_TICK_MS,
+           idle_ns, wait_ns, step_ns, cpu_us, sizeof(menu_item_t), ok ? "true" : "false");
+
+    s_menu_free_items();
+    return ok ? 0 : 1;
+}
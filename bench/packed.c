@@ -0,0 +1,268 @@
+#include "bench.h"
+
+/**
+ * Сжатая таблица строк языка (Menu_SetLanguagePacked): степень сжатия и скорость распаковки.
+ *
+ * menu.c включается целиком с MENU_STRINGS=4096 и MENU_STRINGS_PACKED=1, обучение словаря --
+ * из tools/title_pack.c (как MenuTitlePack). Таблица -- PACKED_TITLES заголовков параметров
+ * ("Motor 12 Speed", "Channel 7 Offset"): сочетания групп, номеров и параметров, как в меню
+ * настройки оборудования. Дерево: группа на каждые PACKED_RING строк, в группе -- пункты строк.
+ *
+ * JSON-строка: байт ПЗУ у таблицы menu_string_t (16 байт на строку), у строк C подряд и у сжатой
+ * таблицы (коды, смещения, словарь), степени сжатия, время обучения; наносекунды на распаковку
+ * заголовка и МБ/с распакованного текста; наносекунды на перерисовку при повороте с обычной и
+ * со сжатой таблицей и распаковок на кадр. Проверки: каждая строка распаковывается в исходную,
+ * кадры прогона по кольцу и случайных переходов по нему с обеими таблицами совпадают, поиск
+ * находит пункт по заголовку.
+ *
+ * Запуск: MenuPacked [--repeat N] [--tokens N]
+ */
+#include "../menu.c"
+
+#define TITLE_PACK_LIBRARY
+#include "../tools/title_pack.c"
+
+#define PACKED_GROUPS  12
+#define PACKED_INDEXES 20
+#define PACKED_PARAMS  17
+#define PACKED_TITLES  (PACKED_GROUPS * PACKED_INDEXES * PACKED_PARAMS)
+#define PACKED_RING    40
+
+_Static_assert(PACKED_TITLES <= MENU_STRINGS, "MENU_STRINGS is too small for the bench table");
+
+static const char *s_packed_groups[PACKED_GROUPS] = {
+    "Motor", "Pump", "Fan", "Heater", "Valve", "Sensor", "Channel", "Input", "Output", "Alarm", "Relay", "Zone",
+};
+
+static const char *s_packed_params[PACKED_PARAMS] = {
+    "Speed", "Current", "Voltage", "Temp", "Delay", "Mode", "Limit", "Offset", "Gain",
+    "Filter", "State", "Enable", "Min", "Max", "Setpoint", "Timeout", "Hyst",
+};
+
+static menu_string_t s_packed_table[MENU_STRINGS]; ///< Обычная таблица: эталон и сравнение
+static uint32_t s_packed_repeat = 200;
+static uint64_t s_packed_frames;
+static int      s_packed_hash;
+static volatile uint32_t s_packed_sink;
+
+void printMenu(const char *str1, const char *str2)
+{
+    if (!s_packed_hash)
+    {
+        s_packed_sink += (uint8_t)str1[0] + (uint8_t)str2[0];
+        return;
+    }
+    s_packed_frames = bench_hash(s_packed_frames, str1, strnlen(str1, MENU_ITEM_TITLE_LEN));
+    s_packed_frames = bench_hash(s_packed_frames, "|", 1);
+    s_packed_frames = bench_hash(s_packed_frames, str2, strnlen(str2, MENU_ITEM_TITLE_LEN));
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+/**
+ * @brief Поворот по кольцу `ring` на `steps` шагов: наносекунды на кадр (лучший из 5 прогонов).
+ */
+static double s_packed_rotate_ns (menu_item_t *ring, uint32_t steps)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t round = 0; round < 5; round++)
+    {
+        s_menu_handle.current = ring;
+        uint64_t start = bench_now_ns();
+        for (uint32_t r = 0; r < steps; r++)
+        {
+            s_menu_handle.current = s_menu_handle.current->next;
+            s_display_menu();
+        }
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < best)
+            best = ns;
+    }
+    return (double)best / steps;
+}
+
+/**
+ * @brief Хеш кадров случайных переходов по кольцу `ring` (как Menu_JumpKey): текущий пункт
+ *        берётся из кэша давно, и распаковка следующего не должна вытеснить его строку.
+ */
+static uint64_t s_packed_jumps (menu_item_t *ring)
+{
+    uint32_t seed = 12345;
+
+    s_packed_hash   = 1;
+    s_packed_frames = 0;
+    s_menu_handle.current = ring;
+    for (uint32_t r = 0; r < 4 * PACKED_RING; r++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        for (uint32_t step = (seed >> 16) % PACKED_RING; step; step--)
+            s_menu_handle.current = s_menu_handle.current->next;
+        s_display_menu();
+    }
+    s_packed_hash = 0;
+    return s_packed_frames;
+}
+
+/**
+ * @brief Хеш кадров полного круга по кольцу `ring` и обратно.
+ */
+static uint64_t s_packed_play (menu_item_t *ring)
+{
+    s_packed_hash   = 1;
+    s_packed_frames = 0;
+    s_menu_handle.current = ring;
+    s_display_menu();
+    for (uint32_t r = 0; r < PACKED_RING; r++)
+    {
+        s_menu_handle.current = s_menu_handle.current->next;
+        s_display_menu();
+    }
+    for (uint32_t r = 0; r < PACKED_RING; r++)
+    {
+        s_menu_handle.current = s_menu_handle.current->prev;
+        s_display_menu();
+    }
+    s_packed_hash = 0;
+    return s_packed_frames;
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t tokens = MENU_PACKED_TOKENS;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            s_packed_repeat = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--tokens") == 0 && i + 1 < argc)
+        {
+            tokens = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--repeat N] [--tokens N]\n", argv[0]);
+            return 1;
+        }
+    }
+    if (s_packed_repeat == 0)
+        s_packed_repeat = 1;
+
+    // Заголовки: группа, номер, параметр (обрезаются до MENU_ITEM_TITLE_LEN байт, как поле пункта)
+    static const char *titles[PACKED_TITLES];
+    uint64_t raw = 0;
+    for (uint32_t i = 0; i < PACKED_TITLES; i++)
+    {
+        char title[64];
+        snprintf(title, sizeof(title), "%s %u %s", s_packed_groups[i / (PACKED_INDEXES * PACKED_PARAMS)],
+                 i / PACKED_PARAMS % PACKED_INDEXES + 1, s_packed_params[i % PACKED_PARAMS]);
+        s_menu_copy_title(s_packed_table[i], title);
+        titles[i] = s_packed_table[i];
+        raw += strnlen(title, MENU_ITEM_TITLE_LEN) + 1;
+    }
+
+    title_pack_t  pack;
+    menu_packed_t packed;
+    uint64_t start = bench_now_ns();
+    if (title_pack_train(&pack, titles, PACKED_TITLES, tokens) != 0)
+    {
+        fprintf(stderr, "packed: title_pack_train failed\n");
+        return 1;
+    }
+    double train_ms = (double)(bench_now_ns() - start) / 1e6;
+    title_pack_view(&pack, &packed);
+
+    // Каждая строка распаковывается в исходную (с нулями до конца поля)
+    int ok = 1;
+    Menu_SetLanguagePacked(&packed);
+    for (uint32_t i = 0; i < PACKED_TITLES; i++)
+        ok = ok && memcmp(s_menu_unpack(i), s_packed_table[i], MENU_ITEM_TITLE_LEN) == 0;
+
+    // Распаковка подряд: каждый заголовок -- промах кэша
+    uint64_t best = UINT64_MAX;
+    for (uint32_t round = 0; round < s_packed_repeat; round++)
+    {
+        for (uint32_t i = 0; i < MENU_PACKED_LINES; i++)
+            s_menu_unpack_lines[i].string = MENU_STRING_NONE;
+        start = bench_now_ns();
+        for (uint32_t i = 0; i < PACKED_TITLES; i++)
+            s_packed_sink += (uint8_t)s_menu_unpack(i)[MENU_ITEM_TITLE_LEN - 1];
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < best)
+            best = ns;
+    }
+    double decode_ns = (double)best / PACKED_TITLES;
+    double decode_mbs = (double)(raw - PACKED_TITLES) * 1e3 / (double)best;
+
+    // Дерево: группы по PACKED_RING пунктов строк
+    Menu_SetLanguage(s_packed_table);
+    menu_item_t *ring = NULL;
+    for (uint32_t g = 0; g * PACKED_RING < PACKED_TITLES && ok; g++)
+    {
+        char group[MENU_ITEM_TITLE_LEN];
+        snprintf(group, sizeof(group), "Page %u", g + 1);
+        menu_item_t *node = s_menu_add_item(group, NULL, NULL, 0);
+        for (uint32_t i = g * PACKED_RING; i < (g + 1) * PACKED_RING && i < PACKED_TITLES; i++)
+        {
+            menu_item_t *item = s_menu_add_string(i, node, NULL, 0);
+            if (item == NULL)
+                ok = 0;
+            else if (node->child == NULL)
+                s_menu_set_child(node, item);
+        }
+        if (g == 3)
+            ring = node->child;
+    }
+    ok = ok && ring != NULL;
+
+    uint32_t steps = s_packed_repeat * 1000;
+    uint64_t plain_frames = ok ? s_packed_play(ring) : 0;
+    uint64_t plain_jumps  = ok ? s_packed_jumps(ring) : 0;
+    double   plain_ns     = ok ? s_packed_rotate_ns(ring, steps) : 0.0;
+
+    Menu_SetLanguagePacked(&packed);
+    uint64_t packed_frames = ok ? s_packed_play(ring) : 0;
+    uint64_t packed_jumps  = ok ? s_packed_jumps(ring) : 0;
+    double   packed_ns     = ok ? s_packed_rotate_ns(ring, steps) : 0.0;
+
+    // Распаковок на кадр при повороте: шаг курсора кэша
+    uint32_t decodes = 0;
+    s_menu_handle.current = ring;
+    s_display_menu();
+    for (uint32_t r = 0; r < PACKED_RING && ok; r++)
+    {
+        uint32_t before = s_menu_handle.unpack_next;
+        s_menu_handle.current = s_menu_handle.current->next;
+        s_display_menu();
+        decodes += (s_menu_handle.unpack_next + MENU_PACKED_LINES - before) % MENU_PACKED_LINES;
+    }
+
+    // Поиск по распакованным заголовкам
+    menu_item_t *found[2];
+    int search_ok = ok && s_menu_search(s_packed_table[ring->string], MENU_SEARCH_EXACT, found, 2) == 1 && found[0] == ring;
+
+    ok = ok && plain_frames == packed_frames && plain_jumps == packed_jumps && search_ok;
+
+    uint32_t table_bytes  = PACKED_TITLES * MENU_ITEM_TITLE_LEN;
+    uint32_t packed_bytes = title_pack_bytes(&pack);
+    printf("{\"bench\":\"packed\",\"titles\":%u,\"tokens\":%u,\"table_bytes\":%u,\"strings_bytes\":%llu,"
+           "\"packed_bytes\":%u,\"codes_bytes\":%u,\"ratio_table\":%.2f,\"ratio_strings\":%.2f,\"train_ms\":%.1f,"
+           "\"decode_ns\":%.2f,\"decode_mb_s\":%.1f,\"render_ns_table\":%.2f,\"render_ns_packed\":%.2f,"
+           "\"decodes_per_frame\":%.2f,\"frames_match\":%s,\"jumps_match\":%s,\"search_ok\":%s}\n",
+           (uint32_t)PACKED_TITLES, pack.token_count, table_bytes, (unsigned long long)raw, packed_bytes, pack.code_bytes,
+           (double)table_bytes / packed_bytes, (double)raw / packed_bytes, train_ms, decode_ns, decode_mbs,
+           plain_ns, packed_ns, (double)decodes / PACKED_RING,
+           plain_frames == packed_frames ? "true" : "false", plain_jumps == packed_jumps ? "true" : "false",
+           search_ok ? "true" : "false");
+
+    s_menu_free_items();
+    title_pack_free(&pack);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,216 @@
+#include "bench.h"
+
+/**
+ * Позиция в кольце и память курсора подменю.
+ *
+ * menu.c включается целиком. Для каждой длины строится корневое кольцо из пунктов и
+ * подменю "Sub" из стольких же пунктов. Прогоны:
+ * - шаги энкодера (--steps, на длинных кольцах -- меньше), после каждого Menu_Position
+ *   сверяется с эталоном, найденным обходом кольца; затем --steps вызовов Menu_Position
+ *   замеряются без проверок, для сравнения -- подсчёт позиции обходом кольца;
+ * - скрытие и показ случайных пунктов (фиксированное зерно) с проверкой позиций после каждого;
+ * - вход в подменю, --steps / 8 случайных шагов, выход длинным нажатием и повторный вход:
+ *   курсор должен вернуться на тот же пункт.
+ *
+ * JSON-строка на длину: наносекунды на Menu_Position, на подсчёт обходом, на скрытие/показ и на
+ * первый Menu_Position после него (перенумерация кольца).
+ *
+ * Цель собирается с MENU_POSITION_INDICATOR=1.
+ *
+ * Запуск: MenuPosition [--steps N] [--seed S]
+ */
+#include "../menu.c"
+
+static const uint32_t s_position_counts[] = { 16, 256, 4096 };
+
+static uint32_t s_position_steps = 100000;
+static uint32_t s_position_seed  = 1;
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static uint32_t s_position_random (uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 16;
+}
+
+/**
+ * @brief Эталон: позиция текущего пункта обходом кольца назад до `items[0]` (он не скрывается).
+ */
+static uint32_t s_position_walk (menu_item_t **items, uint32_t *count)
+{
+    const menu_item_t *current = s_menu_handle.current;
+    uint32_t position = 0;
+    uint32_t total    = 0;
+
+    for (const menu_item_t *walk = current; ; walk = walk->next)
+    {
+        total++;
+        if (walk->next == current)
+            break;
+    }
+
+    for (const menu_item_t *walk = current; ; walk = walk->prev)
+    {
+        position++;
+        if (walk == items[0])
+            break;
+    }
+
+    *count = total;
+    return position;
+}
+
+static int s_position_check (menu_item_t **items, const char *what)
+{
+    uint32_t count    = 0;
+    uint32_t expected = 0;
+    uint32_t position = Menu_Position(&count);
+    uint32_t position_expected = s_position_walk(items, &expected);
+
+    if (position != position_expected || count != expected)
+    {
+        fprintf(stderr, "position: %s at '%.16s': %u/%u, expected %u/%u\n", what,
+                s_menu_handle.current->title, position, count, position_expected, expected);
+        return 0;
+    }
+    return 1;
+}
+
+static int s_position_run (uint32_t count)
+{
+    menu_item_t **items    = malloc(count * sizeof(menu_item_t *));
+    menu_item_t **children = malloc(count * sizeof(menu_item_t *));
+    char title[MENU_ITEM_TITLE_LEN + 1];
+    int ok = items != NULL && children != NULL;
+
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        snprintf(title, sizeof(title), i == 0 ? "Sub" : "Item %u", i);
+        items[i] = s_menu_add_item(title, NULL, NULL, 0);
+        ok = items[i] != NULL;
+    }
+    for (uint32_t i = 0; ok && i < count; i++)
+    {
+        snprintf(title, sizeof(title), "Child %u", i);
+        children[i] = s_menu_add_item(title, items[0], NULL, 0);
+        ok = children[i] != NULL;
+    }
+    if (!ok)
+    {
+        fprintf(stderr, "position: failed to build %u items\n", count);
+        free(items);
+        free(children);
+        return 0;
+    }
+    s_menu_set_child(items[0], children[0]);
+
+    // Шаги энкодера с проверкой позиции; проверка обходит кольцо, поэтому на длинных кольцах шагов меньше
+    uint32_t walks   = s_position_steps / (count / 16 + 1) + 1;
+    uint32_t state   = s_position_seed ? s_position_seed : 1;
+    uint32_t encoder = 0;
+    s_menu_handle.current = items[0];
+    for (uint32_t i = 0; ok && i < walks; i++)
+    {
+        encoder += (s_position_random(&state) & 1) ? ENCODER_INPUT_FILTER : -ENCODER_INPUT_FILTER;
+        s_rotary_encoder_callback(encoder);
+        ok = s_position_check(items, "step");
+    }
+
+    // Замер: Menu_Position и подсчёт обходом
+    volatile uint32_t sink = 0;
+    uint32_t total = 0;
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < s_position_steps; i++)
+        sink += Menu_Position(&total);
+    uint64_t position_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < walks; i++)
+        sink += s_position_walk(items, &total);
+    uint64_t walk_ns = bench_now_ns() - start;
+
+    // Скрытие и показ: O(1), кольцо перенумеровывает следующий Menu_Position
+    uint32_t toggles = count < 1024 ? count : 1024;
+    uint64_t toggle_ns   = 0;
+    uint64_t renumber_ns = 0;
+    for (uint32_t i = 0; ok && i < toggles; i++)
+    {
+        menu_item_t *item = items[1 + s_position_random(&state) % (count - 1)];
+        start = bench_now_ns();
+        s_menu_set_visible(item, (item->flags & MENU_FLAG_HIDDEN) != 0);
+        toggle_ns += bench_now_ns() - start;
+        start = bench_now_ns();
+        sink += Menu_Position(&total);
+        renumber_ns += bench_now_ns() - start;
+        ok = s_position_check(items, "toggle");
+    }
+
+    // Память курсора: вход, шаги, выход и повторный вход
+    for (uint32_t i = 0; ok && i < 8; i++)
+    {
+        s_menu_handle.current = items[0];
+        s_push_button_callback();
+        for (uint32_t j = s_position_random(&state) % (s_position_steps / 8 + 1); j > 0; j--)
+        {
+            encoder += ENCODER_INPUT_FILTER;
+            s_rotary_encoder_callback(encoder);
+        }
+        menu_item_t *left = s_menu_handle.current;
+        s_long_push_button_callback();
+        s_push_button_callback();
+        ok = s_menu_handle.current == left && s_position_check(children, "resume");
+    }
+
+    printf("{\"bench\":\"position\",\"items\":%u,\"steps\":%u,\"ns_per_position\":%.2f,\"ns_per_walk\":%.2f,"
+           "\"ns_per_toggle\":%.2f,\"ns_per_renumber\":%.2f,\"ok\":%s}\n",
+           count, s_position_steps, s_position_steps ? (double)position_ns / s_position_steps : 0.0,
+           (double)walk_ns / walks, toggles ? (double)toggle_ns / toggles : 0.0,
+           toggles ? (double)renumber_ns / toggles : 0.0, ok ? "true" : "false");
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_free_items();
+#endif
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+    free(items);
+    free(children);
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+        {
+            s_position_steps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_position_seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--steps N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    for (uint32_t i = 0; i < sizeof(s_position_counts) / sizeof(s_position_counts[0]); i++)
+        failed += !s_position_run(s_position_counts[i]);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,225 @@
+#include "bench.h"
+
+/**
+ * Условия видимости: кэш результатов и пересчёт только зависимых условий.
+ *
+ * menu.c включается целиком, чтобы вызвать s_menu_add_predicate и s_menu_set_value. Корневое
+ * кольцо: PREDICATE_SWITCHES переключателей и PREDICATE_ITEMS пунктов; пункт i виден, пока
+ * включён переключатель i % PREDICATE_SWITCHES, и зависит только от него. Прогоны:
+ * - `steps`  -- --steps шагов энкодера: условия не вычисляются;
+ * - `switch` -- --changes переключений случайного переключателя: вычисляются только его
+ *              условия, кольцо сверяется с эталоном после каждого переключения;
+ * - `batch`  -- все переключатели в одном пакете (s_menu_value_begin/end): одна перерисовка;
+ * - `naive`  -- для сравнения: вычисление всех условий на каждую перерисовку.
+ *
+ * JSON-строка на прогон: вычисления условий и перерисовки на операцию, наносекунды на операцию.
+ *
+ * Запуск: MenuPredicate [--steps N] [--changes N] [--seed S]
+ */
+#include "../menu.c"
+
+#define PREDICATE_SWITCHES 16
+#define PREDICATE_ITEMS    1000
+
+static struct {
+    uint32_t     steps;
+    uint32_t     changes;
+    uint32_t     seed;
+    uint64_t     evals;   ///< Вызовы условий
+    uint64_t     redraws; ///< Вызовы printMenu
+    menu_item_t *switches[PREDICATE_SWITCHES];
+    menu_item_t *items[PREDICATE_ITEMS];
+} s_pred = { 100000, 10000, 1, 0, 0, { NULL }, { NULL } };
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+    s_pred.redraws++;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static uint32_t s_pred_random (uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 16;
+}
+
+/**
+ * @brief Условие пункта: включён его переключатель (номер пункта -- в `data`).
+ */
+static int s_pred_switch_on (const menu_item_t *item)
+{
+    s_pred.evals++;
+    return s_pred.switches[item->data % PREDICATE_SWITCHES]->data != 0;
+}
+
+/**
+ * @brief Сверяет кольцо с эталоном: переключатели и пункты включённых переключателей в порядке создания.
+ */
+static int s_pred_ring_ok (void)
+{
+    menu_item_t *walk = s_pred.switches[0];
+
+    for (uint32_t i = 0; i < PREDICATE_SWITCHES; i++, walk = walk->next)
+    {
+        if (walk != s_pred.switches[i])
+            return 0;
+    }
+
+    for (uint32_t i = 0; i < PREDICATE_ITEMS; i++)
+    {
+        menu_item_t *item = s_pred.items[i];
+        int visible = !(item->flags & MENU_FLAG_HIDDEN);
+
+        if (visible != (s_pred.switches[i % PREDICATE_SWITCHES]->data != 0))
+            return 0;
+        if (visible)
+        {
+            if (walk != item)
+                return 0;
+            walk = walk->next;
+        }
+    }
+
+    return walk == s_pred.switches[0];
+}
+
+static void s_pred_print (const char *name, uint32_t ops, uint64_t evals, uint64_t redraws, uint64_t ns, int ok)
+{
+    printf("{\"bench\":\"predicate\",\"case\":\"%s\",\"switches\":%u,\"items\":%u,\"ops\":%u,\"evals_per_op\":%.2f,"
+           "\"redraws_per_op\":%.2f,\"ns_per_op\":%.2f,\"ok\":%s}\n",
+           name, PREDICATE_SWITCHES, PREDICATE_ITEMS, ops, ops ? (double)evals / ops : 0.0,
+           ops ? (double)redraws / ops : 0.0, ops ? (double)ns / ops : 0.0, ok ? "true" : "false");
+}
+
+int main(int argc, char *argv[])
+{
+    char title[MENU_ITEM_TITLE_LEN];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+        {
+            s_pred.steps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--changes") == 0 && i + 1 < argc)
+        {
+            s_pred.changes = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_pred.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--steps N] [--changes N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < PREDICATE_SWITCHES; i++)
+    {
+        snprintf(title, sizeof(title), "Switch %u", i);
+        s_pred.switches[i] = s_menu_add_item(title, NULL, NULL, 0);
+        if (s_pred.switches[i] == NULL)
+            return 1;
+        s_pred.switches[i]->data = i & 1;
+    }
+
+    for (uint32_t i = 0; i < PREDICATE_ITEMS; i++)
+    {
+        snprintf(title, sizeof(title), "Item %u", i);
+        s_pred.items[i] = s_menu_add_item(title, NULL, NULL, 0);
+        if (s_pred.items[i] == NULL)
+            return 1;
+        s_pred.items[i]->data = i;
+        if (s_menu_add_predicate(s_pred.items[i], s_pred_switch_on, &s_pred.switches[i % PREDICATE_SWITCHES], 1) == NULL)
+        {
+            fprintf(stderr, "predicate: out of predicate records at item %u\n", i);
+            return 1;
+        }
+    }
+
+    s_menu_handle.current = s_pred.switches[0];
+    int failed = !s_pred_ring_ok();
+
+    // Шаги энкодера: только переходы по кольцу, условия не вычисляются
+    uint64_t evals   = s_pred.evals;
+    uint64_t redraws = s_pred.redraws;
+    uint32_t encoder = 0;
+    uint64_t start   = bench_now_ns();
+    for (uint32_t i = 0; i < s_pred.steps; i++)
+    {
+        encoder += ENCODER_INPUT_FILTER;
+        s_rotary_encoder_callback(encoder);
+    }
+    uint64_t ns = bench_now_ns() - start;
+    int ok = s_pred.evals == evals;
+    s_pred_print("steps", s_pred.steps, s_pred.evals - evals, s_pred.redraws - redraws, ns, ok);
+    failed += !ok;
+
+    // Переключения: вычисляются только условия пунктов переключателя
+    uint32_t state = s_pred.seed ? s_pred.seed : 1;
+    uint64_t total = 0;
+    ok      = 1;
+    evals   = s_pred.evals;
+    redraws = s_pred.redraws;
+    s_menu_handle.current = s_pred.switches[0];
+    for (uint32_t i = 0; i < s_pred.changes; i++)
+    {
+        menu_item_t *item = s_pred.switches[s_pred_random(&state) % PREDICATE_SWITCHES];
+        uint64_t before = s_pred.evals;
+
+        start = bench_now_ns();
+        s_menu_set_value(item, !item->data);
+        total += bench_now_ns() - start;
+
+        if (s_pred.evals - before > (PREDICATE_ITEMS + PREDICATE_SWITCHES - 1) / PREDICATE_SWITCHES || !s_pred_ring_ok())
+        {
+            fprintf(stderr, "predicate: switch '%.16s' re-evaluated %llu predicates or broke the ring\n",
+                    item->title, (unsigned long long)(s_pred.evals - before));
+            ok = 0;
+            break;
+        }
+    }
+    s_pred_print("switch", s_pred.changes, s_pred.evals - evals, s_pred.redraws - redraws, total, ok);
+    failed += !ok;
+
+    // Пакет: все переключатели, условия пересчитываются и меню перерисовывается один раз
+    evals   = s_pred.evals;
+    redraws = s_pred.redraws;
+    start   = bench_now_ns();
+    s_menu_value_begin();
+    for (uint32_t i = 0; i < PREDICATE_SWITCHES; i++)
+        s_menu_set_value(s_pred.switches[i], !s_pred.switches[i]->data);
+    s_menu_value_end();
+    ns = bench_now_ns() - start;
+    ok = s_pred.evals - evals == PREDICATE_ITEMS && s_pred.redraws - redraws == 1 && s_pred_ring_ok();
+    s_pred_print("batch", 1, s_pred.evals - evals, s_pred.redraws - redraws, ns, ok);
+    failed += !ok;
+
+    // Для сравнения: все условия на каждую перерисовку
+    evals = s_pred.evals;
+    volatile uint32_t visible = 0;
+    start = bench_now_ns();
+    for (uint32_t i = 0; i < s_pred.steps / 100; i++)
+    {
+        for (uint32_t j = 0; j < PREDICATE_ITEMS; j++)
+            visible += (uint32_t)s_pred_switch_on(s_pred.items[j]);
+    }
+    ns = bench_now_ns() - start;
+    s_pred_print("naive", s_pred.steps / 100, s_pred.evals - evals, 0, ns, 1);
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_free_items();
+#endif
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,328 @@
+#include "bench.h"
+
+/**
+ * Области отложенных подменю: освобождение и повторное построение подменю, фрагментация кучи.
+ *
+ * menu.c включается целиком, MENU_MALLOC/MENU_FREE подменяются кучей first-fit в статическом
+ * буфере (как malloc в newlib на микроконтроллере: список свободных блоков по адресам, слияние
+ * соседних, вершина кучи растёт только вперёд). Две цели: MenuRegion (MENU_REGION_ITEMS=16)
+ * и MenuRegionOff (без областей: пункт -- отдельное выделение).
+ *
+ * Дерево: REGION_GROUPS отложенных групп разного размера (8..64 параметра), в каждой --
+ * два вложенных отложенных раздела. Прогон --events событий (фиксированное зерно): вход в
+ * случайную группу и иногда в раздел, шаги энкодера, выход, освобождение случайной группы
+ * (s_menu_lazy_release); каждое восьмое событие добавляет в корень долгоживущую заметку
+ * (до REGION_NOTES), которая ложится в кучу между пунктами подменю.
+ *
+ * JSON-строка: выделения и освобождения на освобождение группы, наносекунды на освобождение
+ * и на построение при входе, байты в куче, вершина кучи, свободно под вершиной и самый большой
+ * свободный блок, фрагментация (1 - самый большой / всего свободно), хеш кадров (должен
+ * совпадать у MenuRegion и MenuRegionOff).
+ *
+ * Запуск: MenuRegion [--events N] [--seed S]
+ */
+#include "menu.h"
+
+static void *s_heap_malloc (size_t size);
+static void  s_heap_free   (void *ptr);
+
+#undef MENU_MALLOC
+#undef MENU_FREE
+#define MENU_MALLOC(size) s_heap_malloc(size)
+#define MENU_FREE(ptr)    s_heap_free(ptr)
+
+#include "../menu.c"
+
+#define REGION_GROUPS   24
+#define REGION_SECTIONS 2
+#define REGION_PARAMS   6
+#define REGION_NOTES    512
+#define REGION_HEAP     (8u << 20)
+
+/**
+ * @typedef heap_block_t
+ * @brief Заголовок блока кучи; у свободного блока `next` -- следующий свободный по адресу.
+ */
+typedef struct heap_block {
+    size_t             size; ///< Размер блока вместе с заголовком
+    struct heap_block *next;
+} heap_block_t;
+
+static _Alignas(16) uint8_t s_heap[REGION_HEAP];
+
+static struct {
+    heap_block_t *free_list; ///< Свободные блоки по возрастанию адреса
+    size_t        top;       ///< Вершина кучи: байты от начала буфера, когда-либо выданные
+    size_t        live;      ///< Занято (с заголовками)
+    uint64_t      mallocs;
+    uint64_t      frees;
+} s_heap_state;
+
+static struct {
+    uint32_t events;
+    uint32_t seed;
+    uint64_t frame_hash;
+} s_region = { 20000, 1, 0 };
+
+void printMenu(const char *str1, const char *str2)
+{
+    s_region.frame_hash = bench_hash(s_region.frame_hash, str1, strnlen(str1, MENU_ITEM_TITLE_LEN));
+    s_region.frame_hash = bench_hash(s_region.frame_hash, "|", 1);
+    s_region.frame_hash = bench_hash(s_region.frame_hash, str2, strnlen(str2, MENU_ITEM_TITLE_LEN));
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static void *s_heap_malloc (size_t size)
+{
+    size_t need = (sizeof(heap_block_t) + size + 15u) & ~(size_t)15u;
+    heap_block_t **link = &s_heap_state.free_list;
+
+    // Первый подходящий свободный блок; остаток не меньше заголовка с данными отделяется
+    for (heap_block_t *block = *link; block; link = &block->next, block = block->next)
+    {
+        if (block->size < need)
+            continue;
+        if (block->size - need >= 2 * sizeof(heap_block_t))
+        {
+            heap_block_t *rest = (heap_block_t *)((uint8_t *)block + need);
+            rest->size  = block->size - need;
+            rest->next  = block->next;
+            block->size = need;
+            *link = rest;
+        }
+        else
+        {
+            *link = block->next;
+        }
+        s_heap_state.live += block->size;
+        s_heap_state.mallocs++;
+        return block + 1;
+    }
+
+    if (s_heap_state.top + need > REGION_HEAP)
+        return NULL;
+    heap_block_t *block = (heap_block_t *)(s_heap + s_heap_state.top);
+    block->size = need;
+    s_heap_state.top  += need;
+    s_heap_state.live += need;
+    s_heap_state.mallocs++;
+    return block + 1;
+}
+
+static void s_heap_free (void *ptr)
+{
+    if (ptr == NULL)
+        return;
+
+    heap_block_t *block = (heap_block_t *)ptr - 1;
+    heap_block_t *prev  = NULL;
+    heap_block_t *next  = s_heap_state.free_list;
+
+    s_heap_state.live -= block->size;
+    s_heap_state.frees++;
+
+    while (next && next < block)
+    {
+        prev = next;
+        next = next->next;
+    }
+
+    // Слияние с соседями по адресу
+    block->next = next;
+    if (next && (uint8_t *)block + block->size == (uint8_t *)next)
+    {
+        block->size += next->size;
+        block->next  = next->next;
+    }
+    if (prev && (uint8_t *)prev + prev->size == (uint8_t *)block)
+    {
+        prev->size += block->size;
+        prev->next  = block->next;
+    }
+    else if (prev)
+    {
+        prev->next = block;
+    }
+    else
+    {
+        s_heap_state.free_list = block;
+    }
+}
+
+/**
+ * @brief Свободно под вершиной кучи и самый большой свободный блок.
+ */
+static void s_heap_free_stat (size_t *total, size_t *largest)
+{
+    *total   = 0;
+    *largest = 0;
+    for (heap_block_t *block = s_heap_state.free_list; block; block = block->next)
+    {
+        *total += block->size;
+        if (block->size > *largest)
+            *largest = block->size;
+    }
+}
+
+static uint32_t s_region_random (uint32_t *state)
+{
+    *state = *state * 1664525u + 1013904223u;
+    return *state >> 16;
+}
+
+static void s_region_build_section (menu_item_t *section)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+
+    s_menu_add_item("Back", section, NULL, MENU_FLAG_GOTO_PARENT);
+    for (uint32_t i = 0; i < REGION_PARAMS; i++)
+    {
+        snprintf(title, sizeof(title), "Value %u", i);
+        s_menu_add_item(title, section, NULL, 0);
+    }
+}
+
+static void s_region_build_group (menu_item_t *group)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+    uint32_t index  = (uint32_t)(10 * (group->title[6] - '0') + (group->title[7] - '0'));
+    uint32_t params = 8 + index * 13 % 57;
+
+    s_menu_add_item("Back", group, NULL, MENU_FLAG_GOTO_PARENT);
+    for (uint32_t i = 0; i < REGION_SECTIONS; i++)
+    {
+        snprintf(title, sizeof(title), "Section %u", i);
+        s_menu_add_lazy(title, group, s_region_build_section, 0);
+    }
+    for (uint32_t i = 0; i < params; i++)
+    {
+        snprintf(title, sizeof(title), "Param %u", i);
+        s_menu_add_item(title, group, NULL, 0);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    char title[MENU_ITEM_TITLE_LEN];
+    menu_item_t *groups[REGION_GROUPS];
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+        {
+            s_region.events = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+        {
+            s_region.seed = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--events N] [--seed S]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    for (uint32_t i = 0; i < REGION_GROUPS; i++)
+    {
+        snprintf(title, sizeof(title), "Group %02u", i);
+        groups[i] = s_menu_add_lazy(title, NULL, s_region_build_group, 0);
+        if (groups[i] == NULL)
+            return 1;
+    }
+    s_menu_handle.current = s_menu_handle.start;
+
+    uint32_t state    = s_region.seed ? s_region.seed : 1;
+    uint32_t encoder  = 0;
+    uint32_t notes    = 0;
+    uint32_t builds   = 0;
+    uint32_t releases = 0;
+    uint32_t released = 0;
+    uint64_t build_ns   = 0;
+    uint64_t release_ns = 0;
+    uint64_t release_calls = 0;
+    size_t   top_peak = 0;
+    int ok = 1;
+
+    for (uint32_t e = 0; ok && e < s_region.events; e++)
+    {
+        menu_item_t *group = groups[s_region_random(&state) % REGION_GROUPS];
+
+        // Вход в группу: построение, если она освобождена
+        s_menu_handle.current = group;
+        int build = group->child == NULL;
+        uint64_t start = bench_now_ns();
+        s_push_button_callback();
+        if (build)
+        {
+            build_ns += bench_now_ns() - start;
+            builds++;
+        }
+        ok = s_menu_handle.current->parent == group;
+
+        for (uint32_t steps = s_region_random(&state) % 8; steps > 0; steps--)
+        {
+            encoder += ENCODER_INPUT_FILTER;
+            s_rotary_encoder_callback(encoder);
+        }
+        if ((s_menu_handle.current->flags & MENU_FLAG_LAZY) && s_region_random(&state) % 2)
+        {
+            s_push_button_callback();
+            s_long_push_button_callback();
+        }
+        s_long_push_button_callback();
+
+        // Освобождение случайной группы: выделения и освобождения кучи на одно освобождение
+        menu_item_t *victim = groups[s_region_random(&state) % REGION_GROUPS];
+        if (victim->child && s_region_random(&state) % 2)
+        {
+            uint64_t frees = s_heap_state.frees;
+            start = bench_now_ns();
+            released += s_menu_lazy_release(victim);
+            release_ns += bench_now_ns() - start;
+            release_calls += s_heap_state.frees - frees;
+            releases++;
+        }
+
+        // Долгоживущие выделения между пунктами подменю
+        if (e % 8 == 0 && notes < REGION_NOTES)
+        {
+            snprintf(title, sizeof(title), "Note %u", notes++);
+            ok = ok && s_menu_add_item(title, NULL, NULL, 0) != NULL;
+        }
+
+        if (s_heap_state.top > top_peak)
+            top_peak = s_heap_state.top;
+    }
+
+    size_t free_total = 0;
+    size_t largest    = 0;
+    s_heap_free_stat(&free_total, &largest);
+    ok = ok && s_menu_validate(NULL) == NULL;
+
+    printf("{\"bench\":\"region\",\"region_items\":%u,\"events\":%u,\"builds\":%u,\"releases\":%u,"
+           "\"items_per_release\":%.1f,\"frees_per_release\":%.2f,\"ns_per_release\":%.1f,\"ns_per_build\":%.1f,"
+           "\"mallocs\":%llu,\"heap_live\":%zu,\"heap_top\":%zu,\"heap_free\":%zu,\"largest_free\":%zu,"
+           "\"fragmentation\":%.3f,\"frame_hash\":\"%016llx\",\"ok\":%s}\n",
+           (uint32_t)MENU_REGION_ITEMS, s_region.events, builds, releases,
+           releases ? (double)released / releases : 0.0, releases ? (double)release_calls / releases : 0.0,
+           releases ? (double)release_ns / releases : 0.0, builds ? (double)build_ns / builds : 0.0,
+           (unsigned long long)s_heap_state.mallocs, s_heap_state.live, top_peak, free_total, largest,
+           free_total ? 1.0 - (double)largest / (double)free_total : 0.0,
+           (unsigned long long)s_region.frame_hash, ok ? "true" : "false");
+
+    s_menu_free_items();
+    if (s_heap_state.live != 0)
+    {
+        fprintf(stderr, "region: %zu bytes leaked after s_menu_free_items\n", s_heap_state.live);
+        ok = 0;
+    }
+
+    return ok ? 0 : 1;
+}
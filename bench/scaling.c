@@ -0,0 +1,237 @@
+#include <math.h>
+
+#include "bench.h"
+
+/**
+ * Бенчмарк масштабирования построения меню.
+ *
+ * menu.c включается целиком, чтобы получить доступ к статическим функциям
+ * s_menu_add_item, s_menu_set_child, s_menu_rechain и s_menu_free_items.
+ * Собирается дважды: для статической (MenuScalingStatic) и динамической (MenuScalingDynamic) памяти.
+ *
+ * Дерево строится по уровням (в ширину): на каждом уровне у пункта не больше `breadth` детей,
+ * глубина не больше `depth`. Для каждого размера от --min до --max (удвоением) выводится
+ * JSON-строка: время построения и удаления, пиковая память, стоимость навигации и
+ * показатель роста `build_exp` = log(t2/t1)/log(n2/n1). Значение около 1 -- линейный рост,
+ * около 2 -- квадратичный.
+ *
+ * Запуск: MenuScaling* [--min N] [--max N] [--breadth B] [--depth D] [--nav-events N]
+ */
+#include "../menu.c"
+
+#define SCALING_SEED 0x2545F491u
+
+static struct {
+    uint32_t min;
+    uint32_t max;
+    uint32_t breadth;
+    uint32_t depth;
+    uint32_t nav_events;
+} s_scaling = { 32, 65536, 8, 6, 100000 };
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+/**
+ * @brief Ёмкость дерева заданной ширины и глубины.
+ */
+static uint64_t s_capacity (uint32_t breadth, uint32_t depth)
+{
+    uint64_t level = 1;
+    uint64_t total = 0;
+
+    for (uint32_t d = 0; d < depth && total < UINT32_MAX; d++)
+    {
+        level *= breadth;
+        total += level;
+    }
+
+    return total;
+}
+
+/**
+ * @brief Строит синтетическое дерево из `count` пунктов.
+ *
+ * @param nodes Массив для указателей на созданные пункты (не меньше count).
+ * @return Количество созданных пунктов (меньше count, если закончилась память).
+ */
+static uint32_t s_build (menu_item_t **nodes, uint32_t count)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+    uint32_t built = 0;
+    uint32_t parent_pos = 0;
+
+    // Корневое кольцо
+    while (built < count && built < s_scaling.breadth)
+    {
+        snprintf(title, sizeof(title), "Item %u", built);
+        nodes[built] = s_menu_add_item(title, NULL, NULL, 0);
+        if (nodes[built] == NULL)
+            return built;
+        built++;
+    }
+
+    // Дочерние кольца: родители берутся в порядке создания
+    while (built < count)
+    {
+        menu_item_t *parent = nodes[parent_pos++];
+        uint32_t first = built;
+
+        for (uint32_t i = 0; i < s_scaling.breadth && built < count; i++)
+        {
+            snprintf(title, sizeof(title), "Item %u", built);
+            nodes[built] = s_menu_add_item(title, parent, NULL, i == 0 ? MENU_FLAG_GOTO_PARENT : 0);
+            if (nodes[built] == NULL)
+                return built;
+            built++;
+        }
+
+        s_menu_set_child(parent, nodes[first]);
+    }
+
+    return built;
+}
+
+/**
+ * @brief Освобождает дерево и сбрасывает состояние меню для следующего прогона.
+ */
+static void s_teardown (void)
+{
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    if (s_menu_handle.start)
+    {
+        s_menu_free_items();
+    }
+#endif
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+}
+
+/**
+ * @brief Случайный скрипт навигации с фиксированным зерном: один и тот же для всех размеров.
+ */
+static char *s_nav_script (uint32_t events)
+{
+    char *script = malloc(events + 1);
+    uint32_t state = SCALING_SEED;
+
+    for (uint32_t i = 0; i < events; i++)
+    {
+        state ^= state << 13;
+        state ^= state >> 17;
+        state ^= state << 5;
+
+        uint32_t roll = state % 10;
+        script[i] = roll < 6 ? '+' : roll < 7 ? '-' : roll < 9 ? '*' : '!';
+    }
+    script[events] = '\0';
+
+    return script;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        uint32_t *option = NULL;
+
+        if      (strcmp(argv[i], "--min") == 0)        option = &s_scaling.min;
+        else if (strcmp(argv[i], "--max") == 0)        option = &s_scaling.max;
+        else if (strcmp(argv[i], "--breadth") == 0)    option = &s_scaling.breadth;
+        else if (strcmp(argv[i], "--depth") == 0)      option = &s_scaling.depth;
+        else if (strcmp(argv[i], "--nav-events") == 0) option = &s_scaling.nav_events;
+
+        if (option == NULL || i + 1 >= argc)
+        {
+            fprintf(stderr, "usage: %s [--min N] [--max N] [--breadth B] [--depth D] [--nav-events N]\n", argv[0]);
+            return EXIT_FAILURE;
+        }
+        *option = (uint32_t)strtoul(argv[++i], NULL, 0);
+    }
+
+    if (s_scaling.breadth == 0 || s_scaling.depth == 0 || s_scaling.min == 0)
+    {
+        fprintf(stderr, "scaling: breadth, depth and min must be positive\n");
+        return EXIT_FAILURE;
+    }
+
+    const char *mode = (MENU_USAGE_MEMORY == MENU_USAGE_STATIC_MEMORY) ? "static" : "dynamic";
+    menu_item_t **nodes = malloc(sizeof(menu_item_t *) * s_scaling.max);
+    char *script = s_nav_script(s_scaling.nav_events);
+    uint64_t capacity = s_capacity(s_scaling.breadth, s_scaling.depth);
+    double prev_items = 0.0;
+    double prev_build = 0.0;
+
+    for (uint32_t count = s_scaling.min; count <= s_scaling.max && count != 0; count *= 2)
+    {
+        if (count > capacity)
+        {
+            fprintf(stderr, "scaling: %u items exceed capacity %llu of breadth %u depth %u\n",
+                    count, (unsigned long long)capacity, s_scaling.breadth, s_scaling.depth);
+            break;
+        }
+
+        bench_alloc_reset();
+
+        uint64_t start = bench_now_ns();
+        uint32_t built = s_build(nodes, count);
+        uint64_t build_ns = bench_now_ns() - start;
+
+        if (built != count)
+        {
+            fprintf(stderr, "scaling: out of menu memory after %u of %u items (MENU_SIZE %u)\n",
+                    built, count, (unsigned)MENU_SIZE);
+            s_teardown();
+            break;
+        }
+
+        uint64_t peak_bytes = bench_alloc_stat.bytes_peak;
+#if (MENU_USAGE_MEMORY == MENU_USAGE_STATIC_MEMORY)
+        peak_bytes = (uint64_t)count * sizeof(menu_item_t);
+#endif
+
+        bench_input_t input = { s_rotary_encoder_callback, s_push_button_callback, s_long_push_button_callback, 0, NULL };
+        s_menu_handle.current = s_menu_handle.start;
+        start = bench_now_ns();
+        uint32_t events = bench_play(&input, script);
+        uint64_t nav_ns = bench_now_ns() - start;
+
+        start = bench_now_ns();
+        s_teardown();
+        uint64_t teardown_ns = bench_now_ns() - start;
+
+        double build_exp = prev_items > 0.0 && prev_build > 0.0
+                         ? log((double)build_ns / prev_build) / log((double)count / prev_items)
+                         : 0.0;
+
+        printf("{\"bench\":\"scaling\",\"mode\":\"%s\",\"items\":%u,\"breadth\":%u,\"depth\":%u,"
+               "\"build_ns\":%llu,\"build_ns_per_item\":%.1f,\"build_exp\":%.2f,"
+               "\"teardown_ns\":%llu,\"teardown_ns_per_item\":%.1f,"
+               "\"peak_bytes\":%llu,\"bytes_per_item\":%.1f,\"leaked_bytes\":%llu,"
+               "\"nav_events\":%u,\"nav_ns_per_event\":%.2f}\n",
+               mode, count, s_scaling.breadth, s_scaling.depth,
+               (unsigned long long)build_ns, (double)build_ns / count, build_exp,
+               (unsigned long long)teardown_ns, (double)teardown_ns / count,
+               (unsigned long long)peak_bytes, (double)peak_bytes / count,
+               (unsigned long long)bench_alloc_stat.bytes_current,
+               events, events ? (double)nav_ns / events : 0.0);
+        fflush(stdout);
+
+        prev_items = count;
+        prev_build = (double)build_ns;
+    }
+
+    free(script);
+    free(nodes);
+
+    return 0;
+}
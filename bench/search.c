@@ -0,0 +1,296 @@
+#include "bench.h"
+
+/**
+ * Поиск по заголовкам: s_menu_search (SSE2/NEON) против побайтного сравнения и цикла strncmp.
+ *
+ * menu.c включается целиком. Дерево: SEARCH_GROUPS групп "Group NNN" в корне, в каждой
+ * SEARCH_PARAMS параметров "<слово> <номер>" (около 100 тысяч пунктов). Дерево собирается
+ * напрямую: s_menu_add_item переинициализирует кольцо обходом всего списка, и построение
+ * такого дерева через него квадратично (см. MenuScaling). Первый поиск строит столбец
+ * заголовков, время и размер которого выводятся отдельно. Для каждого запроса (точный,
+ * префикс, без учёта регистра, промах) выводятся наносекунды на пункт (лучший из --repeat
+ * прогонов) для s_menu_search, побайтного сравнения по тому же столбцу и цикла strncmp по
+ * списку пунктов, и совпадение их результатов.
+ *
+ * Затем результаты запроса показываются временным списком (s_menu_search_show): прокрутка
+ * по всем записям, переход нажатием к найденному пункту и выход длинными нажатиями.
+ *
+ * Запуск: MenuSearch [--repeat N]
+ */
+#include <strings.h>
+
+#include "../menu.c"
+
+#define SEARCH_GROUPS 1000
+#define SEARCH_PARAMS 100
+
+typedef struct {
+    const char *name;
+    const char *pattern;
+    uint8_t     mode;
+} search_query_t;
+
+static const char *s_search_words[] = {
+    "Enable", "Delay", "Duration", "Frequency", "Voltage", "Current", "Mode", "Offset", "Gain", "Limit",
+};
+
+static const search_query_t s_search_queries[] = {
+    { "exact",         "Frequency 43", MENU_SEARCH_EXACT                       },
+    { "prefix",        "Freq",         MENU_SEARCH_PREFIX                      },
+    { "nocase_exact",  "frequency 43", MENU_SEARCH_EXACT  | MENU_SEARCH_NOCASE },
+    { "nocase_prefix", "GROUP 1",      MENU_SEARCH_PREFIX | MENU_SEARCH_NOCASE },
+    { "miss",          "Missing",      MENU_SEARCH_EXACT                       },
+};
+
+static uint32_t      s_search_repeat = 20;
+static uint32_t      s_search_items;
+static menu_item_t **s_search_results[3];
+static uint32_t      s_search_found[3];
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+/**
+ * @brief Пункт в конце списка `folowing` без переинициализации кольца.
+ */
+static menu_item_t * s_search_add (const char *title, menu_item_t *parent)
+{
+    menu_item_t *item = s_create_new_item();
+    if (item == NULL)
+        return NULL;
+
+    memset(item, 0, sizeof(*item));
+    s_menu_copy_title(item->title, title);
+    item->parent = parent;
+    if (s_menu_handle.last)
+        s_menu_handle.last->folowing = item;
+    else
+        s_menu_handle.start = item;
+    s_menu_handle.last = item;
+    s_search_items++;
+
+    return item;
+}
+
+static int s_search_build (void)
+{
+    char title[MENU_ITEM_TITLE_LEN + 1];
+    menu_item_t *groups[SEARCH_GROUPS];
+
+    for (uint32_t g = 0; g < SEARCH_GROUPS; g++)
+    {
+        snprintf(title, sizeof(title), "Group %03u", g);
+        if ((groups[g] = s_search_add(title, NULL)) == NULL)
+            return 0;
+    }
+    for (uint32_t g = 0; g < SEARCH_GROUPS; g++)
+    {
+        for (uint32_t p = 0; p < SEARCH_PARAMS; p++)
+        {
+            snprintf(title, sizeof(title), "%s %u", s_search_words[p % 10], p);
+            if (s_search_add(title, groups[g]) == NULL)
+                return 0;
+        }
+    }
+
+    // Кольца -- один проход на родителя
+    s_menu_rechain(NULL);
+    for (uint32_t g = 0; g < SEARCH_GROUPS; g++)
+        s_menu_rechain(groups[g]);
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+    {
+        if (item->parent && item->parent->child == NULL)
+            s_menu_set_child(item->parent, item);
+    }
+#if (MENU_JUMP_INDEX > 0)
+    s_menu_jump_rebuild();
+#endif
+    s_menu_handle.current = s_menu_handle.start;
+
+    return 1;
+}
+
+/**
+ * @brief Тот же проход по столбцу заголовков, что в s_menu_search, с побайтным сравнением.
+ */
+static uint32_t s_search_scalar (const char *pattern, uint8_t mode, menu_item_t **results, uint32_t capacity)
+{
+    menu_search_key_t key;
+    uint32_t found = 0;
+
+    s_menu_search_key(&key, pattern, mode);
+    for (uint32_t i = 0; i < s_menu_search_column.count; i++)
+    {
+        if (s_menu_title_match_scalar(s_menu_search_column.titles[i], &key))
+        {
+            if (found < capacity)
+                results[found] = s_menu_search_column.items[i];
+            found++;
+        }
+    }
+    return found;
+}
+
+/**
+ * @brief Цикл strncmp/strncasecmp -- как искали бы без подготовленного образца.
+ */
+static uint32_t s_search_strncmp (const char *pattern, uint8_t mode, menu_item_t **results, uint32_t capacity)
+{
+    size_t len = (mode & MENU_SEARCH_PREFIX) ? strnlen(pattern, MENU_ITEM_TITLE_LEN) : MENU_ITEM_TITLE_LEN;
+    uint32_t found = 0;
+
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+    {
+        int diff = (mode & MENU_SEARCH_NOCASE) ? strncasecmp(item->title, pattern, len) : strncmp(item->title, pattern, len);
+        if (diff == 0 && !(item->flags & MENU_FLAG_VIRTUAL))
+        {
+            if (found < capacity)
+                results[found] = item;
+            found++;
+        }
+    }
+    return found;
+}
+
+typedef uint32_t (*search_fn_t) (const char *pattern, uint8_t mode, menu_item_t **results, uint32_t capacity);
+
+static double s_search_time (search_fn_t fn, const search_query_t *query, uint32_t slot)
+{
+    uint64_t best = UINT64_MAX;
+
+    for (uint32_t r = 0; r < s_search_repeat; r++)
+    {
+        uint64_t start = bench_now_ns();
+        s_search_found[slot] = fn(query->pattern, query->mode, s_search_results[slot], s_search_items);
+        uint64_t ns = bench_now_ns() - start;
+        if (ns < best)
+            best = ns;
+    }
+    return (double)best / s_search_items;
+}
+
+/**
+ * @brief Проход по списку результатов: все записи по кругу, переход к пункту и выход.
+ */
+static int s_search_navigate (menu_item_t **results, uint32_t count)
+{
+    menu_item_t *origin = s_menu_handle.start;
+    uint32_t encoder = 0;
+
+    s_menu_handle.current = origin;
+    if (s_menu_search_show(results, count) != count)
+        return 0;
+
+    for (uint32_t i = 0; i <= count; i++)
+    {
+        menu_item_t *current = s_menu_handle.current;
+        if (!(current->flags & MENU_FLAG_VIRTUAL) || current->child != results[i % count] ||
+            strncmp(current->title, results[i % count]->title, MENU_ITEM_TITLE_LEN) != 0)
+        {
+            fprintf(stderr, "search: entry %u shows '%.16s'\n", i, current->title);
+            return 0;
+        }
+        encoder += ENCODER_INPUT_FILTER;
+        s_rotary_encoder_callback(encoder);
+    }
+
+    // Сейчас курсор на записи 1 (прошли круг и ещё шаг): нажатие ведёт к найденному пункту
+    s_push_button_callback();
+    if (s_menu_handle.current != results[1 % count])
+        return 0;
+
+    // Повторный показ из найденного пункта, выход: запись -> узел -> пункт начала поиска
+    menu_item_t *found = s_menu_handle.current;
+    s_menu_search_show(results, count);
+    s_long_push_button_callback();
+    if (s_menu_handle.current != &s_menu_search_list.node)
+        return 0;
+    s_push_button_callback();
+    if (s_menu_handle.current->parent != &s_menu_search_list.node)
+        return 0;
+    s_long_push_button_callback();
+    s_long_push_button_callback();
+    if (s_menu_handle.current != found)
+        return 0;
+
+    s_menu_search_close();
+    return 1;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            s_search_repeat = (uint32_t)strtoul(argv[++i], NULL, 0);
+            if (s_search_repeat == 0)
+                s_search_repeat = 1;
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--repeat N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (!s_search_build())
+    {
+        fprintf(stderr, "search: cannot build the tree\n");
+        return 1;
+    }
+
+    for (uint32_t i = 0; i < 3; i++)
+        s_search_results[i] = malloc(s_search_items * sizeof(menu_item_t *));
+
+    uint64_t start = bench_now_ns();
+    s_menu_search("", MENU_SEARCH_EXACT, NULL, 0);
+    uint64_t column_ns = bench_now_ns() - start;
+    printf("{\"bench\":\"search\",\"items\":%u,\"column_build_ns\":%llu,\"column_titles\":%u,\"column_bytes\":%llu}\n",
+           s_search_items, (unsigned long long)column_ns, s_menu_search_column.count,
+           (unsigned long long)s_menu_search_column.capacity * (MENU_ITEM_TITLE_LEN + sizeof(menu_item_t *)));
+
+    int failed = 0;
+    for (uint32_t q = 0; q < sizeof(s_search_queries) / sizeof(s_search_queries[0]); q++)
+    {
+        const search_query_t *query = &s_search_queries[q];
+
+        double simd    = s_search_time(s_menu_search,    query, 0);
+        double scalar  = s_search_time(s_search_scalar,  query, 1);
+        double strn    = s_search_time(s_search_strncmp, query, 2);
+
+        int ok = s_search_found[0] == s_search_found[1] && s_search_found[0] == s_search_found[2] &&
+                 memcmp(s_search_results[0], s_search_results[1], s_search_found[0] * sizeof(menu_item_t *)) == 0 &&
+                 memcmp(s_search_results[0], s_search_results[2], s_search_found[0] * sizeof(menu_item_t *)) == 0;
+        failed += !ok;
+
+        printf("{\"bench\":\"search\",\"query\":\"%s\",\"simd\":\"%s\",\"items\":%u,\"found\":%u,"
+               "\"ns_per_item\":%.3f,\"scalar_ns_per_item\":%.3f,\"strncmp_ns_per_item\":%.3f,"
+               "\"speedup_vs_strncmp\":%.2f,\"ok\":%s}\n",
+               query->name,
+               MENU_SEARCH_SIMD == MENU_SEARCH_SIMD_SSE2 ? "sse2" : MENU_SEARCH_SIMD == MENU_SEARCH_SIMD_NEON ? "neon" : "none",
+               s_search_items, s_search_found[0], simd, scalar, strn, simd > 0 ? strn / simd : 0.0,
+               ok ? "true" : "false");
+    }
+
+    uint32_t count = s_menu_search("Frequency 43", MENU_SEARCH_EXACT, s_search_results[0], s_search_items);
+    int nav = s_search_navigate(s_search_results[0], count);
+    failed += !nav;
+    printf("{\"bench\":\"search\",\"results_list\":%u,\"navigation_ok\":%s}\n", count, nav ? "true" : "false");
+
+    for (uint32_t i = 0; i < 3; i++)
+        free(s_search_results[i]);
+    s_menu_free_items();
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,459 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include "menu.h"
+#include "console.h"
+#include "bench.h"
+
+/**
+ * Сравнение поколений движка меню.
+ *
+ * menu01.c -- menu04.c собираются отдельными библиотеками MenuVariant01..04, в каждой
+ * Menu_Init переименован в Menu_Init_NN. Общий интерфейс для всех поколений -- console.h:
+ * Menu_Init строит демонстрационное дерево и уходит в taskReadKey, кадры выводятся через
+ * printMenu. Эталоном служит текущий menu.c.
+ *
+ * Старые поколения не сбрасывают своё состояние и могут падать, поэтому каждый прогон
+ * выполняется в отдельном процессе (fork) с ограничением по времени. Для каждого поколения:
+ * - build_ns       -- от вызова Menu_Init до входа в taskReadKey (построение и первый кадр),
+ *                     минимум по --repeat прогонам;
+ * - heap_bytes     -- занято кучи на входе в taskReadKey (MENU_ALLOC_HOOKS), allocs -- число выделений;
+ * - heap_left      -- осталось в куче после возврата из Menu_Init (освобождение дерева);
+ * - nav_ns         -- нагрузка "nav" до --events событий без вывода, нс на событие (минимум);
+ * - matching       -- сколько нагрузок дали те же кадры, что и menu.c. Для каждой расходящейся
+ *                     нагрузки выводится первое отличающееся событие.
+ * Последняя строка -- сводка: поколения, кадры которых расходятся с menu.c (`diverging`).
+ * Расхождение старых поколений -- результат сравнения, а не ошибка: код возврата 0, ненулевой --
+ * только если не удалось прогнать эталон.
+ * Статическая память поколений печатается при сборке (menu footprint для libMenuVariantNN.a).
+ *
+ * Запуск: MenuVariants [--repeat N] [--events N] [--script FILE]
+ */
+
+#define VARIANTS_DEFAULT_REPEAT 15u
+#define VARIANTS_DEFAULT_EVENTS 100000u
+#define VARIANTS_TIMEOUT_S      10u  ///< Ограничение времени одного прогона (зацикливание считается сбоем)
+#define VARIANTS_FRAME_LEN      (2 * MENU_ITEM_TITLE_LEN + 2)
+
+void Menu_Init_01 (void);
+void Menu_Init_02 (void);
+void Menu_Init_03 (void);
+void Menu_Init_04 (void);
+
+/**
+ * @typedef variants_engine_t
+ * @brief Поколение движка: имя, способ построения колец и точка входа.
+ */
+typedef struct {
+    const char *name;
+    const char *design;
+    void      (*init) (void);
+} variants_engine_t;
+
+static const variants_engine_t s_engines[] = {
+    { "menu",   "s_menu_rechain, flags",  Menu_Init    }, // Эталон
+    { "menu01", "static pointer tables",  Menu_Init_01 },
+    { "menu02", "s_create_submenu",       Menu_Init_02 },
+    { "menu03", "s_menu_rechain (draft)", Menu_Init_03 },
+    { "menu04", "s_create_submenu",       Menu_Init_04 },
+};
+
+#define VARIANTS_ENGINES (sizeof(s_engines) / sizeof(s_engines[0]))
+
+typedef struct {
+    const char *name;
+    const char *script;
+} variants_workload_t;
+
+static variants_workload_t s_workloads[] = {
+    { "nav",     "+++---" },
+    { "button",  "-**+" },
+    { "gesture", "-*+*!!!" },
+    { "mixed",   "-*++*+-*!+" },
+    { "script",  NULL },              // --script FILE
+};
+
+#define VARIANTS_WORKLOADS (sizeof(s_workloads) / sizeof(s_workloads[0]))
+
+typedef enum {
+    VARIANTS_RUN_TIME,   ///< Замер построения и навигации
+    VARIANTS_RUN_FRAMES, ///< Запись кадров после каждого события
+} variants_run_t;
+
+/**
+ * @typedef variants_result_t
+ * @brief Результат прогона, передаваемый из дочернего процесса через pipe.
+ */
+typedef struct {
+    uint64_t build_ns;
+    uint64_t heap_bytes;
+    uint64_t heap_left;
+    uint64_t allocs;
+    uint64_t nav_ns;
+    uint64_t nav_events;
+} variants_result_t;
+
+static struct {
+    variants_run_t    run;
+    const char       *script;
+    uint32_t          events;
+    uint32_t          repeat;
+    uint64_t          start_ns;
+    variants_result_t result;
+    char              frame[VARIANTS_FRAME_LEN];
+    int               fd;                       ///< Куда дочерний процесс пишет кадры
+} s_variants = { VARIANTS_RUN_TIME, NULL, VARIANTS_DEFAULT_EVENTS, VARIANTS_DEFAULT_REPEAT, 0, { 0 }, { 0 }, -1 };
+
+void printMenu(const char *str1, const char *str2)
+{
+    if (s_variants.run == VARIANTS_RUN_FRAMES)
+    {
+        snprintf(s_variants.frame, sizeof(s_variants.frame), "%.*s|%.*s",
+                 MENU_ITEM_TITLE_LEN, str1, MENU_ITEM_TITLE_LEN, str2);
+    }
+}
+
+static void s_variants_record (void)
+{
+    size_t len = strlen(s_variants.frame);
+
+    s_variants.frame[len] = '\n';
+    if (write(s_variants.fd, s_variants.frame, len + 1) != (ssize_t)(len + 1))
+        _exit(2);
+    s_variants.frame[len] = '\0';
+}
+
+/**
+ * @brief Заглушка длинного нажатия для поколений, которые его не поддерживают (menu01, menu02, menu04).
+ */
+static void s_variants_no_long_push (void)
+{
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    bench_input_t input = { rotary_encoder_callback_func, push_button_callback_func,
+                            long_push_button_callback_func ? long_push_button_callback_func : s_variants_no_long_push, 0, NULL };
+
+    s_variants.result.build_ns   = bench_now_ns() - s_variants.start_ns;
+    s_variants.result.heap_bytes = bench_alloc_stat.bytes_current;
+    s_variants.result.allocs     = bench_alloc_stat.allocs;
+
+    if (s_variants.run == VARIANTS_RUN_FRAMES)
+    {
+        char event[2] = { 0, 0 };
+
+        s_variants_record();
+        for (const char *p = s_variants.script; *p; p++)
+        {
+            if (*p == '#')
+            {
+                while (p[1] && p[1] != '\n')
+                    p++;
+                continue;
+            }
+
+            event[0] = *p;
+            if (bench_play(&input, event) != 0)
+                s_variants_record();
+        }
+        return;
+    }
+
+    uint64_t events = 0;
+    uint64_t start  = bench_now_ns();
+    while (events < s_variants.events)
+    {
+        events += bench_play(&input, s_variants.script);
+    }
+    s_variants.result.nav_ns     = bench_now_ns() - start;
+    s_variants.result.nav_events = events;
+}
+
+/**
+ * @brief Выполняет один прогон поколения в дочернем процессе.
+ * @param frames Буфер для записанных кадров (только для VARIANTS_RUN_FRAMES), освобождает вызывающий.
+ * @return 0 -- успех, иначе номер сигнала (или 128 + код выхода), завершившего процесс.
+ */
+static int s_variants_fork (const variants_engine_t *engine, variants_run_t run, const char *script,
+                            variants_result_t *result, char **frames)
+{
+    int fds[2];
+
+    if (pipe(fds) != 0)
+    {
+        perror("pipe");
+        exit(1);
+    }
+
+    fflush(stdout);
+    pid_t pid = fork();
+    if (pid < 0)
+    {
+        perror("fork");
+        exit(1);
+    }
+
+    if (pid == 0)
+    {
+        close(fds[0]);
+        alarm(VARIANTS_TIMEOUT_S);
+
+        s_variants.run    = run;
+        s_variants.script = script;
+        s_variants.fd     = fds[1];
+        bench_alloc_reset();
+        s_variants.start_ns = bench_now_ns();
+        engine->init();
+        s_variants.result.heap_left = bench_alloc_stat.bytes_current;
+
+        // Результат идёт после кадров: нулевой маркер отделяет его от текста
+        char marker = '\0';
+        if (write(fds[1], &marker, 1) != 1 ||
+            write(fds[1], &s_variants.result, sizeof(s_variants.result)) != (ssize_t)sizeof(s_variants.result))
+            _exit(2);
+        _exit(0);
+    }
+
+    close(fds[1]);
+
+    size_t len = 0;
+    size_t cap = 256;
+    char  *buffer = malloc(cap);
+    ssize_t n;
+    while ((n = read(fds[0], buffer + len, cap - len)) > 0)
+    {
+        len += (size_t)n;
+        if (len == cap)
+        {
+            cap *= 2;
+            buffer = realloc(buffer, cap);
+        }
+    }
+    close(fds[0]);
+
+    int status = 0;
+    waitpid(pid, &status, 0);
+
+    int failure = 0;
+    if (WIFSIGNALED(status))
+        failure = WTERMSIG(status);
+    else if (WEXITSTATUS(status) != 0)
+        failure = 128 + WEXITSTATUS(status);
+
+    char *marker = memchr(buffer, '\0', len);
+    if (!failure && (marker == NULL || (size_t)(buffer + len - marker - 1) != sizeof(*result)))
+        failure = 128;
+
+    if (!failure)
+    {
+        memcpy(result, marker + 1, sizeof(*result));
+        *marker = '\0';
+    }
+    else if (marker == NULL)
+    {
+        buffer[len] = '\0'; // После цикла чтения len < cap
+    }
+
+    if (frames)
+        *frames = buffer;
+    else
+        free(buffer);
+
+    return failure;
+}
+
+static void s_variants_print_failure (int failure)
+{
+    if (failure < 128)
+        printf("\"status\":\"signal %d (%s)\"", failure, strsignal(failure));
+    else
+        printf("\"status\":\"exit %d\"", failure - 128);
+}
+
+/**
+ * @brief Сравнивает кадры поколения с эталоном и печатает первое расхождение.
+ * @return 1 -- совпадают, 0 -- нет.
+ */
+static int s_variants_compare (const variants_engine_t *engine, const variants_workload_t *workload,
+                               const char *expected, const char *actual, int failure)
+{
+    if (!failure && strcmp(expected, actual) == 0)
+        return 1;
+
+    uint32_t event = 0;
+    const char *input = workload->script;
+    while (*expected && *actual)
+    {
+        size_t e_len = strcspn(expected, "\n");
+        size_t a_len = strcspn(actual,   "\n");
+        if (e_len != a_len || memcmp(expected, actual, e_len) != 0)
+            break;
+
+        expected += e_len + (expected[e_len] ? 1 : 0);
+        actual   += a_len + (actual[a_len] ? 1 : 0);
+        event++;
+    }
+
+    // Событие скрипта, после которого записан кадр event (кадр 0 -- начальный)
+    char key[3] = "--";
+    if (event > 0)
+    {
+        uint32_t index = 0;
+        for (; *input; input++)
+        {
+            if (*input == '#')
+            {
+                input += strcspn(input, "\n");
+                if (*input == '\0')
+                    break;
+                continue;
+            }
+            if (strchr("+-*!", *input) && ++index == event)
+            {
+                key[0] = *input;
+                key[1] = '\0';
+                break;
+            }
+        }
+    }
+
+    printf("{\"bench\":\"variants\",\"variant\":\"%s\",\"workload\":\"%s\",\"event\":%u,\"input\":\"%s\","
+           "\"expected\":\"%.*s\",\"actual\":\"%.*s\",",
+           engine->name, workload->name, event, event ? key : "init",
+           (int)strcspn(expected, "\n"), expected, (int)strcspn(actual, "\n"), actual);
+    if (failure)
+        s_variants_print_failure(failure);
+    else
+        printf("\"status\":\"ok\"");
+    printf("}\n");
+
+    return 0;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *script_path = NULL;
+
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            s_variants.repeat = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--events") == 0 && i + 1 < argc)
+        {
+            s_variants.events = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--script") == 0 && i + 1 < argc)
+        {
+            script_path = argv[++i];
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--repeat N] [--events N] [--script FILE]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    if (s_variants.repeat == 0)
+        s_variants.repeat = 1;
+
+    if (script_path)
+    {
+        s_workloads[VARIANTS_WORKLOADS - 1].script = bench_read_file(script_path);
+        if (s_workloads[VARIANTS_WORKLOADS - 1].script == NULL)
+        {
+            fprintf(stderr, "cannot read %s\n", script_path);
+            return 1;
+        }
+    }
+
+    // Эталонные кадры menu.c
+    char *reference[VARIANTS_WORKLOADS] = { NULL };
+    for (size_t w = 0; w < VARIANTS_WORKLOADS; w++)
+    {
+        variants_result_t unused;
+
+        if (s_workloads[w].script == NULL)
+            continue;
+        if (s_variants_fork(&s_engines[0], VARIANTS_RUN_FRAMES, s_workloads[w].script, &unused, &reference[w]) != 0)
+        {
+            fprintf(stderr, "reference engine failed on workload %s\n", s_workloads[w].name);
+            return 1;
+        }
+    }
+
+    char diverging[VARIANTS_ENGINES * 16] = "";
+    for (size_t e = 0; e < VARIANTS_ENGINES; e++)
+    {
+        const variants_engine_t *engine = &s_engines[e];
+        variants_result_t best = { 0 };
+        int failure = 0;
+
+        for (uint32_t r = 0; r < s_variants.repeat && !failure; r++)
+        {
+            variants_result_t result;
+
+            failure = s_variants_fork(engine, VARIANTS_RUN_TIME, s_workloads[0].script, &result, NULL);
+            if (failure)
+                break;
+
+            if (r == 0)
+            {
+                best = result;
+                continue;
+            }
+            if (result.build_ns < best.build_ns)
+                best.build_ns = result.build_ns;
+            if (result.nav_ns < best.nav_ns)
+                best.nav_ns = result.nav_ns;
+        }
+
+        uint32_t workloads = 0;
+        uint32_t matching  = 0;
+        for (size_t w = 0; w < VARIANTS_WORKLOADS; w++)
+        {
+            variants_result_t unused;
+            char *frames = NULL;
+
+            if (s_workloads[w].script == NULL)
+                continue;
+
+            int run_failure = s_variants_fork(engine, VARIANTS_RUN_FRAMES, s_workloads[w].script, &unused, &frames);
+            workloads++;
+            matching += (uint32_t)s_variants_compare(engine, &s_workloads[w], reference[w], frames, run_failure);
+            free(frames);
+        }
+        if (matching != workloads)
+        {
+            size_t used = strlen(diverging);
+            snprintf(diverging + used, sizeof(diverging) - used, "%s\"%s\"", used ? "," : "", engine->name);
+        }
+
+        printf("{\"bench\":\"variants\",\"variant\":\"%s\",\"design\":\"%s\",", engine->name, engine->design);
+        if (failure)
+        {
+            s_variants_print_failure(failure);
+        }
+        else
+        {
+            printf("\"status\":\"ok\",\"build_ns\":%llu,\"heap_bytes\":%llu,\"heap_left\":%llu,\"allocs\":%llu,"
+                   "\"nav_events\":%llu,\"nav_ns_per_event\":%.2f",
+                   (unsigned long long)best.build_ns, (unsigned long long)best.heap_bytes,
+                   (unsigned long long)best.heap_left, (unsigned long long)best.allocs, (unsigned long long)best.nav_events,
+                   best.nav_events ? (double)best.nav_ns / (double)best.nav_events : 0.0);
+        }
+        printf(",\"workloads\":%u,\"matching\":%u}\n", workloads, matching);
+    }
+
+    for (size_t w = 0; w < VARIANTS_WORKLOADS; w++)
+        free(reference[w]);
+
+    printf("{\"bench\":\"variants\",\"summary\":true,\"diverging\":[%s]}\n", diverging);
+    return 0;
+}
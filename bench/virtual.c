@@ -0,0 +1,194 @@
+#include "bench.h"
+
+/**
+ * Виртуальные списки: память и стоимость шага в зависимости от длины списка.
+ *
+ * menu.c включается целиком, чтобы вызвать s_menu_add_virtual. Для каждой длины строится
+ * корневое кольцо из пункта "Start" и виртуального списка "Log" с записями "Entry N",
+ * курсор входит в список и прокручивает его на --steps шагов вперёд и столько же назад,
+ * после каждого шага проверяется, что текущий и следующий пункты показывают нужные записи, а
+ * кольцо окна не длиннее списка (в списках из 1 и 2 записей запись не повторяется). Затем длина
+ * меняется на 1 и 2 при курсоре в списке и возвращается обратно.
+ * Затем --steps шагов вперёд замеряются без проверок.
+ *
+ * JSON-строка на длину: созданные пункты, занятая куча, оценка памяти при создании пункта
+ * на каждую запись (`materialized_bytes`), наносекунды на шаг энкодера.
+ *
+ * Запуск: MenuVirtual [--steps N]
+ */
+#include "../menu.c"
+
+static const uint32_t s_virtual_counts[] = { 1, 2, 10, 1000, 100000, 10000000, UINT32_MAX };
+
+static uint32_t s_virtual_steps = 100000;
+static uint64_t s_virtual_provided; ///< Вызовы источника за прогон
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+static uint32_t s_virtual_provider (uint32_t index, char *title)
+{
+    s_virtual_provided++;
+    snprintf(title, MENU_ITEM_TITLE_LEN, "Entry %u", index);
+    return index;
+}
+
+/**
+ * @brief Проверяет, что текущий пункт показывает запись `index`, а следующий -- `index + 1`,
+ *        и что в кольце окна не больше пунктов, чем записей (запись не показана дважды).
+ */
+static int s_virtual_check (uint32_t count, uint32_t index)
+{
+    menu_item_t *current = s_menu_handle.current;
+    uint32_t next = index + 1 < count ? index + 1 : 0;
+    uint32_t ring = 1;
+    char expected[MENU_ITEM_TITLE_LEN + 1];
+
+    for (menu_item_t *item = current->next; item != current && ring <= MENU_VIRTUAL_WINDOW; item = item->next)
+        ring++;
+    if (ring != (count < MENU_VIRTUAL_WINDOW ? count : MENU_VIRTUAL_WINDOW))
+    {
+        fprintf(stderr, "virtual %u: window ring has %u items\n", count, ring);
+        return 0;
+    }
+
+    snprintf(expected, sizeof(expected), "Entry %u", index);
+    if (current->data != index || strncmp(current->title, expected, MENU_ITEM_TITLE_LEN) != 0)
+    {
+        fprintf(stderr, "virtual %u: current shows '%.16s', expected '%s'\n", count, current->title, expected);
+        return 0;
+    }
+
+    snprintf(expected, sizeof(expected), "Entry %u", next);
+    if (current->next->data != next || strncmp(current->next->title, expected, MENU_ITEM_TITLE_LEN) != 0)
+    {
+        fprintf(stderr, "virtual %u: next shows '%.16s', expected '%s'\n", count, current->next->title, expected);
+        return 0;
+    }
+
+    return 1;
+}
+
+static uint32_t s_virtual_items (void)
+{
+    uint32_t items = 0;
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+        items++;
+    return items;
+}
+
+static int s_virtual_run (uint32_t count)
+{
+    bench_alloc_reset();
+    s_virtual_provided = 0;
+
+    s_menu_add_item("Start", NULL, NULL, 0);
+    menu_item_t *log = s_menu_add_virtual("Log", NULL, count, s_virtual_provider, MENU_FLAG_GOTO_PARENT);
+    if (log == NULL)
+    {
+        fprintf(stderr, "virtual %u: s_menu_add_virtual failed\n", count);
+        return 0;
+    }
+
+    uint64_t heap  = bench_alloc_stat.bytes_current;
+    uint32_t items = s_virtual_items();
+
+    // Вход в список нажатием на узел
+    s_menu_handle.current = log;
+    s_push_button_callback();
+
+    int ok = s_virtual_check(count, 0);
+    uint32_t encoder = 0;
+    uint32_t index   = 0;
+
+    for (uint32_t i = 0; i < s_virtual_steps && ok; i++)
+    {
+        encoder += ENCODER_INPUT_FILTER;
+        s_rotary_encoder_callback(encoder);
+        index = index + 1 < count ? index + 1 : 0;
+        ok = s_virtual_check(count, index);
+    }
+    for (uint32_t i = 0; i < s_virtual_steps && ok; i++)
+    {
+        encoder -= ENCODER_INPUT_FILTER;
+        s_rotary_encoder_callback(encoder);
+        index = index ? index - 1 : count - 1;
+        ok = s_virtual_check(count, index);
+    }
+
+    // Замер без проверок: только шаги энкодера, позиция проверяется в конце
+    uint64_t start = bench_now_ns();
+    for (uint32_t i = 0; i < s_virtual_steps; i++)
+    {
+        encoder += ENCODER_INPUT_FILTER;
+        s_rotary_encoder_callback(encoder);
+    }
+    uint64_t ns = bench_now_ns() - start;
+    index = (uint32_t)(((uint64_t)index + s_virtual_steps) % count);
+    ok = ok && s_virtual_check(count, index);
+
+    // Выход нажатием на запись (MENU_FLAG_GOTO_PARENT) и повторный вход: позиция сохраняется
+    s_push_button_callback();
+    ok = ok && s_menu_handle.current == log;
+    s_push_button_callback();
+    ok = ok && s_virtual_check(count, index);
+
+    // Список укорачивается до одной и двух записей, пока курсор в нём, и возвращается к исходной длине
+    s_menu_virtual_set_count(log, 1);
+    ok = ok && s_virtual_check(1, 0);
+    s_menu_virtual_set_count(log, 2);
+    ok = ok && s_virtual_check(2, 0);
+    encoder += ENCODER_INPUT_FILTER;
+    s_rotary_encoder_callback(encoder);
+    ok = ok && s_virtual_check(2, 1);
+    s_menu_virtual_set_count(log, count);
+    ok = ok && s_virtual_check(count, 1 % count);
+
+    printf("{\"bench\":\"virtual\",\"entries\":%u,\"items\":%u,\"heap_bytes\":%llu,\"descriptor_bytes\":%zu,"
+           "\"materialized_bytes\":%llu,\"steps\":%u,\"ns_per_step\":%.2f,\"provider_calls\":%llu,\"ok\":%s}\n",
+           count, items, (unsigned long long)heap, sizeof(menu_virtual_t),
+           (unsigned long long)count * sizeof(menu_item_t), s_virtual_steps,
+           s_virtual_steps ? (double)ns / (double)s_virtual_steps : 0.0,
+           (unsigned long long)s_virtual_provided, ok ? "true" : "false");
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_free_items();
+#endif
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--steps") == 0 && i + 1 < argc)
+        {
+            s_virtual_steps = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--steps N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    for (uint32_t i = 0; i < sizeof(s_virtual_counts) / sizeof(s_virtual_counts[0]); i++)
+    {
+        failed += !s_virtual_run(s_virtual_counts[i]);
+    }
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,233 @@
+#include "bench.h"
+
+/**
+ * Обход дерева без рекурсии: стек фиксированной ёмкости (MENU_WALK_DEPTH) вместо вызовов.
+ *
+ * menu.c включается целиком, чтобы вызвать s_menu_walk и построенные на нём s_menu_find,
+ * s_menu_export и s_menu_validate. Деревья:
+ * - `wide`     -- WALK_WIDTH пунктов в корне, у каждого подменю из WALK_WIDTH пунктов, у тех --
+ *                 ещё по WALK_WIDTH; каждый третий пункт скрыт (обход проходит и скрытые);
+ * - `deep`     -- цепочка подменю глубиной ровно MENU_WALK_DEPTH уровней;
+ * - `overflow` -- на уровень глубже: обход сообщает о переполнении, s_menu_validate -- о пункте.
+ * Порядок посещений (прямой и обратный, с уровнями) сверяется с рекурсивным эталоном.
+ *
+ * JSON-строка на дерево: пункты, статус обхода, наносекунды на пункт для s_menu_walk и
+ * рекурсии, время s_menu_export, s_menu_find (последний пункт) и s_menu_validate,
+ * байты стека обхода.
+ *
+ * Запуск: MenuWalk [--repeat N]
+ */
+#include "../menu.c"
+
+#define WALK_WIDTH 16
+
+static uint32_t s_walk_repeat = 100;
+
+void printMenu(const char *str1, const char *str2)
+{
+    (void)str1;
+    (void)str2;
+}
+
+void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func)
+{
+    (void)rotary_encoder_callback_func;
+    (void)push_button_callback_func;
+    (void)long_push_button_callback_func;
+}
+
+typedef struct {
+    uint64_t hash;  ///< Хеш последовательности (пункт, уровень, порядок)
+    uint32_t count;
+} walk_trace_t;
+
+static int s_walk_visit (menu_item_t *item, uint32_t depth, uint8_t order, void *context)
+{
+    walk_trace_t *trace = (walk_trace_t *)context;
+    uintptr_t key[3] = { (uintptr_t)item, depth, order };
+
+    trace->hash = bench_hash(trace->hash, key, sizeof(key));
+    trace->count++;
+    return 0;
+}
+
+/**
+ * @brief Посетитель для замеров: только счётчик.
+ */
+static int s_walk_count (menu_item_t *item, uint32_t depth, uint8_t order, void *context)
+{
+    (void)item;
+    (void)depth;
+    (void)order;
+    (*(uint32_t *)context)++;
+    return 0;
+}
+
+/**
+ * @brief Эталон: тот же обход рекурсией (вызов на каждое кольцо).
+ */
+static void s_walk_recursive (menu_item_t *first, uint32_t depth, menu_walk_visit_t visit, void *context)
+{
+    menu_item_t *item = first;
+
+    do
+    {
+        visit(item, depth, MENU_WALK_PRE, context);
+        if (item->child)
+            s_walk_recursive(s_menu_ring_first(item->child), depth + 1, visit, context);
+        visit(item, depth, MENU_WALK_POST, context);
+        item = item->sibling_next;
+    } while (item != first);
+}
+
+/**
+ * @brief Цепочка подменю глубиной `depth`: на каждом уровне "Back", вход глубже и "Leaf".
+ * @return Последний созданный пункт.
+ */
+static menu_item_t * s_walk_build_chain (uint32_t depth)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+    menu_item_t *parent = NULL;
+    menu_item_t *last   = NULL;
+
+    for (uint32_t level = 0; level < depth; level++)
+    {
+        menu_item_t *back = level ? s_menu_add_item("Back", parent, NULL, MENU_FLAG_GOTO_PARENT) : NULL;
+        snprintf(title, sizeof(title), "Level %u", level);
+        menu_item_t *enter = s_menu_add_item(title, parent, NULL, 0);
+        last = s_menu_add_item("Leaf", parent, NULL, 0);
+        if (enter == NULL || last == NULL || (level && back == NULL))
+            return NULL;
+        if (parent)
+            s_menu_set_child(parent, back);
+        parent = enter;
+    }
+    return last;
+}
+
+static menu_item_t * s_walk_build_wide (void)
+{
+    char title[MENU_ITEM_TITLE_LEN];
+    menu_item_t *last = NULL;
+    uint32_t n = 0;
+
+    for (uint32_t i = 0; i < WALK_WIDTH; i++)
+    {
+        snprintf(title, sizeof(title), "Group %u", i);
+        menu_item_t *group = s_menu_add_item(title, NULL, NULL, 0);
+        for (uint32_t j = 0; group && j < WALK_WIDTH; j++)
+        {
+            snprintf(title, sizeof(title), "Section %u.%u", i, j);
+            menu_item_t *section = s_menu_add_item(title, group, NULL, 0);
+            if (section && j == 0)
+                s_menu_set_child(group, section);
+            for (uint32_t k = 0; section && k < WALK_WIDTH; k++)
+            {
+                snprintf(title, sizeof(title), "Param %u.%u.%u", i, j, k);
+                last = s_menu_add_item(title, section, NULL, 0);
+                if (last && k == 0)
+                    s_menu_set_child(section, last);
+                if (last && ++n % 3 == 0)
+                    s_menu_set_visible(last, 0);
+            }
+            if (section == NULL)
+                return NULL;
+        }
+        if (group == NULL)
+            return NULL;
+    }
+    return last;
+}
+
+static int s_walk_run (const char *name, menu_item_t *last, int expect_overflow)
+{
+    uint32_t items = 0;
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+        items++;
+    s_menu_handle.current = s_menu_handle.start;
+
+    walk_trace_t walk = { 0, 0 };
+    walk_trace_t reference = { 0, 0 };
+    int status = s_menu_walk(NULL, MENU_WALK_PRE | MENU_WALK_POST, s_walk_visit, &walk);
+    s_walk_recursive(s_menu_handle.start, 0, s_walk_visit, &reference);
+
+    menu_item_t *bad = s_menu_validate(NULL);
+    int ok = last != NULL;
+    if (expect_overflow)
+        ok = ok && status == MENU_WALK_OVERFLOW && bad != NULL;
+    else
+        ok = ok && status == MENU_WALK_DONE && bad == NULL && walk.hash == reference.hash &&
+             walk.count == 2 * items && s_menu_find(NULL, last->title) == last;
+
+    // Замеры: обход, рекурсия, текст, поиск последнего пункта, проверка
+    uint32_t counted = 0;
+    uint64_t start = bench_now_ns();
+    for (uint32_t r = 0; r < s_walk_repeat; r++)
+        s_menu_walk(NULL, MENU_WALK_PRE | MENU_WALK_POST, s_walk_count, &counted);
+    uint64_t walk_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (uint32_t r = 0; r < s_walk_repeat; r++)
+        s_walk_recursive(s_menu_handle.start, 0, s_walk_count, &counted);
+    uint64_t recursive_ns = bench_now_ns() - start;
+
+    uint32_t length = s_menu_export(NULL, NULL, 0);
+    char *text = malloc(length + 1);
+    start = bench_now_ns();
+    for (uint32_t r = 0; text && r < s_walk_repeat; r++)
+        s_menu_export(NULL, text, length + 1);
+    uint64_t export_ns = bench_now_ns() - start;
+    ok = ok && text != NULL && (expect_overflow || strlen(text) == length);
+    free(text);
+
+    volatile uintptr_t sink = 0;
+    start = bench_now_ns();
+    for (uint32_t r = 0; r < s_walk_repeat; r++)
+        sink += (uintptr_t)s_menu_find(NULL, last ? last->title : "");
+    uint64_t find_ns = bench_now_ns() - start;
+
+    start = bench_now_ns();
+    for (uint32_t r = 0; r < s_walk_repeat; r++)
+        sink += (uintptr_t)s_menu_validate(NULL);
+    uint64_t validate_ns = bench_now_ns() - start;
+
+    double visits = (double)s_walk_repeat * items;
+    printf("{\"bench\":\"walk\",\"tree\":\"%s\",\"items\":%u,\"status\":\"%s\",\"ns_per_item_walk\":%.2f,"
+           "\"ns_per_item_recursive\":%.2f,\"export_bytes\":%u,\"export_us\":%.2f,\"find_us\":%.2f,\"validate_us\":%.2f,"
+           "\"stack_depth\":%u,\"stack_bytes\":%zu,\"ok\":%s}\n",
+           name, items, status == MENU_WALK_DONE ? "done" : status == MENU_WALK_OVERFLOW ? "overflow" : "stopped",
+           (double)walk_ns / visits, (double)recursive_ns / visits, length,
+           (double)export_ns / s_walk_repeat / 1000.0, (double)find_ns / s_walk_repeat / 1000.0,
+           (double)validate_ns / s_walk_repeat / 1000.0, (uint32_t)MENU_WALK_DEPTH,
+           sizeof(menu_walk_frame_t) * MENU_WALK_DEPTH, ok ? "true" : "false");
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_free_items();
+#endif
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
+
+    return ok;
+}
+
+int main(int argc, char *argv[])
+{
+    for (int i = 1; i < argc; i++)
+    {
+        if (strcmp(argv[i], "--repeat") == 0 && i + 1 < argc)
+        {
+            s_walk_repeat = (uint32_t)strtoul(argv[++i], NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "usage: %s [--repeat N]\n", argv[0]);
+            return 1;
+        }
+    }
+
+    int failed = 0;
+    failed += !s_walk_run("wide", s_walk_build_wide(), 0);
+    failed += !s_walk_run("deep", s_walk_build_chain(MENU_WALK_DEPTH), 0);
+    failed += !s_walk_run("overflow", s_walk_build_chain(MENU_WALK_DEPTH + 1), 1);
+
+    return failed ? 1 : 0;
+}
@@ -0,0 +1,41 @@
+# Проверка ROM/RAM бюджета библиотеки движка меню по секциям.
+# Вызывается после сборки MenuEngine:
+#   cmake -DSIZE_TOOL=size -DLIBRARY=libMenuEngine.a -DRAM_BUDGET=0 -DROM_BUDGET=0 -P footprint.cmake
+# ROM = text + data (инициализаторы хранятся во флеше), RAM = data + bss.
+
+if(NOT SIZE_TOOL)
+    message(WARNING "menu footprint: size tool not found, ROM/RAM budgets are not checked")
+    return()
+endif()
+
+execute_process(
+    COMMAND ${SIZE_TOOL} -t ${LIBRARY}
+    OUTPUT_VARIABLE SIZE_OUTPUT
+    RESULT_VARIABLE SIZE_RESULT
+    )
+
+if(NOT SIZE_RESULT EQUAL 0)
+    message(FATAL_ERROR "menu footprint: '${SIZE_TOOL} -t ${LIBRARY}' failed")
+endif()
+
+string(REGEX MATCH "[ \t]*([0-9]+)[ \t]+([0-9]+)[ \t]+([0-9]+)[ \t]+[0-9]+[ \t]+[0-9a-fA-F]+[ \t]+\\(TOTALS\\)" TOTALS "${SIZE_OUTPUT}")
+if(NOT TOTALS)
+    message(FATAL_ERROR "menu footprint: cannot parse output of ${SIZE_TOOL}:\n${SIZE_OUTPUT}")
+endif()
+
+set(TEXT ${CMAKE_MATCH_1})
+set(DATA ${CMAKE_MATCH_2})
+set(BSS  ${CMAKE_MATCH_3})
+math(EXPR ROM "${TEXT} + ${DATA}")
+math(EXPR RAM "${DATA} + ${BSS}")
+
+get_filename_component(LIBRARY_NAME ${LIBRARY} NAME)
+message(STATUS "menu footprint (${LIBRARY_NAME}): ROM ${ROM} bytes (text ${TEXT} + data ${DATA}), RAM ${RAM} bytes (data ${DATA} + bss ${BSS})")
+
+if(ROM_BUDGET GREATER 0 AND ROM GREATER ROM_BUDGET)
+    message(FATAL_ERROR "menu footprint: ROM ${ROM} bytes exceeds MENU_ROM_BUDGET ${ROM_BUDGET}")
+endif()
+
+if(RAM_BUDGET GREATER 0 AND RAM GREATER RAM_BUDGET)
+    message(FATAL_ERROR "menu footprint: static RAM ${RAM} bytes exceeds MENU_RAM_BUDGET ${RAM_BUDGET}")
+endif()
@@ -1,4 +1,7 @@
 #include "console.h"
+#include "menu.h"
+#include "menu_latency.h"
+#include "menu_trace.h"
 
 #include <stdio.h>
 #include <unistd.h>
@@ -68,6 +71,10 @@ void disableRawMode() {
  * - На каждом шаге функция считывает символ с помощью `getKeyPress()`.
  * - Если введённый символ соответствует клавише 'Esc' ('\033'), цикла завершает выполнение.
  * - Если символ — это 'Enter' (значения 13 или 10), вызывается `push_button_callback_func`.
+ * - Если символ — 't' и включён бортовой самописец (`MENU_TRACE_ENABLE`), кольцо сохраняется
+ *   в файл `menu_trace.bin`.
+ * - Если символ — '/', следующая клавиша передаётся в `Menu_JumpKey()`: переход к пункту
+ *   текущего кольца, заголовок которого начинается с этой буквы.
  * - Если символ — это начало управляющей последовательности ('\033'), далее анализируется,
  *   какой именно стрелкой закончилась последовательность:
  *   - 'A' — стрелка вверх: текущая переменная уменьшает значение на 2.
@@ -77,6 +84,7 @@ void disableRawMode() {
  */
 void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func) {
     uint32_t current = 0;
+    int jump = 0; // После '/' следующая клавиша -- буква быстрого перехода
     char buf[3];
 
     while (1) {
@@ -89,15 +97,30 @@ void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_bu
             exit(EXIT_FAILURE);
         }
 
+        MENU_LATENCY_BEGIN(); // Событие поступило: отсюда считается задержка до вывода кадра
+
         if (n == 1 && buf[0] == '\033') {  // Выход при нажатии клавиши Esc
             break;
+        } else if (n == 1 && jump) {
+            jump = 0;
+            Menu_JumpKey(buf[0]);
         } else if (n == 1) { 
             switch (buf[0])
             {
+                case '/':
+                    jump = 1;
+                    break;
                 case 'd':
                 case 'D':
-                    long_push_button_callback_func ();
+                    if (long_push_button_callback_func)
+                        long_push_button_callback_func ();
+                    break;
+#if (MENU_TRACE_ENABLE != 0)
+                case 't':
+                case 'T':
+                    menu_trace_dump("menu_trace.bin");
                     break;
+#endif
                 case 10:
                 case 13:
                     push_button_callback_func      ();
@@ -133,7 +156,8 @@ void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_bu
  * @brief Выводит текстовое меню на экран, обновляя содержимое консоли.
  *
  * Функция очищает экран, затем выводит два переданных строковых параметра в качестве
- * пунктов меню, где первый пункт выделяется символом ">".
+ * пунктов меню, где первый пункт выделяется символом ">". С MENU_POSITION_INDICATOR в заголовке --
+ * позиция текущего пункта в кольце и количество пунктов (Menu_Position).
  *
  * @param str1 Строка, представляющая первый пункт меню, который будет выделен в интерфейсе.
  * @param str2 Строка, представляющая второй пункт меню.
@@ -143,9 +167,35 @@ void printMenu(const char *str1, const char *str2)
     printf("\033[H\033[J"); // Экранированные последовательности ANSI для очистки экрана.
                             // \033[H - перемещает курсор в верхний левый угол экрана (1,1).
                             // \033[J - очищает экран от курсора до конца. Вместе это стирает весь экран.
+#if (MENU_POSITION_INDICATOR > 0)
+    uint32_t count    = 0;
+    uint32_t position = Menu_Position(&count); // Позиция в кольце, "3/17"
+    printf("Для выхода нажмите Esc    %u/%u\r\n", position, count);
+#else
+    printf("Для выхода нажмите Esc\r\n");
+#endif
+
+    // Заголовок занимает до MENU_ITEM_TITLE_LEN байт и может быть не завершён нулём (strncpy
+    // заполняет поле целиком), бегущая строка передаёт указатель внутрь длинного текста
+    printf("> %.*s\r\n", MENU_ITEM_TITLE_LEN, str1); // Выводит первый пункт меню с символом ">", обозначающим его выбор или акцент.
+                                                    // \r\n используется для перевода строки и возвращения каретки.
+    printf("%.*s\r\n", MENU_ITEM_TITLE_LEN, str2);   // Выводит второй пункт меню без какого-либо выделения.
+}
+
+/**
+ * @brief Вывод в режиме MENU_BREADCRUMB: путь к текущему кольцу и выбранный пункт.
+ */
+void printMenuHeader(const char *header, const char *str)
+{
+    printf("\033[H\033[J");
+#if (MENU_POSITION_INDICATOR > 0)
+    uint32_t count    = 0;
+    uint32_t position = Menu_Position(&count);
+    printf("Для выхода нажмите Esc    %u/%u\r\n", position, count);
+#else
     printf("Для выхода нажмите Esc\r\n");
+#endif
 
-    printf("> %s\r\n", str1); // Выводит первый пункт меню с символом ">", обозначающим его выбор или акцент.
-                              // \r\n используется для перевода строки и возвращения каретки.
-    printf("%s\r\n", str2);   // Выводит второй пункт меню без какого-либо выделения.
+    printf("%s\r\n", header);
+    printf("> %.*s\r\n", MENU_ITEM_TITLE_LEN, str);
 }
@@ -9,6 +9,7 @@ typedef void (* long_push_buttont_callback_t) (void);
 
 int getKeyPress(void);
 void printMenu(const char *str1, const char *str2);
+void printMenuHeader(const char *header, const char *str); ///< Вывод в режиме MENU_BREADCRUMB: путь и выбранный пункт
 void taskReadKey(rotary_encoder_callback_t rotary_encoder_callback_func, push_button_callback_t push_button_callback_func, long_push_buttont_callback_t long_push_button_callback_func);
 
 #endif //__CONSOLE_H
\ No newline at end of file
@@ -0,0 +1,83 @@
+#include <stdint.h>
+
+#ifndef __LCD1602_H__
+#define __LCD1602_H__
+
+#define LCD1602_COLS 16 ///< Количество символов в строке
+#define LCD1602_ROWS 2  ///< Количество строк
+
+#define LCD1602_CMD_CLEAR        0x01 ///< Очистка дисплея (медленная команда)
+#define LCD1602_CMD_HOME         0x02 ///< Возврат курсора (медленная команда)
+#define LCD1602_CMD_ENTRY_MODE   0x04 ///< Режим ввода: | 0x02 -- инкремент адреса, | 0x01 -- сдвиг дисплея
+#define LCD1602_CMD_DISPLAY      0x08 ///< Управление дисплеем: | 0x04 -- включить, | 0x02 -- курсор, | 0x01 -- мигание
+#define LCD1602_CMD_SHIFT        0x10 ///< Сдвиг: | 0x08 -- дисплей (иначе курсор), | 0x04 -- вправо
+#define LCD1602_CMD_FUNCTION_SET 0x20 ///< Разрядность шины, число строк, шрифт
+#define LCD1602_CMD_SET_CGRAM    0x40 ///< Адрес CGRAM
+#define LCD1602_CMD_SET_DDRAM    0x80 ///< Адрес DDRAM
+
+#define LCD1602_ROW1_ADDR 0x40 ///< Адрес DDRAM начала второй строки
+
+#define LCD1602_EXEC_US      37   ///< Время выполнения команды или записи данных
+#define LCD1602_EXEC_SLOW_US 1520 ///< Время выполнения CLEAR и HOME
+
+#define LCD1602_CGRAM_SLOTS   8    ///< Знакомест в CGRAM (5x8)
+#define LCD1602_CGRAM_CODE    0x08 ///< Код первого знака CGRAM: 0x08..0x0F -- копии 0x00..0x07, без нуля в строке
+#define LCD1602_CHARSET_MISS  '?'  ///< Код символа, которого нет ни в ПЗУ, ни в свободной CGRAM
+
+/**
+ * @brief Запись байта на шину HD44780.
+ * @param value Команда или символ.
+ * @param rs 0 -- регистр команд, 1 -- регистр данных.
+ */
+typedef void (*lcd1602_bus_write_t) (uint8_t value, uint8_t rs);
+
+/**
+ * @brief Стратегии перерисовки кадра.
+ */
+typedef enum {
+    LCD1602_RENDER_CLEAR,   ///< CLEAR и запись обеих строк целиком
+    LCD1602_RENDER_REWRITE, ///< Установка адреса и запись обеих строк целиком, без CLEAR
+    LCD1602_RENDER_DIFF,    ///< Запись только изменившихся символов по теневому буферу
+    LCD1602_RENDER_COUNT
+} lcd1602_render_t;
+
+/**
+ * @brief Знакогенератор ПЗУ контроллера.
+ */
+typedef enum {
+    LCD1602_ROM_A00,      ///< Стандартный HD44780 A00: латиница и катакана, кириллица -- похожие латинские буквы и CGRAM
+    LCD1602_ROM_CYRILLIC, ///< Русифицированный (WH1602, MT-16S2): вся кириллица в 0xA0..0xE6
+    LCD1602_ROM_COUNT
+} lcd1602_rom_t;
+
+typedef char lcd1602_frame_t[LCD1602_ROWS][LCD1602_COLS + 1]; ///< Кадр 16x2, строки завершены нулём
+
+/**
+ * @typedef lcd1602_stat_t
+ * @brief Счётчики трафика шины с момента последнего lcd1602_stat_reset.
+ */
+typedef struct {
+    uint32_t commands;      ///< Записано команд (RS = 0)
+    uint32_t slow_commands; ///< Из них CLEAR/HOME
+    uint32_t data;          ///< Записано байт данных (RS = 1)
+    uint32_t exec_us;       ///< Суммарное время выполнения контроллером, мкс
+} lcd1602_stat_t;
+
+void lcd1602_init        (lcd1602_bus_write_t write, lcd1602_render_t render);
+void lcd1602_set_render  (lcd1602_render_t render);
+void lcd1602_command     (uint8_t command);
+void lcd1602_data        (uint8_t value);
+void lcd1602_compose     (lcd1602_frame_t frame, const char *str1, const char *str2);
+void lcd1602_show        (const lcd1602_frame_t frame);
+void lcd1602_print_menu  (const char *str1, const char *str2);
+void lcd1602_print_header (const char *header, const char *str);
+const lcd1602_stat_t *lcd1602_stat (void);
+void lcd1602_stat_reset  (void);
+
+void     lcd1602_charset_init (lcd1602_rom_t rom);
+uint32_t lcd1602_transcode    (char *dst, uint32_t size, const char *src);
+uint32_t lcd1602_cgram_used   (void);
+uint32_t lcd1602_charset_missing (void);
+void     lcd1602_cgram_load   (void);
+
+#endif // __LCD1602_H__
@@ -4,11 +4,90 @@
 #define __MENU_H__
 
 #define MENU_ITEM_TITLE_LEN 0x10 ///< Максимальная длина строки элемента меню (16 символов)
+#ifndef MENU_SIZE
 #define MENU_SIZE           0x20 ///< Максимальное значение для размера меню (использутеся для статического массива)
+#endif
 #define ENCODER_INPUT_FILTER   2 ///< Значение фильтра Rotary Encode
+#ifndef MENU_VIRTUAL_LISTS
+#define MENU_VIRTUAL_LISTS     0 ///< Максимальное количество виртуальных списков (дескрипторы в статической памяти), 0 -- без них
+#endif
+#ifndef MENU_LAZY_SUBMENUS
+#define MENU_LAZY_SUBMENUS     0 ///< Максимальное количество отложенных подменю (построители в статической памяти), 0 -- без них
+#endif
+#ifndef MENU_PREDICATES
+#define MENU_PREDICATES        0 ///< Максимальное количество условий видимости (s_menu_add_predicate), 0 -- без условий
+#endif
+#ifndef MENU_HIDDEN_ITEMS
+#define MENU_HIDDEN_ITEMS     (MENU_PREDICATES > 0) ///< 1 -- скрытые пункты (s_menu_set_visible): полное кольцо `sibling_prev`/`sibling_next`
+#endif
+#ifndef MENU_PREDICATE_DEPS
+#define MENU_PREDICATE_DEPS   (2 * MENU_PREDICATES) ///< Максимальное количество зависимостей условий от значений пунктов
+#endif
+#ifndef MENU_CURSOR_MEMORY
+#define MENU_CURSOR_MEMORY     0 ///< 1 -- вход в подменю продолжается с пункта, на котором из него вышли (поле `resume`)
+#endif
+#ifndef MENU_POSITION_INDICATOR
+#define MENU_POSITION_INDICATOR 0 ///< 1 -- позиция пункта в кольце и число пунктов (Menu_Position, "3/17")
+#endif
+#ifndef MENU_REGION_ITEMS
+#define MENU_REGION_ITEMS      0 ///< Пунктов в блоке области отложенного подменю (0 -- без областей, пункт -- отдельный malloc)
+#endif
+#ifndef MENU_STRINGS
+#define MENU_STRINGS           0 ///< Строк в таблице языка (s_menu_add_string, Menu_SetLanguage), 0 -- без таблиц
+#endif
+#ifndef MENU_STRINGS_PACKED
+#define MENU_STRINGS_PACKED    0 ///< 1 -- таблицы языков могут быть сжаты словарём (Menu_SetLanguagePacked, tools/title_pack.c)
+#endif
+#ifndef MENU_PACKED_LINES
+#define MENU_PACKED_LINES      4 ///< Распакованных заголовков в кэше (кадр читает два, путь и поиск -- по одному)
+#endif
+#ifndef MENU_MARQUEE_TITLES
+#define MENU_MARQUEE_TITLES    0 ///< Длинных заголовков во внешней памяти (s_menu_add_long, бегущая строка), 0 -- без них
+#endif
+#ifndef MENU_MARQUEE_WIDTH
+#define MENU_MARQUEE_WIDTH    14 ///< Видимых знаков заголовка выбранного пункта (LCD1602: "> " и 14 знаков)
+#endif
+#ifndef MENU_MARQUEE_STEP_MS
+#define MENU_MARQUEE_STEP_MS 300 ///< Период сдвига бегущей строки на один знак, мс (Menu_Tick)
+#endif
+#ifndef MENU_MARQUEE_HOLD
+#define MENU_MARQUEE_HOLD      3 ///< Шагов паузы бегущей строки в начале и в конце текста
+#endif
+#ifndef MENU_BREADCRUMB
+#define MENU_BREADCRUMB        0 ///< 1 -- первая строка -- путь к текущему кольцу ("Opt>PWM>Freq"), вторая -- выбранный пункт (printMenuHeader)
+#endif
+#ifndef MENU_BREADCRUMB_WIDTH
+#define MENU_BREADCRUMB_WIDTH 16 ///< Знаков строки пути (ширина дисплея)
+#endif
+#ifndef MENU_BREADCRUMB_DEPTH
+#define MENU_BREADCRUMB_DEPTH  8 ///< Уровней пути, которые хранятся для пошагового обновления; внешние сверх них -- '<'
+#endif
+#ifndef MENU_BREADCRUMB_ROOT
+#define MENU_BREADCRUMB_ROOT "Menu" ///< Строка пути в корневом кольце
+#endif
+#ifndef MENU_TITLE_CHARSET
+#define MENU_TITLE_CHARSET     0 ///< 1 -- заголовки UTF-8 перекодируются в коды HD44780 при добавлении (lcd1602_transcode)
+#endif
+#ifndef MENU_WALK_DEPTH
+#define MENU_WALK_DEPTH        8 ///< Ёмкость стека обхода дерева (s_menu_walk): уровней вложенности подменю
+#endif
+#ifndef MENU_SEARCH
+#define MENU_SEARCH            0 ///< 1 -- поиск по заголовкам (s_menu_search) и список результатов (s_menu_search_show)
+#endif
+#ifndef MENU_FUZZY
+#define MENU_FUZZY             0 ///< 1 -- нечёткий поиск по путям (s_menu_fuzzy) и его индекс
+#endif
+#ifndef MENU_JUMP_INDEX
+#define MENU_JUMP_INDEX        0 ///< Записей индекса быстрого перехода, пар (кольцо, буква); степень двойки, 0 -- без индекса (обход кольца)
+#endif
+#define MENU_VIRTUAL_WINDOW    3 ///< Пунктов в окне виртуального списка: текущий и по одному соседу с каждой стороны
 
+#ifndef MENU_STATIC_MEMORY
 #define MENU_STATIC_MEMORY  0 ///< Использовать статический массив
+#endif
+#ifndef MENU_DYNAMIC_MEMORY
 #define MENU_DYNAMIC_MEMORY 1 ///< Использовать динамический массив
+#endif
 
 #define MENU_USAGE_STATIC_MEMORY 1
 #define MENU_USAGE_DYNAMIC_MEMORY 2
@@ -21,11 +100,73 @@
 #define MENU_USAGE_MEMORY MENU_USAGE_DYNAMIC_MEMORY
 #endif
 
+/**
+ * Бюджеты памяти цели в байтах (0 -- без проверки). Задаются при сборке, например
+ * `cmake -DMENU_RAM_BUDGET=2048 -DMENU_ROM_BUDGET=8192`.
+ * RAM проверяется при компиляции menu.c (MENU_SIZE пунктов, состояние меню, буферы
+ * самописца и гистограмм), ROM и итоговая RAM по секциям -- после сборки MenuEngine.
+ */
+#ifndef MENU_RAM_BUDGET
+#define MENU_RAM_BUDGET 0
+#endif
+#ifndef MENU_ROM_BUDGET
+#define MENU_ROM_BUDGET 0
+#endif
+
+#if defined(MENU_ALLOC_HOOKS)
+#include <stddef.h>
+void *menu_hook_malloc (size_t size); ///< Подменяет malloc (например, для подсчёта выделений в бенчмарке)
+void  menu_hook_free   (void *ptr);   ///< Подменяет free
+#define MENU_MALLOC(size) menu_hook_malloc(size)
+#define MENU_FREE(ptr)    menu_hook_free(ptr)
+#else
+#define MENU_MALLOC(size) malloc(size)
+#define MENU_FREE(ptr)    free(ptr)
+#endif
+
 #define MENU_FLAG_GOTO_PARENT 0x80
 #define MENU_FLAG_EDIT_DATA   0x40
 #define MENU_FLAG_GOTO_CHILD  0x20
 #define MNUE_FLAG_GOTO_CBFUNC 0x10
+#define MENU_FLAG_LAZY        0x04 ///< Дочерняя цепочка строится при первом входе (s_menu_add_lazy)
+#define MENU_FLAG_VIRTUAL     0x08 ///< Пункт окна виртуального списка (заполняется источником записей)
+#define MENU_FLAG_HIDDEN      0x02 ///< Пункт скрыт: не входит в кольцо навигации (s_menu_set_visible)
+#define MENU_FLAG_DISABLED    0x01 ///< Пункт виден, но нажатие и callback не выполняются (s_menu_set_enabled)
+
+typedef char menu_string_t[MENU_ITEM_TITLE_LEN]; ///< Строка таблицы языка: заголовок целиком, как поле пункта
+
+#define MENU_PACKED_TOKENS    128  ///< Фрагментов в словаре: коды 0x80..0xFF
+#define MENU_PACKED_TOKEN_LEN 8    ///< Наибольшая длина фрагмента; фрагмент копируется за одну запись 8 байт
+#define MENU_PACKED_ESCAPE    0x7F ///< Следующий байт -- знак как есть (коды 0x7F..0xFF дисплея)
+
+/**
+ * @typedef menu_packed_t
+ * @brief Таблица строк языка, сжатая словарём фрагментов (строится tools/title_pack.c по списку заголовков).
+ *
+ * Строка i -- коды `codes[offsets[i]] .. codes[offsets[i + 1] - 1]`: код 0x00..0x7E -- знак,
+ * 0x80 + n -- фрагмент n словаря, MENU_PACKED_ESCAPE -- следующий байт как есть.
+ */
+typedef struct {
+    const uint8_t  *codes;   ///< Коды всех строк подряд
+    const uint16_t *offsets; ///< Начала строк, `count + 1` записей
+    const char    (*tokens)[MENU_PACKED_TOKEN_LEN]; ///< Фрагменты словаря (дополнены нулями)
+    const uint8_t  *lengths; ///< Длины фрагментов
+    uint16_t        count;   ///< Строк в таблице
+} menu_packed_t;
 
 void Menu_Init(void);
+void Menu_JumpKey(char key); ///< Переход к пункту текущего кольца по первой букве заголовка
+#if (MENU_POSITION_INDICATOR > 0)
+uint32_t Menu_Position(uint32_t *count); ///< Позиция текущего пункта в кольце и число пунктов ("3/17")
+#endif
+#if (MENU_MARQUEE_TITLES > 0)
+void Menu_Tick(uint32_t now_ms); ///< Шаг бегущей строки выбранного пункта; вызывается в контексте обработчиков ввода, не из прерывания
+#endif
+#if (MENU_STRINGS > 0)
+void Menu_SetLanguage(const menu_string_t *strings); ///< Таблица строк языка (MENU_STRINGS строк в ПЗУ) и перерисовка
+#if MENU_STRINGS_PACKED
+void Menu_SetLanguagePacked(const menu_packed_t *packed); ///< Сжатая таблица строк языка и перерисовка
+#endif
+#endif
 
 #endif // __MENU_H__
\ No newline at end of file
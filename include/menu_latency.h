@@ -0,0 +1,82 @@
+#include <stdint.h>
+
+#ifndef __MENU_LATENCY_H__
+#define __MENU_LATENCY_H__
+
+/**
+ * Измерение задержки от входного события (шаг энкодера, нажатие) до вывода кадра.
+ *
+ * Источник ввода вызывает MENU_LATENCY_BEGIN() в момент поступления события, движок меню
+ * отмечает стадии MENU_LATENCY_MARK(). Для каждой стадии хранится гистограмма в стиле HDR
+ * (логарифмически-линейные корзины) фиксированного размера.
+ *
+ * При MENU_LATENCY_ENABLE == 0 макросы раскрываются в пустые выражения, а menu_latency.c
+ * компилируется в пустой объект.
+ */
+
+#ifndef MENU_LATENCY_ENABLE
+#define MENU_LATENCY_ENABLE   0  ///< Включить сбор гистограмм задержки
+#endif
+
+#ifndef MENU_LATENCY_SUB_BITS
+#define MENU_LATENCY_SUB_BITS 3  ///< 2^N корзин на каждую степень двойки (точность ~ 1/2^N)
+#endif
+
+#define MENU_LATENCY_SUB_COUNT (1u << MENU_LATENCY_SUB_BITS)
+#define MENU_LATENCY_BUCKETS   ((33u - MENU_LATENCY_SUB_BITS) * MENU_LATENCY_SUB_COUNT) ///< Покрывает весь диапазон uint32_t
+
+/**
+ * @brief Стадии обработки события. Каждая стадия измеряется от предыдущей отметки.
+ */
+typedef enum {
+    MENU_LATENCY_DISPATCH, ///< Поступление события -> вход в обработчик меню
+    MENU_LATENCY_CALLBACK, ///< Вход в обработчик -> возврат из колбэка пункта меню
+    MENU_LATENCY_RENDER,   ///< Предыдущая отметка -> начало отрисовки
+    MENU_LATENCY_FLUSH,    ///< Начало отрисовки -> кадр выведен
+    MENU_LATENCY_TOTAL,    ///< Поступление события -> кадр выведен
+    MENU_LATENCY_STAGES
+} menu_latency_stage_t;
+
+/**
+ * @typedef menu_latency_hist_t
+ * @brief Гистограмма одной стадии. Единицы -- тики MENU_LATENCY_NOW() (на хосте наносекунды).
+ */
+typedef struct {
+    uint32_t count;                         ///< Количество отсчётов
+    uint32_t min;                           ///< Минимальное значение
+    uint32_t max;                           ///< Максимальное значение
+    uint64_t sum;                           ///< Сумма значений (для среднего)
+    uint32_t buckets[MENU_LATENCY_BUCKETS]; ///< Счётчики корзин
+} menu_latency_hist_t;
+
+typedef void (*menu_latency_write_t) (const char *line); ///< Вывод одной строки отчёта
+
+#if (MENU_LATENCY_ENABLE != 0)
+#define MENU_LATENCY_RAM_BYTES (MENU_LATENCY_STAGES * sizeof(menu_latency_hist_t) + 16u) ///< Гистограммы и состояние
+#else
+#define MENU_LATENCY_RAM_BYTES 0u
+#endif
+
+#if (MENU_LATENCY_ENABLE != 0)
+
+void     menu_latency_begin      (void);
+void     menu_latency_mark       (menu_latency_stage_t stage);
+void     menu_latency_end        (void);
+void     menu_latency_reset      (void);
+uint32_t menu_latency_percentile (menu_latency_stage_t stage, uint32_t permille);
+const menu_latency_hist_t *menu_latency_get (menu_latency_stage_t stage);
+void     menu_latency_dump       (menu_latency_write_t write);
+
+#define MENU_LATENCY_BEGIN()      menu_latency_begin()
+#define MENU_LATENCY_MARK(stage)  menu_latency_mark(stage)
+#define MENU_LATENCY_END()        menu_latency_end()
+
+#else
+
+#define MENU_LATENCY_BEGIN()      ((void)0)
+#define MENU_LATENCY_MARK(stage)  ((void)0)
+#define MENU_LATENCY_END()        ((void)0)
+
+#endif
+
+#endif // __MENU_LATENCY_H__
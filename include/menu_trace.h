@@ -0,0 +1,115 @@
+#include <stdint.h>
+
+#ifndef __MENU_TRACE_H__
+#define __MENU_TRACE_H__
+
+/**
+ * Бортовой самописец меню: кольцевой буфер компактных двоичных записей.
+ *
+ * Запись -- одно 32-битное слово: [31..24] событие, [23..16] аргумент, [15..0] приращение
+ * времени от предыдущей записи в тиках MENU_TRACE_NOW(). Если приращение не помещается
+ * в 16 бит, перед записью добавляется MENU_TRACE_EV_TIME со старшими битами.
+ *
+ * Запись в буфер без блокировок: слот резервируется атомарным инкрементом индекса, а сама
+ * запись -- одна атомарная 32-битная операция, поэтому писать можно и из прерываний, и из потоков.
+ * Рядом с каждым слотом хранится номер слота его записи: снимок пропускает слоты, писатель
+ * которых ещё не закончил, и после переполнения кольца не выдаёт запись прошлого круга.
+ * При одновременной записи порядок слотов может отличаться от порядка отметок времени
+ * на одно-два событие, сумма приращений при этом остаётся верной.
+ *
+ * Формат файла дампа: заголовок menu_trace_file_header_t, затем записи от старой к новой.
+ * Расшифровка на хосте: tools/trace_decode.c (цель MenuTraceDecode).
+ */
+
+#ifndef MENU_TRACE_ENABLE
+#define MENU_TRACE_ENABLE 0     ///< Включить бортовой самописец
+#endif
+
+#ifndef MENU_TRACE_SIZE
+#define MENU_TRACE_SIZE   256   ///< Количество записей в кольце (степень двойки)
+#endif
+
+#ifndef MENU_TRACE_TICK_NS
+#define MENU_TRACE_TICK_NS 1000 ///< Длительность тика MENU_TRACE_NOW() в наносекундах (записывается в дамп)
+#endif
+
+#if (MENU_TRACE_SIZE & (MENU_TRACE_SIZE - 1)) != 0
+#error "MENU_TRACE_SIZE must be a power of two"
+#endif
+
+#define MENU_TRACE_MAGIC   0x4352544Du ///< "MTRC"
+#define MENU_TRACE_VERSION 1
+
+/**
+ * @brief Коды событий.
+ */
+typedef enum {
+    MENU_TRACE_EV_EMPTY = 0,      ///< Незаполненный слот
+    MENU_TRACE_EV_TIME,           ///< Расширение времени: аргумент и приращение -- старшие 24 бита следующего приращения
+    MENU_TRACE_EV_INPUT,          ///< Входное событие, аргумент -- menu_trace_input_t
+    MENU_TRACE_EV_NAV,            ///< Смена текущего пункта, аргумент -- menu_trace_nav_t
+    MENU_TRACE_EV_CALLBACK_BEGIN, ///< Вызов колбэка пункта меню
+    MENU_TRACE_EV_CALLBACK_END,   ///< Возврат из колбэка
+    MENU_TRACE_EV_RENDER,         ///< Отрисовка кадра, аргумент -- первый символ заголовка
+    MENU_TRACE_EV_PERSIST,        ///< Сохранение настроек (аргумент задаёт приложение)
+    MENU_TRACE_EV_USER,           ///< Событие приложения
+    MENU_TRACE_EV_COUNT
+} menu_trace_event_t;
+
+typedef enum {
+    MENU_TRACE_INPUT_ROTATE_NEXT = 0,
+    MENU_TRACE_INPUT_ROTATE_PREV,
+    MENU_TRACE_INPUT_PUSH,
+    MENU_TRACE_INPUT_LONG_PUSH,
+    MENU_TRACE_INPUT_JUMP,
+} menu_trace_input_t;
+
+typedef enum {
+    MENU_TRACE_NAV_NEXT = 0,
+    MENU_TRACE_NAV_PREV,
+    MENU_TRACE_NAV_CHILD,
+    MENU_TRACE_NAV_PARENT,
+    MENU_TRACE_NAV_START,
+    MENU_TRACE_NAV_JUMP,
+} menu_trace_nav_t;
+
+/**
+ * @typedef menu_trace_file_header_t
+ * @brief Заголовок файла дампа. Все поля little-endian.
+ */
+typedef struct {
+    uint32_t magic;   ///< MENU_TRACE_MAGIC
+    uint32_t version; ///< MENU_TRACE_VERSION
+    uint32_t tick_ns; ///< Длительность тика
+    uint32_t count;   ///< Количество записей после заголовка
+} menu_trace_file_header_t;
+
+#define MENU_TRACE_RECORD(event, arg, delta) \
+    (((uint32_t)(event) << 24) | ((uint32_t)((arg) & 0xFFu) << 16) | ((uint32_t)(delta) & 0xFFFFu))
+#define MENU_TRACE_RECORD_EVENT(record) ((uint8_t)((record) >> 24))
+#define MENU_TRACE_RECORD_ARG(record)   ((uint8_t)((record) >> 16))
+#define MENU_TRACE_RECORD_DELTA(record) ((uint16_t)(record))
+
+#if (MENU_TRACE_ENABLE != 0)
+#define MENU_TRACE_RAM_BYTES (2u * MENU_TRACE_SIZE * sizeof(uint32_t) + 8u) ///< Кольцо, номера слотов, индекс и время последней записи
+#else
+#define MENU_TRACE_RAM_BYTES 0u
+#endif
+
+#if (MENU_TRACE_ENABLE != 0)
+
+void     menu_trace_write    (menu_trace_event_t event, uint8_t arg);
+uint32_t menu_trace_snapshot (uint32_t *records, uint32_t capacity);
+int      menu_trace_dump     (const char *path);
+void     menu_trace_install_crash_dump (const char *path);
+void     menu_trace_reset    (void);
+
+#define MENU_TRACE(event, arg) menu_trace_write((event), (uint8_t)(arg))
+
+#else
+
+#define MENU_TRACE(event, arg) ((void)0)
+
+#endif
+
+#endif // __MENU_TRACE_H__
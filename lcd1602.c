@@ -0,0 +1,187 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "lcd1602.h"
+
+/**
+ * Драйвер дисплея HD44780 (LCD1602) поверх абстрактной шины.
+ *
+ * Отвечает только за то, какие байты и в каком порядке попадают на шину; передача
+ * (4-битная параллельная шина, PCF8574 по I2C и т.д.) реализуется функцией lcd1602_bus_write_t.
+ * Хранит теневой буфер того, что сейчас на экране, и счётчики трафика.
+ */
+
+/**
+ * @typedef lcd1602_handle_t
+ * @brief Состояние дисплея.
+ */
+typedef struct {
+    lcd1602_bus_write_t write;   ///< Запись байта на шину
+    lcd1602_render_t    render;  ///< Текущая стратегия перерисовки
+    lcd1602_frame_t     shadow;  ///< Содержимое DDRAM видимой области
+    uint8_t             address; ///< Счётчик адреса DDRAM (0xFF -- неизвестен)
+    lcd1602_stat_t      stat;    ///< Счётчики трафика
+} lcd1602_handle_t;
+
+static lcd1602_handle_t s_lcd1602;
+
+void lcd1602_command (uint8_t command)
+{
+    s_lcd1602.write(command, 0);
+    s_lcd1602.stat.commands++;
+
+    if (command == LCD1602_CMD_CLEAR || (command & 0xFE) == LCD1602_CMD_HOME)
+    {
+        s_lcd1602.stat.slow_commands++;
+        s_lcd1602.stat.exec_us += LCD1602_EXEC_SLOW_US;
+        s_lcd1602.address = 0;
+    }
+    else
+    {
+        s_lcd1602.stat.exec_us += LCD1602_EXEC_US;
+        if (command & LCD1602_CMD_SET_DDRAM)
+        {
+            s_lcd1602.address = command & 0x7F;
+        }
+        else if ((command & 0xC0) == LCD1602_CMD_SET_CGRAM)
+        {
+            s_lcd1602.address = 0xFF; // Дальнейшие данные идут в CGRAM
+        }
+    }
+}
+
+void lcd1602_data (uint8_t value)
+{
+    s_lcd1602.write(value, 1);
+    s_lcd1602.stat.data++;
+    s_lcd1602.stat.exec_us += LCD1602_EXEC_US;
+
+    if (s_lcd1602.address != 0xFF)
+    {
+        s_lcd1602.address++;
+    }
+}
+
+/**
+ * @brief Инициализация контроллера: 4 бита, 2 строки, дисплей включён, курсор выключен, инкремент адреса.
+ */
+void lcd1602_init (lcd1602_bus_write_t write, lcd1602_render_t render)
+{
+    memset(&s_lcd1602, 0, sizeof(s_lcd1602));
+    s_lcd1602.write  = write;
+    s_lcd1602.render = render;
+
+    lcd1602_command(LCD1602_CMD_FUNCTION_SET | 0x08);
+    lcd1602_command(LCD1602_CMD_DISPLAY | 0x04);
+    lcd1602_command(LCD1602_CMD_ENTRY_MODE | 0x02);
+    lcd1602_command(LCD1602_CMD_CLEAR);
+
+    memset(s_lcd1602.shadow, ' ', sizeof(s_lcd1602.shadow));
+    s_lcd1602.shadow[0][LCD1602_COLS] = '\0';
+    s_lcd1602.shadow[1][LCD1602_COLS] = '\0';
+}
+
+void lcd1602_set_render (lcd1602_render_t render)
+{
+    s_lcd1602.render = render;
+}
+
+/**
+ * @brief Формирует кадр меню так же, как его выводит printMenu в консоли: "> str1" и "str2".
+ *        Строки обрезаются по ширине дисплея и дополняются пробелами.
+ */
+void lcd1602_compose (lcd1602_frame_t frame, const char *str1, const char *str2)
+{
+    snprintf(frame[0], sizeof(frame[0]), "> %-*.*s", LCD1602_COLS - 2, LCD1602_COLS - 2, str1 ? str1 : "");
+    snprintf(frame[1], sizeof(frame[1]), "%-*.*s", LCD1602_COLS, LCD1602_COLS, str2 ? str2 : "");
+}
+
+static void s_lcd1602_write_row (uint8_t row, const char *text)
+{
+    lcd1602_command(LCD1602_CMD_SET_DDRAM | (row ? LCD1602_ROW1_ADDR : 0));
+    for (uint8_t col = 0; col < LCD1602_COLS; col++)
+    {
+        lcd1602_data((uint8_t)text[col]);
+    }
+}
+
+/**
+ * @brief Дописывает только изменившиеся символы. Адрес устанавливается лишь перед разрывом
+ *        в последовательности изменений, дальше используется автоинкремент.
+ */
+static void s_lcd1602_write_diff (uint8_t row, const char *text)
+{
+    uint8_t base = row ? LCD1602_ROW1_ADDR : 0;
+
+    for (uint8_t col = 0; col < LCD1602_COLS; col++)
+    {
+        if (s_lcd1602.shadow[row][col] == text[col])
+            continue;
+
+        if (s_lcd1602.address != base + col)
+        {
+            lcd1602_command(LCD1602_CMD_SET_DDRAM | (base + col));
+        }
+        lcd1602_data((uint8_t)text[col]);
+    }
+}
+
+/**
+ * @brief Выводит кадр выбранной стратегией и обновляет теневой буфер.
+ */
+void lcd1602_show (const lcd1602_frame_t frame)
+{
+    switch (s_lcd1602.render)
+    {
+        case LCD1602_RENDER_CLEAR:
+            lcd1602_command(LCD1602_CMD_CLEAR);
+            s_lcd1602_write_row(0, frame[0]);
+            s_lcd1602_write_row(1, frame[1]);
+            break;
+        case LCD1602_RENDER_REWRITE:
+            s_lcd1602_write_row(0, frame[0]);
+            s_lcd1602_write_row(1, frame[1]);
+            break;
+        case LCD1602_RENDER_DIFF:
+        default:
+            s_lcd1602_write_diff(0, frame[0]);
+            s_lcd1602_write_diff(1, frame[1]);
+            break;
+    }
+
+    memcpy(s_lcd1602.shadow, frame, sizeof(s_lcd1602.shadow));
+}
+
+/**
+ * @brief Реализация printMenu для LCD1602: формирует кадр и выводит его.
+ */
+void lcd1602_print_menu (const char *str1, const char *str2)
+{
+    lcd1602_frame_t frame;
+
+    lcd1602_compose(frame, str1, str2);
+    lcd1602_show(frame);
+}
+
+/**
+ * @brief Реализация printMenuHeader для LCD1602: путь в первой строке, "> str" во второй.
+ *        При LCD1602_RENDER_DIFF неизменный путь (поворот внутри кольца) на шину не пишется.
+ */
+void lcd1602_print_header (const char *header, const char *str)
+{
+    lcd1602_frame_t frame;
+
+    snprintf(frame[0], sizeof(frame[0]), "%-*.*s", LCD1602_COLS, LCD1602_COLS, header ? header : "");
+    snprintf(frame[1], sizeof(frame[1]), "> %-*.*s", LCD1602_COLS - 2, LCD1602_COLS - 2, str ? str : "");
+    lcd1602_show(frame);
+}
+
+const lcd1602_stat_t *lcd1602_stat (void)
+{
+    return &s_lcd1602.stat;
+}
+
+void lcd1602_stat_reset (void)
+{
+    memset(&s_lcd1602.stat, 0, sizeof(s_lcd1602.stat));
+}
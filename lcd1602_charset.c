@@ -0,0 +1,367 @@
+#include <string.h>
+
+#include "lcd1602.h"
+
+/**
+ * Перекодировка UTF-8 в коды знакогенератора HD44780.
+ *
+ * Заголовки меню пишутся в UTF-8, а дисплей понимает один байт на знакоместо: код ПЗУ
+ * (A00 или русифицированного) либо 0x08..0x0F -- знак из CGRAM. Перекодировка выполняется
+ * один раз, при добавлении пункта (MENU_TITLE_CHARSET), поэтому 16 байт заголовка вмещают
+ * 16 знаков кириллицы, а не 8, и вывод кадра не тратит времени на UTF-8.
+ *
+ * Серии печатных ASCII копируются как есть: SSE2/NEON проверяют 16 байт за сравнение
+ * (LCD1602_CHARSET_SCALAR=1 отключает векторную ветку). Остальное декодируется и ищется
+ * в таблицах: кириллица U+0400..U+045F -- прямым индексом, прочие символы -- двоичным
+ * поиском. Если в ПЗУ знака нет, он рисуется в CGRAM: знакоместо занимается при первой
+ * встрече и держится до lcd1602_charset_init, загружает знаки lcd1602_cgram_load.
+ */
+
+#if !defined(LCD1602_CHARSET_SCALAR) && defined(__SSE2__)
+#include <emmintrin.h>
+#define LCD1602_CHARSET_SSE2 1
+#elif !defined(LCD1602_CHARSET_SCALAR) && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define LCD1602_CHARSET_NEON 1
+#endif
+
+#define LCD1602_CYRILLIC_FIRST 0x0400 ///< Первый код таблицы кириллицы
+#define LCD1602_CYRILLIC_COUNT 0x60   ///< Кодов в таблице кириллицы (U+0400..U+045F)
+#define LCD1602_ASCII_SHORT    2      ///< Серия ASCII короче -- без векторной проверки
+
+/**
+ * Коды ПЗУ кириллицы, 0 -- знака нет. В A00 буквы без похожей латинской рисуются в CGRAM,
+ * строчные -- знаком прописной (малые прописные), Ё -- как E.
+ */
+static const uint8_t s_lcd1602_cyrillic[LCD1602_ROM_COUNT][LCD1602_CYRILLIC_COUNT] = {
+    [LCD1602_ROM_A00] = {
+        0x00, 0x45, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // U+0400 ЀЁЂЃЄЅІЇЈЉЊЋЌЍЎЏ
+        0x41, 0x00, 0x42, 0x00, 0x00, 0x45, 0x00, 0x00, 0x00, 0x00, 0x4B, 0x00, 0x4D, 0x48, 0x4F, 0x00, // U+0410 АБВГДЕЖЗИЙКЛМНОП
+        0x50, 0x43, 0x54, 0x00, 0x00, 0x58, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // U+0420 РСТУФХЦЧШЩЪЫЬЭЮЯ
+        0x61, 0x00, 0x42, 0x00, 0x00, 0x65, 0x00, 0x00, 0x00, 0x00, 0x4B, 0x00, 0x4D, 0x48, 0x6F, 0x00, // U+0430 абвгдежзийклмноп
+        0x70, 0x63, 0x54, 0x79, 0x00, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // U+0440 рстуфхцчшщъыьэюя
+        0x00, 0x65, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // U+0450 ѐёђѓєѕіїјљњћќѝўџ
+    },
+    [LCD1602_ROM_CYRILLIC] = {
+        0x00, 0xA2, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // U+0400 ЀЁЂЃЄЅІЇЈЉЊЋЌЍЎЏ
+        0x41, 0xA0, 0x42, 0xA1, 0xE0, 0x45, 0xA3, 0xA4, 0xA5, 0xA6, 0x4B, 0xA7, 0x4D, 0x48, 0x4F, 0xA8, // U+0410 АБВГДЕЖЗИЙКЛМНОП
+        0x50, 0x43, 0x54, 0xA9, 0xAA, 0x58, 0xE1, 0xAB, 0xAC, 0xE2, 0xAD, 0xAE, 0x62, 0xAF, 0xB0, 0xB1, // U+0420 РСТУФХЦЧШЩЪЫЬЭЮЯ
+        0x61, 0xB2, 0xB3, 0xB4, 0xE3, 0x65, 0xB6, 0xB7, 0xB8, 0xB9, 0xBA, 0xBB, 0xBC, 0xBD, 0x6F, 0xBE, // U+0430 абвгдежзийклмноп
+        0x70, 0x63, 0xBF, 0x79, 0xE4, 0x78, 0xE5, 0xC0, 0xC1, 0xE6, 0xC2, 0xC3, 0xC4, 0xC5, 0xC6, 0xC7, // U+0440 рстуфхцчшщъыьэюя
+        0x00, 0xB5, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, // U+0450 ѐёђѓєѕіїјљњћќѝўџ
+    },
+};
+
+/**
+ * @typedef lcd1602_symbol_t
+ * @brief Символ вне кириллицы и его коды в ПЗУ (0 -- нет, рисуется в CGRAM).
+ */
+typedef struct {
+    uint16_t code_point;
+    uint8_t  code[LCD1602_ROM_COUNT];
+} lcd1602_symbol_t;
+
+static const lcd1602_symbol_t s_lcd1602_symbols[] = { // По возрастанию code_point
+    { 0x00B0, { 0xDF, 0x00 } }, // °
+    { 0x00B5, { 0xE4, 0x00 } }, // µ
+    { 0x00F7, { 0xFD, 0x00 } }, // ÷
+    { 0x03A3, { 0xF6, 0x00 } }, // Σ
+    { 0x03A9, { 0xF4, 0x00 } }, // Ω
+    { 0x03B1, { 0xE0, 0x00 } }, // α
+    { 0x03B2, { 0xE2, 0x00 } }, // β
+    { 0x03BC, { 0xE4, 0x00 } }, // μ
+    { 0x03C0, { 0xF7, 0x00 } }, // π
+    { 0x2190, { 0x7F, 0x00 } }, // ←
+    { 0x2192, { 0x7E, 0x00 } }, // →
+    { 0x221A, { 0xE8, 0x00 } }, // √
+};
+
+/**
+ * @typedef lcd1602_glyph_t
+ * @brief Знак для CGRAM: строки 5x8 сверху вниз, младшие 5 бит; восьмая строка -- под курсор.
+ */
+typedef struct {
+    uint16_t code_point;
+    uint8_t  rows[8];
+} lcd1602_glyph_t;
+
+static const lcd1602_glyph_t s_lcd1602_glyphs[] = { // По возрастанию code_point
+    { 0x00B0, { 0x0C, 0x12, 0x12, 0x0C, 0x00, 0x00, 0x00, 0x00 } }, // °
+    { 0x00B5, { 0x00, 0x00, 0x11, 0x11, 0x13, 0x1D, 0x10, 0x10 } }, // µ
+    { 0x0411, { 0x1F, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x1E, 0x00 } }, // Б
+    { 0x0413, { 0x1F, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x00 } }, // Г
+    { 0x0414, { 0x06, 0x0A, 0x0A, 0x0A, 0x0A, 0x1F, 0x11, 0x00 } }, // Д
+    { 0x0416, { 0x15, 0x15, 0x15, 0x0E, 0x15, 0x15, 0x15, 0x00 } }, // Ж
+    { 0x0417, { 0x0E, 0x11, 0x01, 0x06, 0x01, 0x11, 0x0E, 0x00 } }, // З
+    { 0x0418, { 0x11, 0x11, 0x13, 0x15, 0x19, 0x11, 0x11, 0x00 } }, // И
+    { 0x0419, { 0x0A, 0x04, 0x11, 0x13, 0x15, 0x19, 0x11, 0x00 } }, // Й
+    { 0x041B, { 0x07, 0x09, 0x09, 0x09, 0x09, 0x09, 0x11, 0x00 } }, // Л
+    { 0x041F, { 0x1F, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x00 } }, // П
+    { 0x0423, { 0x11, 0x11, 0x11, 0x0F, 0x01, 0x11, 0x0E, 0x00 } }, // У
+    { 0x0424, { 0x04, 0x0E, 0x15, 0x15, 0x15, 0x0E, 0x04, 0x00 } }, // Ф
+    { 0x0426, { 0x12, 0x12, 0x12, 0x12, 0x12, 0x1F, 0x01, 0x00 } }, // Ц
+    { 0x0427, { 0x11, 0x11, 0x11, 0x0F, 0x01, 0x01, 0x01, 0x00 } }, // Ч
+    { 0x0428, { 0x15, 0x15, 0x15, 0x15, 0x15, 0x15, 0x1F, 0x00 } }, // Ш
+    { 0x0429, { 0x15, 0x15, 0x15, 0x15, 0x15, 0x1F, 0x01, 0x00 } }, // Щ
+    { 0x042A, { 0x18, 0x08, 0x08, 0x0E, 0x09, 0x09, 0x0E, 0x00 } }, // Ъ
+    { 0x042B, { 0x11, 0x11, 0x11, 0x1D, 0x13, 0x13, 0x1D, 0x00 } }, // Ы
+    { 0x042C, { 0x10, 0x10, 0x10, 0x1E, 0x11, 0x11, 0x1E, 0x00 } }, // Ь
+    { 0x042D, { 0x0E, 0x11, 0x01, 0x07, 0x01, 0x11, 0x0E, 0x00 } }, // Э
+    { 0x042E, { 0x12, 0x15, 0x15, 0x1D, 0x15, 0x15, 0x12, 0x00 } }, // Ю
+    { 0x042F, { 0x0F, 0x11, 0x11, 0x0F, 0x05, 0x09, 0x11, 0x00 } }, // Я
+    { 0x2190, { 0x00, 0x04, 0x08, 0x1F, 0x08, 0x04, 0x00, 0x00 } }, // ←
+    { 0x2192, { 0x00, 0x04, 0x02, 0x1F, 0x02, 0x04, 0x00, 0x00 } }, // →
+};
+
+#define LCD1602_SYMBOLS (sizeof(s_lcd1602_symbols) / sizeof(s_lcd1602_symbols[0]))
+#define LCD1602_GLYPHS  (sizeof(s_lcd1602_glyphs) / sizeof(s_lcd1602_glyphs[0]))
+
+/**
+ * @typedef lcd1602_charset_t
+ * @brief Состояние перекодировки: знакогенератор и занятые знакоместа CGRAM.
+ */
+typedef struct {
+    lcd1602_rom_t rom;
+    uint8_t       slots;                        ///< Занято знакомест CGRAM
+    uint8_t       glyph[LCD1602_CGRAM_SLOTS];   ///< Номер знака s_lcd1602_glyphs в знакоместе
+    uint32_t      missing;                      ///< Символов, заменённых на LCD1602_CHARSET_MISS
+} lcd1602_charset_t;
+
+static lcd1602_charset_t s_lcd1602_charset;
+
+/**
+ * @brief Выбирает знакогенератор и освобождает CGRAM. Коды уже перекодированных строк
+ *        CGRAM после этого не действительны.
+ */
+void lcd1602_charset_init (lcd1602_rom_t rom)
+{
+    memset(&s_lcd1602_charset, 0, sizeof(s_lcd1602_charset));
+    s_lcd1602_charset.rom = rom < LCD1602_ROM_COUNT ? rom : LCD1602_ROM_A00;
+}
+
+/**
+ * @brief Длина серии печатных ASCII (0x20..0x7E) в начале `src`, не больше `limit`.
+ *        Вызывается, когда первый байт уже печатный: внутри кириллицы серии короткие.
+ *        DEL (0x7F) в серию не входит: это управляющий символ, он заменяется на LCD1602_CHARSET_MISS.
+ */
+static uint32_t s_lcd1602_ascii_run (const uint8_t *src, uint32_t limit)
+{
+    uint32_t run = 0;
+
+    // Короткие серии (пробел между русскими словами) -- побайтно, вектор -- только для длинных
+    while (run < LCD1602_ASCII_SHORT && run < limit && src[run] >= 0x20 && src[run] < 0x7F)
+        run++;
+    if (run < LCD1602_ASCII_SHORT)
+        return run;
+
+#if defined(LCD1602_CHARSET_SSE2) || defined(LCD1602_CHARSET_NEON)
+    // Вектор читает только байты строки: до её конца (strnlen) и не дальше `limit`, хвост -- побайтно
+    limit = run + (uint32_t)strnlen((const char *)src + run, limit - run);
+    while (run + 16 <= limit)
+    {
+#if defined(LCD1602_CHARSET_SSE2)
+        __m128i v    = _mm_loadu_si128((const __m128i *)(src + run));
+        // Знаковое сравнение: байты >= 0x80 отрицательны и попадают вместе с управляющими, DEL -- отдельно
+        __m128i stop = _mm_or_si128(_mm_cmplt_epi8(v, _mm_set1_epi8(0x20)), _mm_cmpeq_epi8(v, _mm_set1_epi8(0x7F)));
+        uint32_t mask = (uint32_t)_mm_movemask_epi8(stop);
+        if (mask)
+            return run + (uint32_t)__builtin_ctz(mask);
+#else
+        int8x16_t  v    = vld1q_s8((const int8_t *)(src + run));
+        uint8x16_t stop = vorrq_u8(vcltq_s8(v, vdupq_n_s8(0x20)), vceqq_s8(v, vdupq_n_s8(0x7F)));
+        if (vmaxvq_u8(stop))
+            break; // Остаток серии -- побайтно
+#endif
+        run += 16;
+    }
+#endif
+
+    while (run < limit && src[run] >= 0x20 && src[run] < 0x7F)
+        run++;
+    return run;
+}
+
+/**
+ * @brief Знак CGRAM для символа: уже занятое знакоместо или новое.
+ * @return Код знака или 0, если знака нет или CGRAM занята.
+ */
+static uint8_t s_lcd1602_cgram_code (uint32_t code_point)
+{
+    uint32_t lo = 0;
+    uint32_t hi = LCD1602_GLYPHS;
+
+    while (lo < hi)
+    {
+        uint32_t mid = (lo + hi) / 2;
+        if (s_lcd1602_glyphs[mid].code_point < code_point)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if (lo == LCD1602_GLYPHS || s_lcd1602_glyphs[lo].code_point != code_point)
+        return 0;
+
+    for (uint8_t slot = 0; slot < s_lcd1602_charset.slots; slot++)
+    {
+        if (s_lcd1602_charset.glyph[slot] == lo)
+            return LCD1602_CGRAM_CODE + slot;
+    }
+    if (s_lcd1602_charset.slots == LCD1602_CGRAM_SLOTS)
+        return 0;
+
+    s_lcd1602_charset.glyph[s_lcd1602_charset.slots] = (uint8_t)lo;
+    return LCD1602_CGRAM_CODE + s_lcd1602_charset.slots++;
+}
+
+/**
+ * @brief Код дисплея для символа вне ASCII: ПЗУ, затем CGRAM, затем LCD1602_CHARSET_MISS.
+ */
+static uint8_t s_lcd1602_code (uint32_t code_point)
+{
+    lcd1602_rom_t rom = s_lcd1602_charset.rom;
+    uint8_t code = 0;
+
+    if (code_point - LCD1602_CYRILLIC_FIRST < LCD1602_CYRILLIC_COUNT)
+    {
+        code = s_lcd1602_cyrillic[rom][code_point - LCD1602_CYRILLIC_FIRST];
+        // Строчной без знака в ПЗУ хватает знака прописной
+        if (code == 0 && code_point >= 0x0430 && code_point < 0x0450)
+            code_point -= 0x20;
+    }
+    else
+    {
+        uint32_t lo = 0;
+        uint32_t hi = LCD1602_SYMBOLS;
+        while (lo < hi)
+        {
+            uint32_t mid = (lo + hi) / 2;
+            if (s_lcd1602_symbols[mid].code_point < code_point)
+                lo = mid + 1;
+            else
+                hi = mid;
+        }
+        if (lo < LCD1602_SYMBOLS && s_lcd1602_symbols[lo].code_point == code_point)
+            code = s_lcd1602_symbols[lo].code[rom];
+    }
+
+    if (code == 0)
+        code = s_lcd1602_cgram_code(code_point);
+    if (code == 0)
+    {
+        s_lcd1602_charset.missing++;
+        code = LCD1602_CHARSET_MISS;
+    }
+    return code;
+}
+
+/**
+ * @brief Перекодирует строку UTF-8 в коды дисплея, как strncpy: не больше `size` кодов,
+ *        остаток `dst` заполняется нулями (при `size` кодах нуля в конце нет).
+ *        Неверные последовательности, управляющие символы и символы без знака
+ *        заменяются на LCD1602_CHARSET_MISS.
+ * @return Число записанных кодов.
+ */
+uint32_t lcd1602_transcode (char *dst, uint32_t size, const char *src)
+{
+    const uint8_t *in = (const uint8_t *)src;
+    uint32_t n = 0;
+
+    while (n < size && *in)
+    {
+        uint32_t code_point = 0;
+        uint32_t length     = 1;
+        uint8_t  lead       = in[0];
+
+        if (lead >= 0x20 && lead < 0x7F)
+        {
+            uint32_t run = s_lcd1602_ascii_run(in, size - n);
+            memcpy(dst + n, in, run);
+            n  += run;
+            in += run;
+            continue;
+        }
+
+        // Кириллица U+0400..U+047F (0xD0 и 0xD1) со знаком в ПЗУ -- прямо по таблице
+        if ((lead & 0xFE) == 0xD0 && (in[1] & 0xC0) == 0x80)
+        {
+            uint32_t index = ((uint32_t)(lead & 0x01) << 6) | (in[1] & 0x3F);
+            uint8_t  code  = index < LCD1602_CYRILLIC_COUNT ? s_lcd1602_cyrillic[s_lcd1602_charset.rom][index] : 0;
+            if (code)
+            {
+                dst[n++] = (char)code;
+                in += 2;
+                continue;
+            }
+        }
+
+        if (lead >= 0xC2 && lead <= 0xDF && (in[1] & 0xC0) == 0x80)
+        {
+            code_point = ((uint32_t)(lead & 0x1F) << 6) | (in[1] & 0x3F);
+            length     = 2;
+        }
+        else if (lead >= 0xE0 && lead <= 0xEF && (in[1] & 0xC0) == 0x80 && (in[2] & 0xC0) == 0x80)
+        {
+            code_point = ((uint32_t)(lead & 0x0F) << 12) | ((uint32_t)(in[1] & 0x3F) << 6) | (in[2] & 0x3F);
+            length     = 3;
+            if (code_point < 0x800) // Избыточная запись -- неверная последовательность
+            {
+                code_point = 0;
+                length     = 1;
+            }
+        }
+        else if (lead >= 0xF0 && lead <= 0xF4 && (in[1] & 0xC0) == 0x80 && (in[2] & 0xC0) == 0x80 &&
+                 (in[3] & 0xC0) == 0x80)
+        {
+            length = 4; // Вне базовой плоскости знаков нет
+        }
+
+        if (code_point)
+        {
+            dst[n++] = (char)s_lcd1602_code(code_point);
+        }
+        else
+        {
+            dst[n++] = LCD1602_CHARSET_MISS;
+            s_lcd1602_charset.missing++;
+        }
+        in += length;
+    }
+
+    if (n < size)
+        memset(dst + n, 0, size - n);
+    return n;
+}
+
+/**
+ * @brief Занято знакомест CGRAM.
+ */
+uint32_t lcd1602_cgram_used (void)
+{
+    return s_lcd1602_charset.slots;
+}
+
+/**
+ * @brief Символов, заменённых на LCD1602_CHARSET_MISS с последнего lcd1602_charset_init.
+ */
+uint32_t lcd1602_charset_missing (void)
+{
+    return s_lcd1602_charset.missing;
+}
+
+/**
+ * @brief Загружает занятые знакоместа в CGRAM одной серией (адрес CGRAM инкрементируется сам).
+ *        DDRAM и теневой буфер не меняются, следующий вывод кадра сам установит адрес DDRAM.
+ */
+void lcd1602_cgram_load (void)
+{
+    if (s_lcd1602_charset.slots == 0)
+        return;
+
+    lcd1602_command(LCD1602_CMD_SET_CGRAM);
+    for (uint8_t slot = 0; slot < s_lcd1602_charset.slots; slot++)
+    {
+        const uint8_t *rows = s_lcd1602_glyphs[s_lcd1602_charset.glyph[slot]].rows;
+        for (uint8_t row = 0; row < 8; row++)
+            lcd1602_data(rows[row]);
+    }
+}
@@ -1,10 +1,14 @@
 #include <stdio.h>
 
 #include "menu.h"
+#include "menu_trace.h"
 
 int main(int argc, char *argv[], char **penv)
 {
     // printf("int - %lu, float - %lu, double - %lu, uint32_t - %lu\r\n", sizeof(int), sizeof(float), sizeof(double), sizeof(uint32_t));
+#if (MENU_TRACE_ENABLE != 0)
+    menu_trace_install_crash_dump("menu_trace.bin");
+#endif
     Menu_Init();
     
     return 0;
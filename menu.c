@@ -7,12 +7,142 @@
 
 #include "menu.h"
 #include "console.h"
+#include "menu_latency.h"
+#include "menu_trace.h"
+#if MENU_TITLE_CHARSET
+#include "lcd1602.h"
+#endif
+
+/**
+ * Поиск по заголовкам (s_menu_search, MENU_SEARCH=1): поле заголовка -- ровно 16 байт, один
+ * векторный регистр. MENU_SEARCH_SCALAR=1 отключает векторную ветку.
+ */
+#define MENU_SEARCH_SIMD_NONE 0
+#define MENU_SEARCH_SIMD_SSE2 1
+#define MENU_SEARCH_SIMD_NEON 2
+
+#if MENU_SEARCH && !defined(MENU_SEARCH_SCALAR) && MENU_ITEM_TITLE_LEN == 16 && defined(__SSE2__)
+#include <emmintrin.h>
+#define MENU_SEARCH_SIMD MENU_SEARCH_SIMD_SSE2
+#elif MENU_SEARCH && !defined(MENU_SEARCH_SCALAR) && MENU_ITEM_TITLE_LEN == 16 && defined(__ARM_NEON) && defined(__aarch64__)
+#include <arm_neon.h>
+#define MENU_SEARCH_SIMD MENU_SEARCH_SIMD_NEON
+#else
+#define MENU_SEARCH_SIMD MENU_SEARCH_SIMD_NONE
+#endif
+
+#define MENU_FUZZY_NONE   0xFFFFFFFFu ///< Нет записи нечёткого индекса (родитель -- корень)
+#define MENU_STRING_NONE  0xFFFFu     ///< Заголовок пункта -- в поле `title`, а не в таблице языка
+#define MENU_LAZY_NONE    0xFFFFFFFFu ///< Отложенное подменю создано вне построителя другого отложенного подменю
+#define MENU_FUZZY_QUERY  32          ///< Значимых символов в запросе нечёткого поиска (без пробелов)
+#define MENU_FUZZY_MIN    64          ///< Начальная ёмкость нечёткого индекса в динамическом режиме
+
+#define MENU_RING_STALE     0x80000000u ///< Бит счётчика кольца (`children`): номера `ordinal` его пунктов устарели
+
+/**
+ * Освобождение отложенных подменю (динамический режим): потомки отложенного подменю лежат
+ * в списке `folowing` одним участком сразу после него, и s_menu_lazy_release вырезает участок целиком.
+ */
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY) && (MENU_LAZY_SUBMENUS > 0)
+#define MENU_LAZY_RELEASE 1
+#else
+#define MENU_LAZY_RELEASE 0
+#endif
+
+/**
+ * Области отложенных подменю: все пункты участка отложенного подменю берутся блоками по
+ * MENU_REGION_ITEMS из области его записи и освобождаются вместе с блоками.
+ */
+#if MENU_LAZY_RELEASE && (MENU_REGION_ITEMS > 0)
+#define MENU_REGIONS 1
+#else
+#define MENU_REGIONS 0
+#endif
+
+/**
+ * Окна виртуальных списков: нужны спискам s_menu_add_virtual и списку результатов поиска.
+ * Без них ветки окон на шаге энкодера и при нажатии не собираются.
+ */
+#define MENU_VIRTUAL ((MENU_VIRTUAL_LISTS > 0) || MENU_SEARCH)
+
+#if (MENU_PREDICATES > 0) && !(MENU_HIDDEN_ITEMS > 0)
+#error "MENU_PREDICATES: условия видимости скрывают пункты, нужен MENU_HIDDEN_ITEMS=1"
+#endif
+
+/**
+ * Скрытые пункты (MENU_HIDDEN_ITEMS=1): полное кольцо `sibling_prev`/`sibling_next` включает
+ * скрытые пункты. Без них полное кольцо совпадает с кольцом навигации, а проверки
+ * MENU_FLAG_HIDDEN не собираются.
+ */
+#if (MENU_HIDDEN_ITEMS > 0)
+#define MENU_HIDDEN(item)    ((item)->flags & MENU_FLAG_HIDDEN)
+#define MENU_RING_NEXT(item) ((item)->sibling_next)
+#define MENU_RING_PREV(item) ((item)->sibling_prev)
+#else
+#define MENU_HIDDEN(item)    0
+#define MENU_RING_NEXT(item) ((item)->next)
+#define MENU_RING_PREV(item) ((item)->prev)
+#endif
+
+#define MENU_WALK_PRE      0x01 ///< s_menu_walk: посещение пункта до его подменю
+#define MENU_WALK_POST     0x02 ///< s_menu_walk: посещение пункта после его подменю
+
+#define MENU_WALK_DONE      0 ///< Обход завершён
+#define MENU_WALK_STOPPED   1 ///< Обход остановлен посетителем
+#define MENU_WALK_OVERFLOW -1 ///< Вложенность глубже MENU_WALK_DEPTH: обход прерван
+
+#define MENU_SEARCH_EXACT  0x00 ///< Заголовок совпадает с образцом целиком
+#define MENU_SEARCH_PREFIX 0x01 ///< Заголовок начинается с образца
+#define MENU_SEARCH_NOCASE 0x02 ///< Латиница без учёта регистра (вместе с EXACT или PREFIX)
 
 /** @typedef Функция обратного вызова элемента меню
  *  @brief 
  */
 typedef void (*menu_item_callback_t) (void);
 
+/**
+ * @typedef menu_virtual_provider_t
+ * @brief Источник записей виртуального списка.
+ *
+ * Записывает заголовок записи `index` (не более MENU_ITEM_TITLE_LEN символов, завершающий ноль
+ * не обязателен) и возвращает её значение, которое сохраняется в `data` пункта окна.
+ */
+typedef uint32_t (*menu_virtual_provider_t) (uint32_t index, char *title);
+
+struct _menu_item_t;
+
+/**
+ * @typedef menu_builder_t
+ * @brief Построитель отложенного подменю: создаёт дочернюю цепочку пункта `item`
+ *        через s_menu_add_item(..., item, ...). s_menu_set_child вызывать не обязательно.
+ */
+typedef void (*menu_builder_t) (struct _menu_item_t *item);
+
+/**
+ * @typedef menu_predicate_t
+ * @brief Условие видимости пункта `item`: ненулевое значение -- пункт показывается.
+ *
+ * Результат кэшируется и пересчитывается только после изменения значения одного из пунктов,
+ * от которых условие объявлено зависящим (s_menu_add_predicate, s_menu_set_value).
+ * Условие не должно само менять значения пунктов.
+ */
+typedef int (*menu_predicate_t) (const struct _menu_item_t *item);
+
+/**
+ * @typedef menu_walk_visit_t
+ * @brief Посетитель обхода дерева (s_menu_walk).
+ *
+ * @param item    Пункт.
+ * @param depth   Уровень пункта: 0 -- кольцо, с которого начат обход.
+ * @param order   MENU_WALK_PRE или MENU_WALK_POST.
+ * @param context Аргумент s_menu_walk.
+ * @return 0 -- продолжить обход, иначе остановить.
+ *
+ * Посетитель не меняет кольца и дочерние указатели; при MENU_WALK_POST он может освободить
+ * сам пункт `item` (следующий пункт к этому моменту уже прочитан).
+ */
+typedef int (*menu_walk_visit_t) (struct _menu_item_t *item, uint32_t depth, uint8_t order, void *context);
+
 /** 
  * @typedef rotenc_data_t
  * @brief структура для хранения предыдущего, текущего и следующего значения rotary encoder 
@@ -62,16 +192,273 @@ typedef struct {
  */
 typedef struct _menu_item_t {
     char title[MENU_ITEM_TITLE_LEN]; ///< Заголовок пункта меню.
-    struct _menu_item_t *prev;       ///< Указатель на предыдущий пункт меню (для навигации назад).
-    struct _menu_item_t *next;       ///< Указатель на следующий пункт меню (для навигации вперёд).
+    struct _menu_item_t *prev;       ///< Предыдущий видимый пункт (для навигации назад).
+    struct _menu_item_t *next;       ///< Следующий видимый пункт (для навигации вперёд).
+#if (MENU_HIDDEN_ITEMS > 0)
+    struct _menu_item_t *sibling_prev; ///< Предыдущий пункт полного кольца, включая скрытые (возврат скрытого пункта на место)
+    struct _menu_item_t *sibling_next; ///< Следующий пункт полного кольца, включая скрытые (обход в порядке создания)
+#endif
     struct _menu_item_t *folowing;   ///< Указатель на следующий элемент для односвязного списка.
     struct _menu_item_t *parent;     ///< Указатель на родительский пункт меню. Определяет возврат на верхний уровень
-    struct _menu_item_t *child;      ///< Указатель на дочерний пункт меню. Определяет переход на подменю (Дочерняя цепочка меню)
+    struct _menu_item_t *child;      ///< Дочерний пункт, на который ведёт вход в подменю (s_menu_set_child)
+#if (MENU_CURSOR_MEMORY > 0)
+    struct _menu_item_t *resume;     ///< Пункт дочернего кольца, на котором из подменю вышли: вход продолжается с него (NULL -- с `child`)
+#endif
     menu_item_callback_t callback;   ///< Функция обратного вызова, выполняемая при взаимодействии с элементом
+#if (MENU_JUMP_INDEX > 0)
+    struct _menu_item_t *jump;       ///< Следующий пункт кольца с той же первой буквой (кольцо быстрого перехода)
+#endif
     uint32_t data;                   ///< Данные текущего пункта меню
+#if (MENU_POSITION_INDICATOR > 0)
+    uint32_t ordinal;                ///< Номер среди видимых пунктов кольца, с 1 (если у кольца нет MENU_RING_STALE)
+    uint32_t children;               ///< Количество видимых пунктов дочернего кольца и бит MENU_RING_STALE
+#endif
     uint8_t flags;                   ///< Флаги для обработки при нажатии кнопки и т.д.
+    uint8_t first;                   ///< 1 -- первый пункт полного кольца в порядке создания (начало обхода); в выравнивании после `flags`
+#if (MENU_MARQUEE_TITLES > 0)
+    uint8_t marquee;                 ///< Длинный заголовок (s_menu_add_long): номер записи + 1, 0 -- нет; в выравнивании после `flags`
+#endif
+#if (MENU_STRINGS > 0)
+    uint16_t string;                 ///< Строка таблицы языка (MENU_STRING_NONE -- заголовок в `title`); в выравнивании после `flags`
+#endif
 } menu_item_t;
 
+/**
+ * @typedef menu_virtual_t
+ * @brief Виртуальный список: узел меню, за которым стоят `count` записей источника.
+ *
+ * Дочерняя цепочка узла -- кольцо из MENU_VIRTUAL_WINDOW пунктов (окно). Текущий пункт окна
+ * показывает запись `index`, соседние -- записи `index - 1` и `index + 1` (по модулю `count`).
+ * В списке короче окна кольцо -- первые `count` пунктов окна, и каждая запись показана одним пунктом.
+ * При шаге энкодера перезаполняется один пункт окна, поэтому шаг стоит O(1), а память не
+ * зависит от длины списка. Номер списка хранится в поле `data` узла.
+ */
+typedef struct {
+    menu_item_t            *node;     ///< Пункт-узел, дочерняя цепочка которого -- окно
+    menu_virtual_provider_t provider; ///< Источник заголовков и значений
+    uint32_t                count;    ///< Количество записей
+    uint32_t                index;    ///< Запись, показанная текущим пунктом окна
+    menu_item_t            *window[MENU_VIRTUAL_WINDOW]; ///< Пункты окна в порядке создания
+} menu_virtual_t;
+
+/**
+ * @typedef menu_lazy_t
+ * @brief Отложенное подменю: дочерняя цепочка пункта строится при первом входе в него.
+ *        Номер записи хранится в поле `data` пункта.
+ */
+typedef struct {
+    menu_item_t   *item;    ///< Пункт с MENU_FLAG_LAZY (NULL -- запись свободна или ждёт повторного построения)
+    menu_builder_t builder; ///< Построитель дочерней цепочки
+#if (MENU_CURSOR_MEMORY > 0)
+    uint32_t       resume;  ///< Шагов от `child` до пункта, с которого продолжится вход после освобождения (0 -- с `child`)
+#endif
+    uint32_t       owner;   ///< Запись подменю, построитель которого создал пункт (MENU_LAZY_NONE -- вне построителя)
+    uint32_t       order;   ///< Номер среди отложенных подменю, созданных тем же построением
+#if MENU_LAZY_RELEASE
+    menu_item_t   *last;    ///< Последний пункт участка подменю в списке `folowing` (NULL -- у пункта нет потомков)
+#endif
+#if MENU_REGIONS
+    struct _menu_region_t *region;       ///< Блоки области построенного подменю (NULL -- не построено)
+    uint32_t               region_items; ///< Пунктов в области при последнем освобождении: ёмкость первого блока
+#endif
+} menu_lazy_t;
+
+#if MENU_REGIONS
+/**
+ * @typedef menu_region_t
+ * @brief Блок области отложенного подменю: пункты подряд в одном выделении памяти.
+ *
+ * Построение подменю занимает блоки, освобождение подменю возвращает их целиком: число
+ * вызовов malloc/free -- по блокам, а не по пунктам, и подменю не оставляет в куче дыр
+ * размером с пункт между долгоживущими выделениями. Пункты области не обходятся ни при
+ * освобождении подменю, ни в s_menu_free_items.
+ */
+typedef struct _menu_region_t {
+    struct _menu_region_t *next;     ///< Предыдущий блок той же области
+    uint32_t               used;     ///< Занято пунктов
+    uint32_t               capacity; ///< Пунктов в блоке
+    menu_item_t            items[];
+} menu_region_t;
+#endif
+
+/**
+ * @typedef menu_predicate_entry_t
+ * @brief Условие видимости пункта и его кэшированный результат.
+ */
+typedef struct {
+    menu_item_t     *item;      ///< Пункт, видимость которого задаёт условие (NULL -- запись свободна)
+    menu_predicate_t predicate; ///< Условие
+    uint32_t         dirty_next; ///< Следующее условие списка ждущих пересчёта (номер + 1, 0 -- конец)
+    uint8_t          visible;   ///< Последний результат условия
+    uint8_t          dirty;     ///< Значение зависимости изменилось: условие в списке ждущих пересчёта
+} menu_predicate_entry_t;
+
+/**
+ * @typedef menu_predicate_dep_t
+ * @brief Зависимость условия `predicate` от значения (`data`) пункта `source`.
+ *
+ * Записи упорядочены по адресу `source`: зависимости одного пункта лежат подряд и находятся
+ * двоичным поиском.
+ */
+typedef struct {
+    const menu_item_t *source;    ///< Пункт-источник (NULL -- запись свободна)
+    uint32_t           predicate; ///< Номер условия в s_menu_predicate
+} menu_predicate_dep_t;
+
+/**
+ * @typedef menu_jump_t
+ * @brief Запись индекса быстрого перехода: пункты кольца `parent` с первой буквой `key`.
+ *
+ * Такие пункты связаны полем `jump` в кольцо в порядке кольца меню. Запись хранит последний
+ * из них (первый -- `tail->jump`), поэтому добавление пункта стоит O(1). Записи лежат в
+ * хеш-таблице с открытой адресацией по паре (parent, key).
+ */
+typedef struct {
+    menu_item_t *parent; ///< Родитель кольца (NULL -- корневое кольцо)
+    menu_item_t *tail;   ///< Последний пункт кольца с буквой `key` (NULL -- запись свободна)
+    char         key;    ///< Первая буква заголовка, латиница приведена к нижнему регистру
+} menu_jump_t;
+
+/**
+ * @typedef menu_walk_frame_t
+ * @brief Уровень стека обхода дерева: кольцо, которое сейчас проходится.
+ */
+typedef struct {
+    menu_item_t *item;  ///< Текущий пункт кольца
+    menu_item_t *last;  ///< Последний пункт полного кольца (в порядке создания)
+    uint8_t      order; ///< Следующее посещение пункта: MENU_WALK_PRE или MENU_WALK_POST
+} menu_walk_frame_t;
+
+/**
+ * @typedef menu_search_key_t
+ * @brief Образец поиска, подготовленный под сравнение всего поля заголовка за одну операцию.
+ *
+ * Байты вне `mask` (хвост образца при MENU_SEARCH_PREFIX) не сравниваются. Заголовки пунктов
+ * дополнены нулями до MENU_ITEM_TITLE_LEN (s_menu_copy_title в s_menu_add_item), образец -- тоже, поэтому
+ * точное совпадение -- равенство всех байт поля.
+ */
+typedef struct {
+    uint8_t bytes[MENU_ITEM_TITLE_LEN]; ///< Образец, при MENU_SEARCH_NOCASE -- в нижнем регистре
+    uint8_t mask[MENU_ITEM_TITLE_LEN];  ///< 0xFF -- байт сравнивается, 0 -- нет
+    uint8_t nocase;                     ///< Приводить заголовок к нижнему регистру
+} menu_search_key_t;
+
+/**
+ * @typedef menu_search_column_t
+ * @brief Столбец заголовков для поиска (динамический режим).
+ *
+ * Заголовки всех пунктов дерева (кроме окон виртуальных списков) лежат подряд по
+ * MENU_ITEM_TITLE_LEN байт в порядке создания, поэтому поиск читает память последовательно,
+ * а не переходит по указателям `folowing`. Столбец строится при первом поиске, затем
+ * s_menu_add_item дописывает в него новые пункты. При освобождении пунктов и нехватке
+ * памяти столбец освобождается и строится заново при следующем поиске.
+ */
+typedef struct {
+    char        (*titles)[MENU_ITEM_TITLE_LEN]; ///< Заголовки подряд (NULL -- столбец не построен)
+    menu_item_t **items;                        ///< Пункт каждого заголовка
+    uint32_t      count;                        ///< Заголовков в столбце
+    uint32_t      capacity;                     ///< Выделено мест
+} menu_search_column_t;
+
+/**
+ * @typedef menu_fuzzy_entry_t
+ * @brief Запись нечёткого индекса: пункт, запись его родителя и символы пути от корня.
+ */
+typedef struct {
+    menu_item_t *item;   ///< Пункт (NULL -- пункт освобождён, запись ждёт уплотнения)
+    uint32_t     parent; ///< Запись родителя (MENU_FUZZY_NONE -- корень); всегда раньше этой записи
+    uint32_t     mask;   ///< Символы пути (s_menu_fuzzy_mask): фильтр без чтения заголовков
+} menu_fuzzy_entry_t;
+
+/**
+ * @typedef menu_fuzzy_state_t
+ * @brief Состояние сопоставления запроса с путём до пункта (рабочая память запроса).
+ */
+typedef struct {
+    int16_t score;   ///< Очки совпадения по пути
+    uint8_t matched; ///< Символов запроса найдено по пути
+    uint8_t need;    ///< Равно `epoch` запроса: пункт или его потомок -- кандидат
+} menu_fuzzy_state_t;
+
+/**
+ * @typedef menu_fuzzy_index_t
+ * @brief Нечёткий индекс по путям пунктов ("Hi Arm/Duration" по запросу "hi dur").
+ *
+ * Записи идут в порядке создания пунктов, родитель всегда раньше потомков. Состояние
+ * сопоставления пункта получается из состояния родителя проходом по одному заголовку,
+ * поэтому путь целиком не собирается ни при индексации, ни при запросе. Добавление пункта --
+ * запись в конец и место в таблице `map`; освобождение поддерева помечает записи одним
+ * проходом, уплотнение -- когда освобождённых больше половины. Память на пункт:
+ * запись, состояние и два места `map`.
+ */
+typedef struct {
+    menu_fuzzy_entry_t *entries;  ///< Записи (NULL -- индекс не построен)
+    menu_fuzzy_state_t *states;   ///< Состояния сопоставления, по одному на запись
+    uint32_t           *map;      ///< Открытая адресация: пункт -> номер записи, 2 * capacity мест
+    uint32_t            count;    ///< Записей, включая освобождённые
+    uint32_t            capacity; ///< Мест под записи
+    uint32_t            dead;     ///< Освобождённых записей
+    uint8_t             epoch;    ///< Отметка `need` текущего запроса (прежние отметки не сбрасываются)
+} menu_fuzzy_index_t;
+
+/**
+ * @typedef menu_marquee_title_t
+ * @brief Длинный заголовок во внешней памяти. В поле `title` пункта -- его первые MENU_ITEM_TITLE_LEN байт
+ *        (по ним работают поиск и быстрый переход).
+ */
+typedef struct {
+    const char *text;   ///< Текст, завершённый нулём (обычно константа в ПЗУ); не копируется
+    uint16_t    length; ///< Длина текста
+} menu_marquee_title_t;
+
+/**
+ * @typedef menu_marquee_t
+ * @brief Бегущая строка выбранного пункта.
+ */
+typedef struct {
+    const menu_item_t *item;   ///< Пункт, заголовок которого бежит (NULL -- строка стоит)
+    const char        *text;   ///< Его длинный заголовок
+    uint16_t           offset; ///< Первый видимый знак
+    uint16_t           last;   ///< Последнее смещение: длина - MENU_MARQUEE_WIDTH
+    uint8_t            hold;   ///< Шагов паузы до следующего сдвига
+    uint8_t            armed;  ///< Срок следующего шага задан (первый Menu_Tick после выбора пункта)
+    uint32_t           due;    ///< Время следующего шага, мс
+} menu_marquee_t;
+
+/**
+ * @typedef menu_breadcrumb_t
+ * @brief Строка пути к текущему кольцу (MENU_BREADCRUMB).
+ *
+ * Хранит предков текущего кольца от внешнего к родителю: вход в подменю добавляет уровень,
+ * выход -- снимает, и строка заново укладывается в ширину по длинам, сохранённым при добавлении.
+ * Поворот энкодера внутри кольца строку не трогает: родитель тот же.
+ */
+typedef struct {
+    const menu_item_t *parent;                        ///< Родитель кольца, для которого построена строка (NULL -- корень)
+    const menu_item_t *path[MENU_BREADCRUMB_DEPTH];   ///< Предки кольца: path[depth - 1] == parent
+    uint8_t            length[MENU_BREADCRUMB_DEPTH]; ///< Длины их заголовков без хвостовых пробелов
+    uint8_t            depth;                         ///< Уровней в `path`
+    uint8_t            clipped;                       ///< Внешние уровни не поместились в `path`
+    uint8_t            valid;                         ///< Строка построена (0 -- построить заново при выводе)
+    char               text[MENU_BREADCRUMB_WIDTH + 1]; ///< Строка пути
+} menu_breadcrumb_t;
+
+/**
+ * @typedef menu_search_list_t
+ * @brief Временный список результатов поиска.
+ *
+ * Виртуальный список, узел, окно и дескриптор которого лежат в статической памяти вне дерева
+ * (не в списке `folowing` и ни в одном кольце), поэтому показ результатов не создаёт пунктов
+ * и не занимает дескрипторов s_menu_virtual ни в одном режиме памяти. Нажатие на запись ведёт к найденному пункту, длинное нажатие -- на узел,
+ * повторное -- к пункту, из которого начат поиск.
+ */
+typedef struct {
+    menu_item_t   node;                         ///< Узел списка: родитель -- пункт, из которого начат поиск
+    menu_item_t   window[MENU_VIRTUAL_WINDOW];  ///< Окно: дочерний пункт каждого -- найденный пункт
+    menu_virtual_t descriptor;                  ///< Дескриптор списка (свой, не из таблицы s_menu_virtual)
+    menu_item_t **results;                      ///< Найденные пункты (буфер вызывающего)
+} menu_search_list_t;
+
 /**
  * @typedef menu_handle_t
  * @brief Структура для управления и навигации по меню.
@@ -88,31 +475,370 @@ typedef struct {
                            ///< Используется для отображения текущего состояния меню на дисплее и навигации пользователя.
     menu_item_t  *start;   ///< Указатель на стартовый элемент меню.
                            ///< Полезен для управления памятью и удаления всей цепочки меню при необходимости.
+    menu_item_t  *last;    ///< Последний созданный пункт: хвост односвязного списка `folowing`.
+                           ///< Новые пункты добавляются после него, в том числе при работе меню.
+#if (MENU_VIRTUAL_LISTS > 0)
+    uint32_t      virtual_lists; ///< Количество использованных дескрипторов виртуальных списков
+#endif
+#if (MENU_LAZY_SUBMENUS > 0)
+    uint32_t      lazy_submenus; ///< Количество использованных записей отложенных подменю
+    menu_item_t  *building;      ///< Отложенное подменю, которое сейчас строится (не освобождается)
+    uint32_t      building_lazies; ///< Отложенных подменю, созданных текущим построением
+#endif
+#if MENU_LAZY_RELEASE
+    menu_item_t  *adding;        ///< Родитель создаваемого пункта: его подменю не освобождаются при нехватке памяти
+#endif
+#if (MENU_POSITION_INDICATOR > 0)
+    uint32_t      root_children; ///< Количество видимых пунктов корневого кольца и бит MENU_RING_STALE
+#endif
+#if (MENU_PREDICATES > 0)
+    uint32_t      predicates;     ///< Количество использованных записей условий видимости
+    uint32_t      predicate_deps; ///< Количество записей зависимостей условий (без пропусков)
+    uint8_t       value_batch;    ///< Глубина пакета изменений значений (s_menu_value_begin)
+    uint32_t      predicate_dirty; ///< Первое условие списка ждущих пересчёта (номер + 1, 0 -- список пуст)
+#endif
+#if MENU_BREADCRUMB
+    menu_breadcrumb_t breadcrumb;  ///< Строка пути к текущему кольцу
+#endif
+#if (MENU_JUMP_INDEX > 0) && MENU_LAZY_RELEASE
+    uint8_t       jump_full;       ///< Пункт не вошёл в индекс быстрого перехода: таблица заполнена
+#endif
+#if (MENU_MARQUEE_TITLES > 0)
+    menu_marquee_t marquee;        ///< Бегущая строка выбранного пункта
+    uint32_t      marquee_titles;  ///< Количество использованных записей длинных заголовков
+#endif
+#if (MENU_STRINGS > 0)
+    const menu_string_t *strings; ///< Таблица строк текущего языка (Menu_SetLanguage)
+#if MENU_STRINGS_PACKED
+    const menu_packed_t *packed;  ///< Сжатая таблица текущего языка (Menu_SetLanguagePacked), вместо `strings`
+    uint32_t      unpack_next;    ///< Строка кэша, в которую распакуется следующий заголовок
+#endif
+    uint8_t       jump_stale;     ///< Язык сменился: индекс быстрого перехода перестроится при следующем переходе
+#endif
 #if (MENU_USAGE_MEMORY == MENU_USAGE_STATIC_MEMORY)
-    uint8_t       static_array_pos; ///< Используется в условиях статического распределения памяти.
+    uint32_t      static_array_pos; ///< Используется в условиях статического распределения памяти.
                                     ///< Предоставляет индекс для работы с внутренним статическим массивом элементов меню.
 #endif    
 } menu_handle_t;
 
+/**
+ * Редкие ветки (виртуальные списки и т.п.) не встраиваются в обработчики ввода, чтобы не
+ * раздувать пролог горячего пути (см. MenuCycles).
+ */
+#if defined(__GNUC__)
+#define MENU_COLD __attribute__((noinline, cold))
+#else
+#define MENU_COLD
+#endif
+
+/**
+ * Внутренний API, который вызывают не все сборки (примеры, бенчмарки, часть опций),
+ * не даёт предупреждений -Wunused-function.
+ */
+#if defined(__GNUC__)
+#define MENU_UNUSED __attribute__((unused))
+#else
+#define MENU_UNUSED
+#endif
+
+/**
+ * @brief Копирует заголовок в поле из MENU_ITEM_TITLE_LEN байт: не длиннее поля, остаток -- нули.
+ *
+ * Поле не обязано заканчиваться нулём (заголовок ровно на всю ширину дисплея), поэтому копия
+ * ограничена strnlen, а не strncpy с границей, равной размеру поля.
+ */
+static inline void s_menu_copy_title (char *field, const char *title)
+{
+    size_t length = strnlen(title, MENU_ITEM_TITLE_LEN);
+
+    memcpy(field, title, length);
+    memset(field + length, 0, MENU_ITEM_TITLE_LEN - length);
+}
+
 static menu_handle_t s_menu_handle; ///< Все текущие состояния, связанные с меню, состоянием энкодера и т.д.
 
+#if (MENU_STRINGS > 0)
+_Static_assert(MENU_STRINGS < MENU_STRING_NONE, "MENU_STRINGS must fit in menu_item_t.string");
+#endif
+
+#if (MENU_STRINGS > 0) && MENU_STRINGS_PACKED
+/**
+ * @typedef menu_unpack_line_t
+ * @brief Распакованный заголовок сжатой таблицы. Хвост `text` -- запас под копирование фрагмента целиком.
+ */
+typedef struct {
+    uint16_t string;                                          ///< Строка таблицы (MENU_STRING_NONE -- пусто)
+    char     text[MENU_ITEM_TITLE_LEN + MENU_PACKED_TOKEN_LEN]; ///< Заголовок, дополненный нулями
+} menu_unpack_line_t;
+
+static menu_unpack_line_t s_menu_unpack_lines[MENU_PACKED_LINES]; ///< Кэш распакованных заголовков
+#define MENU_UNPACK_RAM_BYTES sizeof(s_menu_unpack_lines)
+
+/**
+ * @brief Распаковывает строку `string` сжатой таблицы в кэш и возвращает её.
+ *
+ * Кэш -- MENU_PACKED_LINES последних заголовков: при повороте энкодера текущий пункт уже был
+ * следующим в прошлом кадре, поэтому распаковывается один заголовок на кадр. Фрагмент словаря
+ * копируется записью MENU_PACKED_TOKEN_LEN байт без цикла по знакам.
+ */
+static const char * s_menu_unpack (uint32_t string)
+{
+    for (uint32_t i = 0; i < MENU_PACKED_LINES; i++)
+    {
+        if (s_menu_unpack_lines[i].string == string)
+            return s_menu_unpack_lines[i].text;
+    }
+
+    const menu_packed_t *packed = s_menu_handle.packed;
+    menu_unpack_line_t  *line   = &s_menu_unpack_lines[s_menu_handle.unpack_next];
+    const uint8_t       *code   = packed->codes + packed->offsets[string];
+    const uint8_t       *end    = packed->codes + packed->offsets[string + 1];
+    uint32_t             length = 0;
+
+    s_menu_handle.unpack_next = (s_menu_handle.unpack_next + 1) % MENU_PACKED_LINES;
+
+    while (code < end && length < MENU_ITEM_TITLE_LEN)
+    {
+        uint8_t c = *code++;
+        if (c & 0x80)
+        {
+            memcpy(line->text + length, packed->tokens[c & 0x7F], MENU_PACKED_TOKEN_LEN);
+            length += packed->lengths[c & 0x7F];
+        }
+        else if (c == MENU_PACKED_ESCAPE && code < end)
+        {
+            line->text[length++] = (char)*code++;
+        }
+        else
+        {
+            line->text[length++] = (char)c;
+        }
+    }
+    if (length > MENU_ITEM_TITLE_LEN)
+        length = MENU_ITEM_TITLE_LEN;
+    memset(line->text + length, 0, sizeof(line->text) - length);
+
+    line->string = (uint16_t)string;
+    return line->text;
+}
+#else
+#define MENU_UNPACK_RAM_BYTES 0
+#endif
+
+/**
+ * @brief Заголовок пункта: поле `title` или строка таблицы текущего языка. Без таблиц (MENU_STRINGS 0)
+ *        -- то же `title`, что и раньше.
+ */
+static inline const char * s_menu_title (const menu_item_t *item)
+{
+#if (MENU_STRINGS > 0)
+    if (item->string != MENU_STRING_NONE)
+    {
+#if MENU_STRINGS_PACKED
+        if (s_menu_handle.packed)
+            return s_menu_unpack(item->string);
+#endif
+        return s_menu_handle.strings[item->string];
+    }
+#endif
+    return item->title;
+}
+
+#if (MENU_VIRTUAL_LISTS > 0)
+static menu_virtual_t s_menu_virtual[MENU_VIRTUAL_LISTS]; ///< Дескрипторы виртуальных списков
+#define MENU_VIRTUAL_RAM_BYTES sizeof(s_menu_virtual)
+#else
+#define MENU_VIRTUAL_RAM_BYTES 0
+#endif
+#if (MENU_PREDICATES > 0)
+static menu_predicate_entry_t s_menu_predicate[MENU_PREDICATES];         ///< Условия видимости
+static menu_predicate_dep_t   s_menu_predicate_dep[MENU_PREDICATE_DEPS]; ///< Зависимости условий от значений
+#define MENU_PREDICATE_RAM_BYTES (sizeof(s_menu_predicate) + sizeof(s_menu_predicate_dep))
+_Static_assert(MENU_PREDICATE_DEPS > 0, "menu: MENU_PREDICATE_DEPS must be positive with MENU_PREDICATES");
+#else
+#define MENU_PREDICATE_RAM_BYTES 0
+#endif
+#if MENU_SEARCH
+static menu_search_list_t s_menu_search_list;             ///< Временный список результатов поиска
+#define MENU_SEARCH_RAM_BYTES sizeof(s_menu_search_list)
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+static menu_search_column_t s_menu_search_column;         ///< Столбец заголовков для поиска (в куче)
+#endif
+#else
+#define MENU_SEARCH_RAM_BYTES 0
+#endif
+#if MENU_FUZZY
+static menu_fuzzy_index_t s_menu_fuzzy_index;             ///< Нечёткий индекс по путям
+#if (MENU_USAGE_MEMORY == MENU_USAGE_STATIC_MEMORY)
+static menu_fuzzy_entry_t s_menu_fuzzy_entries[MENU_SIZE];
+static menu_fuzzy_state_t s_menu_fuzzy_states[MENU_SIZE];
+static uint32_t           s_menu_fuzzy_map[2 * MENU_SIZE];
+#define MENU_FUZZY_RAM_BYTES (sizeof(s_menu_fuzzy_index) + sizeof(s_menu_fuzzy_entries) + sizeof(s_menu_fuzzy_states) + sizeof(s_menu_fuzzy_map))
+#else
+#define MENU_FUZZY_RAM_BYTES sizeof(s_menu_fuzzy_index)
+#endif
+#else
+#define MENU_FUZZY_RAM_BYTES 0
+#endif
+#if (MENU_MARQUEE_TITLES > 0)
+static menu_marquee_title_t s_menu_marquee[MENU_MARQUEE_TITLES]; ///< Длинные заголовки (s_menu_add_long)
+#define MENU_MARQUEE_RAM_BYTES sizeof(s_menu_marquee)
+_Static_assert(MENU_MARQUEE_TITLES <= 0xFF, "menu: MENU_MARQUEE_TITLES must fit in menu_item_t.marquee");
+_Static_assert(MENU_MARQUEE_WIDTH >= 1 && MENU_MARQUEE_WIDTH <= MENU_ITEM_TITLE_LEN, "menu: MENU_MARQUEE_WIDTH must be 1..MENU_ITEM_TITLE_LEN");
+#else
+#define MENU_MARQUEE_RAM_BYTES 0
+#endif
+#if (MENU_LAZY_SUBMENUS > 0)
+static menu_lazy_t    s_menu_lazy[MENU_LAZY_SUBMENUS];    ///< Построители отложенных подменю
+#define MENU_LAZY_RAM_BYTES sizeof(s_menu_lazy)
+#else
+#define MENU_LAZY_RAM_BYTES 0
+#endif
+#if (MENU_JUMP_INDEX > 0)
+static menu_jump_t    s_menu_jump[MENU_JUMP_INDEX];       ///< Индекс быстрого перехода по первой букве
+#define MENU_JUMP_RAM_BYTES sizeof(s_menu_jump)
+_Static_assert((MENU_JUMP_INDEX & (MENU_JUMP_INDEX - 1)) == 0, "menu: MENU_JUMP_INDEX must be a power of two");
+#else
+#define MENU_JUMP_RAM_BYTES 0
+#endif
+_Static_assert(MENU_WALK_DEPTH >= 1, "menu: MENU_WALK_DEPTH must be at least 1");
+
 #if (MENU_USAGE_MEMORY == MENU_USAGE_STATIC_MEMORY)
 static menu_item_t s_menu_items[MENU_SIZE] = {0}; ///< Статический массив из которого берутся новые значения для элементов меню. Задействован, чтобы не использовать malloc
 #endif
 
+/**
+ * @brief Оценка RAM меню в худшем случае: MENU_SIZE пунктов (в статическом массиве или в куче),
+ *        состояние меню, буферы гистограмм задержки и самописца.
+ */
+#define MENU_RAM_BYTES (sizeof(menu_handle_t) + MENU_SIZE * sizeof(menu_item_t) + MENU_VIRTUAL_RAM_BYTES + MENU_LAZY_RAM_BYTES + \
+                        MENU_PREDICATE_RAM_BYTES + MENU_SEARCH_RAM_BYTES + MENU_FUZZY_RAM_BYTES + MENU_JUMP_RAM_BYTES + MENU_MARQUEE_RAM_BYTES + MENU_UNPACK_RAM_BYTES + MENU_LATENCY_RAM_BYTES + MENU_TRACE_RAM_BYTES)
+
+#if (MENU_RAM_BUDGET > 0)
+_Static_assert(MENU_RAM_BYTES <= MENU_RAM_BUDGET,
+               "menu: MENU_SIZE * sizeof(menu_item_t) plus static buffers exceeds MENU_RAM_BUDGET; "
+               "reduce MENU_SIZE, MENU_ITEM_TITLE_LEN or MENU_TRACE_SIZE, or disable MENU_LATENCY_ENABLE");
+#endif
+
 static void s_rotary_encoder_callback   (uint32_t current);
 static void s_push_button_callback      (void);
 static void s_display_menu              (void);
 static void s_menu_position_handling    (void);
 static void s_menu_init                 (void);
 static menu_item_t * s_create_new_item  (void);
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+static uint32_t s_menu_memory_relief    (void);
+#endif
+#if MENU_LAZY_RELEASE
+static menu_item_t * s_menu_lazy_owner  (menu_item_t *parent);
+static void s_menu_lazy_link            (menu_item_t *owner, menu_item_t *item);
+#endif
+#if MENU_REGIONS
+static menu_item_t * s_menu_region_alloc (menu_item_t *owner);
+static uint32_t s_menu_region_release   (uint32_t slot);
+#endif
 
 static menu_item_t * s_menu_add_item    (char *title, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags);
+static menu_item_t * s_menu_add_entry   (char *title, uint32_t string, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags);
+#if (MENU_STRINGS > 0)
+static menu_item_t * s_menu_add_string  (uint32_t string, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags);
+static void s_menu_language_changed     (void);
+#endif
+#if MENU_BREADCRUMB
+static const char * s_menu_breadcrumb_follow (const menu_item_t *parent);
+#endif
+#if (MENU_MARQUEE_TITLES > 0)
+static menu_item_t * s_menu_add_long    (const char *text, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags);
+static const char * s_menu_marquee_follow (const menu_item_t *item);
+#endif
 static void s_menu_set_child            (menu_item_t *item, menu_item_t *child);
 static void s_menu_rechain              (menu_item_t *parent);
 
 static void s_long_push_button_callback (void);
 
+#if (MENU_HIDDEN_ITEMS > 0)
+static void s_menu_set_visible          (menu_item_t *item, int visible);
+static int  s_menu_visible_apply        (menu_item_t *item, int visible);
+#endif
+static void s_menu_set_enabled          (menu_item_t *item, int enabled);
+#if (MENU_HIDDEN_ITEMS > 0)
+static menu_item_t * s_menu_visible_from (menu_item_t *item);
+static menu_item_t * s_menu_visible_up  (menu_item_t *item);
+#endif
+static int s_menu_is_descendant         (const menu_item_t *item, const menu_item_t *root);
+#if (MENU_POSITION_INDICATOR > 0)
+static uint32_t * s_menu_ring_count     (const menu_item_t *item);
+static uint32_t s_menu_ring_number      (menu_item_t *item);
+#endif
+#if (MENU_CURSOR_MEMORY > 0)
+static void s_menu_resume_save          (menu_item_t *item);
+#endif
+
+static int  s_menu_walk                 (menu_item_t *parent, uint8_t orders, menu_walk_visit_t visit, void *context);
+static menu_item_t * s_menu_ring_first  (menu_item_t *item);
+static menu_item_t * s_menu_find        (menu_item_t *parent, const char *title);
+static uint32_t s_menu_export           (menu_item_t *parent, char *buffer, uint32_t size);
+static menu_item_t * s_menu_validate    (menu_item_t *parent);
+
+#if (MENU_PREDICATES > 0)
+static menu_item_t * s_menu_add_predicate (menu_item_t *item, menu_predicate_t predicate, menu_item_t **sources, uint32_t count);
+static uint32_t s_menu_predicate_dep_find (const menu_item_t *source);
+static void s_menu_set_value            (menu_item_t *item, uint32_t value);
+static void s_menu_value_changed        (const menu_item_t *item);
+static void s_menu_value_begin          (void);
+static void s_menu_value_end            (void);
+static void s_menu_predicate_flush      (void);
+#if MENU_LAZY_RELEASE
+static void s_menu_predicate_forget     (const menu_item_t *root);
+#endif
+#endif
+
+#if (MENU_VIRTUAL_LISTS > 0)
+static menu_item_t * s_menu_add_virtual (char *title, menu_item_t *parent, uint32_t count, menu_virtual_provider_t provider, uint8_t flags);
+#endif
+#if MENU_VIRTUAL
+static void s_menu_virtual_set_count    (menu_item_t *node, uint32_t count);
+static void s_menu_virtual_enter        (menu_item_t *item);
+static void s_menu_virtual_step         (menu_item_t *item, int32_t step);
+#endif
+
+#if (MENU_LAZY_SUBMENUS > 0)
+static menu_item_t * s_menu_add_lazy    (char *title, menu_item_t *parent, menu_builder_t builder, uint8_t flags);
+static menu_item_t * s_menu_lazy_build  (menu_item_t *item);
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+static uint32_t s_menu_lazy_release     (menu_item_t *item);
+static uint32_t s_menu_lazy_trim        (void);
+#endif
+#endif
+
+#if MENU_SEARCH
+static uint32_t s_menu_search          (const char *pattern, uint8_t mode, menu_item_t **results, uint32_t capacity);
+static uint32_t s_menu_search_show     (menu_item_t **results, uint32_t count);
+static void s_menu_search_close        (void);
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+static void s_menu_search_column_add   (menu_item_t *item);
+static uint32_t s_menu_search_column_drop (void);
+#endif
+#endif
+
+#if MENU_FUZZY
+static uint32_t s_menu_fuzzy           (const char *query, menu_item_t **results, int32_t *scores, uint32_t capacity);
+static void s_menu_fuzzy_add           (menu_item_t *item);
+#if MENU_LAZY_RELEASE
+static void s_menu_fuzzy_remove        (menu_item_t *item);
+#endif
+static uint32_t s_menu_fuzzy_drop      (void);
+#endif
+
+#if (MENU_JUMP_INDEX > 0)
+static void s_menu_jump_add             (menu_item_t *item);
+static void s_menu_jump_rebuild         (void);
+#if MENU_LAZY_RELEASE
+static void s_menu_jump_forget          (const menu_item_t *root);
+#endif
+#endif
+static menu_item_t * s_menu_jump_find   (menu_item_t *from, char key);
+
 #if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
 static void s_menu_free_items           (void);
 #endif
@@ -122,7 +848,7 @@ static void s_print_chain (menu_item_t *item)
     menu_item_t *first = item;
     while(item->next != first)
     {
-        printf("%s\r\n", item->title);
+        printf("%.*s\r\n", MENU_ITEM_TITLE_LEN, s_menu_title(item));
         item = item->next;
     }
 }
@@ -198,6 +924,9 @@ void Menu_Init(void)
  *    для управления ресурсами и предотвращения утечек памяти в системах, где
  *    пункты меню могут варьироваться по структуре и количеству во время работы.
  *
+ * 4. Сбрасывает состояние меню (в статическом режиме -- и позицию в массиве
+ *    элементов), чтобы `Menu_Init()` можно было вызвать повторно.
+ *
  * @note Макрос `MENU_USAGE_MEMORY` контролирует использование динамической
  *       памяти. При `MENU_USAGE_DYNAMIC_MEMORY` память освобождается в
  *       процессе инициализации.
@@ -208,12 +937,19 @@ void Menu_Init(void)
  */
 static void s_menu_init (void)
 {
+#if (MENU_HIDDEN_ITEMS > 0)
+    menu_item_t *first = s_menu_visible_from(s_menu_handle.start);
+    s_menu_handle.current = first ? first : s_menu_handle.start;
+#else
     s_menu_handle.current = s_menu_handle.start;
+#endif
     s_display_menu();
     taskReadKey(s_rotary_encoder_callback, s_push_button_callback, s_long_push_button_callback);
 #if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
     s_menu_free_items ();
 #endif    
+    // Сброс состояния: после выхода Menu_Init можно вызвать повторно
+    memset(&s_menu_handle, 0, sizeof(s_menu_handle));
 }
 
 
@@ -233,13 +969,21 @@ static void s_rotary_encoder_callback (uint32_t current)
       return; // Неправильное значение, игнорировать
     }
 
-    s_menu_handle.rotenc.delta = (int)(current / 2) - (int)s_menu_handle.rotenc.current;
-    s_menu_handle.rotenc.prev  = s_menu_handle.rotenc.current;
-    s_menu_handle.rotenc.current += s_menu_handle.rotenc.delta;
+    MENU_LATENCY_MARK(MENU_LATENCY_DISPATCH);
+
+    // Разность считается в беззнаковой арифметике: переход счётчика через 0 даёт шаг -1, а не +0x7FFFFFFF
+    s_menu_handle.rotenc.delta   = (int32_t)(current - s_menu_handle.rotenc.current) / ENCODER_INPUT_FILTER;
+    s_menu_handle.rotenc.prev    = s_menu_handle.rotenc.current;
+    s_menu_handle.rotenc.current = current;
+
+    MENU_TRACE(MENU_TRACE_EV_INPUT, s_menu_handle.rotenc.delta < 0 ? MENU_TRACE_INPUT_ROTATE_PREV : MENU_TRACE_INPUT_ROTATE_NEXT);
     
-    if (s_menu_handle.current->callback != NULL)
+    if (s_menu_handle.current->callback != NULL && !(s_menu_handle.current->flags & MENU_FLAG_DISABLED))
     {
+        MENU_TRACE(MENU_TRACE_EV_CALLBACK_BEGIN, 0);
         s_menu_handle.current->callback();
+        MENU_TRACE(MENU_TRACE_EV_CALLBACK_END, 0);
+        MENU_LATENCY_MARK(MENU_LATENCY_CALLBACK);
     } else {
         s_menu_position_handling();
     }
@@ -266,10 +1010,20 @@ static void s_menu_position_handling (void)
     if (s_menu_handle.rotenc.delta > 0)
     {
         s_menu_handle.current = s_menu_handle.current->next;
+#if MENU_VIRTUAL
+        if (s_menu_handle.current->flags & MENU_FLAG_VIRTUAL)
+            s_menu_virtual_step(s_menu_handle.current, 1);
+#endif
+        MENU_TRACE(MENU_TRACE_EV_NAV, MENU_TRACE_NAV_NEXT);
     } 
     else if (s_menu_handle.rotenc.delta < 0)
     {
         s_menu_handle.current = s_menu_handle.current->prev;
+#if MENU_VIRTUAL
+        if (s_menu_handle.current->flags & MENU_FLAG_VIRTUAL)
+            s_menu_virtual_step(s_menu_handle.current, -1);
+#endif
+        MENU_TRACE(MENU_TRACE_EV_NAV, MENU_TRACE_NAV_PREV);
     }
 
     s_display_menu();
@@ -298,19 +1052,72 @@ static void s_menu_position_handling (void)
  */
 static void s_push_button_callback (void)
 {
-    if (s_menu_handle.current->child && (s_menu_handle.current->flags & MENU_FLAG_GOTO_CHILD) == MENU_FLAG_GOTO_CHILD)
+    MENU_LATENCY_MARK(MENU_LATENCY_DISPATCH);
+    MENU_TRACE(MENU_TRACE_EV_INPUT, MENU_TRACE_INPUT_PUSH);
+
+    menu_item_t *current = s_menu_handle.current;
+#if (MENU_CURSOR_MEMORY > 0)
+    menu_item_t *child   = current->resume ? current->resume : current->child;
+#else
+    menu_item_t *child   = current->child;
+#endif
+
+#if (MENU_LAZY_SUBMENUS > 0)
+    if (child == NULL && (current->flags & (MENU_FLAG_LAZY | MENU_FLAG_DISABLED)) == MENU_FLAG_LAZY)
     {
-        // Переход к дочернему элементу меню
-        s_menu_handle.current = s_menu_handle.current->child;
-    } 
-    else if (s_menu_handle.current->parent && (s_menu_handle.current->flags & MENU_FLAG_GOTO_PARENT) == MENU_FLAG_GOTO_PARENT)
+        // Первый вход в отложенное подменю: строим дочернюю цепочку
+        child = s_menu_lazy_build(current);
+    }
+#endif
+
+#if (MENU_HIDDEN_ITEMS > 0)
+    if (child && (child->flags & MENU_FLAG_HIDDEN))
     {
-        // Переход к родительскому элементу меню
-        s_menu_handle.current = s_menu_handle.current->parent;
+        // Пункт входа в подменю скрыт: входим на следующий видимый (NULL -- скрыты все)
+        child = s_menu_visible_from(child);
     }
+#endif
 
-    // Обновление отображения меню
-    s_display_menu();
+    if (child && (current->flags & (MENU_FLAG_GOTO_CHILD | MENU_FLAG_DISABLED)) == MENU_FLAG_GOTO_CHILD)
+    {
+        // Переход к дочернему элементу меню
+        s_menu_handle.current = child;
+#if MENU_VIRTUAL
+        if (child->flags & MENU_FLAG_VIRTUAL)
+            s_menu_virtual_enter(child);
+#endif
+        MENU_TRACE(MENU_TRACE_EV_NAV, MENU_TRACE_NAV_CHILD);
+    } 
+    else if (current->parent && (current->flags & (MENU_FLAG_GOTO_PARENT | MENU_FLAG_DISABLED)) == MENU_FLAG_GOTO_PARENT)
+    {
+        // Переход к родительскому элементу меню; повторный вход продолжится с этого пункта
+        menu_item_t *parent = current->parent;
+#if (MENU_CURSOR_MEMORY > 0)
+        s_menu_resume_save(current);
+#endif
+#if (MENU_HIDDEN_ITEMS > 0)
+        if (parent->flags & MENU_FLAG_HIDDEN)
+            parent = s_menu_visible_up(parent); // Родитель скрыт: первый видимый пункт его кольца
+#endif
+        s_menu_handle.current = parent;
+        MENU_TRACE(MENU_TRACE_EV_NAV, MENU_TRACE_NAV_PARENT);
+    }
+
+    // Обновление отображения меню
+    s_display_menu();
+}
+
+/**
+ * @brief Вывод кадра: строка выбранного пункта `line` и следующий пункт, а в режиме MENU_BREADCRUMB --
+ *        путь к текущему кольцу и строка выбранного пункта.
+ */
+static inline void s_menu_print (const char *line)
+{
+#if MENU_BREADCRUMB
+    printMenuHeader(s_menu_breadcrumb_follow(s_menu_handle.current->parent), line);
+#else
+    printMenu(line, s_menu_title(s_menu_handle.current->next));
+#endif
 }
 
 /**
@@ -318,7 +1125,26 @@ static void s_push_button_callback (void)
  */
 static void s_display_menu(void)
 {
-    printMenu(s_menu_handle.current->title, s_menu_handle.current->next->title);
+    MENU_LATENCY_MARK(MENU_LATENCY_RENDER);
+    MENU_TRACE(MENU_TRACE_EV_RENDER, s_menu_title(s_menu_handle.current)[0]);
+#if (MENU_MARQUEE_TITLES > 0)
+    const char *line = s_menu_marquee_follow(s_menu_handle.current);
+#else
+    const char *line = s_menu_title(s_menu_handle.current);
+#endif
+#if (MENU_STRINGS > 0) && MENU_STRINGS_PACKED
+    // Строка кэша распаковки может быть вытеснена заголовком следующего пункта (и пути):
+    // кадр выводит свою копию текущего заголовка
+    char frame[MENU_ITEM_TITLE_LEN];
+    if (s_menu_handle.packed && s_menu_handle.current->string != MENU_STRING_NONE)
+    {
+        memcpy(frame, line, MENU_ITEM_TITLE_LEN);
+        line = frame;
+    }
+#endif
+    s_menu_print(line);
+    MENU_LATENCY_MARK(MENU_LATENCY_FLUSH);
+    MENU_LATENCY_END();
 }
 
 /**
@@ -356,11 +1182,138 @@ static menu_item_t * s_create_new_item(void)
     }
     item = &s_menu_items[s_menu_handle.static_array_pos++]; // Берём следующий доступный элемент
 #elif (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
-    item = (menu_item_t *)malloc(sizeof(menu_item_t));
+    item = (menu_item_t *)MENU_MALLOC(sizeof(menu_item_t));
+    if (item == NULL && s_menu_memory_relief())
+        item = (menu_item_t *)MENU_MALLOC(sizeof(menu_item_t));
 #endif
     return item;
 }
 
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+/**
+ * @brief Нехватка памяти: освобождает индексы поиска и неактивные отложенные подменю.
+ *
+ * Подменю, в которое сейчас добавляется пункт (`adding`), не освобождается.
+ *
+ * @return Ненулевое значение, если что-то освобождено и выделение стоит повторить.
+ */
+static uint32_t s_menu_memory_relief (void)
+{
+    uint32_t freed = 0;
+#if MENU_FUZZY
+    freed += s_menu_fuzzy_drop();
+#endif
+#if MENU_SEARCH
+    freed += s_menu_search_column_drop();
+#endif
+#if (MENU_LAZY_SUBMENUS > 0)
+    freed += s_menu_lazy_trim();
+#endif
+    return freed;
+}
+#endif
+
+#if MENU_LAZY_RELEASE
+/**
+ * @brief Ближайшее отложенное подменю, в участке которого лежат потомки `parent`
+ *        (сам `parent`, если он отложенное подменю; NULL -- вне отложенных подменю).
+ */
+static menu_item_t * s_menu_lazy_owner (menu_item_t *parent)
+{
+    while (parent && !(parent->flags & MENU_FLAG_LAZY))
+        parent = parent->parent;
+    return parent;
+}
+
+/**
+ * @brief Ставит новый пункт в конец участка отложенного подменю `owner` в списке `folowing`.
+ *
+ * Участок -- потомки `owner` подряд сразу после него, включая участки вложенных отложенных
+ * подменю. Участки объемлющих подменю, кончавшиеся там же, продлеваются до нового пункта.
+ */
+static void s_menu_lazy_link (menu_item_t *owner, menu_item_t *item)
+{
+    menu_lazy_t *lazy  = &s_menu_lazy[owner->data];
+    menu_item_t *after = lazy->last ? lazy->last : owner;
+
+    item->folowing  = after->folowing;
+    after->folowing = item;
+    if (s_menu_handle.last == after)
+        s_menu_handle.last = item;
+
+    lazy->last = item;
+    for (owner = s_menu_lazy_owner(owner->parent); owner && s_menu_lazy[owner->data].last == after;
+         owner = s_menu_lazy_owner(owner->parent))
+        s_menu_lazy[owner->data].last = item;
+}
+#endif
+
+#if MENU_REGIONS
+/**
+ * @brief Берёт пункт из области отложенного подменю `owner`.
+ *
+ * В область попадают все пункты участка подменю -- созданные его построителем и добавленные
+ * в него позже: они освобождаются вместе с ним. Первый блок вмещает столько пунктов, сколько
+ * было в области при прошлом освобождении, поэтому повторное построение занимает один блок.
+ * Если на блок не хватает памяти, берётся блок на один пункт (при нехватке и на него --
+ * после s_menu_memory_relief).
+ *
+ * @return Пункт или NULL, если нет памяти и на него.
+ */
+static menu_item_t * s_menu_region_alloc (menu_item_t *owner)
+{
+    menu_lazy_t   *lazy  = &s_menu_lazy[owner->data];
+    menu_region_t *block = lazy->region;
+    if (block == NULL || block->used == block->capacity)
+    {
+        uint32_t capacity = (block == NULL && lazy->region_items > MENU_REGION_ITEMS) ? lazy->region_items : MENU_REGION_ITEMS;
+        menu_region_t *fresh = (menu_region_t *)MENU_MALLOC(sizeof(menu_region_t) + (size_t)capacity * sizeof(menu_item_t));
+        if (fresh == NULL)
+        {
+            capacity = 1;
+            fresh = (menu_region_t *)MENU_MALLOC(sizeof(menu_region_t) + sizeof(menu_item_t));
+            if (fresh == NULL && s_menu_memory_relief())
+                fresh = (menu_region_t *)MENU_MALLOC(sizeof(menu_region_t) + sizeof(menu_item_t));
+        }
+        if (fresh == NULL)
+            return NULL;
+
+        fresh->next     = block;
+        fresh->used     = 0;
+        fresh->capacity = capacity;
+        lazy->region    = block = fresh;
+    }
+
+    return &block->items[block->used++];
+}
+
+/**
+ * @brief Освобождает блоки области записи `slot` и запоминает число пунктов в ней.
+ *
+ * Вызовов free -- по блокам области, а не по пунктам; пункты к этому моменту исключены из меню.
+ *
+ * @return Количество пунктов в освобождённых блоках.
+ */
+static uint32_t s_menu_region_release (uint32_t slot)
+{
+    menu_lazy_t *lazy  = &s_menu_lazy[slot];
+    uint32_t     items = 0;
+
+    if (lazy->region == NULL)
+        return 0; // Не построено или уже освобождено: число пунктов прошлого построения сохраняется
+
+    while (lazy->region)
+    {
+        menu_region_t *next = lazy->region->next;
+        items += lazy->region->used;
+        MENU_FREE(lazy->region);
+        lazy->region = next;
+    }
+    lazy->region_items = items;
+    return items;
+}
+#endif
+
 /**
  * @brief Переинициализация цепочки подменю по родителю
  *
@@ -378,15 +1331,37 @@ static void s_menu_rechain (menu_item_t *parent)
     // Указатель на предыдущий элемент в новом двусвязном списке
     menu_item_t *prev  = NULL;
 
+    // Первый и последний элементы полного кольца (включая скрытые)
+    menu_item_t *all_first = NULL;
+#if (MENU_HIDDEN_ITEMS > 0)
+    menu_item_t *all_last  = NULL;
+#endif
+
     // Указатель, с которого начинается обход текущего списка меню 
     menu_item_t *item  = s_menu_handle.start;
 
     // Перебираем все элементы в исходном списке
     while (item)
     {
-        // Проверяем, принадлежит ли текущий элемент указанному родителю
         if (item->parent == parent)
         {
+#if (MENU_HIDDEN_ITEMS > 0)
+            // Полное кольцо назад: по нему скрытый пункт находит своё место при показе
+            item->sibling_prev = all_last;
+            if (all_last)
+                all_last->sibling_next = item;
+#endif
+            item->first = (all_first == NULL);
+            if (all_first == NULL)
+                all_first = item;
+#if (MENU_HIDDEN_ITEMS > 0)
+            all_last = item;
+#endif
+        }
+
+        // Проверяем, принадлежит ли текущий элемент указанному родителю (скрытые в кольцо не входят)
+        if (item->parent == parent && !MENU_HIDDEN(item))
+        {
             // Если это первый элемент в подменю, запоминаем его
             if (first == NULL)
             {
@@ -405,6 +1380,11 @@ static void s_menu_rechain (menu_item_t *parent)
                 prev->next = item;
             }
 
+#if (MENU_POSITION_INDICATOR > 0)
+            // Номер среди видимых пунктов кольца
+            item->ordinal = (prev ? prev->ordinal : 0) + 1;
+#endif
+
             // Обновляем указатель предыдущего элемента для следующей итерации
             prev = item;
         }
@@ -423,6 +1403,43 @@ static void s_menu_rechain (menu_item_t *parent)
     {
         prev->next = first; // Замыкаем кольцо: последний элемент ссылается на первый
     }
+
+#if (MENU_POSITION_INDICATOR > 0)
+    // Количество видимых пунктов кольца -- номер последнего
+    uint32_t count = prev ? prev->ordinal : 0;
+    if (parent)
+        parent->children = count;
+    else
+        s_menu_handle.root_children = count;
+#endif
+
+#if (MENU_HIDDEN_ITEMS > 0)
+    if (all_first)
+    {
+        all_first->sibling_prev = all_last;
+        all_last->sibling_next  = all_first;
+    }
+
+    // Скрытые пункты ссылаются на видимых соседей: курсор, оказавшийся на скрытом пункте
+    // (переход к скрытому родителю), уходит с него в кольцо. Обход назад: `after` -- ближайший
+    // видимый после пункта по кругу (NULL -- скрыты все, пункт ссылается на себя).
+    menu_item_t *after = first;
+    for (item = all_last; item; item = item->sibling_prev)
+    {
+        if (item->flags & MENU_FLAG_HIDDEN)
+        {
+            item->next = after ? after : item;
+            item->prev = after ? after->prev : item;
+        }
+        else
+        {
+            after = item;
+        }
+
+        if (item == all_first)
+            break;
+    }
+#endif
 }
 
 /**
@@ -439,130 +1456,2831 @@ static void s_menu_rechain (menu_item_t *parent)
  */
 static menu_item_t* s_menu_add_item(char *title, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags)
 {
-    // Создаём новый элемент меню с помощью вспомогательной функции s_create_new_item.
-    menu_item_t *item = s_create_new_item();
+    return s_menu_add_entry(title, MENU_STRING_NONE, parent, callback, flags);
+}
+
+/**
+ * @brief Создаёт пункт с заголовком `title` или, если `title` NULL, со строкой `string` таблицы языка.
+ *        Общая часть s_menu_add_item и s_menu_add_string.
+ */
+static menu_item_t * s_menu_add_entry (char *title, uint32_t string, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags)
+{
+    // Создаём новый элемент меню: из области отложенного подменю, в которое он попадает, или s_create_new_item.
+    // При нехватке памяти подменю родителя не освобождается (`adding`).
+#if MENU_LAZY_RELEASE
+    menu_item_t *owner = s_menu_lazy_owner(parent);
+    s_menu_handle.adding = parent;
+#if MENU_REGIONS
+    menu_item_t *item  = owner ? s_menu_region_alloc(owner) : s_create_new_item();
+#else
+    menu_item_t *item  = s_create_new_item();
+#endif
+    s_menu_handle.adding = NULL;
+#else
+    menu_item_t *item  = s_create_new_item();
+#endif
     
     // Если создать элемент не удалось, возвращаем NULL.
     if (item == NULL)
         return NULL; // Ошибка создания нового элемента
 
     // Инициализация нового элемента меню.
-    // Копируем заголовок в поле title. Количество копируемых символов ограничено MENU_ITEM_TITLE_LEN.
-    strncpy(item->title, title, MENU_ITEM_TITLE_LEN);
+#if (MENU_STRINGS > 0)
+    item->string = (uint16_t)string;
+#else
+    (void)string;
+#endif
+#if (MENU_MARQUEE_TITLES > 0)
+    item->marquee = 0;
+#endif
+    if (title == NULL)
+    {
+        memset(item->title, 0, MENU_ITEM_TITLE_LEN); // Заголовок -- строка таблицы языка
+    }
+    else
+    {
+#if MENU_TITLE_CHARSET
+        // Заголовок UTF-8 перекодируется в коды дисплея один раз: MENU_ITEM_TITLE_LEN знаков, а не байт.
+        lcd1602_transcode(item->title, MENU_ITEM_TITLE_LEN, title);
+#else
+        // Копируем заголовок в поле title. Количество копируемых символов ограничено MENU_ITEM_TITLE_LEN.
+        s_menu_copy_title(item->title, title);
+#endif
+    }
     item->parent   = parent;   // Устанавливаем родительский элемент.
     item->child    = NULL;     // Пока у нового элемента нет дочерних элементов.
+#if (MENU_CURSOR_MEMORY > 0)
+    item->resume   = NULL;     // Вход в подменю -- с `child`, пока из него не выходили.
+#endif
     item->flags    = flags;    // Устанавливаем флаги элемента.
     item->callback = callback; // Устанавливаем callback-функцию, если она есть.
     item->folowing = NULL;     // Следующий элемент в цепочке пока не определён.
+#if (MENU_JUMP_INDEX > 0)
+    item->jump     = NULL;     // Пункт ещё не в индексе быстрого перехода.
+#endif
+    item->data     = 0;        // Значение пункта (s_menu_set_value); в куче память не обнулена.
+    item->first    = 0;        // Начало полного кольца отметит s_menu_rechain.
+#if (MENU_POSITION_INDICATOR > 0)
+    item->ordinal  = 0;        // Номер задаст s_menu_rechain.
+    item->children = 0;        // Дочернего кольца пока нет.
+#endif
 
-    // Если в текущем контексте меню установлен текущий элемент...
-    if (s_menu_handle.current) 
+    // Добавляем элемент в конец односвязного списка (пункт отложенного подменю -- в конец его участка).
+    // Курсор (current) не трогаем: пункты могут создаваться и во время работы меню (отложенные подменю).
+#if MENU_LAZY_RELEASE
+    if (owner)
     {
-        // Указываем, что после текущего элемента идёт только что созданный элемент.
-        s_menu_handle.current->folowing = item;
-        // Необходимо для отладки, чтобы увидеть, как связаны элементы (закомментировано).
-        // printf("%s => %s\r\n", s_menu_handle.current->title, item->title);
+        s_menu_lazy_link(owner, item);
     }
+    else
+#endif
+    {
+        if (s_menu_handle.last)
+        {
+            s_menu_handle.last->folowing = item;
+        }
 
-    // Устанавливаем созданный элемент как текущий элемент меню.
-    s_menu_handle.current = item;
+        s_menu_handle.last = item;
+    }
 
     // Если начальный элемент (стартовый) цепочки ещё не определён, устанавливаем созданный элемент.
+    // Это первый пункт нового дерева: индекс быстрого перехода от прежнего дерева сбрасывается.
     if (s_menu_handle.start == NULL)
     {
         s_menu_handle.start = item;
+#if (MENU_JUMP_INDEX > 0)
+        s_menu_jump_rebuild();
+#endif
+#if MENU_FUZZY
+        s_menu_fuzzy_drop();
+#endif
+#if MENU_SEARCH
+        s_menu_search_close();
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+        s_menu_search_column_drop();
+#endif
+#endif
     }
 
     // Переинициализируем цепочку подменю для указанного родителя.
     s_menu_rechain(parent);
 
+#if (MENU_JUMP_INDEX > 0)
+    // Пункт добавлен в конец кольца: он же последний в кольце своей буквы
+    s_menu_jump_add(item);
+#endif
+#if MENU_SEARCH && (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_search_column_add(item);
+#endif
+#if MENU_FUZZY
+    s_menu_fuzzy_add(item);
+#endif
+
     // Возвращаем указатель на созданный элемент меню.
     return item;
 }
 
+#if (MENU_STRINGS > 0)
+/**
+ * @brief Добавляет пункт, заголовок которого -- строка `string` таблицы языка.
+ *
+ * Текст не копируется: отрисовка, поиск и быстрый переход читают строку из таблицы текущего
+ * языка (s_menu_title), поэтому смена языка (Menu_SetLanguage) не трогает пункты.
+ *
+ * @return Пункт или NULL, если язык не задан, `string` вне таблицы или нет памяти.
+ */
+MENU_UNUSED static menu_item_t * s_menu_add_string (uint32_t string, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags)
+{
+#if MENU_STRINGS_PACKED
+    if (s_menu_handle.packed && string < MENU_STRINGS && string < s_menu_handle.packed->count)
+        return s_menu_add_entry(NULL, string, parent, callback, flags);
+#endif
+    if (s_menu_handle.strings == NULL || string >= MENU_STRINGS)
+        return NULL;
+
+    return s_menu_add_entry(NULL, string, parent, callback, flags);
+}
+
+/**
+ * @brief Переключает язык: заменяет таблицу строк и перерисовывает меню.
+ *
+ * Таблица -- MENU_STRINGS строк по MENU_ITEM_TITLE_LEN байт, обычно константа в ПЗУ, одна на
+ * язык. Пункты хранят номера строк, поэтому смена языка -- замена указателя и перерисовка.
+ * Индексы, построенные по тексту заголовков, сбрасываются и строятся заново при следующем
+ * обращении: быстрый переход -- при нажатии буквы, столбец поиска и нечёткий индекс -- при
+ * запросе. Окна виртуальных списков перезаполняются источником при прокрутке.
+ */
+void Menu_SetLanguage (const menu_string_t *strings)
+{
+#if MENU_STRINGS_PACKED
+    if (strings == NULL || (strings == s_menu_handle.strings && s_menu_handle.packed == NULL))
+        return;
+    s_menu_handle.packed = NULL;
+#else
+    if (strings == NULL || strings == s_menu_handle.strings)
+        return;
+#endif
+
+    s_menu_handle.strings = strings;
+    s_menu_language_changed();
+}
 
+#if MENU_STRINGS_PACKED
 /**
- * @brief Настройка элемента меню для перехода в дочернюю цепочку 
- * и перехода из родительского элемента по клику в родительскую цепочку.
+ * @brief Переключает язык на сжатую таблицу строк (tools/title_pack.c) и перерисовывает меню.
  *
- * @param item Указатель на элемент меню, который будет настроен для перехода.
- * @param child Указатель на дочерний элемент меню, к которому будет осуществлён переход.
+ * Заголовки распаковываются по одному, только когда их читают (кадр, поиск), в кэш из
+ * MENU_PACKED_LINES строк; пункты и индексы -- как при Menu_SetLanguage.
  */
-static void s_menu_set_child(menu_item_t *item, menu_item_t *child)
+void Menu_SetLanguagePacked (const menu_packed_t *packed)
 {
-    // Проверяем, что переданный элемент item не является NULL.
-    if (item)
+    if (packed == NULL || packed == s_menu_handle.packed)
+        return;
+
+    s_menu_handle.packed  = packed;
+    s_menu_handle.strings = NULL;
+    for (uint32_t i = 0; i < MENU_PACKED_LINES; i++)
+        s_menu_unpack_lines[i].string = MENU_STRING_NONE;
+    s_menu_language_changed();
+}
+#endif
+
+/**
+ * @brief Общая часть смены языка: индексы по тексту заголовков сбрасываются, меню перерисовывается.
+ */
+static void s_menu_language_changed (void)
+{
+    s_menu_handle.jump_stale = 1;
+#if MENU_BREADCRUMB
+    s_menu_handle.breadcrumb.valid = 0; // Заголовки уровней пути сменились
+#endif
+#if MENU_FUZZY
+    s_menu_fuzzy_drop();
+#endif
+#if MENU_SEARCH && (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    s_menu_search_column_drop();
+#endif
+
+    if (s_menu_handle.current)
+        s_display_menu();
+}
+#endif
+
+#if (MENU_MARQUEE_TITLES > 0)
+/**
+ * @brief Добавляет пункт с заголовком длиннее строки дисплея.
+ *
+ * Текст не копируется и должен жить, пока жив пункт (константа в ПЗУ); в поле `title` попадают
+ * его первые MENU_ITEM_TITLE_LEN байт, по ним работают поиск и быстрый переход. Когда пункт
+ * выбран, его заголовок бежит по строке (Menu_Tick). Запись берётся одна на текст: отложенное
+ * подменю, построенное повторно с тем же текстом, новой записи не занимает.
+ *
+ * @return Пункт или NULL, если нет памяти. Текст короче MENU_MARQUEE_WIDTH + 1 знаков или
+ *         нехватка записей -- обычный пункт с обрезанным заголовком.
+ */
+MENU_UNUSED static menu_item_t * s_menu_add_long (const char *text, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags)
+{
+    menu_item_t *item = s_menu_add_item((char *)text, parent, callback, flags);
+    size_t length = strlen(text);
+
+    if (item == NULL || length <= MENU_MARQUEE_WIDTH || length > UINT16_MAX)
+        return item;
+
+    uint32_t slot = 0;
+    while (slot < s_menu_handle.marquee_titles && s_menu_marquee[slot].text != text)
+        slot++;
+
+    if (slot == s_menu_handle.marquee_titles)
     {
-        // Устанавливаем указатель на дочерний элемент для текущего элемента меню.
-        item->child = child;
-        
-        // Устанавливаем флаг MENU_FLAG_GOTO_CHILD для текущего элемента меню,
-        // чтобы указать, что у него есть возможность перейти к дочернему элементу.
-        item->flags |= MENU_FLAG_GOTO_CHILD;
+        if (slot >= MENU_MARQUEE_TITLES)
+            return item;
+        s_menu_marquee[slot].text   = text;
+        s_menu_marquee[slot].length = (uint16_t)length;
+        s_menu_handle.marquee_titles++;
     }
+
+    item->marquee = (uint8_t)(slot + 1);
+    return item;
 }
 
-#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
 /**
- * @brief Рекурсивное освобождение памяти всех элементов меню.
- * 
- * Эта функция рекурсивно освобождает память, занятую элементами меню,
- * начиная с указанного элемента и продолжая перерабатывать связанный
- * список всех подчинённых элементов. 
+ * @brief Заголовок выбранного пункта для перерисовки: видимая часть бегущей строки.
  *
- * @param item Указатель на элемент меню, начиная с которого будет
- * осуществляться освобождение памяти. Если указанный элемент или его дочерний
- * элемент равен `NULL`, функция завершает выполнение сразу.
- *
- * @details
- * Функция сначала проверяет, не является ли текущий элемент или его дочерний
- * элемент пустыми. В случае, если дочерний элемент не пуст, функция вызывает
- * сама себя рекурсивно для освобождения памяти всех дочерних элементов.
- * 
- * Затем функция проходит через все элементы в цепочке, начиная с текущего
- * элемента, и освобождает память для каждого из них. Если элемент имеет своих 
- * дочерних элементов, то они также освобождаются рекурсивно.
+ * Вызывается из s_display_menu. Выбран другой пункт -- строка начинается сначала с паузой
+ * MENU_MARQUEE_HOLD шагов; тот же пункт (перерисовка после правки значения) -- остаётся на месте.
+ */
+static const char * s_menu_marquee_follow (const menu_item_t *item)
+{
+    menu_marquee_t *marquee = &s_menu_handle.marquee;
+
+    if (item != marquee->item)
+    {
+        marquee->item = NULL;
+        if (item->marquee == 0)
+            return s_menu_title(item);
+
+        const menu_marquee_title_t *title = &s_menu_marquee[item->marquee - 1];
+        marquee->item   = item;
+        marquee->text   = title->text;
+        marquee->offset = 0;
+        marquee->last   = (uint16_t)(title->length - MENU_MARQUEE_WIDTH);
+        marquee->hold   = MENU_MARQUEE_HOLD;
+        marquee->armed  = 0;
+    }
+
+    return marquee->item ? marquee->text + marquee->offset : s_menu_title(item);
+}
+
+/**
+ * @brief Шаг бегущей строки. Вызывается с текущим временем в мс раз в 10..50 мс; период
+ *        шага -- MENU_MARQUEE_STEP_MS.
  *
- * Наконец, сам исходный элемент также освобождается.
+ * Шаг рисует через printMenu, поэтому Menu_Tick вызывается в том же контексте, что и
+ * обработчики ввода (задача taskReadKey или основной цикл), а не из прерывания: иначе он
+ * войдёт в драйвер дисплея посреди кадра обработчика. Таймер (SysTick) только отмечает
+ * срок, вызов делает основной цикл.
  *
- * Это прекращает использование и утечку памяти, гарантируя, что вся
- * память, выделенная для меню, корректно освобождается.
+ * Пока выбран пункт с коротким заголовком, стоит одно сравнение. Шаг сдвигает заголовок на
+ * знак и перерисовывает меню через printMenu: вторая строка не меняется, и драйвер с теневым
+ * буфером (LCD1602_RENDER_DIFF) пишет на шину только изменившиеся знаки первой строки.
+ * Дойдя до конца, строка стоит MENU_MARQUEE_HOLD шагов и возвращается к началу.
  */
-static void s_menu_free_items (void)
+void Menu_Tick (uint32_t now_ms)
 {
-    menu_item_t *item = s_menu_handle.start;
-    menu_item_t *next = NULL;
-    while(item->folowing)
+    menu_marquee_t *marquee = &s_menu_handle.marquee;
+
+    if (marquee->item == NULL)
+        return;
+
+    // Пункт мог смениться без перерисовки (освобождение подменю): строка останавливается
+    if (marquee->item != s_menu_handle.current)
     {
-        next = item->folowing;
-        free(item);
-        item = next;
+        marquee->item = NULL;
+        return;
+    }
+
+    if (!marquee->armed)
+    {
+        marquee->armed = 1;
+        marquee->due   = now_ms + MENU_MARQUEE_STEP_MS;
+        return;
+    }
+
+    // Сравнение через разность: переход счётчика миллисекунд через 0 не останавливает строку
+    if ((int32_t)(now_ms - marquee->due) < 0)
+        return;
+    marquee->due = now_ms + MENU_MARQUEE_STEP_MS;
+
+    if (marquee->hold)
+    {
+        marquee->hold--;
+        return;
+    }
+
+    if (marquee->offset < marquee->last)
+    {
+        marquee->offset++;
+        if (marquee->offset == marquee->last)
+            marquee->hold = MENU_MARQUEE_HOLD;
+    }
+    else
+    {
+        marquee->offset = 0;
+        marquee->hold   = MENU_MARQUEE_HOLD;
     }
-}
 
+    s_menu_print(marquee->text + marquee->offset);
+}
 #endif
 
+#if MENU_BREADCRUMB
+#define MENU_BREADCRUMB_MIN 3 ///< Знаков, до которых сокращается заголовок уровня
 
 /**
- * @brief Обратный вызов для обработки длительного нажатия кнопки, 
- * переходящий к родительскому элементу меню или к стартовому элементу меню.
+ * @brief Длина заголовка уровня пути: без хвостовых пробелов или, если `compact`, без всех пробелов.
  */
-static void s_long_push_button_callback (void)
+static uint32_t s_menu_breadcrumb_length (const menu_item_t *item, int compact)
 {
-    // Проверяем, есть ли у текущего элемента меню родительский элемент.
-    if (s_menu_handle.current->parent)
+    const char *title  = s_menu_title(item);
+    uint32_t    length = (uint32_t)strnlen(title, MENU_ITEM_TITLE_LEN);
+    uint32_t    spaces = 0;
+
+    while (length && title[length - 1] == ' ')
+        length--;
+    if (compact)
+    {
+        for (uint32_t i = 0; i < length; i++)
+            spaces += title[i] == ' ';
+    }
+    return length - spaces;
+}
+
+/**
+ * @brief Дописывает к `out` не больше `limit` знаков заголовка; `compact` -- без пробелов.
+ */
+static char * s_menu_breadcrumb_put (char *out, const menu_item_t *item, uint32_t limit, int compact)
+{
+    const char *title = s_menu_title(item);
+    char       *start = out;
+
+    for (uint32_t i = 0; i < MENU_ITEM_TITLE_LEN && title[i] && limit; i++)
     {
-        // Устанавливаем текущий элемент меню как его родительский элемент.
-        s_menu_handle.current = s_menu_handle.current->parent;
+        if (compact && title[i] == ' ')
+            continue;
+        *out++ = title[i];
+        limit--;
+    }
+    while (out > start && out[-1] == ' ') // Хвостовые пробелы обрезанного заголовка
+        out--;
+    return out;
+}
 
-        // Вызываем функцию для обновления и отображения меню.
-        s_display_menu();
-    } 
-    else 
+/**
+ * @brief Укладывает путь в MENU_BREADCRUMB_WIDTH знаков.
+ *
+ * По порядку, пока строка не помещается:
+ * 1. заголовки целиком через '>';
+ * 2. внешние уровни без пробелов и обрезаны до общей наибольшей длины (не короче MENU_BREADCRUMB_MIN),
+ *    последний уровень -- целиком;
+ * 3. внешние уровни по MENU_BREADCRUMB_MIN знаков, последний -- на оставшееся место;
+ * 4. самый внешний уровень отбрасывается, строка начинается с '<', и всё повторяется.
+ * Последний уровень (родитель текущего кольца) остаётся всегда, при нехватке места -- обрезанным.
+ */
+static void s_menu_breadcrumb_fit (menu_breadcrumb_t *crumb)
+{
+    uint8_t  compact[MENU_BREADCRUMB_DEPTH];
+    uint32_t first = 0;
+    uint32_t last  = crumb->depth - 1;
+    uint32_t cap   = 0;     // 0 -- уровни целиком
+    uint32_t tail  = crumb->length[last];
+    int      pack  = 0;     // Внешние уровни без пробелов
+
+    for (uint32_t i = 0; i < crumb->depth; i++)
+        compact[i] = (uint8_t)s_menu_breadcrumb_length(crumb->path[i], 1);
+
+    for (;;)
     {
-        // Если у текущего элемента нет родителя, устанавливаем текущий элемент
-        // меню как стартовый элемент меню (корневой элемент).
-        s_menu_handle.current = s_menu_handle.start;
+        uint32_t prefix = (crumb->clipped || first) ? 1 : 0;
+        uint32_t fixed  = prefix + (last - first);   // '<' и разделители
+        uint32_t full   = fixed;
+        for (uint32_t i = first; i <= last; i++)
+            full += crumb->length[i];
+
+        if (full <= MENU_BREADCRUMB_WIDTH)
+        {
+            cap = 0;
+            tail = crumb->length[last];
+            pack = 0;
+            break;
+        }
+
+        // Внешние уровни сокращаются до общей длины `cap`, последний -- целиком
+        uint32_t longest = 0;
+        for (uint32_t i = first; i < last; i++)
+            longest = compact[i] > longest ? compact[i] : longest;
+
+        pack = 1;
+        tail = crumb->length[last];
+        for (cap = longest; cap >= MENU_BREADCRUMB_MIN; cap--)
+        {
+            uint32_t width = fixed + tail;
+            for (uint32_t i = first; i < last; i++)
+                width += compact[i] < cap ? compact[i] : cap;
+            if (width <= MENU_BREADCRUMB_WIDTH)
+                break;
+        }
+        if (cap >= MENU_BREADCRUMB_MIN || first == last)
+        {
+            if (cap < MENU_BREADCRUMB_MIN)
+                cap = MENU_BREADCRUMB_MIN;
+            break;
+        }
+
+        // Последний уровень -- на место, оставшееся от внешних по MENU_BREADCRUMB_MIN знаков
+        uint32_t width = fixed;
+        for (uint32_t i = first; i < last; i++)
+            width += compact[i] < MENU_BREADCRUMB_MIN ? compact[i] : MENU_BREADCRUMB_MIN;
+        if (width + MENU_BREADCRUMB_MIN <= MENU_BREADCRUMB_WIDTH)
+        {
+            cap  = MENU_BREADCRUMB_MIN;
+            tail = MENU_BREADCRUMB_WIDTH - width;
+            break;
+        }
+
+        first++;
+    }
+
+    char *out = crumb->text;
+    if (crumb->clipped || first)
+        *out++ = '<';
+    for (uint32_t i = first; i < last; i++)
+    {
+        out = s_menu_breadcrumb_put(out, crumb->path[i], cap ? cap : crumb->length[i], pack);
+        *out++ = '>';
+    }
+
+    // Последний уровень: целиком или обрезан до `tail`; первым -- до ширины за вычетом '<'
+    uint32_t room = MENU_BREADCRUMB_WIDTH - (uint32_t)(out - crumb->text);
+    out = s_menu_breadcrumb_put(out, crumb->path[last], tail < room ? tail : room, 0);
+    *out = '\0';
+}
+
+/**
+ * @brief Строка пути для кольца с родителем `parent`. Вызывается при каждом выводе кадра.
+ *
+ * Тот же родитель (поворот энкодера) -- готовая строка, одно сравнение. Вход в подменю и выход
+ * из него -- добавление или снятие одного уровня и укладка строки; другой переход (результат
+ * поиска, смена языка) -- построение заново по цепочке родителей.
+ */
+static const char * s_menu_breadcrumb_follow (const menu_item_t *parent)
+{
+    menu_breadcrumb_t *crumb = &s_menu_handle.breadcrumb;
+
+    if (crumb->valid && parent == crumb->parent)
+        return crumb->text;
+
+    if (parent == NULL)
+    {
+        crumb->depth   = 0;
+        crumb->clipped = 0;
+    }
+    else if (crumb->valid && parent->parent == crumb->parent && crumb->depth < MENU_BREADCRUMB_DEPTH)
+    {
+        // Вход в подменю: уровень добавляется
+        crumb->path[crumb->depth]   = parent;
+        crumb->length[crumb->depth] = (uint8_t)s_menu_breadcrumb_length(parent, 0);
+        crumb->depth++;
+    }
+    else if (crumb->valid && crumb->depth >= 2 && !crumb->clipped && parent == crumb->path[crumb->depth - 2])
+    {
+        // Выход к родителю: уровень снимается
+        crumb->depth--;
+    }
+    else
+    {
+        uint32_t depth = 0;
+        for (const menu_item_t *item = parent; item; item = item->parent)
+            depth++;
+
+        crumb->clipped = depth > MENU_BREADCRUMB_DEPTH;
+        crumb->depth   = (uint8_t)(crumb->clipped ? MENU_BREADCRUMB_DEPTH : depth);
+
+        const menu_item_t *item = parent;
+        for (uint32_t i = crumb->depth; i > 0; i--, item = item->parent)
+        {
+            crumb->path[i - 1]   = item;
+            crumb->length[i - 1] = (uint8_t)s_menu_breadcrumb_length(item, 0);
+        }
+    }
+
+    crumb->parent = parent;
+    crumb->valid  = 1;
+
+    if (crumb->depth)
+        s_menu_breadcrumb_fit(crumb);
+    else
+        snprintf(crumb->text, sizeof(crumb->text), "%s", MENU_BREADCRUMB_ROOT);
+    return crumb->text;
+}
+#endif
+
+
+/**
+ * @brief Настройка элемента меню для перехода в дочернюю цепочку 
+ * и перехода из родительского элемента по клику в родительскую цепочку.
+ *
+ * @param item Указатель на элемент меню, который будет настроен для перехода.
+ * @param child Указатель на дочерний элемент меню, к которому будет осуществлён переход.
+ */
+static void s_menu_set_child(menu_item_t *item, menu_item_t *child)
+{
+    // Проверяем, что переданный элемент item не является NULL.
+    if (item)
+    {
+        // Устанавливаем указатель на дочерний элемент для текущего элемента меню.
+        item->child = child;
+        
+        // Устанавливаем флаг MENU_FLAG_GOTO_CHILD для текущего элемента меню,
+        // чтобы указать, что у него есть возможность перейти к дочернему элементу.
+        item->flags |= MENU_FLAG_GOTO_CHILD;
+    }
+}
+
+#if (MENU_HIDDEN_ITEMS > 0)
+/**
+ * @brief Первый видимый пункт кольца, начиная с `item` (сам `item`, если он не скрыт).
+ *
+ * Ближайший видимый пункт перед `item` ищется обходом полного кольца назад (`sibling_prev`),
+ * его `next` -- первый видимый после `item`. Стоимость -- число скрытых пунктов подряд.
+ *
+ * @return Пункт или NULL, если скрыты все пункты кольца.
+ */
+MENU_COLD static menu_item_t * s_menu_visible_from (menu_item_t *item)
+{
+    if (item == NULL || !(item->flags & MENU_FLAG_HIDDEN))
+        return item;
+
+    for (menu_item_t *walk = item->sibling_prev; walk != item; walk = walk->sibling_prev)
+    {
+        if (!(walk->flags & MENU_FLAG_HIDDEN))
+            return walk->next;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Пункт, на который встаёт курсор вместо `item` при переходе вверх по дереву.
+ *
+ * Сам `item`, если он не скрыт, иначе первый видимый пункт его кольца. Если скрыто всё
+ * кольцо -- то же для родителя; в корне со всеми скрытыми пунктами возвращается `item`.
+ * Путь нажатия вызывает её, только если `item` скрыт (MENU_FLAG_HIDDEN проверяется на месте).
+ */
+MENU_COLD static menu_item_t * s_menu_visible_up (menu_item_t *item)
+{
+    while (item && (item->flags & MENU_FLAG_HIDDEN))
+    {
+        menu_item_t *visible = s_menu_visible_from(item);
+        if (visible)
+            return visible;
+        if (item->parent == NULL)
+            return item;
+        item = item->parent;
+    }
+    return item;
+}
+
+/**
+ * @brief Скрывает пункт или показывает его снова, не перестраивая кольцо.
+ *
+ * Кольцо `prev`/`next` содержит только видимые пункты, поэтому шаг энкодера остаётся O(1)
+ * при любом числе скрытых соседей, а смена видимости -- O(1): с MENU_POSITION_INDICATOR
+ * меняется только счётчик кольца и ставится его бит MENU_RING_STALE, номера пунктов
+ * пересчитает следующий Menu_Position. Скрытие вынимает пункт из кольца
+ * (его `prev`/`next` продолжают указывать на бывших соседей), показ вставляет его после
+ * ближайшего видимого предшественника в полном кольце. Если курсор был на пункте или внутри его подменю, он
+ * переходит к следующему видимому пункту (к родителю, если видимых не осталось) и меню
+ * перерисовывается. Если курсор стоит на скрытом пункте кольца, где скрыты все, показ
+ * пункта переводит курсор на него. Окна виртуальных списков не скрываются.
+ *
+ * Видимость пункта с условием (s_menu_add_predicate) задаётся условием и будет
+ * перезаписана при его следующем пересчёте.
+ */
+MENU_UNUSED static void s_menu_set_visible (menu_item_t *item, int visible)
+{
+    if (s_menu_visible_apply(item, visible))
+        s_display_menu();
+}
+
+/**
+ * @brief Меняет видимость пункта без перерисовки (s_menu_set_visible).
+ * @return 1, если курсор переставлен и меню нужно перерисовать.
+ */
+static int s_menu_visible_apply (menu_item_t *item, int visible)
+{
+    if (item == NULL || (item->flags & MENU_FLAG_VIRTUAL) || !(item->flags & MENU_FLAG_HIDDEN) == !!visible)
+        return 0;
+
+#if (MENU_POSITION_INDICATOR > 0)
+    uint32_t *count = s_menu_ring_count(item);
+    *count = (visible ? *count + 1 : *count - 1) | MENU_RING_STALE;
+#endif
+
+    if (visible)
+    {
+        item->flags &= (uint8_t)~MENU_FLAG_HIDDEN;
+
+        menu_item_t *prev = item->sibling_prev;
+        while (prev != item && (prev->flags & MENU_FLAG_HIDDEN))
+            prev = prev->sibling_prev;
+
+        if (prev == item)
+        {
+            // Единственный видимый пункт кольца
+            item->prev = item;
+            item->next = item;
+        }
+        else
+        {
+            item->prev       = prev;
+            item->next       = prev->next;
+            prev->next->prev = item;
+            prev->next       = item;
+        }
+
+        // Курсор остался на скрытом пункте этого кольца (были скрыты все): переходим на показанный
+        menu_item_t *current = s_menu_handle.current;
+        if (current && (current->flags & MENU_FLAG_HIDDEN) && current->parent == item->parent)
+        {
+            s_menu_handle.current = item;
+            return 1;
+        }
+        return 0;
+    }
+
+    item->flags |= MENU_FLAG_HIDDEN;
+    item->prev->next = item->next;
+    item->next->prev = item->prev;
+
+    menu_item_t *current = s_menu_handle.current;
+    if (current == item || s_menu_is_descendant(current, item))
+    {
+        menu_item_t *target = item->next != item ? item->next : s_menu_visible_up(item->parent);
+        if (target)
+        {
+            s_menu_handle.current = target;
+            return 1;
+        }
+    }
+    return 0;
+}
+
+#endif
+
+/**
+ * @brief Разрешает или запрещает пункт: запрещённый виден и выбирается энкодером, но нажатие
+ *        (переход в подменю, к родителю) и callback не выполняются.
+ */
+MENU_UNUSED static void s_menu_set_enabled (menu_item_t *item, int enabled)
+{
+    if (item == NULL)
+        return;
+
+    if (enabled)
+        item->flags &= (uint8_t)~MENU_FLAG_DISABLED;
+    else
+        item->flags |= MENU_FLAG_DISABLED;
+}
+
+#if (MENU_PREDICATES > 0)
+/**
+ * @brief Первая запись зависимостей с источником не меньше `source` (двоичный поиск).
+ */
+static uint32_t s_menu_predicate_dep_find (const menu_item_t *source)
+{
+    uint32_t lo = 0;
+    uint32_t hi = s_menu_handle.predicate_deps;
+
+    while (lo < hi)
+    {
+        uint32_t mid = lo + (hi - lo) / 2;
+        if ((uintptr_t)s_menu_predicate_dep[mid].source < (uintptr_t)source)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    return lo;
+}
+
+/**
+ * @brief Задаёт видимость пункта условием `predicate`, зависящим от значений пунктов `sources`.
+ *
+ * Условие вычисляется сразу, затем -- только после изменения значения одного из `sources`
+ * (s_menu_set_value или s_menu_value_changed), поэтому перерисовка и шаг энкодера условий
+ * не вычисляют. Изменение значения пересчитывает лишь зависящие от него условия.
+ * Например, "Frequency" видна, только если включён ШИМ:
+ * `s_menu_add_predicate(menu_pwm_freq, s_pwm_enabled, &menu_pwm_enable, 1)`.
+ *
+ * @param sources Пункты, от значений которых зависит условие (`count` штук).
+ * @return Пункт или NULL, если закончились записи условий (MENU_PREDICATES) или
+ *         зависимостей (MENU_PREDICATE_DEPS); тогда пункт остаётся видимым.
+ */
+MENU_UNUSED static menu_item_t * s_menu_add_predicate (menu_item_t *item, menu_predicate_t predicate, menu_item_t **sources, uint32_t count)
+{
+    uint32_t slot = 0;
+
+    if (item == NULL || predicate == NULL || (item->flags & MENU_FLAG_VIRTUAL) || (count && sources == NULL))
+        return NULL;
+
+    // Записи условий освобождённых подменю используются повторно
+    while (slot < s_menu_handle.predicates && s_menu_predicate[slot].item != NULL)
+        slot++;
+    if (slot >= MENU_PREDICATES)
+        return NULL;
+
+    if (count > MENU_PREDICATE_DEPS - s_menu_handle.predicate_deps)
+        return NULL;
+
+    // Вставка с сохранением порядка по адресу источника
+    for (uint32_t i = 0; i < count; i++)
+    {
+        uint32_t dep = s_menu_predicate_dep_find(sources[i]);
+
+        memmove(&s_menu_predicate_dep[dep + 1], &s_menu_predicate_dep[dep],
+                (s_menu_handle.predicate_deps - dep) * sizeof(menu_predicate_dep_t));
+        s_menu_predicate_dep[dep].source    = sources[i];
+        s_menu_predicate_dep[dep].predicate = slot;
+        s_menu_handle.predicate_deps++;
+    }
+
+    menu_predicate_entry_t *entry = &s_menu_predicate[slot];
+    entry->item      = item;
+    entry->predicate = predicate;
+    entry->visible   = predicate(item) != 0;
+    if (slot == s_menu_handle.predicates)
+    {
+        // Повторно занятая запись может ещё стоять в списке ждущих пересчёта -- её поля списка не трогаем
+        entry->dirty      = 0;
+        entry->dirty_next = 0;
+        s_menu_handle.predicates++;
+    }
+
+    s_menu_set_visible(item, entry->visible);
+    return item;
+}
+
+/**
+ * @brief Записывает значение пункта и пересчитывает зависящие от него условия видимости.
+ *
+ * Поле `data` отложенных подменю и узлов виртуальных списков занято движком, их значения не меняются.
+ */
+MENU_UNUSED static void s_menu_set_value (menu_item_t *item, uint32_t value)
+{
+    if (item == NULL || item->data == value || (item->flags & MENU_FLAG_LAZY) ||
+        (item->child && (item->child->flags & MENU_FLAG_VIRTUAL)))
+        return;
+
+    item->data = value;
+    s_menu_value_changed(item);
+}
+
+/**
+ * @brief Сообщает, что значение пункта изменилось (например, его callback сам изменил `data`).
+ *
+ * Зависящие условия (двоичный поиск по записям зависимостей) попадают в список ждущих
+ * пересчёта. Вне пакета (s_menu_value_begin) условия пересчитываются сразу.
+ */
+static void s_menu_value_changed (const menu_item_t *item)
+{
+    for (uint32_t i = s_menu_predicate_dep_find(item);
+         i < s_menu_handle.predicate_deps && s_menu_predicate_dep[i].source == item; i++)
+    {
+        uint32_t slot = s_menu_predicate_dep[i].predicate;
+        menu_predicate_entry_t *entry = &s_menu_predicate[slot];
+        if (!entry->dirty)
+        {
+            entry->dirty      = 1;
+            entry->dirty_next = s_menu_handle.predicate_dirty;
+            s_menu_handle.predicate_dirty = slot + 1;
+        }
+    }
+
+    if (s_menu_handle.value_batch == 0)
+        s_menu_predicate_flush();
+}
+
+/**
+ * @brief Начинает пакет изменений значений: условия пересчитываются один раз в s_menu_value_end.
+ *        Пакеты могут быть вложенными.
+ */
+MENU_UNUSED static void s_menu_value_begin (void)
+{
+    s_menu_handle.value_batch++;
+}
+
+/**
+ * @brief Завершает пакет изменений значений; на внешнем уровне пересчитывает условия.
+ */
+MENU_UNUSED static void s_menu_value_end (void)
+{
+    if (s_menu_handle.value_batch > 0 && --s_menu_handle.value_batch == 0)
+        s_menu_predicate_flush();
+}
+
+/**
+ * @brief Пересчитывает помеченные условия и меняет видимость их пунктов одним пакетом.
+ *
+ * Обходится только список ждущих пересчёта. Кольца обновляются по пунктам
+ * (s_menu_visible_apply), меню перерисовывается один раз, если видимость хотя бы одного
+ * пункта изменилась.
+ */
+static void s_menu_predicate_flush (void)
+{
+    int changed = 0;
+
+    while (s_menu_handle.predicate_dirty)
+    {
+        menu_predicate_entry_t *entry = &s_menu_predicate[s_menu_handle.predicate_dirty - 1];
+        s_menu_handle.predicate_dirty = entry->dirty_next;
+        entry->dirty = 0;
+        if (entry->item == NULL)
+            continue;
+
+        uint8_t visible = entry->predicate(entry->item) != 0;
+        if (visible == entry->visible)
+            continue;
+
+        entry->visible = visible;
+        s_menu_visible_apply(entry->item, visible);
+        changed = 1;
+    }
+
+    if (changed && s_menu_handle.current)
+        s_display_menu();
+}
+#endif
+
+#if MENU_VIRTUAL
+/**
+ * @brief Заполняет пункт окна записью `index` виртуального списка.
+ */
+static void s_menu_virtual_fill (menu_virtual_t *list, menu_item_t *item, uint32_t index)
+{
+    memset(item->title, 0, MENU_ITEM_TITLE_LEN);
+    item->data = list->provider(index, item->title);
+#if MENU_SEARCH
+    if (list == &s_menu_search_list.descriptor)
+        item->child = s_menu_search_list.results[index]; // Нажатие на результат ведёт к пункту
+#endif
+}
+
+/**
+ * @brief Возвращает дескриптор виртуального списка с узлом `node`.
+ */
+static menu_virtual_t * s_menu_virtual_list (const menu_item_t *node)
+{
+#if MENU_SEARCH
+    if (node == &s_menu_search_list.node)
+        return &s_menu_search_list.descriptor;
+#endif
+#if (MENU_VIRTUAL_LISTS > 0)
+    return &s_menu_virtual[node->data];
+#else
+    return &s_menu_search_list.descriptor; // Других списков нет
+#endif
+}
+
+/**
+ * @brief Возвращает дескриптор списка, которому принадлежит пункт окна.
+ */
+static menu_virtual_t * s_menu_virtual_of (menu_item_t *item)
+{
+    return s_menu_virtual_list(item->parent);
+}
+
+#if (MENU_VIRTUAL_LISTS > 0)
+/**
+ * @brief Свободный дескриптор виртуального списка.
+ * @return Номер дескриптора или MENU_VIRTUAL_LISTS, если свободных нет.
+ */
+static uint32_t s_menu_virtual_slot (void)
+{
+    uint32_t slot = 0;
+
+    // Дескрипторы списков из освобождённых отложенных подменю используются повторно
+    while (slot < s_menu_handle.virtual_lists && s_menu_virtual[slot].node != NULL)
+        slot++;
+
+    return slot < MENU_VIRTUAL_LISTS ? slot : MENU_VIRTUAL_LISTS;
+}
+
+/**
+ * @brief Занимает дескриптор `slot` под список с узлом `node`.
+ */
+static void s_menu_virtual_take (uint32_t slot, menu_item_t *node, menu_virtual_provider_t provider)
+{
+    menu_virtual_t *list = &s_menu_virtual[slot];
+
+    list->node     = node;
+    list->provider = provider;
+    list->count    = 0;
+    list->index    = 0;
+    node->data     = slot;
+    if (slot == s_menu_handle.virtual_lists)
+        s_menu_handle.virtual_lists++;
+}
+
+/**
+ * @brief Создаёт виртуальный список: узел с заголовком `title` и окно из MENU_VIRTUAL_WINDOW пунктов.
+ *
+ * Записи не создаются: заголовок и значение записи запрашиваются у `provider`, только когда
+ * запись попадает в окно. Пункты окна получают флаги `flags` (например, MENU_FLAG_GOTO_PARENT,
+ * чтобы нажатие на запись возвращало к узлу) и MENU_FLAG_VIRTUAL.
+ *
+ * @param count Количество записей; 0 -- вход в список невозможен до s_menu_virtual_set_count.
+ * @return Узел списка или NULL, если закончились дескрипторы (MENU_VIRTUAL_LISTS) или пункты.
+ */
+MENU_UNUSED static menu_item_t * s_menu_add_virtual (char *title, menu_item_t *parent, uint32_t count, menu_virtual_provider_t provider, uint8_t flags)
+{
+    if (provider == NULL)
+        return NULL;
+
+    uint32_t slot = s_menu_virtual_slot();
+    if (slot >= MENU_VIRTUAL_LISTS)
+        return NULL;
+
+    menu_item_t *node = s_menu_add_item(title, parent, NULL, 0);
+    if (node == NULL)
+        return NULL;
+
+    s_menu_virtual_take(slot, node, provider);
+
+    menu_virtual_t *list = &s_menu_virtual[slot];
+    for (uint32_t i = 0; i < MENU_VIRTUAL_WINDOW; i++)
+    {
+        list->window[i] = s_menu_add_item("", node, NULL, flags | MENU_FLAG_VIRTUAL);
+        if (list->window[i] == NULL)
+            return NULL;
+    }
+
+    node->child = list->window[0];
+    s_menu_virtual_set_count(node, count);
+
+    return node;
+}
+#endif
+
+/**
+ * @brief Меняет количество записей виртуального списка (например, когда журнал пополнился).
+ *
+ * Вход в пустой список запрещается снятием MENU_FLAG_GOTO_CHILD. Кольцо окна сокращается до
+ * `count` пунктов, если записей меньше, чем пунктов в окне. Если курсор сейчас внутри списка,
+ * окно перезаполняется; если список опустел -- курсор возвращается на узел.
+ */
+static void s_menu_virtual_set_count (menu_item_t *node, uint32_t count)
+{
+    menu_virtual_t *list = s_menu_virtual_list(node);
+    uint32_t        size = count < MENU_VIRTUAL_WINDOW ? count : MENU_VIRTUAL_WINDOW;
+
+    list->count = count;
+    if (list->index >= count)
+        list->index = count ? count - 1 : 0;
+
+    for (uint32_t i = 0; i < size; i++)
+    {
+        list->window[i]->next = list->window[(i + 1) % size];
+        list->window[i]->prev = list->window[(i + size - 1) % size];
+    }
+
+    if (count)
+        node->flags |= MENU_FLAG_GOTO_CHILD;
+    else
+        node->flags &= (uint8_t)~MENU_FLAG_GOTO_CHILD;
+
+    menu_item_t *current = s_menu_handle.current;
+    if (current && current->parent == node && (current->flags & MENU_FLAG_VIRTUAL))
+    {
+        for (uint32_t i = size; i < MENU_VIRTUAL_WINDOW; i++)
+        {
+            if (current == list->window[i])
+                current = s_menu_handle.current = list->window[0]; // Пункт вне сокращённого кольца
+        }
+        if (count)
+            s_menu_virtual_enter(current);
+        else
+            s_menu_handle.current = node;
+    }
+}
+
+/**
+ * @brief Заполняет окно вокруг пункта `item`: он показывает текущую запись, соседи -- соседние.
+ */
+MENU_COLD static void s_menu_virtual_enter (menu_item_t *item)
+{
+    menu_virtual_t *list = s_menu_virtual_of(item);
+
+    s_menu_virtual_fill(list, item,       list->index);
+    s_menu_virtual_fill(list, item->next, list->index + 1 < list->count ? list->index + 1 : 0);
+    s_menu_virtual_fill(list, item->prev, list->index ? list->index - 1 : list->count - 1);
+}
+
+/**
+ * @brief Шаг по виртуальному списку: курсор уже перешёл на `item`.
+ *
+ * Пункт окна впереди по ходу движения перезаполняется следующей записью, остальные пункты
+ * окна уже показывают нужные записи.
+ *
+ * @param step 1 -- вперёд, -1 -- назад.
+ */
+MENU_COLD static void s_menu_virtual_step (menu_item_t *item, int32_t step)
+{
+    menu_virtual_t *list = s_menu_virtual_of(item);
+
+    if (step > 0)
+    {
+        list->index = list->index + 1 < list->count ? list->index + 1 : 0;
+        s_menu_virtual_fill(list, item->next, list->index + 1 < list->count ? list->index + 1 : 0);
+    }
+    else
+    {
+        list->index = list->index ? list->index - 1 : list->count - 1;
+        s_menu_virtual_fill(list, item->prev, list->index ? list->index - 1 : list->count - 1);
+    }
+}
+#endif
+
+#if (MENU_LAZY_SUBMENUS > 0)
+/**
+ * @brief Вызывает построитель дочерней цепочки пункта и назначает её первый пункт дочерним.
+ */
+static void s_menu_build_children (menu_item_t *item, menu_builder_t builder)
+{
+    menu_item_t *building = s_menu_handle.building;
+    uint32_t     lazies   = s_menu_handle.building_lazies;
+
+    s_menu_handle.building        = item;
+    s_menu_handle.building_lazies = 0;
+    builder(item);
+    s_menu_handle.building        = building;
+    s_menu_handle.building_lazies = lazies;
+
+    if (item->child == NULL)
+    {
+        // Первый созданный пункт с родителем item
+#if MENU_LAZY_RELEASE
+        // Потомки отложенного подменю -- его участок списка сразу после него
+        menu_item_t *child = (item->flags & MENU_FLAG_LAZY) ? item->folowing : s_menu_handle.start;
+#else
+        menu_item_t *child = s_menu_handle.start;
+#endif
+        for (; child; child = child->folowing)
+        {
+            if (child->parent == item)
+            {
+                s_menu_set_child(item, child);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Проверяет, свободна ли запись отложенного подменю (не занята и не ждёт повторного построения).
+ */
+static inline int s_menu_lazy_free (uint32_t slot)
+{
+    return s_menu_lazy[slot].item == NULL && s_menu_lazy[slot].owner == MENU_LAZY_NONE;
+}
+
+/**
+ * @brief Ищет запись, ждущую повторного построения: то же подменю-владелец, тот же номер и построитель.
+ * @return Номер записи или MENU_LAZY_NONE.
+ */
+static uint32_t s_menu_lazy_dormant (uint32_t owner, uint32_t order, menu_builder_t builder)
+{
+    if (owner == MENU_LAZY_NONE)
+        return MENU_LAZY_NONE;
+
+    for (uint32_t slot = 0; slot < s_menu_handle.lazy_submenus; slot++)
+    {
+        const menu_lazy_t *lazy = &s_menu_lazy[slot];
+        if (lazy->item == NULL && lazy->owner == owner && lazy->order == order && lazy->builder == builder)
+            return slot;
+    }
+    return MENU_LAZY_NONE;
+}
+
+/**
+ * @brief Освобождает ждущие повторного построения записи, владелец которых свободен.
+ */
+static void s_menu_lazy_orphans (void)
+{
+    // Владельцы всегда ждут дольше вложенных записей: проходы повторяются, пока находятся осиротевшие
+    for (int changed = 1; changed; )
+    {
+        changed = 0;
+        for (uint32_t i = 0; i < s_menu_handle.lazy_submenus; i++)
+        {
+            menu_lazy_t *lazy = &s_menu_lazy[i];
+            if (lazy->item == NULL && lazy->owner != MENU_LAZY_NONE && s_menu_lazy_free(lazy->owner))
+            {
+                lazy->owner = MENU_LAZY_NONE;
+                changed = 1;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Освобождает запись отложенного подменю вместе с ждущими записями, владельцем которых она была.
+ */
+static void s_menu_lazy_forget (uint32_t slot)
+{
+    s_menu_lazy[slot].owner = MENU_LAZY_NONE;
+    s_menu_lazy_orphans();
+}
+
+/**
+ * @brief Создаёт пункт, дочерняя цепочка которого строится при первом входе в него.
+ *
+ * Пункт получает MENU_FLAG_LAZY и MENU_FLAG_GOTO_CHILD. При первом нажатии на него
+ * s_push_button_callback вызывает `builder`, после чего переходит в построенную цепочку.
+ * До этого подменю не занимает ни пунктов, ни времени построения.
+ * Если записи построителей (MENU_LAZY_SUBMENUS) закончились, подменю строится сразу.
+ *
+ * @return Пункт или NULL, если не удалось создать пункт.
+ */
+MENU_UNUSED static menu_item_t * s_menu_add_lazy (char *title, menu_item_t *parent, menu_builder_t builder, uint8_t flags)
+{
+    if (builder == NULL)
+        return NULL;
+
+    menu_item_t *building = s_menu_handle.building;
+    uint32_t owner = (building && (building->flags & MENU_FLAG_LAZY)) ? building->data : MENU_LAZY_NONE;
+    uint32_t order = s_menu_handle.building_lazies++;
+    uint32_t slot  = s_menu_lazy_dormant(owner, order, builder);
+    int revived    = slot != MENU_LAZY_NONE;
+
+    // Иначе -- свободная запись: освобождённые вложенные подменю без владельца используются повторно
+    if (slot == MENU_LAZY_NONE)
+    {
+        slot = 0;
+        while (slot < s_menu_handle.lazy_submenus && !s_menu_lazy_free(slot))
+            slot++;
+    }
+    if (slot >= MENU_LAZY_SUBMENUS)
+    {
+        // Записи кончились: занимаем запись, ждущую повторного построения, её память курсора теряется
+        slot = 0;
+        while (slot < s_menu_handle.lazy_submenus && s_menu_lazy[slot].item != NULL)
+            slot++;
+        if (slot < s_menu_handle.lazy_submenus)
+            s_menu_lazy_forget(slot);
+    }
+
+    if (slot >= MENU_LAZY_SUBMENUS)
+    {
+        menu_item_t *item = s_menu_add_item(title, parent, NULL, flags);
+        if (item)
+            s_menu_build_children(item, builder);
+        return item;
+    }
+
+    menu_item_t *item = s_menu_add_item(title, parent, NULL, flags | MENU_FLAG_LAZY | MENU_FLAG_GOTO_CHILD);
+    if (item == NULL)
+        return NULL;
+
+#if (MENU_CURSOR_MEMORY > 0)
+    if (!revived)
+        s_menu_lazy[slot].resume = 0;
+#endif
+#if MENU_REGIONS
+    s_menu_lazy[slot].region = NULL;
+    if (!revived)
+        s_menu_lazy[slot].region_items = 0;
+#endif
+#if MENU_LAZY_RELEASE
+    s_menu_lazy[slot].last    = NULL;
+#endif
+    s_menu_lazy[slot].item    = item;
+    s_menu_lazy[slot].builder = builder;
+    s_menu_lazy[slot].owner   = owner;
+    s_menu_lazy[slot].order   = order;
+    item->data = slot;
+    if (slot == s_menu_handle.lazy_submenus)
+        s_menu_handle.lazy_submenus++;
+
+    return item;
+}
+
+/**
+ * @brief Первый вход в отложенное подменю: строит его дочернюю цепочку.
+ *
+ * С MENU_CURSOR_MEMORY после освобождения (s_menu_lazy_release) вход продолжается с пункта,
+ * на котором его покинули: `resume` -- столько же шагов от `child`, сколько было до освобождения.
+ */
+MENU_COLD static menu_item_t * s_menu_lazy_build (menu_item_t *item)
+{
+    menu_lazy_t *lazy = &s_menu_lazy[item->data];
+
+    s_menu_build_children(item, lazy->builder);
+
+#if (MENU_CURSOR_MEMORY > 0)
+    menu_item_t *resume = item->child;
+    for (uint32_t i = 0; resume && i < lazy->resume && resume->next != item->child; i++)
+        resume = resume->next;
+    item->resume = lazy->resume ? resume : NULL;
+    return item->resume ? item->resume : item->child;
+#else
+    return item->child;
+#endif
+}
+#endif
+
+/**
+ * @brief Проверяет, лежит ли пункт `item` внутри подменю `root` (на любой глубине).
+ */
+MENU_UNUSED static int s_menu_is_descendant (const menu_item_t *item, const menu_item_t *root)
+{
+    for (item = item ? item->parent : NULL; item; item = item->parent)
+    {
+        if (item == root)
+            return 1;
+    }
+    return 0;
+}
+
+#if (MENU_POSITION_INDICATOR > 0)
+/**
+ * @brief Счётчик видимых пунктов кольца, в котором лежит `item` (у родителя или у корня).
+ */
+static uint32_t * s_menu_ring_count (const menu_item_t *item)
+{
+    return item->parent ? &item->parent->children : &s_menu_handle.root_children;
+}
+
+/**
+ * @brief Нумерует видимые пункты кольца `item` по полному кольцу от его начала и снимает
+ *        бит MENU_RING_STALE: O(n) по длине кольца, один раз после серии скрытий и показов.
+ * @return Количество видимых пунктов кольца.
+ */
+static uint32_t s_menu_ring_number (menu_item_t *item)
+{
+    menu_item_t *first = s_menu_ring_first(item);
+    menu_item_t *walk  = first;
+    uint32_t ordinal = 0;
+
+    do
+    {
+        if (!MENU_HIDDEN(walk))
+            walk->ordinal = ++ordinal;
+        walk = MENU_RING_NEXT(walk);
+    } while (walk != first);
+
+    *s_menu_ring_count(item) = ordinal;
+    return ordinal;
+}
+#endif
+
+#if (MENU_CURSOR_MEMORY > 0)
+/**
+ * @brief Запоминает `item` в `resume` родителя: следующий вход в подменю продолжится с него.
+ *
+ * Вызывается при выходе из подменю к родителю, одна запись на выход. Пункт входа (`child`)
+ * не меняется. Выход пунктом "Назад" (MENU_FLAG_GOTO_PARENT) не запоминается: следующий вход --
+ * снова с `child`. Окна виртуальных списков и список результатов поиска не запоминаются:
+ * у них свой курсор (запись `index`).
+ */
+static void s_menu_resume_save (menu_item_t *item)
+{
+    menu_item_t *parent = item->parent;
+
+#if MENU_VIRTUAL
+    if (item->flags & MENU_FLAG_VIRTUAL)
+        return;
+#endif
+#if MENU_SEARCH
+    if (item == &s_menu_search_list.node)
+        return;
+#endif
+    if (parent)
+        parent->resume = (item->flags & MENU_FLAG_GOTO_PARENT) ? NULL : item;
+}
+
+#if MENU_LAZY_RELEASE
+/**
+ * @brief Шагов по кольцу от `child` до `resume` пункта: память курсора отложенного подменю,
+ *        которая переживает освобождение его пунктов (0 -- вход с `child`).
+ */
+static uint32_t s_menu_resume_steps (const menu_item_t *item)
+{
+    const menu_item_t *first = item->child;
+    uint32_t steps = 0;
+
+    if (item->resume == NULL || first == NULL)
+        return 0;
+    if (MENU_HIDDEN(first))
+        first = first->next; // Скрытый пункт входа ссылается на видимого соседа
+    for (const menu_item_t *walk = first; walk != item->resume; steps++)
+    {
+        walk = walk->next;
+        if (walk == first)
+            return 0; // `resume` скрыт: вход с `child`
+    }
+    return steps;
+}
+#endif
+#endif
+
+#if (MENU_POSITION_INDICATOR > 0)
+/**
+ * @brief Позиция текущего пункта в его кольце и количество видимых пунктов кольца ("3/17").
+ *
+ * Номера задаёт s_menu_rechain, и пока видимость пунктов кольца не менялась, чтение стоит O(1).
+ * После скрытия или показа (бит MENU_RING_STALE у счётчика кольца) первый вызов нумерует
+ * кольцо заново за O(n). В виртуальном списке -- номер записи и количество записей.
+ *
+ * @param count Количество пунктов (может быть NULL).
+ * @return Позиция с 1 или 0, если меню не запущено.
+ */
+uint32_t Menu_Position (uint32_t *count)
+{
+    menu_item_t *item = s_menu_handle.current;
+    uint32_t position = 0;
+    uint32_t total    = 0;
+
+    if (item == NULL || MENU_HIDDEN(item))
+    {
+        // Меню не запущено или скрыты все пункты кольца
+    }
+#if MENU_VIRTUAL
+    else if (item->flags & MENU_FLAG_VIRTUAL)
+    {
+        const menu_virtual_t *list = s_menu_virtual_list(item->parent);
+        position = list->index + 1;
+        total    = list->count;
+    }
+#endif
+#if MENU_SEARCH
+    else if (item == &s_menu_search_list.node)
+    {
+        position = 1;
+        total    = 1;
+    }
+#endif
+    else
+    {
+        total    = *s_menu_ring_count(item);
+        if (total & MENU_RING_STALE)
+            total = s_menu_ring_number(item);
+        position = item->ordinal;
+    }
+
+    if (count)
+        *count = total;
+    return position;
+}
+#endif
+
+/**
+ * @brief Первый пункт полного кольца, в котором лежит `item` (в порядке создания).
+ */
+static menu_item_t * s_menu_ring_first (menu_item_t *item)
+{
+    menu_item_t *walk = item;
+
+    while (walk && !walk->first)
+    {
+        walk = MENU_RING_PREV(walk);
+        if (walk == item)
+            break; // Отметки нет: кольцо повреждено, обход начнётся с `item`
+    }
+    return walk;
+}
+
+/**
+ * @brief Обходит подменю пункта `parent` (NULL -- всё меню) без рекурсии.
+ *
+ * Кольца проходятся по полному кольцу (MENU_RING_NEXT: с MENU_HIDDEN_ITEMS -- `sibling_next`,
+ * включая скрытые пункты) в порядке создания, вход в подменю -- по `child`. Вместо рекурсии -- стек из MENU_WALK_DEPTH уровней
+ * в кадре функции: расход стека известен при компиляции и не зависит от формы дерева.
+ * Пункты, на которые не ведёт ни одна цепочка `child` (непостроенное отложенное подменю),
+ * не посещаются.
+ *
+ * На обходе построены экспорт, поиск и проверка структуры. Освобождение памяти на нём не
+ * строится: обход не доходит до пунктов, на которые не ведёт `child`, и прерывается на
+ * подменю глубже MENU_WALK_DEPTH -- такие пункты остались бы в куче. Освобождение идёт по
+ * списку `folowing` (s_menu_free_items, участки s_menu_lazy_release): он содержит каждый пункт
+ * ровно один раз и проходится циклом без стека.
+ *
+ * @param orders  MENU_WALK_PRE, MENU_WALK_POST или оба: когда вызывать посетителя.
+ * @return MENU_WALK_DONE, MENU_WALK_STOPPED или MENU_WALK_OVERFLOW (подменю глубже стека
+ *         не посещены, обход прерван).
+ */
+static int s_menu_walk (menu_item_t *parent, uint8_t orders, menu_walk_visit_t visit, void *context)
+{
+    menu_walk_frame_t stack[MENU_WALK_DEPTH];
+    uint32_t depth = 0;
+    menu_item_t *first = s_menu_ring_first(parent ? parent->child : s_menu_handle.start);
+
+    if (first == NULL)
+        return MENU_WALK_DONE;
+
+    stack[depth++] = (menu_walk_frame_t){ first, MENU_RING_PREV(first), MENU_WALK_PRE };
+    while (depth)
+    {
+        menu_walk_frame_t *frame = &stack[depth - 1];
+        menu_item_t *item = frame->item;
+
+        if (frame->order == MENU_WALK_PRE)
+        {
+            frame->order = MENU_WALK_POST;
+            if ((orders & MENU_WALK_PRE) && visit(item, depth - 1, MENU_WALK_PRE, context))
+                return MENU_WALK_STOPPED;
+
+            if (item->child)
+            {
+                if (depth == MENU_WALK_DEPTH)
+                    return MENU_WALK_OVERFLOW;
+                first = s_menu_ring_first(item->child);
+                stack[depth++] = (menu_walk_frame_t){ first, MENU_RING_PREV(first), MENU_WALK_PRE };
+            }
+            continue;
+        }
+
+        // Следующий пункт читается до посещения: посетитель может освободить `item`
+        menu_item_t *next = (item != frame->last) ? MENU_RING_NEXT(item) : NULL;
+        if ((orders & MENU_WALK_POST) && visit(item, depth - 1, MENU_WALK_POST, context))
+            return MENU_WALK_STOPPED;
+
+        if (next)
+        {
+            frame->item  = next;
+            frame->order = MENU_WALK_PRE;
+        }
+        else
+        {
+            depth--;
+        }
+    }
+
+    return MENU_WALK_DONE;
+}
+
+typedef struct {
+    const char  *title;
+    menu_item_t *found;
+} menu_find_t;
+
+static int s_menu_find_visit (menu_item_t *item, uint32_t depth, uint8_t order, void *context)
+{
+    menu_find_t *find = (menu_find_t *)context;
+
+    (void)depth;
+    (void)order;
+    if (strncmp(s_menu_title(item), find->title, MENU_ITEM_TITLE_LEN) != 0)
+        return 0;
+    find->found = item;
+    return 1;
+}
+
+/**
+ * @brief Ищет в подменю `parent` (NULL -- во всём меню) первый пункт с заголовком `title`.
+ *
+ * Порядок -- прямой обход: пункт раньше своего подменю, кольца в порядке создания.
+ * Скрытые пункты тоже находятся.
+ */
+MENU_UNUSED static menu_item_t * s_menu_find (menu_item_t *parent, const char *title)
+{
+#if MENU_TITLE_CHARSET
+    char coded[MENU_ITEM_TITLE_LEN];
+    lcd1602_transcode(coded, MENU_ITEM_TITLE_LEN, title);
+    title = coded;
+#endif
+    menu_find_t find = { title, NULL };
+
+    s_menu_walk(parent, MENU_WALK_PRE, s_menu_find_visit, &find);
+    return find.found;
+}
+
+typedef struct {
+    char    *buffer;
+    uint32_t size;
+    uint32_t length; ///< Длина всего текста, даже если он не поместился
+} menu_export_t;
+
+static void s_menu_export_put (menu_export_t *out, const char *text, uint32_t length)
+{
+    for (uint32_t i = 0; i < length; i++, out->length++)
+    {
+        if (out->length + 1 < out->size)
+            out->buffer[out->length] = text[i];
+    }
+}
+
+static int s_menu_export_visit (menu_item_t *item, uint32_t depth, uint8_t order, void *context)
+{
+    menu_export_t *out = (menu_export_t *)context;
+
+    (void)order;
+    for (uint32_t i = 0; i < depth; i++)
+        s_menu_export_put(out, "  ", 2);
+    const char *title = s_menu_title(item);
+    s_menu_export_put(out, title, (uint32_t)strnlen(title, MENU_ITEM_TITLE_LEN));
+    if (MENU_HIDDEN(item))
+        s_menu_export_put(out, " [hidden]", 9);
+    if (item->flags & MENU_FLAG_DISABLED)
+        s_menu_export_put(out, " [disabled]", 11);
+    if ((item->flags & MENU_FLAG_LAZY) && item->child == NULL)
+        s_menu_export_put(out, " [lazy]", 7);
+    s_menu_export_put(out, "\n", 1);
+    return 0;
+}
+
+/**
+ * @brief Записывает подменю `parent` (NULL -- всё меню) текстом: пункт на строку, отступ -- два
+ *        пробела на уровень, отметки [hidden], [disabled] и [lazy] (подменю ещё не построено).
+ *
+ * Текст обрезается по `size` и всегда завершается нулём (если `size` не 0).
+ *
+ * @return Длина всего текста без завершающего нуля (как у snprintf) или 0 при переполнении стека обхода.
+ */
+MENU_UNUSED static uint32_t s_menu_export (menu_item_t *parent, char *buffer, uint32_t size)
+{
+    menu_export_t out = { buffer, size, 0 };
+
+    if (s_menu_walk(parent, MENU_WALK_PRE, s_menu_export_visit, &out) == MENU_WALK_OVERFLOW)
+        out.length = 0;
+    if (size)
+        buffer[out.length < size ? out.length : size - 1] = '\0';
+    return out.length;
+}
+
+static int s_menu_validate_visit (menu_item_t *item, uint32_t depth, uint8_t order, void *context)
+{
+    menu_item_t **bad = (menu_item_t **)context;
+    int ok = 1;
+
+    (void)order;
+
+#if (MENU_HIDDEN_ITEMS > 0)
+    // Полное кольцо: симметрично и с одним родителем
+    ok = ok && item->sibling_next->sibling_prev == item && item->sibling_prev->sibling_next == item;
+    ok = ok && item->sibling_next->parent == item->parent;
+#endif
+
+    // Подменю ведёт в пункты этого пункта и помещается в стек обхода
+    ok = ok && (item->child == NULL || (item->child->parent == item && depth + 1 < MENU_WALK_DEPTH));
+
+    // Кольцо навигации: видимые пункты, симметрично
+    if (ok && !MENU_HIDDEN(item))
+    {
+        ok = item->next->prev == item && item->prev->next == item;
+        ok = ok && !MENU_HIDDEN(item->next) && item->next->parent == item->parent;
+    }
+
+#if (MENU_POSITION_INDICATOR > 0)
+    // Номера идут подряд до счётчика кольца (если кольцо не ждёт перенумерации)
+    uint32_t count = *s_menu_ring_count(item);
+    if (ok && !MENU_HIDDEN(item) && !(count & MENU_RING_STALE))
+    {
+        uint32_t next = item->next->ordinal;
+
+        ok = item->ordinal <= count;
+        ok = ok && (next == item->ordinal + 1 || (next == 1 && item->ordinal == count));
+    }
+#endif
+
+    if (!ok)
+        *bad = item;
+    return !ok;
+}
+
+/**
+ * @brief Проверяет структуру подменю `parent` (NULL -- всего меню): кольца, дочерние указатели,
+ *        номера видимых пунктов и глубину вложенности (не глубже MENU_WALK_DEPTH).
+ *
+ * @return Первый пункт с нарушением (в порядке прямого обхода) или NULL.
+ */
+MENU_UNUSED static menu_item_t * s_menu_validate (menu_item_t *parent)
+{
+    menu_item_t *bad = NULL;
+
+    s_menu_walk(parent, MENU_WALK_PRE, s_menu_validate_visit, &bad);
+    return bad;
+}
+
+#if MENU_LAZY_RELEASE
+
+/**
+ * @brief Освобождает построенную дочернюю цепочку отложенного подменю (со всеми вложенными).
+ *
+ * Подменю не освобождается, если в нём курсор, оно сейчас строится или в него добавляется
+ * пункт. Следующий вход построит его заново. Вложенные отложенные подменю и виртуальные списки
+ * освобождают свои записи.
+ *
+ * Потомки пункта -- его участок списка `folowing` (s_menu_lazy_link): участок вырезается за O(1)
+ * без обхода остального меню. Записи вложенных подменю, виртуальных списков, условий и индекса быстрого
+ * перехода снимаются проходом по их таблицам (подъём по `parent` -- до освобождения, пока цепочки
+ * целы). С областями (MENU_REGION_ITEMS) пункты освобождаются блоками; без них участок
+ * проходится один раз вызовами free. Индекс быстрого перехода перестраивается по всему меню
+ * только если в нём когда-то не хватило записей.
+ *
+ * @return Количество освобождённых пунктов.
+ */
+static uint32_t s_menu_lazy_release (menu_item_t *item)
+{
+    if (item == NULL || !(item->flags & MENU_FLAG_LAZY) || item->child == NULL)
+        return 0;
+    if (s_menu_is_descendant(s_menu_handle.current, item) ||
+        s_menu_handle.building == item || s_menu_is_descendant(s_menu_handle.building, item) ||
+        s_menu_handle.adding == item || s_menu_is_descendant(s_menu_handle.adding, item))
+        return 0;
+
+    menu_lazy_t *own   = &s_menu_lazy[item->data];
+    menu_item_t *first = item->folowing;
+    menu_item_t *last  = own->last;
+
+    // Записи вложенных подменю ждут повторного построения владельца вместе с памятью курсора
+    for (uint32_t slot = 0; slot < s_menu_handle.lazy_submenus; slot++)
+    {
+        menu_lazy_t *lazy = &s_menu_lazy[slot];
+        if (lazy->item == NULL || lazy->item == item || !s_menu_is_descendant(lazy->item, item))
+            continue;
+#if (MENU_CURSOR_MEMORY > 0)
+        if (lazy->item->child)
+            lazy->resume = s_menu_resume_steps(lazy->item);
+#endif
+        lazy->item = NULL;
+        lazy->last = NULL;
+    }
+    s_menu_lazy_orphans(); // Вложенные подменю, созданные вне построителя, не ждут
+
+#if (MENU_VIRTUAL_LISTS > 0)
+    for (uint32_t i = 0; i < s_menu_handle.virtual_lists; i++)
+    {
+        if (s_menu_virtual[i].node && s_menu_is_descendant(s_menu_virtual[i].node, item))
+            s_menu_virtual[i].node = NULL;
+    }
+#endif
+#if (MENU_PREDICATES > 0)
+    // Цепочки `parent` потомков ещё целы: снимаем их условия и зависимости до освобождения
+    s_menu_predicate_forget(item);
+#endif
+#if (MENU_JUMP_INDEX > 0)
+    s_menu_jump_forget(item);
+#endif
+
+#if (MENU_CURSOR_MEMORY > 0)
+    // Пункт, с которого продолжится вход после повторного построения
+    own->resume  = s_menu_resume_steps(item);
+    item->resume = NULL;
+#endif
+
+    // Участок вырезается из списка; участки объемлющих подменю, кончавшиеся на нём, кончаются на пункте
+    item->folowing = last->folowing;
+    if (s_menu_handle.last == last)
+        s_menu_handle.last = item;
+    for (menu_item_t *owner = s_menu_lazy_owner(item->parent); owner && s_menu_lazy[owner->data].last == last;
+         owner = s_menu_lazy_owner(owner->parent))
+        s_menu_lazy[owner->data].last = item;
+    own->last   = NULL;
+    item->child = NULL;
+
+    uint32_t released = 0;
+#if MENU_REGIONS
+    // Все пункты участка -- из областей: своей и вложенных подменю (их записи уже без пунктов)
+    (void)first;
+    released += s_menu_region_release(item->data);
+    for (uint32_t slot = 0; slot < s_menu_handle.lazy_submenus; slot++)
+    {
+        if (s_menu_lazy[slot].item == NULL)
+            released += s_menu_region_release(slot);
+    }
+#else
+    for (menu_item_t *node = first, *next; node; node = next)
+    {
+        next = (node != last) ? node->folowing : NULL;
+        MENU_FREE(node);
+        released++;
+    }
+#endif
+
+#if (MENU_JUMP_INDEX > 0)
+    if (s_menu_handle.jump_full)
+        s_menu_jump_rebuild(); // Кольца вне индекса могут занять освободившиеся записи только целиком
+#endif
+#if MENU_FUZZY
+    s_menu_fuzzy_remove(item);
+#endif
+#if MENU_SEARCH
+    s_menu_search_column_drop();
+    s_menu_search_close(); // Результаты могли указывать на освобождённые пункты
+#endif
+    return released;
+}
+
+#if (MENU_PREDICATES > 0)
+/**
+ * @brief Освобождает записи условий пунктов внутри подменю `root` и зависимостей от таких пунктов.
+ *        Условие в списке ждущих пересчёта остаётся в нём и пропускается.
+ *
+ * Вызывается до освобождения пунктов: s_menu_is_descendant читает их цепочки `parent`.
+ */
+static void s_menu_predicate_forget (const menu_item_t *root)
+{
+    for (uint32_t i = 0; i < s_menu_handle.predicates; i++)
+    {
+        if (s_menu_predicate[i].item && s_menu_is_descendant(s_menu_predicate[i].item, root))
+            s_menu_predicate[i].item = NULL;
+    }
+
+    // Уплотнение: порядок оставшихся записей сохраняется
+    uint32_t kept = 0;
+    for (uint32_t i = 0; i < s_menu_handle.predicate_deps; i++)
+    {
+        menu_predicate_dep_t *dep = &s_menu_predicate_dep[i];
+        if (s_menu_predicate[dep->predicate].item != NULL && !s_menu_is_descendant(dep->source, root))
+            s_menu_predicate_dep[kept++] = *dep;
+    }
+    s_menu_handle.predicate_deps = kept;
+}
+#endif
+
+/**
+ * @brief Освобождает все неактивные построенные отложенные подменю (нехватка памяти).
+ * @return Количество освобождённых пунктов.
+ */
+static uint32_t s_menu_lazy_trim (void)
+{
+    uint32_t released = 0;
+
+    for (uint32_t slot = 0; slot < s_menu_handle.lazy_submenus; slot++)
+    {
+        released += s_menu_lazy_release(s_menu_lazy[slot].item);
+    }
+
+    return released;
+}
+#endif
+
+/**
+ * @brief Ключ быстрого перехода: первая буква, латиница без учёта регистра.
+ */
+static inline char s_menu_jump_key (char c)
+{
+    return (c >= 'A' && c <= 'Z') ? (char)(c - 'A' + 'a') : c;
+}
+
+#if (MENU_JUMP_INDEX > 0)
+/**
+ * @brief Ищет запись индекса для пары (parent, key).
+ * @param insert Вернуть свободную запись, если пары нет.
+ * @return Запись или NULL (пары нет, либо таблица заполнена).
+ */
+static inline uint32_t s_menu_jump_hash (const menu_item_t *parent, char key)
+{
+    return ((uint32_t)((uintptr_t)parent >> 3) * 31u + (uint8_t)key) & (MENU_JUMP_INDEX - 1);
+}
+
+static menu_jump_t * s_menu_jump_slot (const menu_item_t *parent, char key, int insert)
+{
+    uint32_t hash = s_menu_jump_hash(parent, key);
+
+    for (uint32_t probe = 0; probe < MENU_JUMP_INDEX; probe++)
+    {
+        menu_jump_t *slot = &s_menu_jump[(hash + probe) & (MENU_JUMP_INDEX - 1)];
+
+        if (slot->tail == NULL)
+            return insert ? slot : NULL;
+        if (slot->parent == parent && slot->key == key)
+            return slot;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Добавляет пункт в индекс быстрого перехода последним в кольце своей буквы.
+ *
+ * Пункты окон виртуальных списков (заголовки меняются при прокрутке) и пункты с пустым
+ * заголовком в индекс не входят. Если таблица заполнена, пункт остаётся вне индекса, и
+ * s_menu_jump_find ищет такие пункты обходом кольца.
+ */
+static void s_menu_jump_add (menu_item_t *item)
+{
+    char key = s_menu_jump_key(s_menu_title(item)[0]);
+
+    if (key == '\0' || (item->flags & MENU_FLAG_VIRTUAL))
+        return;
+#if (MENU_STRINGS > 0)
+    if (s_menu_handle.jump_stale)
+        return; // Войдёт при перестроении
+#endif
+
+    menu_jump_t *slot = s_menu_jump_slot(item->parent, key, 1);
+    if (slot == NULL)
+    {
+#if MENU_LAZY_RELEASE
+        s_menu_handle.jump_full = 1;
+#endif
+        return;
+    }
+
+    if (slot->tail == NULL)
+    {
+        slot->parent = item->parent;
+        slot->key    = key;
+        item->jump   = item;
+    }
+    else
+    {
+        item->jump       = slot->tail->jump;
+        slot->tail->jump = item;
+    }
+    slot->tail = item;
+}
+
+/**
+ * @brief Перестраивает индекс быстрого перехода по списку `folowing` (после освобождения пунктов).
+ */
+static void s_menu_jump_rebuild (void)
+{
+    memset(s_menu_jump, 0, sizeof(s_menu_jump));
+#if MENU_LAZY_RELEASE
+    s_menu_handle.jump_full = 0;
+#endif
+#if (MENU_STRINGS > 0)
+    s_menu_handle.jump_stale = 0;
+#endif
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+    {
+        item->jump = NULL;
+        s_menu_jump_add(item);
+    }
+}
+
+#if MENU_LAZY_RELEASE
+/**
+ * @brief Убирает из индекса записи колец внутри подменю `root` (s_menu_lazy_release).
+ *
+ * Проходится только таблица. Запись удаляется со сдвигом следующих записей её цепочки проб
+ * на освободившееся место, поэтому поиск оставшихся колец не прерывается пустой записью.
+ */
+static void s_menu_jump_forget (const menu_item_t *root)
+{
+    for (uint32_t i = 0; i < MENU_JUMP_INDEX; )
+    {
+        const menu_item_t *parent = s_menu_jump[i].parent;
+        if (s_menu_jump[i].tail == NULL || (parent != root && !s_menu_is_descendant(parent, root)))
+        {
+            i++;
+            continue;
+        }
+
+        // Удаление из цепочки проб: запись `next` переносится в дыру, если её место по хэшу не
+        // лежит по кругу между дырой и ней самой
+        uint32_t hole = i;
+        uint32_t next = (hole + 1) & (MENU_JUMP_INDEX - 1);
+        for (uint32_t step = 1; step < MENU_JUMP_INDEX && s_menu_jump[next].tail; step++, next = (next + 1) & (MENU_JUMP_INDEX - 1))
+        {
+            uint32_t home = s_menu_jump_hash(s_menu_jump[next].parent, s_menu_jump[next].key);
+            if (((next - home) & (MENU_JUMP_INDEX - 1)) >= ((next - hole) & (MENU_JUMP_INDEX - 1)))
+            {
+                s_menu_jump[hole] = s_menu_jump[next];
+                hole = next;
+            }
+        }
+        s_menu_jump[hole].tail = NULL;
+        // Запись `i` проверяется снова: в неё могла переехать другая
+    }
+}
+#endif
+
+/**
+ * @brief Первый видимый пункт кольца буквы (`jump`), начиная со скрытого `target`.
+ *
+ * @return Пункт или NULL, если скрыты все пункты с этой буквой.
+ */
+MENU_COLD static menu_item_t * s_menu_jump_visible (menu_item_t *target)
+{
+    for (menu_item_t *first = target; target->flags & MENU_FLAG_HIDDEN; )
+    {
+        target = target->jump;
+        if (target == first)
+            return NULL;
+    }
+    return target;
+}
+#endif
+
+/**
+ * @brief Пункт кольца `from`, к которому ведёт нажатие буквы `key`.
+ *
+ * Если заголовок `from` начинается с этой буквы -- следующий пункт кольца с той же буквой
+ * (повторные нажатия перебирают их по кругу), иначе -- первый такой пункт кольца. Обе ветки
+ * стоят O(1) (плюс скрытые пункты буквы, которые пропускаются). Без записи в индексе (таблица
+ * заполнена) -- следующий после `from` пункт с этой буквой, найденный обходом кольца.
+ *
+ * @return Пункт или NULL, если в кольце нет видимых пунктов с этой буквой.
+ */
+static menu_item_t * s_menu_jump_find (menu_item_t *from, char key)
+{
+    key = s_menu_jump_key(key);
+
+#if (MENU_JUMP_INDEX > 0)
+    // Скрытые пункты остаются в кольце буквы: проверка флага на месте, пропуск -- вне горячего пути
+    if (from->jump && s_menu_jump_key(s_menu_title(from)[0]) == key)
+    {
+        menu_item_t *target = from->jump;
+        return MENU_HIDDEN(target) ? s_menu_jump_visible(target) : target;
+    }
+
+    menu_jump_t *slot = s_menu_jump_slot(from->parent, key, 0);
+    if (slot)
+    {
+        menu_item_t *target = slot->tail->jump;
+        return MENU_HIDDEN(target) ? s_menu_jump_visible(target) : target;
+    }
+#endif
+
+#if (MENU_HIDDEN_ITEMS > 0)
+    if (from->flags & MENU_FLAG_HIDDEN)
+    {
+        // Скрытый `from` не входит в кольцо навигации: обходим кольцо с первого видимого после него
+        menu_item_t *first = s_menu_visible_from(from);
+        menu_item_t *item  = first;
+        while (item)
+        {
+            if (s_menu_jump_key(s_menu_title(item)[0]) == key)
+                return item;
+            item = item->next != first ? item->next : NULL;
+        }
+        return NULL;
+    }
+#endif
+
+    for (menu_item_t *item = from->next; item != from; item = item->next)
+    {
+        if (s_menu_jump_key(s_menu_title(item)[0]) == key)
+            return item;
+    }
+    return NULL;
+}
+
+/**
+ * @brief Быстрый переход по первой букве заголовка в кольце текущего пункта.
+ *
+ * Вызывается платформой при нажатии клавиши с буквой (в console.c -- '/' и буква). Внутри
+ * виртуальных списков (и списка результатов поиска) переход не выполняется.
+ */
+void Menu_JumpKey (char key)
+{
+    menu_item_t *current = s_menu_handle.current;
+
+    // Окно виртуального списка и узел списка результатов поиска не входят в индекс
+    if (current == NULL || (current->flags & MENU_FLAG_VIRTUAL))
+        return;
+#if MENU_SEARCH
+    if (current == &s_menu_search_list.node)
+        return;
+#endif
+
+    MENU_LATENCY_MARK(MENU_LATENCY_DISPATCH);
+    MENU_TRACE(MENU_TRACE_EV_INPUT, MENU_TRACE_INPUT_JUMP);
+#if (MENU_STRINGS > 0) && (MENU_JUMP_INDEX > 0)
+    if (s_menu_handle.jump_stale)
+        s_menu_jump_rebuild(); // Первый переход после смены языка
+#endif
+
+    menu_item_t *target = s_menu_jump_find(current, key);
+    if (target && target != current)
+    {
+        s_menu_handle.current = target;
+        MENU_TRACE(MENU_TRACE_EV_NAV, MENU_TRACE_NAV_JUMP);
+    }
+
+    s_display_menu();
+}
+
+#if MENU_SEARCH
+/**
+ * @brief Готовит образец поиска: копия до MENU_ITEM_TITLE_LEN байт, маска сравниваемых байт.
+ */
+static void s_menu_search_key (menu_search_key_t *key, const char *pattern, uint8_t mode)
+{
+#if MENU_TITLE_CHARSET
+    char coded[MENU_ITEM_TITLE_LEN]; // Образец сравнивается с заголовками в кодах дисплея
+    lcd1602_transcode(coded, MENU_ITEM_TITLE_LEN, pattern);
+    pattern = coded;
+#endif
+    size_t len = strnlen(pattern, MENU_ITEM_TITLE_LEN);
+
+    memset(key, 0, sizeof(*key));
+    key->nocase = (mode & MENU_SEARCH_NOCASE) != 0;
+    for (size_t i = 0; i < len; i++)
+    {
+        key->bytes[i] = key->nocase ? (uint8_t)s_menu_jump_key(pattern[i]) : (uint8_t)pattern[i];
+    }
+    // EXACT сравнивает и нулевой хвост поля, PREFIX -- только байты образца
+    memset(key->mask, 0xFF, (mode & MENU_SEARCH_PREFIX) ? len : MENU_ITEM_TITLE_LEN);
+}
+
+/**
+ * @brief Сравнение заголовка с образцом побайтно (без векторных инструкций).
+ */
+MENU_UNUSED static int s_menu_title_match_scalar (const char *title, const menu_search_key_t *key)
+{
+    for (uint32_t i = 0; i < MENU_ITEM_TITLE_LEN; i++)
+    {
+        uint8_t c = (uint8_t)title[i];
+        if (key->nocase)
+            c = (uint8_t)s_menu_jump_key((char)c);
+        if ((c ^ key->bytes[i]) & key->mask[i])
+            return 0;
+    }
+    return 1;
+}
+
+/**
+ * @brief Сравнение всего поля заголовка с образцом одной векторной операцией.
+ */
+static inline int s_menu_title_match (const char *title, const menu_search_key_t *key)
+{
+#if (MENU_SEARCH_SIMD == MENU_SEARCH_SIMD_SSE2)
+    __m128i t = _mm_loadu_si128((const __m128i *)title);
+    if (key->nocase)
+    {
+        // 'A'..'Z' -> 'a'..'z'; байты >= 0x80 при знаковом сравнении отрицательны и не затрагиваются
+        __m128i upper = _mm_and_si128(_mm_cmpgt_epi8(t, _mm_set1_epi8('A' - 1)), _mm_cmplt_epi8(t, _mm_set1_epi8('Z' + 1)));
+        t = _mm_or_si128(t, _mm_and_si128(upper, _mm_set1_epi8(0x20)));
+    }
+    __m128i diff = _mm_and_si128(_mm_xor_si128(t, _mm_loadu_si128((const __m128i *)key->bytes)),
+                                 _mm_loadu_si128((const __m128i *)key->mask));
+    return _mm_movemask_epi8(_mm_cmpeq_epi8(diff, _mm_setzero_si128())) == 0xFFFF;
+#elif (MENU_SEARCH_SIMD == MENU_SEARCH_SIMD_NEON)
+    uint8x16_t t = vld1q_u8((const uint8_t *)title);
+    if (key->nocase)
+    {
+        uint8x16_t upper = vandq_u8(vcgeq_u8(t, vdupq_n_u8('A')), vcleq_u8(t, vdupq_n_u8('Z')));
+        t = vorrq_u8(t, vandq_u8(upper, vdupq_n_u8(0x20)));
+    }
+    uint8x16_t diff = vandq_u8(veorq_u8(t, vld1q_u8(key->bytes)), vld1q_u8(key->mask));
+    return vmaxvq_u8(diff) == 0;
+#else
+    return s_menu_title_match_scalar(title, key);
+#endif
+}
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+/**
+ * @brief Освобождает столбец заголовков.
+ * @return Освобождённых мест (0 -- столбец не был построен).
+ */
+static uint32_t s_menu_search_column_drop (void)
+{
+    uint32_t capacity = s_menu_search_column.titles ? s_menu_search_column.capacity : 0;
+
+    if (s_menu_search_column.titles)
+    {
+        MENU_FREE(s_menu_search_column.titles);
+        MENU_FREE(s_menu_search_column.items);
+    }
+    memset(&s_menu_search_column, 0, sizeof(s_menu_search_column));
+
+    return capacity;
+}
+
+/**
+ * @brief Выделяет столбец на `capacity` мест и переносит в него построенную часть.
+ * @return 0, если не хватило памяти (прежний столбец остаётся).
+ */
+static int s_menu_search_column_grow (uint32_t capacity)
+{
+    menu_search_column_t *column = &s_menu_search_column;
+    char        (*titles)[MENU_ITEM_TITLE_LEN] = MENU_MALLOC((size_t)capacity * MENU_ITEM_TITLE_LEN);
+    menu_item_t **items = MENU_MALLOC((size_t)capacity * sizeof(menu_item_t *));
+
+    if (titles == NULL || items == NULL)
+    {
+        if (titles)
+            MENU_FREE(titles);
+        if (items)
+            MENU_FREE(items);
+        return 0;
+    }
+
+    if (column->titles)
+    {
+        memcpy(titles, column->titles, (size_t)column->count * MENU_ITEM_TITLE_LEN);
+        memcpy(items, column->items, (size_t)column->count * sizeof(menu_item_t *));
+        MENU_FREE(column->titles);
+        MENU_FREE(column->items);
+    }
+    column->titles   = titles;
+    column->items    = items;
+    column->capacity = capacity;
+
+    return 1;
+}
+
+/**
+ * @brief Дописывает пункт в столбец, если столбец построен. Места удваиваются по мере роста.
+ */
+static void s_menu_search_column_add (menu_item_t *item)
+{
+    menu_search_column_t *column = &s_menu_search_column;
+
+    if (column->titles == NULL || (item->flags & MENU_FLAG_VIRTUAL))
+        return;
+
+    if (column->count == column->capacity && !s_menu_search_column_grow(column->capacity * 2))
+    {
+        // Нет памяти на рост: поиск обойдётся списком пунктов, пока столбец не построится снова
+        s_menu_search_column_drop();
+        return;
+    }
+
+    memcpy(column->titles[column->count], s_menu_title(item), MENU_ITEM_TITLE_LEN);
+    column->items[column->count++] = item;
+}
+
+/**
+ * @brief Строит столбец заголовков по списку `folowing`.
+ */
+static void s_menu_search_column_build (void)
+{
+    uint32_t count = 0;
+
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+        count++;
+
+    s_menu_search_column_drop();
+    if (count == 0 || !s_menu_search_column_grow(count + count / 2))
+        return;
+
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+        s_menu_search_column_add(item);
+}
+#endif
+
+/**
+ * @brief Поиск пунктов по заголовку во всём дереве.
+ *
+ * Просматривает все пункты в порядке создания (в статическом режиме -- массив пунктов, в
+ * динамическом -- столбец заголовков, а если он не поместился в куче -- список `folowing`) и
+ * сравнивает поле заголовка целиком: SSE2 или NEON, если доступны, иначе побайтно. Пункты
+ * окон виртуальных списков не просматриваются.
+ *
+ * @param pattern  Образец, используются первые MENU_ITEM_TITLE_LEN символов.
+ * @param mode     MENU_SEARCH_EXACT или MENU_SEARCH_PREFIX, можно с MENU_SEARCH_NOCASE.
+ * @param results  Буфер для найденных пунктов (может быть NULL при `capacity` 0).
+ * @param capacity Размер буфера: сверх него пункты только считаются.
+ * @return Количество найденных пунктов (может превышать `capacity`).
+ */
+MENU_UNUSED static uint32_t s_menu_search (const char *pattern, uint8_t mode, menu_item_t **results, uint32_t capacity)
+{
+    menu_search_key_t key;
+    uint32_t found = 0;
+
+    s_menu_search_key(&key, pattern, mode);
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    if (s_menu_search_column.titles == NULL)
+        s_menu_search_column_build();
+
+    menu_search_column_t *column = &s_menu_search_column;
+    if (column->titles)
+    {
+        for (uint32_t i = 0; i < column->count; i++)
+        {
+            if (s_menu_title_match(column->titles[i], &key))
+            {
+                if (found < capacity)
+                    results[found] = column->items[i];
+                found++;
+            }
+        }
+        return found;
+    }
+
+    // Столбец не поместился в куче: поиск по списку пунктов
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+    {
+#else
+    for (uint32_t i = 0; i < s_menu_handle.static_array_pos; i++)
+    {
+        menu_item_t *item = &s_menu_items[i];
+#endif
+        if (s_menu_title_match(s_menu_title(item), &key) && !(item->flags & MENU_FLAG_VIRTUAL))
+        {
+            if (found < capacity)
+                results[found] = item;
+            found++;
+        }
+    }
+
+    return found;
+}
+#endif
+
+#if MENU_FUZZY
+/**
+ * @brief Символы заголовка битами: a-z (без учёта регистра), цифры парами, прочее -- один бит.
+ */
+static uint32_t s_menu_fuzzy_mask (const char *title)
+{
+    uint32_t mask = 0;
+
+    for (uint32_t i = 0; i < MENU_ITEM_TITLE_LEN && title[i]; i++)
+    {
+        char c = s_menu_jump_key(title[i]);
+        if (c >= 'a' && c <= 'z')
+            mask |= 1u << (c - 'a');
+        else if (c >= '0' && c <= '9')
+            mask |= 1u << (26 + (c - '0') / 2);
+        else if (c != ' ')
+            mask |= 1u << 31;
+    }
+    return mask;
+}
+
+/**
+ * @brief Место таблицы `map` для пункта: с его записью или первое свободное.
+ *
+ * Места освобождённых записей не очищаются (их `item` -- NULL и ни с чем не совпадает),
+ * поэтому пункт, созданный по адресу освобождённого, получает новое место.
+ */
+static uint32_t * s_menu_fuzzy_slot (const menu_item_t *item)
+{
+    menu_fuzzy_index_t *index = &s_menu_fuzzy_index;
+    uint32_t size = 2 * index->capacity;
+    uint32_t hash = (uint32_t)(((uintptr_t)item >> 4) * 2654435761u) % size;
+
+    for (;;)
+    {
+        uint32_t *slot = &index->map[hash];
+        if (*slot == MENU_FUZZY_NONE || index->entries[*slot].item == item)
+            return slot;
+        hash = hash + 1 < size ? hash + 1 : 0;
+    }
+}
+
+/**
+ * @brief Номер записи пункта или MENU_FUZZY_NONE.
+ */
+static uint32_t s_menu_fuzzy_find (const menu_item_t *item)
+{
+    return item ? *s_menu_fuzzy_slot(item) : MENU_FUZZY_NONE;
+}
+
+/**
+ * @brief Заполняет таблицу `map` по записям (после выделения или уплотнения).
+ */
+static void s_menu_fuzzy_rehash (void)
+{
+    menu_fuzzy_index_t *index = &s_menu_fuzzy_index;
+
+    memset(index->map, 0xFF, 2 * (size_t)index->capacity * sizeof(uint32_t));
+    for (uint32_t i = 0; i < index->count; i++)
+    {
+        if (index->entries[i].item)
+            *s_menu_fuzzy_slot(index->entries[i].item) = i;
+    }
+}
+
+/**
+ * @brief Освобождает нечёткий индекс. Следующий запрос построит его заново.
+ * @return Мест, которые занимал индекс (0 -- не был построен).
+ */
+static uint32_t s_menu_fuzzy_drop (void)
+{
+    uint32_t capacity = s_menu_fuzzy_index.entries ? s_menu_fuzzy_index.capacity : 0;
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+    if (s_menu_fuzzy_index.entries)
+    {
+        MENU_FREE(s_menu_fuzzy_index.entries);
+        MENU_FREE(s_menu_fuzzy_index.states);
+        MENU_FREE(s_menu_fuzzy_index.map);
+    }
+#endif
+    memset(&s_menu_fuzzy_index, 0, sizeof(s_menu_fuzzy_index));
+
+    return capacity;
+}
+
+/**
+ * @brief Выделяет индекс на `capacity` записей и переносит в него прежние записи.
+ * @return 0, если не хватило памяти (прежний индекс остаётся).
+ */
+static int s_menu_fuzzy_grow (uint32_t capacity)
+{
+    menu_fuzzy_index_t *index = &s_menu_fuzzy_index;
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_STATIC_MEMORY)
+    (void)capacity; // Статические таблицы рассчитаны на MENU_SIZE пунктов
+    if (index->entries)
+        return 0;
+    index->entries  = s_menu_fuzzy_entries;
+    index->states   = s_menu_fuzzy_states;
+    index->map      = s_menu_fuzzy_map;
+    index->capacity = MENU_SIZE;
+#else
+    menu_fuzzy_entry_t *entries = MENU_MALLOC((size_t)capacity * sizeof(menu_fuzzy_entry_t));
+    menu_fuzzy_state_t *states  = MENU_MALLOC((size_t)capacity * sizeof(menu_fuzzy_state_t));
+    uint32_t           *map     = MENU_MALLOC(2 * (size_t)capacity * sizeof(uint32_t));
+
+    if (entries == NULL || states == NULL || map == NULL)
+    {
+        if (entries)
+            MENU_FREE(entries);
+        if (states)
+            MENU_FREE(states);
+        if (map)
+            MENU_FREE(map);
+        return 0;
+    }
+
+    if (index->entries)
+    {
+        memcpy(entries, index->entries, (size_t)index->count * sizeof(menu_fuzzy_entry_t));
+        MENU_FREE(index->entries);
+        MENU_FREE(index->states);
+        MENU_FREE(index->map);
+    }
+    index->entries  = entries;
+    index->states   = states;
+    index->map      = map;
+    index->capacity = capacity;
+#endif
+    memset(index->states, 0, (size_t)index->capacity * sizeof(menu_fuzzy_state_t));
+    index->epoch = 0;
+    s_menu_fuzzy_rehash();
+
+    return 1;
+}
+
+/**
+ * @brief Убирает освобождённые записи, сохраняя порядок, и перенумеровывает родителей.
+ */
+static void s_menu_fuzzy_compact (void)
+{
+    menu_fuzzy_index_t *index = &s_menu_fuzzy_index;
+    uint32_t *renumber = index->map; // Таблица всё равно перестраивается после уплотнения
+    uint32_t  count    = 0;
+
+    for (uint32_t i = 0; i < index->count; i++)
+    {
+        renumber[i] = count;
+        if (index->entries[i].item == NULL)
+            continue;
+
+        menu_fuzzy_entry_t entry = index->entries[i];
+        if (entry.parent != MENU_FUZZY_NONE)
+            entry.parent = renumber[entry.parent];
+        index->entries[count++] = entry;
+    }
+
+    index->count = count;
+    index->dead  = 0;
+    s_menu_fuzzy_rehash();
+}
+
+/**
+ * @brief Добавляет пункт в нечёткий индекс, если индекс построен. Окна виртуальных списков
+ *        (заголовки меняются при прокрутке) в индекс не входят.
+ */
+static void s_menu_fuzzy_add (menu_item_t *item)
+{
+    menu_fuzzy_index_t *index = &s_menu_fuzzy_index;
+
+    if (index->entries == NULL || (item->flags & MENU_FLAG_VIRTUAL))
+        return;
+
+    if (index->count == index->capacity)
+    {
+        if (index->dead >= index->capacity / 4)
+        {
+            s_menu_fuzzy_compact();
+        }
+        else if (!s_menu_fuzzy_grow(index->capacity * 2))
+        {
+            // Нет памяти на рост: индекс строится заново при следующем запросе
+            s_menu_fuzzy_drop();
+            return;
+        }
+    }
+
+    uint32_t parent = s_menu_fuzzy_find(item->parent);
+    menu_fuzzy_entry_t *entry = &index->entries[index->count];
+
+    entry->item   = item;
+    entry->parent = parent;
+    entry->mask   = s_menu_fuzzy_mask(s_menu_title(item)) | (parent != MENU_FUZZY_NONE ? index->entries[parent].mask : 0);
+    index->states[index->count].need = 0;
+    *s_menu_fuzzy_slot(item) = index->count++;
+}
+
+#if MENU_LAZY_RELEASE
+/**
+ * @brief Убирает из индекса потомков пункта (их освобождает s_menu_lazy_release).
+ *
+ * Родитель всегда раньше потомков, поэтому поддерево помечается одним проходом вперёд:
+ * запись освобождается, если её родитель -- `item` или уже освобождённая запись.
+ */
+static void s_menu_fuzzy_remove (menu_item_t *item)
+{
+    menu_fuzzy_index_t *index = &s_menu_fuzzy_index;
+
+    if (index->entries == NULL)
+        return;
+
+    uint32_t root = s_menu_fuzzy_find(item);
+    if (root == MENU_FUZZY_NONE)
+        return;
+
+    for (uint32_t i = root + 1; i < index->count; i++)
+    {
+        menu_fuzzy_entry_t *entry = &index->entries[i];
+        if (entry->item && entry->parent != MENU_FUZZY_NONE &&
+            (entry->parent == root || index->entries[entry->parent].item == NULL))
+        {
+            entry->item = NULL;
+            index->dead++;
+        }
+    }
+
+    if (index->dead * 2 > index->count)
+        s_menu_fuzzy_compact();
+}
+#endif
+
+/**
+ * @brief Строит нечёткий индекс по списку `folowing`.
+ */
+static void s_menu_fuzzy_build (void)
+{
+    uint32_t count = 0;
+
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+        count++;
+
+    s_menu_fuzzy_drop();
+
+    uint32_t capacity = MENU_FUZZY_MIN;
+    while (capacity < count)
+        capacity *= 2;
+    if (!s_menu_fuzzy_grow(capacity))
+        return;
+
+    for (menu_item_t *item = s_menu_handle.start; item; item = item->folowing)
+        s_menu_fuzzy_add(item);
+}
+
+/**
+ * @typedef menu_fuzzy_query_t
+ * @brief Разобранный запрос: символы без пробелов, начала слов и символы для фильтра.
+ */
+typedef struct {
+    char     chars[MENU_FUZZY_QUERY]; ///< Символы запроса в нижнем регистре
+    uint32_t starts;                  ///< Бит i -- символ i начинает слово запроса
+    uint32_t mask;                    ///< Символы запроса в виде s_menu_fuzzy_mask
+    uint8_t  len;                     ///< Количество символов
+} menu_fuzzy_query_t;
+
+/**
+ * @brief Продолжает сопоставление запроса с путём на один заголовок.
+ *
+ * Символы запроса ищутся по пути по порядку, каждый -- первым подходящим символом (жадно).
+ * Очки: символ +1, в начале слова пути +2 (+8, если и в запросе он начинает слово),
+ * подряд с предыдущим найденным +4; пропуск символа пути внутри совпадения -1, каждый
+ * уровень пути -1 (короткие пути выше).
+ */
+static menu_fuzzy_state_t s_menu_fuzzy_advance (menu_fuzzy_state_t state, const char *title, const menu_fuzzy_query_t *query)
+{
+    char prev = '/'; // Начало заголовка -- граница слова пути
+    int  run  = 0;
+
+    state.score--;
+    for (uint32_t i = 0; i < MENU_ITEM_TITLE_LEN && title[i] && state.matched < query->len; i++)
+    {
+        char c = s_menu_jump_key(title[i]);
+
+        if (c == query->chars[state.matched])
+        {
+            int16_t bonus = 1;
+            if (prev == '/' || prev == ' ' || prev == '-' || prev == '_')
+                bonus += ((query->starts >> state.matched) & 1) ? 8 : 2;
+            if (run)
+                bonus += 4;
+            state.score += bonus;
+            state.matched++;
+            run = 1;
+        }
+        else
+        {
+            if (state.matched)
+                state.score--;
+            run = 0;
+        }
+        prev = c;
+    }
+
+    return state;
+}
+
+/**
+ * @brief Нечёткий поиск по путям пунктов: "hi dur" находит "Hi Arm/Duration".
+ *
+ * Символы запроса (пробелы разделяют слова) должны встретиться в пути по порядку, не
+ * обязательно подряд, регистр латиницы не важен. Индекс строится при первом запросе и затем
+ * поддерживается при добавлении и освобождении пунктов. Запрос -- три прохода по записям:
+ * фильтр по символам пути, отметка предков кандидатов (их состояния нужны потомкам) и
+ * сопоставление, где состояние пункта продолжает состояние родителя по одному заголовку.
+ *
+ * @param results  Лучшие совпадения по убыванию оценки (при равной -- в порядке создания).
+ * @param scores   Их оценки.
+ * @param capacity Размер буферов.
+ * @return Количество совпадений всего (может превышать `capacity`).
+ */
+MENU_UNUSED static uint32_t s_menu_fuzzy (const char *query, menu_item_t **results, int32_t *scores, uint32_t capacity)
+{
+    menu_fuzzy_index_t *index = &s_menu_fuzzy_index;
+    menu_fuzzy_query_t  parsed;
+    uint32_t found = 0;
+    uint32_t kept  = 0;
+    int      word  = 1;
+
+    memset(&parsed, 0, sizeof(parsed));
+    for (; *query && parsed.len < MENU_FUZZY_QUERY; query++)
+    {
+        if (*query == ' ')
+        {
+            word = 1;
+            continue;
+        }
+        char title[2] = { *query, '\0' };
+        parsed.chars[parsed.len] = s_menu_jump_key(*query);
+        parsed.mask  |= s_menu_fuzzy_mask(title);
+        parsed.starts |= (uint32_t)word << parsed.len;
+        parsed.len++;
+        word = 0;
+    }
+    if (parsed.len == 0)
+        return 0;
+
+    if (index->entries == NULL)
+        s_menu_fuzzy_build();
+    if (index->entries == NULL)
+        return 0;
+
+    menu_fuzzy_entry_t *entries = index->entries;
+    menu_fuzzy_state_t *states  = index->states;
+
+    if (++index->epoch == 0)
+    {
+        // Отметки прошлых запросов могли бы совпасть с новой: сброс раз в 255 запросов
+        for (uint32_t i = 0; i < index->count; i++)
+            states[i].need = 0;
+        index->epoch = 1;
+    }
+
+    // 1. Обратный проход: кандидаты -- пункты, в пути которых есть все символы запроса; их
+    //    предкам нужны состояния для сопоставления. Потомки идут после родителя, поэтому к
+    //    записи родителя все отметки детей уже поставлены.
+    for (uint32_t i = index->count; i-- > 0; )
+    {
+        menu_fuzzy_entry_t *entry = &entries[i];
+        uint8_t need = states[i].need == index->epoch ||
+                       (entry->item && (entry->mask & parsed.mask) == parsed.mask);
+
+        states[i].need = need ? index->epoch : 0;
+        if (need && entry->parent != MENU_FUZZY_NONE)
+            states[entry->parent].need = index->epoch;
+    }
+
+    // 2. Сопоставление в порядке записей: родитель уже сопоставлен
+    for (uint32_t i = 0; i < index->count; i++)
+    {
+        if (states[i].need != index->epoch)
+            continue;
+
+        menu_fuzzy_state_t state = { 0, 0, index->epoch };
+        if (entries[i].parent != MENU_FUZZY_NONE)
+            state = states[entries[i].parent];
+
+        uint8_t before = state.matched;
+        state = s_menu_fuzzy_advance(state, s_menu_title(entries[i].item), &parsed);
+        states[i] = state;
+
+        if (state.matched < parsed.len || (entries[i].mask & parsed.mask) != parsed.mask)
+            continue;
+
+        // Совпадение в собственном заголовке пункта ценится выше, чем в пути к нему
+        int32_t score = state.score + 3 * (state.matched - before);
+        found++;
+
+        // Вставка в лучшие `capacity` по убыванию оценки; равная оценка не вытесняет раннюю
+        if (kept == capacity && (capacity == 0 || score <= scores[kept - 1]))
+            continue;
+        uint32_t pos = kept < capacity ? kept++ : kept - 1;
+        for (; pos > 0 && scores[pos - 1] < score; pos--)
+        {
+            results[pos] = results[pos - 1];
+            scores[pos]  = scores[pos - 1];
+        }
+        results[pos] = entries[i].item;
+        scores[pos]  = score;
+    }
+
+    return found;
+}
+#endif
+
+#if MENU_SEARCH
+/**
+ * @brief Источник записей списка результатов: заголовок найденного пункта.
+ */
+static uint32_t s_menu_search_provider (uint32_t index, char *title)
+{
+    memcpy(title, s_menu_title(s_menu_search_list.results[index]), MENU_ITEM_TITLE_LEN);
+    return index;
+}
+
+/**
+ * @brief Показывает найденные пункты временным списком и переводит в него курсор.
+ *
+ * Прокрутка энкодером перебирает результаты, нажатие переходит к найденному пункту, длинное
+ * нажатие -- на узел "Results" (нажатие на него возвращает в список), второе длинное
+ * нажатие -- к пункту, из которого начат поиск. Буфер `results` должен жить, пока открыт
+ * список: до следующего показа, s_menu_search_close или освобождения пунктов.
+ *
+ * @param count Количество результатов в буфере (не больше его размера).
+ * @return `count` или 0, если показывать нечего.
+ */
+MENU_UNUSED static uint32_t s_menu_search_show (menu_item_t **results, uint32_t count)
+{
+    menu_search_list_t *list = &s_menu_search_list;
+    menu_item_t *node = &list->node;
+
+    if (count == 0 || results == NULL || s_menu_handle.current == NULL)
+        return 0;
+
+    // Курсор может уже стоять в прежнем списке: поиск начат из того же места
+    menu_item_t *origin = s_menu_handle.current;
+    while (origin == node || origin->parent == node)
+        origin = node->parent;
+
+    s_menu_copy_title(node->title, "Results");
+#if (MENU_STRINGS > 0)
+    node->string = MENU_STRING_NONE;
+#endif
+    node->parent = origin;
+    node->prev   = node;
+    node->next   = node;
+    node->child  = &list->window[0];
+
+    for (uint32_t i = 0; i < MENU_VIRTUAL_WINDOW; i++)
+    {
+        menu_item_t *item = &list->window[i];
+        list->descriptor.window[i] = item; // Кольцо окна связывает s_menu_virtual_set_count
+        item->parent = node;
+        item->flags  = MENU_FLAG_VIRTUAL | MENU_FLAG_GOTO_CHILD;
+#if (MENU_STRINGS > 0)
+        item->string = MENU_STRING_NONE;
+#endif
+    }
+
+    list->results = results;
+    list->descriptor.node     = node;
+    list->descriptor.provider = s_menu_search_provider;
+    list->descriptor.index    = 0;
+    s_menu_virtual_set_count(node, count);
+
+    s_menu_handle.current = node->child;
+    s_menu_virtual_enter(node->child);
+    s_display_menu();
+
+    return count;
+}
+
+/**
+ * @brief Закрывает список результатов. Если курсор в нём -- возвращает к пункту начала поиска.
+ */
+static void s_menu_search_close (void)
+{
+    menu_item_t *node = &s_menu_search_list.node;
+    menu_item_t *current = s_menu_handle.current;
+
+    if (current && (current == node || current->parent == node))
+        s_menu_handle.current = node->parent;
+
+    s_menu_search_list.descriptor.count = 0;
+    node->flags &= (uint8_t)~MENU_FLAG_GOTO_CHILD;
+    s_menu_search_list.results = NULL;
+}
+#endif
+
+#if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
+/**
+ * @brief Освобождение памяти всех элементов меню.
+ * 
+ * Все элементы меню, независимо от уровня, связаны в односвязный список через поле
+ * `folowing` в порядке создания, начиная с `s_menu_handle.start`. Функция проходит
+ * этот список и освобождает каждый элемент, включая последний. Обход дерева (s_menu_walk)
+ * здесь не используется: список плоский и не требует стека, а обход пропускает пункты без
+ * цепочки `child` и останавливается на подменю глубже MENU_WALK_DEPTH.
+ *
+ * После освобождения указатели `start` и `current` обнуляются, так что меню можно
+ * построить заново.
+ */
+static void s_menu_free_items (void)
+{
+    menu_item_t *item = s_menu_handle.start;
+    menu_item_t *next = NULL;
+    while(item)
+    {
+        next = item->folowing;
+#if MENU_REGIONS
+        // Участок отложенного подменю -- пункты областей: пропускается, блоки освобождаются ниже
+        if ((item->flags & MENU_FLAG_LAZY) && s_menu_lazy[item->data].last)
+            next = s_menu_lazy[item->data].last->folowing;
+#endif
+        MENU_FREE(item);
+        item = next;
+    }
+#if MENU_REGIONS
+    for (uint32_t slot = 0; slot < s_menu_handle.lazy_submenus; slot++)
+    {
+        s_menu_region_release(slot);
+        s_menu_lazy[slot].region_items = 0;
+    }
+#endif
+#if MENU_SEARCH
+    s_menu_search_column_drop();
+#endif
+#if MENU_FUZZY
+    s_menu_fuzzy_drop();
+#endif
+#if MENU_BREADCRUMB
+    s_menu_handle.breadcrumb.valid = 0;
+#endif
+#if (MENU_MARQUEE_TITLES > 0)
+    s_menu_handle.marquee.item   = NULL;
+    s_menu_handle.marquee_titles  = 0;
+#endif
+
+    s_menu_handle.start   = NULL;
+    s_menu_handle.current = NULL;
+    s_menu_handle.last    = NULL;
+}
+
+#endif
+
+
+/**
+ * @brief Обратный вызов для обработки длительного нажатия кнопки, 
+ * переходящий к родительскому элементу меню или к стартовому элементу меню.
+ */
+static void s_long_push_button_callback (void)
+{
+    MENU_LATENCY_MARK(MENU_LATENCY_DISPATCH);
+    MENU_TRACE(MENU_TRACE_EV_INPUT, MENU_TRACE_INPUT_LONG_PUSH);
+
+    // Проверяем, есть ли у текущего элемента меню родительский элемент.
+    if (s_menu_handle.current->parent)
+    {
+        // Устанавливаем текущий элемент меню как его родительский элемент
+        // (первый видимый пункт кольца родителя, если родитель скрыт).
+        // Повторный вход в подменю продолжится с текущего пункта.
+        menu_item_t *parent = s_menu_handle.current->parent;
+#if (MENU_CURSOR_MEMORY > 0)
+        s_menu_resume_save(s_menu_handle.current);
+#endif
+#if (MENU_HIDDEN_ITEMS > 0)
+        if (parent->flags & MENU_FLAG_HIDDEN)
+            parent = s_menu_visible_up(parent);
+#endif
+        s_menu_handle.current = parent;
+        MENU_TRACE(MENU_TRACE_EV_NAV, MENU_TRACE_NAV_PARENT);
+
+        // Вызываем функцию для обновления и отображения меню.
+        s_display_menu();
+    } 
+    else 
+    {
+        // Если у текущего элемента нет родителя, устанавливаем текущий элемент
+        // меню как стартовый элемент меню (первый видимый корневой элемент).
+        menu_item_t *first = s_menu_handle.start;
+#if (MENU_HIDDEN_ITEMS > 0)
+        if (first->flags & MENU_FLAG_HIDDEN)
+        {
+            first = s_menu_visible_from(first);
+            if (first == NULL)
+                first = s_menu_handle.start; // Скрыты все корневые пункты
+        }
+#endif
+        s_menu_handle.current = first;
+        MENU_TRACE(MENU_TRACE_EV_NAV, MENU_TRACE_NAV_START);
 
         // Вызываем функцию для обновления и отображения меню.
         s_display_menu();
@@ -31,7 +31,7 @@ typedef struct {
     int16_t delta;
 } rotenc_data_t;
 
-static rotenc_current_t rotenc_current = {0};
+static rotenc_data_t rotenc_current = {0};
 
 typedef struct _menu_item_t {
     char *title;
@@ -98,7 +98,7 @@ void Menu_Init(void)
 {
     // printf("Size: %lu, %0.2f\r\n", sizeof(s_menu_start), sizeof(s_menu_start) * 12.0 / 1024.0);
     s_display_menu();
-    taskReadKey(s_rotary_encoder_callback, s_push_button_callback);
+    taskReadKey(s_rotary_encoder_callback, s_push_button_callback, NULL);
 }
 
 /**
@@ -150,7 +150,5 @@ static void s_push_button_callback (void)
 
 static void s_display_menu(void)
 {
-    printf("\033[H\033[J");
-    printf("> %s\r\n", s_menu_current_item->title);
-    printf("%s\r\n", s_menu_current_item->next->title);
+    printMenu(s_menu_current_item->title, s_menu_current_item->next->title);
 }
\ No newline at end of file
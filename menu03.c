@@ -123,7 +123,7 @@ static menu_item_t * s_menu_add_item     (char *title, menu_item_t *parent, menu
 static void          s_menu_rechain (menu_item_t *parent);
 
 // static menu_item_t * s_create_submenu (char *title, menu_item_t *parent, uint8_t flags);
-static void s_menu_set_start_values   (menu_item_t *item);
+// static void s_menu_set_start_values   (menu_item_t *item);
 static void s_long_push_button_callback (void);
 
 #if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
@@ -351,7 +351,7 @@ static menu_item_t * s_create_new_item(void)
     }
     item = &s_menu_items[s_menu_handle.static_array_pos++]; // Берём следующий доступный элемент
 #elif (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
-    item = (menu_item_t *)malloc(sizeof(menu_item_t));
+    item = (menu_item_t *)MENU_MALLOC(sizeof(menu_item_t));
 #endif
     return item;
 }
@@ -385,6 +385,7 @@ static menu_item_t * s_create_new_item(void)
  * @param item Указатель на элемент меню, который необходимо установить как текущий 
  * и/или начальный, если они ещё не были установлены.
  */
+#if 0 // Вызывается только из отключённых вариантов s_menu_add_item ниже
 static void s_menu_set_start_values(menu_item_t *item)
 {
     if (s_menu_handle.current == NULL) 
@@ -397,6 +398,7 @@ static void s_menu_set_start_values(menu_item_t *item)
         s_menu_handle.start = item;
     }
 }
+#endif
 
 /**
  * @brief Переинициализация цепочки подменю по родителю
@@ -483,6 +485,7 @@ static menu_item_t* s_menu_add_item(char *title, menu_item_t *parent, menu_item_
     }
 
     s_menu_rechain(parent);
+    return item;
 }
 #if 0
 static menu_item_t* s_menu_add_item(char *title, menu_item_t *parent, menu_item_callback_t callback, uint8_t flags)
@@ -615,10 +618,12 @@ static void s_menu_free_items (void)
     while(item->folowing)
     {
         next = item->folowing;
-        free(item);
+        MENU_FREE(item);
         item = next;
     }
 }
+#endif
+
 #if 0
 static void s_menu_free_recursively(menu_item_t *item) 
 {
@@ -121,7 +121,7 @@ static menu_item_t * s_menu_add_item  (const char *title, menu_item_callback_t c
 static menu_item_t * s_create_submenu (const char *title, menu_item_t *parent);
 static void s_menu_set_start_values   (menu_item_t *item);
 #if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
-static void s_menu_free_recursively   (menu_item_t *item);
+static void s_menu_free_tree          (menu_item_t *item);
 static void s_menu_free_items         (void);
 #endif
 
@@ -295,7 +295,7 @@ static void s_push_button_callback (void)
 static void s_menu_init (void)
 {
     s_display_menu();
-    taskReadKey(s_rotary_encoder_callback, s_push_button_callback);
+    taskReadKey(s_rotary_encoder_callback, s_push_button_callback, NULL);
 #if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
     s_menu_free_items ();
 #endif    
@@ -344,7 +344,7 @@ static menu_item_t * s_create_new_item(void)
     }
     item = &s_menu_items[s_menu_handle.static_array_pos++]; // Берём следующий доступный элемент
 #elif (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
-    item = (menu_item_t *)malloc(sizeof(menu_item_t));
+    item = (menu_item_t *)MENU_MALLOC(sizeof(menu_item_t));
 #endif
     return item;
 }
@@ -509,72 +509,42 @@ static menu_item_t * s_create_submenu (const char *title, menu_item_t *parent)
 
 #if (MENU_USAGE_MEMORY == MENU_USAGE_DYNAMIC_MEMORY)
 /**
- * @brief Рекурсивное освобождение памяти всех элементов меню.
- * 
- * Эта функция рекурсивно освобождает память, занятую элементами меню,
- * начиная с указанного элемента и продолжая перерабатывать связанный
- * список всех подчинённых элементов. 
- *
- * @param item Указатель на элемент меню, начиная с которого будет
- * осуществляться освобождение памяти. Если указанный элемент или его дочерний
- * элемент равен `NULL`, функция завершает выполнение сразу.
- *
- * @details
- * Функция сначала проверяет, не является ли текущий элемент или его дочерний
- * элемент пустыми. В случае, если дочерний элемент не пуст, функция вызывает
- * сама себя рекурсивно для освобождения памяти всех дочерних элементов.
- * 
- * Затем функция проходит через все элементы в цепочке, начиная с текущего
- * элемента, и освобождает память для каждого из них. Если элемент имеет своих 
- * дочерних элементов, то они также освобождаются рекурсивно.
+ * @brief Освобождение памяти всех элементов дерева меню без рекурсии.
  *
- * Наконец, сам исходный элемент также освобождается.
+ * Кольцо, в котором лежит `item`, размыкается и проходится по `next` как список.
+ * Дочернее кольцо встреченного пункта вставляется в список сразу за ним, после чего
+ * пункт освобождается: всё дерево проходится одним циклом, стек не растёт с
+ * вложенностью меню, а каждый пункт посещается один раз.
  *
- * Это прекращает использование и утечку памяти, гарантируя, что вся
- * память, выделенная для меню, корректно освобождается.
+ * @param item Указатель на любой элемент кольца. `NULL` -- ничего не делать.
  */
-static void s_menu_free_recursively(menu_item_t *item) 
+static void s_menu_free_tree(menu_item_t *item)
 {
-    if (item == NULL && item->child == NULL)
+    if (item == NULL)
         return;
 
-    // Сначала обработать дочерние элементы, если они есть
-    if (item->child != NULL) {
-        s_menu_free_recursively(item->child);
-    }
-    
-    // Обрабатывать и освобождать память от остальных в цепочке
-    menu_item_t *next_item = item->next;
-    menu_item_t *last = next_item->prev;
-    menu_item_t *firts = last->next;
-    while (next_item != last) {
-        menu_item_t *temp = next_item;
-
-        if(temp == NULL)
-            return;
-
-        next_item = next_item->next;
-        
-        // Если у элемента есть дети, освободите их память рекурсивно.
-        if (temp->child != NULL) {
-            s_menu_free_recursively(temp->child);
+    // Размыкаем кольцо: дальше список заканчивается на NULL
+    item->prev->next = NULL;
+
+    while (item != NULL) {
+        // Дочернее кольцо -- в список за пунктом
+        if (item->child != NULL) {
+            menu_item_t *first = item->child;
+            first->prev->next = item->next;
+            item->next = first;
         }
-        
-        // Освободить текущий элемент.
-        // printf("%s\r\n", temp->title);
 
-        free(temp);
+        menu_item_t *next = item->next;
+        MENU_FREE(item);
+        item = next;
     }
-    
-    // Освободить первоначально переданный элемент
-    free(item);
 }
 
 /**
  * @brief Освобождает память, занятую всеми элементами меню.
  * 
  * Эта функция является точкой входа для освобождения всех элементов меню,
- * представленных в виде связного списка, посредством вызова рекурсивной функции.
+ * представленных в виде связного списка, посредством вызова s_menu_free_tree.
  *
  * @details
  * Функция сначала проверяет, пуст ли список элементов меню, проверяя
@@ -582,8 +552,8 @@ static void s_menu_free_recursively(menu_item_t *item)
  * функция немедленно возвращает управление, так как нет памяти для 
  * освобождения.
  *
- * Если же элементы меню присутствуют, функция вызывает `s_menu_free_recursively`,
- * которая рекурсивно освобождает память для каждого элемента меню начиная с `s_menu_handle.start`.
+ * Если же элементы меню присутствуют, функция вызывает `s_menu_free_tree`,
+ * которая без рекурсии освобождает память для каждого элемента меню начиная с `s_menu_handle.start`.
  *
  * @note Это ключевая процедура для предотвращения утечек памяти, так как она
  * гарантирует, что все выделенные ресурсы, связанные с элементами меню,
@@ -595,7 +565,7 @@ static void s_menu_free_items(void)
         return;
     }
 
-    s_menu_free_recursively(s_menu_handle.start);
+    s_menu_free_tree(s_menu_handle.start);
 }
 
 #endif
\ No newline at end of file
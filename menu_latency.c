@@ -0,0 +1,186 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "menu_latency.h"
+
+#if (MENU_LATENCY_ENABLE != 0)
+
+#ifndef MENU_LATENCY_NOW
+#include <time.h>
+/**
+ * @brief Источник времени по умолчанию (хост): монотонные наносекунды, усечённые до 32 бит.
+ *        На микроконтроллере переопределяется, например `-DMENU_LATENCY_NOW()=DWT->CYCCNT`.
+ */
+static uint32_t s_latency_now (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec);
+}
+#define MENU_LATENCY_NOW() s_latency_now()
+#endif
+
+static const char *s_latency_stage_names[MENU_LATENCY_STAGES] = {
+    "dispatch", "callback", "render", "flush", "total"
+};
+
+/**
+ * @brief Состояние измерения: метка начала текущего события и время последней отметки.
+ */
+static struct {
+    uint32_t            start;  ///< Время поступления события
+    uint32_t            last;   ///< Время последней отметки стадии
+    uint8_t             active; ///< Событие в обработке
+    menu_latency_hist_t hist[MENU_LATENCY_STAGES];
+} s_latency;
+
+/**
+ * @brief Номер корзины для значения: до 2^SUB_BITS линейно, дальше по SUB_COUNT корзин на октаву.
+ */
+static uint32_t s_latency_bucket (uint32_t value)
+{
+    if (value < MENU_LATENCY_SUB_COUNT)
+        return value;
+
+    uint32_t msb   = 31u - (uint32_t)__builtin_clz(value);
+    uint32_t shift = msb - MENU_LATENCY_SUB_BITS;
+
+    return (shift + 1u) * MENU_LATENCY_SUB_COUNT + (value >> shift) - MENU_LATENCY_SUB_COUNT;
+}
+
+/**
+ * @brief Нижняя граница значений корзины (обратное к s_latency_bucket).
+ */
+static uint32_t s_latency_bucket_floor (uint32_t bucket)
+{
+    if (bucket < MENU_LATENCY_SUB_COUNT)
+        return bucket;
+
+    uint32_t shift = bucket / MENU_LATENCY_SUB_COUNT - 1u;
+    uint32_t sub   = bucket % MENU_LATENCY_SUB_COUNT + MENU_LATENCY_SUB_COUNT;
+
+    return sub << shift;
+}
+
+static void s_latency_record (menu_latency_stage_t stage, uint32_t value)
+{
+    menu_latency_hist_t *hist = &s_latency.hist[stage];
+
+    if (hist->count == 0 || value < hist->min)
+        hist->min = value;
+    if (value > hist->max)
+        hist->max = value;
+
+    hist->count++;
+    hist->sum += value;
+    hist->buckets[s_latency_bucket(value)]++;
+}
+
+/**
+ * @brief Отмечает поступление входного события. Вызывается источником ввода (ISR, опрос консоли).
+ */
+void menu_latency_begin (void)
+{
+    s_latency.start  = MENU_LATENCY_NOW();
+    s_latency.last   = s_latency.start;
+    s_latency.active = 1;
+}
+
+/**
+ * @brief Отмечает достижение стадии. Без активного события (например, первая отрисовка) игнорируется.
+ */
+void menu_latency_mark (menu_latency_stage_t stage)
+{
+    if (!s_latency.active)
+        return;
+
+    uint32_t now = MENU_LATENCY_NOW();
+    s_latency_record(stage, now - s_latency.last);
+    s_latency.last = now;
+}
+
+/**
+ * @brief Завершает событие: записывает полную задержку от поступления до вывода кадра.
+ */
+void menu_latency_end (void)
+{
+    if (!s_latency.active)
+        return;
+
+    s_latency_record(MENU_LATENCY_TOTAL, MENU_LATENCY_NOW() - s_latency.start);
+    s_latency.active = 0;
+}
+
+void menu_latency_reset (void)
+{
+    memset(&s_latency, 0, sizeof(s_latency));
+}
+
+const menu_latency_hist_t *menu_latency_get (menu_latency_stage_t stage)
+{
+    return stage < MENU_LATENCY_STAGES ? &s_latency.hist[stage] : NULL;
+}
+
+/**
+ * @brief Перцентиль стадии с точностью до корзины.
+ *
+ * @param permille Доля в тысячных (500 -- медиана, 990 -- p99).
+ * @return Нижняя граница корзины, в которую попадает перцентиль, но не больше max.
+ */
+uint32_t menu_latency_percentile (menu_latency_stage_t stage, uint32_t permille)
+{
+    const menu_latency_hist_t *hist = menu_latency_get(stage);
+
+    if (hist == NULL || hist->count == 0)
+        return 0;
+
+    uint64_t target = ((uint64_t)hist->count * permille + 999u) / 1000u;
+    uint64_t seen   = 0;
+
+    if (target == 0)
+        target = 1;
+
+    for (uint32_t i = 0; i < MENU_LATENCY_BUCKETS; i++)
+    {
+        seen += hist->buckets[i];
+        if (seen >= target)
+        {
+            uint32_t floor = s_latency_bucket_floor(i);
+            return floor < hist->min ? hist->min : floor > hist->max ? hist->max : floor;
+        }
+    }
+
+    return hist->max;
+}
+
+/**
+ * @brief Построчный отчёт: сводка и непустые корзины каждой стадии.
+ */
+void menu_latency_dump (menu_latency_write_t write)
+{
+    char line[128];
+
+    for (uint32_t stage = 0; stage < MENU_LATENCY_STAGES; stage++)
+    {
+        const menu_latency_hist_t *hist = &s_latency.hist[stage];
+
+        snprintf(line, sizeof(line), "%s: count=%lu min=%lu p50=%lu p90=%lu p99=%lu max=%lu mean=%lu",
+                 s_latency_stage_names[stage], (unsigned long)hist->count, (unsigned long)hist->min,
+                 (unsigned long)menu_latency_percentile(stage, 500), (unsigned long)menu_latency_percentile(stage, 900),
+                 (unsigned long)menu_latency_percentile(stage, 990), (unsigned long)hist->max,
+                 (unsigned long)(hist->count ? hist->sum / hist->count : 0));
+        write(line);
+
+        for (uint32_t i = 0; i < MENU_LATENCY_BUCKETS; i++)
+        {
+            if (hist->buckets[i])
+            {
+                snprintf(line, sizeof(line), "  >=%lu: %lu",
+                         (unsigned long)s_latency_bucket_floor(i), (unsigned long)hist->buckets[i]);
+                write(line);
+            }
+        }
+    }
+}
+
+#endif
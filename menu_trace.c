@@ -0,0 +1,203 @@
+#include <string.h>
+#include <stdatomic.h>
+
+#include "menu_trace.h"
+
+#if (MENU_TRACE_ENABLE != 0)
+
+#if defined(__unix__) || defined(__APPLE__)
+#define MENU_TRACE_POSIX 1
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#endif
+
+#ifndef MENU_TRACE_NOW
+#include <time.h>
+/**
+ * @brief Источник времени по умолчанию (хост): монотонное время в тиках MENU_TRACE_TICK_NS.
+ *        На микроконтроллере переопределяется, например `-DMENU_TRACE_NOW()=HAL_GetTick()`.
+ */
+static uint32_t s_trace_now (void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint32_t)(((uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec) / MENU_TRACE_TICK_NS);
+}
+#define MENU_TRACE_NOW() s_trace_now()
+#endif
+
+static _Atomic uint32_t s_trace_ring[MENU_TRACE_SIZE]; ///< Кольцо записей
+static _Atomic uint32_t s_trace_seq[MENU_TRACE_SIZE];  ///< Номер слота записи + 1 (0 -- слот пуст или запись не завершена)
+static _Atomic uint32_t s_trace_head;                  ///< Количество зарезервированных слотов за всё время
+static _Atomic uint32_t s_trace_last;                  ///< Время последней записи
+
+#if defined(MENU_TRACE_POSIX)
+static char     s_trace_crash_path[256];               ///< Файл для дампа при аварийном завершении
+static uint32_t s_trace_crash_records[MENU_TRACE_SIZE]; ///< Буфер снимка для обработчика сигнала (без стека и malloc)
+#endif
+
+/**
+ * @brief Заполняет зарезервированный слот `slot`.
+ *
+ * Номер слота снимается до записи и ставится после неё: снимок отличает законченную запись
+ * этого круга от записи прошлого круга, которую писатель ещё не заменил.
+ */
+static void s_trace_store (uint32_t slot, uint32_t record)
+{
+    uint32_t index = slot & (MENU_TRACE_SIZE - 1);
+
+    atomic_store_explicit(&s_trace_seq[index], 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+    atomic_store_explicit(&s_trace_ring[index], record, memory_order_relaxed);
+    atomic_store_explicit(&s_trace_seq[index], slot + 1, memory_order_release);
+}
+
+/**
+ * @brief Добавляет запись в кольцо. Безопасна в прерываниях и из нескольких потоков.
+ *
+ * Расширение времени и его событие занимают два соседних слота, зарезервированных одним
+ * атомарным сложением: запись из прерывания не попадёт между ними.
+ */
+void menu_trace_write (menu_trace_event_t event, uint8_t arg)
+{
+    uint32_t now   = MENU_TRACE_NOW();
+    uint32_t delta = now - atomic_exchange_explicit(&s_trace_last, now, memory_order_relaxed);
+    uint32_t slots = (delta > 0xFFFFu) ? 2 : 1;
+    uint32_t slot  = atomic_fetch_add_explicit(&s_trace_head, slots, memory_order_relaxed);
+
+    if (slots == 2)
+    {
+        uint32_t high = delta >> 16; // Не больше 16 бит: в расширение (24 бита) помещается без насыщения
+        s_trace_store(slot++, MENU_TRACE_RECORD(MENU_TRACE_EV_TIME, high >> 16, high));
+    }
+
+    s_trace_store(slot, MENU_TRACE_RECORD(event, arg, delta));
+}
+
+/**
+ * @brief Копирует записи от старой к новой.
+ *
+ * @param records Буфер для записей.
+ * @param capacity Размер буфера в записях.
+ * @return Количество скопированных записей. Незавершённые слоты пропускаются, в том числе после
+ *         переполнения кольца, когда в слоте ещё лежит запись прошлого круга: номер слота в
+ *         `s_trace_seq` не совпадёт. Расширение времени без своего события тоже пропускается.
+ */
+uint32_t menu_trace_snapshot (uint32_t *records, uint32_t capacity)
+{
+    uint32_t head  = atomic_load_explicit(&s_trace_head, memory_order_acquire);
+    uint32_t count = head < MENU_TRACE_SIZE ? head : MENU_TRACE_SIZE;
+    uint32_t out   = 0;
+
+    for (uint32_t i = head - count; i != head && out < capacity; i++)
+    {
+        uint32_t index  = i & (MENU_TRACE_SIZE - 1);
+        uint32_t seq    = atomic_load_explicit(&s_trace_seq[index], memory_order_acquire);
+        uint32_t record = atomic_load_explicit(&s_trace_ring[index], memory_order_relaxed);
+        atomic_thread_fence(memory_order_acquire);
+        if (seq != i + 1 || atomic_load_explicit(&s_trace_seq[index], memory_order_relaxed) != seq)
+        {
+            // Расширение времени без своего события отнесло бы приращение к следующему
+            if (out > 0 && MENU_TRACE_RECORD_EVENT(records[out - 1]) == MENU_TRACE_EV_TIME)
+                out--;
+            continue;
+        }
+        records[out++] = record;
+    }
+
+    return out;
+}
+
+void menu_trace_reset (void)
+{
+    for (uint32_t i = 0; i < MENU_TRACE_SIZE; i++)
+    {
+        atomic_store_explicit(&s_trace_ring[i], 0, memory_order_relaxed);
+        atomic_store_explicit(&s_trace_seq[i], 0, memory_order_relaxed);
+    }
+    atomic_store(&s_trace_head, 0);
+    atomic_store(&s_trace_last, MENU_TRACE_NOW());
+}
+
+#if defined(MENU_TRACE_POSIX)
+static void s_trace_put_le32 (uint8_t *out, uint32_t value)
+{
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Пишет снимок в файл только через open/write, чтобы её можно было вызывать из обработчика сигнала.
+ */
+static int s_trace_dump_records (const char *path, uint32_t *records)
+{
+    uint32_t count = menu_trace_snapshot(records, MENU_TRACE_SIZE);
+    uint8_t  word[4];
+    uint32_t header[4] = { MENU_TRACE_MAGIC, MENU_TRACE_VERSION, MENU_TRACE_TICK_NS, count };
+    int      result = 0;
+
+    int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0)
+        return -1;
+
+    for (uint32_t i = 0; i < 4 && result == 0; i++)
+    {
+        s_trace_put_le32(word, header[i]);
+        result = write(fd, word, sizeof(word)) == (ssize_t)sizeof(word) ? 0 : -1;
+    }
+
+    for (uint32_t i = 0; i < count && result == 0; i++)
+    {
+        s_trace_put_le32(word, records[i]);
+        result = write(fd, word, sizeof(word)) == (ssize_t)sizeof(word) ? 0 : -1;
+    }
+
+    close(fd);
+    return result;
+}
+
+static void s_trace_crash_handler (int sig)
+{
+    s_trace_dump_records(s_trace_crash_path, s_trace_crash_records);
+    signal(sig, SIG_DFL);
+    raise(sig);
+}
+#endif
+
+/**
+ * @brief Сохраняет кольцо в файл (формат -- см. menu_trace.h).
+ * @return 0 при успехе, -1 при ошибке или если платформа не поддерживает файлы.
+ */
+int menu_trace_dump (const char *path)
+{
+#if defined(MENU_TRACE_POSIX)
+    static uint32_t records[MENU_TRACE_SIZE];
+    return s_trace_dump_records(path, records);
+#else
+    (void)path;
+    return -1;
+#endif
+}
+
+/**
+ * @brief Устанавливает обработчики SIGSEGV, SIGBUS, SIGILL, SIGFPE и SIGABRT, сохраняющие кольцо в файл.
+ */
+void menu_trace_install_crash_dump (const char *path)
+{
+#if defined(MENU_TRACE_POSIX)
+    strncpy(s_trace_crash_path, path, sizeof(s_trace_crash_path) - 1);
+
+    static const int signals[] = { SIGSEGV, SIGBUS, SIGILL, SIGFPE, SIGABRT };
+    for (uint32_t i = 0; i < sizeof(signals) / sizeof(signals[0]); i++)
+    {
+        signal(signals[i], s_trace_crash_handler);
+    }
+#else
+    (void)path;
+#endif
+}
+
+#endif
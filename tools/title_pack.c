@@ -0,0 +1,303 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+
+#include "menu.h"
+
+/**
+ * Сжатие таблицы строк языка словарём фрагментов (menu_packed_t, Menu_SetLanguagePacked).
+ *
+ * Обучение -- слияние пар (BPE): на каждом шаге самая выгодная пара соседних символов по всем
+ * заголовкам становится фрагментом словаря, пока есть коды 0x80..0xFF и пара окупает место
+ * фрагмента в словаре. Фрагменты хранятся развёрнутыми (не ссылками на другие фрагменты), не
+ * длиннее MENU_PACKED_TOKEN_LEN, поэтому распаковка -- один проход по кодам без рекурсии.
+ *
+ * Запуск: MenuTitlePack TITLES_FILE NAME [--tokens N] > NAME.c
+ *
+ * TITLES_FILE -- по заголовку на строку (строка i -- строка i таблицы, не длиннее
+ * MENU_ITEM_TITLE_LEN байт; длиннее -- обрезается), заголовки уже в кодах дисплея. На stdout --
+ * исходник с `const menu_packed_t NAME`, на stderr -- размеры и степень сжатия.
+ */
+
+#define TITLE_PACK_SYMBOLS (256 + MENU_PACKED_TOKENS) ///< Знаки 0..255 и фрагменты
+
+/**
+ * @typedef title_pack_t
+ * @brief Сжатая таблица в памяти: те же массивы, что выводятся в исходник.
+ */
+typedef struct {
+    uint8_t  *codes;       ///< Коды всех строк подряд
+    uint32_t  code_bytes;  ///< Байт кодов
+    uint16_t *offsets;     ///< Начала строк, `count + 1` записей
+    char    (*tokens)[MENU_PACKED_TOKEN_LEN]; ///< Фрагменты
+    uint8_t   lengths[MENU_PACKED_TOKENS];    ///< Длины фрагментов
+    uint32_t  token_count; ///< Фрагментов в словаре
+    uint32_t  count;       ///< Строк
+} title_pack_t;
+
+/**
+ * @brief Байт кодов на знак: коды 0x7F..0xFF идут через MENU_PACKED_ESCAPE.
+ */
+static uint32_t s_title_pack_cost (uint32_t symbol)
+{
+    return symbol >= 256 ? 1 : (symbol >= MENU_PACKED_ESCAPE ? 2 : 1);
+}
+
+static uint32_t s_title_pack_length (const title_pack_t *pack, uint32_t symbol)
+{
+    return symbol >= 256 ? pack->lengths[symbol - 256] : 1;
+}
+
+/**
+ * @brief Обучает словарь не больше чем из `tokens` фрагментов и сжимает `count` заголовков.
+ * @return 0 или -1 (нет памяти, коды не помещаются в uint16_t смещений).
+ */
+int title_pack_train (title_pack_t *pack, const char *const *titles, uint32_t count, uint32_t tokens)
+{
+    uint16_t (*symbols)[MENU_ITEM_TITLE_LEN] = malloc((size_t)count * sizeof(*symbols) + 1);
+    uint8_t   *lengths = malloc((size_t)count + 1);
+    uint32_t  *pairs   = malloc((size_t)TITLE_PACK_SYMBOLS * TITLE_PACK_SYMBOLS * sizeof(uint32_t));
+
+    memset(pack, 0, sizeof(*pack));
+    pack->tokens  = calloc(MENU_PACKED_TOKENS, MENU_PACKED_TOKEN_LEN);
+    pack->offsets = malloc(((size_t)count + 1) * sizeof(uint16_t));
+    pack->count   = count;
+    if (symbols == NULL || lengths == NULL || pairs == NULL || pack->tokens == NULL || pack->offsets == NULL)
+        goto fail;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        lengths[i] = (uint8_t)strnlen(titles[i], MENU_ITEM_TITLE_LEN);
+        for (uint32_t k = 0; k < lengths[i]; k++)
+            symbols[i][k] = (uint8_t)titles[i][k];
+    }
+
+    if (tokens > MENU_PACKED_TOKENS)
+        tokens = MENU_PACKED_TOKENS;
+
+    while (pack->token_count < tokens)
+    {
+        // Выгода пары -- байт кодов, сэкономленных её заменой одним кодом, по всем вхождениям
+        memset(pairs, 0, (size_t)TITLE_PACK_SYMBOLS * TITLE_PACK_SYMBOLS * sizeof(uint32_t));
+        for (uint32_t i = 0; i < count; i++)
+        {
+            for (uint32_t k = 0; k + 1 < lengths[i]; k++)
+            {
+                uint32_t a = symbols[i][k];
+                uint32_t b = symbols[i][k + 1];
+                if (s_title_pack_length(pack, a) + s_title_pack_length(pack, b) <= MENU_PACKED_TOKEN_LEN)
+                    pairs[a * TITLE_PACK_SYMBOLS + b] += s_title_pack_cost(a) + s_title_pack_cost(b) - 1;
+            }
+        }
+
+        uint32_t best = 0;
+        for (uint32_t p = 1; p < TITLE_PACK_SYMBOLS * TITLE_PACK_SYMBOLS; p++)
+        {
+            if (pairs[p] > pairs[best])
+                best = p;
+        }
+
+        // Фрагмент окупается, если экономит больше, чем занимает в словаре
+        if (pairs[best] <= MENU_PACKED_TOKEN_LEN + 1)
+            break;
+
+        uint32_t a     = best / TITLE_PACK_SYMBOLS;
+        uint32_t b     = best % TITLE_PACK_SYMBOLS;
+        uint32_t token = pack->token_count++;
+        uint32_t la    = s_title_pack_length(pack, a);
+
+        if (a >= 256)
+            memcpy(pack->tokens[token], pack->tokens[a - 256], la);
+        else
+            pack->tokens[token][0] = (char)a;
+        if (b >= 256)
+            memcpy(pack->tokens[token] + la, pack->tokens[b - 256], pack->lengths[b - 256]);
+        else
+            pack->tokens[token][la] = (char)b;
+        pack->lengths[token] = (uint8_t)(la + s_title_pack_length(pack, b));
+
+        // Замена вхождений слева направо, без перекрытий
+        for (uint32_t i = 0; i < count; i++)
+        {
+            uint32_t out = 0;
+            for (uint32_t k = 0; k < lengths[i]; k++)
+            {
+                if (k + 1 < lengths[i] && symbols[i][k] == a && symbols[i][k + 1] == b)
+                {
+                    symbols[i][out++] = (uint16_t)(256 + token);
+                    k++;
+                }
+                else
+                {
+                    symbols[i][out++] = symbols[i][k];
+                }
+            }
+            lengths[i] = (uint8_t)out;
+        }
+    }
+
+    uint64_t bytes = 0;
+    for (uint32_t i = 0; i < count; i++)
+    {
+        for (uint32_t k = 0; k < lengths[i]; k++)
+            bytes += s_title_pack_cost(symbols[i][k]);
+    }
+    if (bytes > UINT16_MAX)
+        goto fail;
+
+    pack->codes = calloc((size_t)bytes + 1, 1);
+    if (pack->codes == NULL)
+        goto fail;
+
+    for (uint32_t i = 0; i < count; i++)
+    {
+        pack->offsets[i] = (uint16_t)pack->code_bytes;
+        for (uint32_t k = 0; k < lengths[i]; k++)
+        {
+            uint32_t symbol = symbols[i][k];
+            if (symbol >= 256)
+            {
+                pack->codes[pack->code_bytes++] = (uint8_t)(0x80 | (symbol - 256));
+                continue;
+            }
+            if (symbol >= MENU_PACKED_ESCAPE)
+                pack->codes[pack->code_bytes++] = MENU_PACKED_ESCAPE;
+            pack->codes[pack->code_bytes++] = (uint8_t)symbol;
+        }
+    }
+    pack->offsets[count] = (uint16_t)pack->code_bytes;
+
+    free(symbols);
+    free(lengths);
+    free(pairs);
+    return 0;
+
+fail:
+    free(symbols);
+    free(lengths);
+    free(pairs);
+    free(pack->tokens);
+    free(pack->offsets);
+    memset(pack, 0, sizeof(*pack));
+    return -1;
+}
+
+/**
+ * @brief Таблица для Menu_SetLanguagePacked поверх массивов `pack` (без копирования).
+ */
+void title_pack_view (const title_pack_t *pack, menu_packed_t *packed)
+{
+    packed->codes   = pack->codes;
+    packed->offsets = pack->offsets;
+    packed->tokens  = (const char (*)[MENU_PACKED_TOKEN_LEN])pack->tokens;
+    packed->lengths = pack->lengths;
+    packed->count   = (uint16_t)pack->count;
+}
+
+/**
+ * @brief Байт ПЗУ сжатой таблицы: коды, смещения и словарь.
+ */
+uint32_t title_pack_bytes (const title_pack_t *pack)
+{
+    return pack->code_bytes + (pack->count + 1) * (uint32_t)sizeof(uint16_t) +
+           pack->token_count * (MENU_PACKED_TOKEN_LEN + 1);
+}
+
+void title_pack_free (title_pack_t *pack)
+{
+    free(pack->codes);
+    free(pack->offsets);
+    free(pack->tokens);
+    memset(pack, 0, sizeof(*pack));
+}
+
+#ifndef TITLE_PACK_LIBRARY
+static void s_title_pack_bytes (const char *type, const char *name, const char *suffix, const uint8_t *data, uint32_t size)
+{
+    printf("static const %s %s_%s[] = {", type, name, suffix);
+    for (uint32_t i = 0; i < size; i++)
+        printf("%s0x%02X,", i % 16 ? " " : "\n    ", data[i]);
+    printf("\n};\n\n");
+}
+
+int main(int argc, char *argv[])
+{
+    uint32_t tokens = MENU_PACKED_TOKENS;
+
+    if (argc == 5 && strcmp(argv[3], "--tokens") == 0)
+        tokens = (uint32_t)strtoul(argv[4], NULL, 0);
+    else if (argc != 3)
+    {
+        fprintf(stderr, "usage: %s TITLES_FILE NAME [--tokens N]\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL)
+    {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    char   line[256];
+    char **titles = NULL;
+    uint32_t count = 0;
+    uint64_t raw = 0;
+    while (fgets(line, sizeof(line), file))
+    {
+        line[strcspn(line, "\r\n")] = '\0';
+        char **grown = realloc(titles, (count + 1) * sizeof(*titles));
+        if (grown == NULL)
+            return EXIT_FAILURE;
+        titles = grown;
+        titles[count] = strdup(line);
+        raw += strnlen(line, MENU_ITEM_TITLE_LEN) + 1;
+        count++;
+    }
+    fclose(file);
+
+    title_pack_t pack;
+    if (count == 0 || count > UINT16_MAX || title_pack_train(&pack, (const char *const *)titles, count, tokens) != 0)
+    {
+        fprintf(stderr, "%s: cannot pack %u titles\n", argv[1], count);
+        return EXIT_FAILURE;
+    }
+
+    const char *name = argv[2];
+    printf("/* Сгенерировано MenuTitlePack из %s: %u строк, %u фрагментов */\n", argv[1], count, pack.token_count);
+    printf("#include \"menu.h\"\n\n");
+    s_title_pack_bytes("uint8_t", name, "codes", pack.codes, pack.code_bytes ? pack.code_bytes : 1);
+
+    printf("static const uint16_t %s_offsets[] = {", name);
+    for (uint32_t i = 0; i <= count; i++)
+        printf("%s%u,", i % 12 ? " " : "\n    ", pack.offsets[i]);
+    printf("\n};\n\n");
+
+    printf("static const char %s_tokens[][MENU_PACKED_TOKEN_LEN] = {\n", name);
+    for (uint32_t t = 0; t < pack.token_count; t++)
+    {
+        printf("    {");
+        for (uint32_t k = 0; k < MENU_PACKED_TOKEN_LEN; k++)
+            printf("%s0x%02X", k ? ", " : "", (uint8_t)pack.tokens[t][k]);
+        printf("},\n");
+    }
+    if (pack.token_count == 0)
+        printf("    {0},\n");
+    printf("};\n\n");
+    s_title_pack_bytes("uint8_t", name, "lengths", pack.lengths, pack.token_count ? pack.token_count : 1);
+
+    printf("const menu_packed_t %s = { %s_codes, %s_offsets, %s_tokens, %s_lengths, %u };\n",
+           name, name, name, name, name, count);
+
+    fprintf(stderr, "%u titles: table %u bytes, strings %llu bytes, packed %u bytes (codes %u, dictionary %u tokens), ratio %.2f / %.2f\n",
+            count, count * MENU_ITEM_TITLE_LEN, (unsigned long long)raw, title_pack_bytes(&pack), pack.code_bytes,
+            pack.token_count, (double)count * MENU_ITEM_TITLE_LEN / title_pack_bytes(&pack), (double)raw / title_pack_bytes(&pack));
+
+    title_pack_free(&pack);
+    for (uint32_t i = 0; i < count; i++)
+        free(titles[i]);
+    free(titles);
+    return EXIT_SUCCESS;
+}
+#endif
@@ -0,0 +1,117 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <stdint.h>
+
+#include "menu_trace.h"
+
+/**
+ * Расшифровка дампа бортового самописца меню (menu_trace_dump) в текстовую ленту событий.
+ *
+ * Запуск: MenuTraceDecode menu_trace.bin
+ *
+ * Время отсчитывается от самой старой записи в дампе.
+ */
+
+static const char *s_event_names[MENU_TRACE_EV_COUNT] = {
+    "empty", "time", "input", "nav", "callback-begin", "callback-end", "render", "persist", "user"
+};
+
+static const char *s_input_names[] = { "rotate-next", "rotate-prev", "push", "long-push", "jump" };
+static const char *s_nav_names[]   = { "next", "prev", "child", "parent", "start", "jump" };
+
+static int s_read_le32 (FILE *file, uint32_t *value)
+{
+    uint8_t b[4];
+
+    if (fread(b, 1, sizeof(b), file) != sizeof(b))
+        return -1;
+
+    *value = (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24);
+    return 0;
+}
+
+static void s_print_arg (uint8_t event, uint8_t arg)
+{
+    switch (event)
+    {
+        case MENU_TRACE_EV_INPUT:
+            printf("%s", arg < sizeof(s_input_names) / sizeof(s_input_names[0]) ? s_input_names[arg] : "?");
+            break;
+        case MENU_TRACE_EV_NAV:
+            printf("%s", arg < sizeof(s_nav_names) / sizeof(s_nav_names[0]) ? s_nav_names[arg] : "?");
+            break;
+        case MENU_TRACE_EV_RENDER:
+            printf("'%c'", arg >= 0x20 && arg < 0x7F ? arg : '?');
+            break;
+        default:
+            printf("%u", arg);
+            break;
+    }
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "usage: %s TRACE_FILE\n", argv[0]);
+        return EXIT_FAILURE;
+    }
+
+    FILE *file = fopen(argv[1], "rb");
+    if (file == NULL)
+    {
+        perror(argv[1]);
+        return EXIT_FAILURE;
+    }
+
+    menu_trace_file_header_t header;
+    if (s_read_le32(file, &header.magic) || s_read_le32(file, &header.version) ||
+        s_read_le32(file, &header.tick_ns) || s_read_le32(file, &header.count) ||
+        header.magic != MENU_TRACE_MAGIC || header.version != MENU_TRACE_VERSION)
+    {
+        fprintf(stderr, "%s: not a menu trace (version %u expected)\n", argv[1], MENU_TRACE_VERSION);
+        fclose(file);
+        return EXIT_FAILURE;
+    }
+
+    printf("# %u records, tick %u ns\n", header.count, header.tick_ns);
+    printf("#      time, s      delta, s  event           arg\n");
+
+    uint64_t ticks = 0;
+    uint64_t pending_high = 0;
+    int first = 1;
+
+    for (uint32_t i = 0; i < header.count; i++)
+    {
+        uint32_t record;
+        if (s_read_le32(file, &record))
+        {
+            fprintf(stderr, "%s: truncated after %u records\n", argv[1], i);
+            break;
+        }
+
+        uint8_t event = MENU_TRACE_RECORD_EVENT(record);
+        uint8_t arg   = MENU_TRACE_RECORD_ARG(record);
+
+        if (event == MENU_TRACE_EV_TIME)
+        {
+            pending_high = ((uint64_t)arg << 16 | MENU_TRACE_RECORD_DELTA(record)) << 16;
+            continue;
+        }
+
+        // Приращение самой старой записи относится к событию, которого уже нет в кольце
+        uint64_t delta = first ? 0 : pending_high + MENU_TRACE_RECORD_DELTA(record);
+        pending_high = 0;
+        first = 0;
+        ticks += delta;
+
+        printf("%14.6f  %+12.6f  %-14s  ", (double)ticks * header.tick_ns * 1e-9,
+               (double)delta * header.tick_ns * 1e-9,
+               event < MENU_TRACE_EV_COUNT ? s_event_names[event] : "unknown");
+        s_print_arg(event, arg);
+        printf("\n");
+    }
+
+    fclose(file);
+    return EXIT_SUCCESS;
+}